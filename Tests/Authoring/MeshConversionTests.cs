@@ -122,6 +122,116 @@ namespace Unity.Tiny.Authoring.Tests
             meshFilter.sharedMesh = mesh;
         }
 
+        // Closed UV sphere of triangles, the seam column and the poles have their own vertices like an imported mesh.
+        // Rings are split evenly into subMeshCount sub meshes, and the vertices are shuffled when seed is not 0.
+        GameObject InitGameObjectSphere(string shaderName, int rings, int segments, int subMeshCount, int seed)
+        {
+            GameObject sphere = new GameObject();
+            var meshRenderer = sphere.AddComponent<UnityEngine.MeshRenderer>();
+            var meshFilter = sphere.AddComponent<UnityEngine.MeshFilter>();
+
+            var materials = new Material[subMeshCount];
+            for (int i = 0; i < subMeshCount; i++)
+                materials[i] = new Material(Shader.Find(shaderName));
+            meshRenderer.sharedMaterials = materials;
+
+            int vertexCount = (rings + 1) * (segments + 1);
+            int[] order = new int[vertexCount];
+            for (int i = 0; i < vertexCount; i++)
+                order[i] = i;
+            if (seed != 0)
+            {
+                var random = new System.Random(seed);
+                for (int i = vertexCount - 1; i > 0; i--)
+                {
+                    int j = random.Next(i + 1);
+                    int t = order[i];
+                    order[i] = order[j];
+                    order[j] = t;
+                }
+            }
+
+            var vertices = new Vector3[vertexCount];
+            var uvs = new Vector2[vertexCount];
+            for (int r = 0; r <= rings; r++)
+            {
+                for (int s = 0; s <= segments; s++)
+                {
+                    float theta = Mathf.PI * r / rings;
+                    float phi = 2.0f * Mathf.PI * s / segments;
+                    int v = order[r * (segments + 1) + s];
+                    vertices[v] = new Vector3(Mathf.Sin(theta) * Mathf.Cos(phi), Mathf.Cos(theta), Mathf.Sin(theta) * Mathf.Sin(phi));
+                    uvs[v] = new Vector2((float)s / segments, (float)r / rings);
+                }
+            }
+
+            var mesh = new Mesh();
+            mesh.subMeshCount = subMeshCount;
+            mesh.vertices = vertices;
+            mesh.uv = uvs;
+            int ringsPerSubMesh = (rings + subMeshCount - 1) / subMeshCount;
+            for (int i = 0; i < subMeshCount; i++)
+            {
+                List<int> indices = new List<int>();
+                for (int r = i * ringsPerSubMesh; r < Mathf.Min(rings, (i + 1) * ringsPerSubMesh); r++)
+                {
+                    for (int s = 0; s < segments; s++)
+                    {
+                        int a = order[r * (segments + 1) + s];
+                        int b = order[r * (segments + 1) + s + 1];
+                        int c = order[(r + 1) * (segments + 1) + s];
+                        int d = order[(r + 1) * (segments + 1) + s + 1];
+                        if (r > 0)
+                            indices.AddRange(new[] { a, c, b });
+                        if (r < rings - 1)
+                            indices.AddRange(new[] { b, c, d });
+                    }
+                }
+                mesh.SetTriangles(indices, i);
+            }
+            mesh.RecalculateBounds();
+            mesh.RecalculateNormals();
+            mesh.RecalculateTangents();
+            meshFilter.sharedMesh = mesh;
+
+            return sphere;
+        }
+
+        static string CornerKey(float3 position, float2 uv)
+        {
+            return $"{position.x:R},{position.y:R},{position.z:R}/{uv.x:R},{uv.y:R}";
+        }
+
+        // Triangles as position and uv of their corners, starting at the smallest corner so the winding is kept
+        static List<string> TriangleKeys(List<string> corners)
+        {
+            var triangles = new List<string>();
+            for (int i = 0; i < corners.Count; i += 3)
+            {
+                int first = i;
+                for (int k = i + 1; k < i + 3; k++)
+                {
+                    if (string.CompareOrdinal(corners[k], corners[first]) < 0)
+                        first = k;
+                }
+                int o = first - i;
+                triangles.Add(corners[i + o] + ";" + corners[i + (o + 1) % 3] + ";" + corners[i + (o + 2) % 3]);
+            }
+            triangles.Sort(string.CompareOrdinal);
+            return triangles;
+        }
+
+        // Triangles of a sub mesh of the source mesh, with the uvs flipped like the conversion does
+        static List<string> SourceTriangleKeys(Mesh uMesh, int subMesh)
+        {
+            var vertices = uMesh.vertices;
+            var uvs = uMesh.uv;
+            var corners = new List<string>();
+            foreach (int v in uMesh.GetIndices(subMesh))
+                corners.Add(CornerKey(vertices[v], new float2(uvs[v].x, 1 - uvs[v].y)));
+            return TriangleKeys(corners);
+        }
+
         [Test]
         public void TinySimpleMeshConversionTest()
         {
@@ -228,6 +338,181 @@ namespace Unity.Tiny.Authoring.Tests
             Assert.IsTrue(blob1.GetUnsafePtr() == blob2.GetUnsafePtr());
         }
 
+        [Test]
+        public void TinyMeshVertexOrderConversionTest()
+        {
+            GameObject go = InitGameObjectSphere("Universal Render Pipeline/Unlit", 16, 32, 2, 1234);
+            var uMesh = go.GetComponent<MeshFilter>().sharedMesh;
+
+            //Run GO conversion
+            var entity = GameObjectConversionUtility.ConvertGameObjectHierarchy(go, settings);
+            var meshRenderer = entityManager.GetComponentData<MeshRenderer>(entity);
+            var blobAsset = entityManager.GetComponentData<SimpleMeshRenderData>(meshRenderer.mesh).Mesh;
+            ref SimpleMeshData data = ref blobAsset.Value;
+            Assert.IsTrue(data.Vertices.Length == uMesh.vertexCount);
+
+            //Test sub mesh ranges
+            Assert.IsTrue(meshRenderer.startIndex == (int)uMesh.GetIndexStart(0));
+            Assert.IsTrue(meshRenderer.indexCount == (int)uMesh.GetIndexCount(0));
+            Assert.IsTrue(data.Indices.Length == (int)(uMesh.GetIndexCount(0) + uMesh.GetIndexCount(1)));
+
+            //Test every sub mesh range still holds the same triangles
+            for (int i = 0; i < uMesh.subMeshCount; i++)
+            {
+                var corners = new List<string>();
+                int start = (int)uMesh.GetIndexStart(i);
+                int end = start + (int)uMesh.GetIndexCount(i);
+                for (int j = start; j < end; j++)
+                {
+                    ref SimpleVertex vertex = ref data.Vertices[data.Indices[j]];
+                    corners.Add(CornerKey(vertex.Position, vertex.TexCoord0));
+                }
+                CollectionAssert.AreEqual(SourceTriangleKeys(uMesh, i), TriangleKeys(corners));
+            }
+
+            //Test vertices are numbered in order of first use
+            int next = 0;
+            for (int j = 0; j < data.Indices.Length; j++)
+            {
+                Assert.IsTrue(data.Indices[j] <= next);
+                if (data.Indices[j] == next)
+                    next++;
+            }
+        }
+
+        [Test]
+        public void TinyBlendShapeMeshVertexOrderConversionTest()
+        {
+            GameObject go = InitGameObjectSphere("Universal Render Pipeline/Lit", 16, 32, 1, 1234);
+            var uMesh = go.GetComponent<MeshFilter>().sharedMesh;
+            var deltas = new Vector3[uMesh.vertexCount];
+            for (int i = 0; i < deltas.Length; i++)
+                deltas[i] = new Vector3(0, 0.1f, 0);
+            uMesh.AddBlendShapeFrame("Up", 100, deltas, null, null);
+
+            //Run GO conversion
+            var entity = GameObjectConversionUtility.ConvertGameObjectHierarchy(go, settings);
+            var entityMesh = entityManager.GetComponentData<MeshRenderer>(entity).mesh;
+            var blobAsset = entityManager.GetComponentData<LitMeshRenderData>(entityMesh).Mesh;
+            ref LitMeshData data = ref blobAsset.Value;
+
+            //Test blend shape deltas still line up with the vertices, nothing was reordered
+            var vertices = uMesh.vertices;
+            Assert.IsTrue(data.Vertices.Length == vertices.Length);
+            for (int i = 0; i < vertices.Length; i++)
+                Assert.IsTrue(data.Vertices[i].Position.Equals((float3)vertices[i]));
+
+            var indices = uMesh.GetIndices(0);
+            Assert.IsTrue(data.Indices.Length == indices.Length);
+            for (int j = 0; j < indices.Length; j++)
+                Assert.IsTrue(data.Indices[j] == indices[j]);
+        }
+
+        [Test]
+        public unsafe void TinyBlendShapeSparseConversionTest()
+        {
+            GameObject go = InitGameObjectSphere("Universal Render Pipeline/Lit", 16, 32, 1, 0);
+            var uMesh = go.GetComponent<MeshFilter>().sharedMesh;
+            var uVertices = uMesh.vertices;
+            var deltaVertices = new Vector3[uVertices.Length];
+            var deltaNormals = new Vector3[uVertices.Length];
+            for (int i = 0; i < uVertices.Length; i++)
+            {
+                if (uVertices[i].y > 0.5f)
+                    deltaVertices[i] = uVertices[i] * 0.2f;
+                if (uVertices[i].x > 0.8f)
+                    deltaNormals[i] = new Vector3(0, 0.1f, 0);
+            }
+            uMesh.AddBlendShapeFrame("Bulge", 100, deltaVertices, deltaNormals, null);
+
+            //Run GO conversion
+            var entity = GameObjectConversionUtility.ConvertGameObjectHierarchy(go, settings);
+            var entityMesh = entityManager.GetComponentData<MeshRenderer>(entity).mesh;
+            Assert.IsTrue(entityManager.HasComponent<MeshBlendShapeData>(entityMesh));
+            var blendShapeAsset = entityManager.GetComponentData<MeshBlendShapeData>(entityMesh).BlendShapeDataRef;
+            ref BlendShapeData blendShapes = ref blendShapeAsset.Value;
+            Assert.IsTrue(blendShapes.Channels.Length == 1);
+            Assert.IsTrue(blendShapes.Channels[0].Frames.Length == 1);
+            ref BlendShapeFrame frame = ref blendShapes.Channels[0].Frames[0];
+
+            //Test only moved vertices are stored, and expanding them gives the dense deltas back
+            Assert.IsTrue(frame.Weight == 100);
+            Assert.IsTrue(frame.HasNormals);
+            Assert.IsFalse(frame.HasTangents);
+            Assert.IsTrue(frame.VertexIndices.Length > 0 && frame.VertexIndices.Length < uVertices.Length);
+            var densePositions = new float3[uVertices.Length];
+            var denseNormals = new float3[uVertices.Length];
+            for (int k = 0; k < frame.VertexIndices.Length; k++)
+            {
+                Assert.IsTrue(k == 0 || frame.VertexIndices[k] > frame.VertexIndices[k - 1]);
+                densePositions[frame.VertexIndices[k]] = frame.VerticesPosition[k].DeltaPosition;
+                denseNormals[frame.VertexIndices[k]] = frame.VerticesNormal[k].DeltaNormal;
+            }
+            for (int i = 0; i < uVertices.Length; i++)
+            {
+                Assert.IsTrue(densePositions[i].Equals((float3)deltaVertices[i]));
+                Assert.IsTrue(denseNormals[i].Equals((float3)deltaNormals[i]));
+            }
+
+            //Test applying the sparse frame gives the same vertices as adding the dense deltas to every vertex
+            ref LitMeshData data = ref entityManager.GetComponentData<LitMeshRenderData>(entityMesh).Mesh.Value;
+            var vertices = new DynamicLitVertex[data.Vertices.Length];
+            for (int i = 0; i < vertices.Length; i++)
+                vertices[i].Value = data.Vertices[i];
+            const float weight = 0.6f;
+            fixed (DynamicLitVertex* verticesPtr = vertices)
+                MeshBlendShapingSystem.MeshBlendShapingJob.ApplyBlendShapeToVertices(weight, ref frame, (byte*)verticesPtr, true);
+            for (int i = 0; i < vertices.Length; i++)
+            {
+                Assert.IsTrue(vertices[i].Value.Position.Equals(data.Vertices[i].Position + weight * (float3)deltaVertices[i]));
+                Assert.IsTrue(vertices[i].Value.Normal.Equals(data.Vertices[i].Normal + weight * (float3)deltaNormals[i]));
+                Assert.IsTrue(vertices[i].Value.Tangent.Equals(data.Vertices[i].Tangent));
+            }
+        }
+
+        [Test]
+        public void TinyMeshLODConversionTest()
+        {
+            GameObject go = InitGameObjectSphere("Universal Render Pipeline/Lit", 40, 80, 1, 0);
+
+            //Run GO conversion
+            var entity = GameObjectConversionUtility.ConvertGameObjectHierarchy(go, settings);
+            var meshRenderer = entityManager.GetComponentData<MeshRenderer>(entity);
+            var blobAsset = entityManager.GetComponentData<LitMeshRenderData>(meshRenderer.mesh).Mesh;
+            ref LitMeshData data = ref blobAsset.Value;
+
+            //Test levels
+            Assert.IsTrue(data.LODs.Length >= 1 && data.LODs.Length <= 3);
+            int previousTriangles = meshRenderer.indexCount / 3;
+            for (int level = 1; level <= data.LODs.Length; level++)
+            {
+                ref MeshLOD lod = ref data.LODs[level - 1];
+                Assert.IsTrue(lod.Level == level);
+                Assert.IsTrue(lod.SubMeshStartIndex == meshRenderer.startIndex);
+                Assert.IsTrue(lod.IndexCount > 0 && lod.IndexCount % 3 == 0);
+                Assert.IsTrue(lod.IndexCount / 3 * 4 <= previousTriangles * 3);
+                Assert.IsTrue(lod.StartIndex >= data.Indices.Length);
+                Assert.IsTrue(lod.StartIndex + lod.IndexCount <= data.Indices.Length + data.LODIndices.Length);
+                previousTriangles = lod.IndexCount / 3;
+            }
+
+            //Test indices
+            for (int j = 0; j < data.LODIndices.Length; j++)
+                Assert.IsTrue(data.LODIndices[j] < data.Vertices.Length);
+
+            //Test renderer
+            Assert.IsTrue(entityManager.HasComponent<MeshRendererLOD>(entity));
+            var rendererLOD = entityManager.GetComponentData<MeshRendererLOD>(entity);
+            Assert.IsTrue(rendererLOD.Matches(meshRenderer));
+            Assert.IsTrue(rendererLOD.startIndex.x == meshRenderer.startIndex);
+            Assert.IsTrue(rendererLOD.indexCount.x == meshRenderer.indexCount);
+            for (int level = 1; level <= data.LODs.Length; level++)
+            {
+                Assert.IsTrue(rendererLOD.startIndex[level] == data.LODs[level - 1].StartIndex);
+                Assert.IsTrue(rendererLOD.indexCount[level] == data.LODs[level - 1].IndexCount);
+            }
+        }
+
         void MeasurePerformanceWithUpdates(List<GameObject> unlitMeshes, List<GameObject> litMeshes, int meshCount, int updateCount)
         {
             if (updateCount > meshCount)
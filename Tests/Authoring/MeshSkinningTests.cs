@@ -0,0 +1,274 @@
+using System.Diagnostics;
+using NUnit.Framework;
+using Unity.Burst;
+using Unity.Collections;
+using Unity.Collections.LowLevel.Unsafe;
+using Unity.Entities;
+using Unity.Jobs;
+using Unity.Mathematics;
+using Unity.PerformanceTesting;
+using Unity.Tiny.Rendering;
+
+namespace Unity.Tiny.Authoring.Tests
+{
+    class MeshSkinningTests
+    {
+        const int kCharacterVertexCount = 8000;
+        const int kCharacterBoneCount = 60;
+        const int kCharacterShapeCount = 16;
+        const int kShapeVertexCount = 400;
+
+        static float4x4 BlendReference(float4x4[] bones, SkinnedMeshVertex skin)
+        {
+            int4 bone = (int4)skin.BoneIndex;
+            return skin.BoneWeight.x * bones[bone.x] + skin.BoneWeight.y * bones[bone.y] +
+                skin.BoneWeight.z * bones[bone.z] + skin.BoneWeight.w * bones[bone.w];
+        }
+
+        [Test]
+        public unsafe void TinyCPUSkinningTest()
+        {
+            var bones = new[]
+            {
+                float4x4.Translate(new float3(1, 2, 3)),
+                float4x4.TRS(new float3(0, 5, 0), quaternion.RotateY(math.PI * 0.5f), new float3(1)),
+                float4x4.TRS(new float3(-2, 0, 1), quaternion.RotateX(0.3f), new float3(2))
+            };
+            var src = new LitVertex[4];
+            var skin = new SkinnedMeshVertex[4];
+            for (int i = 0; i < src.Length; i++)
+            {
+                src[i].Position = new float3(i, 1 - i, 0.5f * i);
+                src[i].Normal = math.normalize(new float3(1, i, 2));
+            }
+            skin[0] = new SkinnedMeshVertex { BoneWeight = new float4(1, 0, 0, 0), BoneIndex = new float4(0, 0, 0, 0) };
+            skin[1] = new SkinnedMeshVertex { BoneWeight = new float4(1, 0, 0, 0), BoneIndex = new float4(1, 0, 0, 0) };
+            skin[2] = new SkinnedMeshVertex { BoneWeight = new float4(0.25f, 0.75f, 0, 0), BoneIndex = new float4(0, 1, 0, 0) };
+            skin[3] = new SkinnedMeshVertex { BoneWeight = new float4(0.1f, 0.2f, 0.3f, 0.4f), BoneIndex = new float4(2, 0, 1, 2) };
+            var dest = new DynamicLitVertex[src.Length];
+
+            fixed (float4x4* bonesPtr = bones)
+            fixed (LitVertex* srcPtr = src)
+            fixed (SkinnedMeshVertex* skinPtr = skin)
+            fixed (DynamicLitVertex* destPtr = dest)
+                CPUMeshSkinningSystem.CPUMeshSkinningJob.SkinVertices(srcPtr, skinPtr, null, bonesPtr, SkinQuality.Bone4, destPtr, src.Length);
+
+            //Test against the blended matrix, normals are directions and must not pick up the bone translation
+            for (int i = 0; i < src.Length; i++)
+            {
+                float4x4 mat = BlendReference(bones, skin[i]);
+                float3 position = math.mul(mat, new float4(src[i].Position, 1)).xyz;
+                float3 normal = math.mul(mat, new float4(src[i].Normal, 0)).xyz;
+                Assert.IsTrue(math.distance(dest[i].Value.Position, position) < 1e-5f);
+                Assert.IsTrue(math.distance(dest[i].Value.Normal, normal) < 1e-5f);
+            }
+            Assert.IsTrue(math.distance(dest[0].Value.Normal, src[0].Normal) < 1e-6f);
+
+            //Test bone indices from the original index buffer win over the skin data
+            var originalBoneIndex = new float4[src.Length];
+            for (int i = 0; i < src.Length; i++)
+                originalBoneIndex[i] = new float4(2, 1, 0, 0);
+            fixed (float4x4* bonesPtr = bones)
+            fixed (LitVertex* srcPtr = src)
+            fixed (SkinnedMeshVertex* skinPtr = skin)
+            fixed (float4* originalPtr = originalBoneIndex)
+            fixed (DynamicLitVertex* destPtr = dest)
+                CPUMeshSkinningSystem.CPUMeshSkinningJob.SkinVertices(srcPtr, skinPtr, originalPtr, bonesPtr, SkinQuality.Bone1, destPtr, src.Length);
+            for (int i = 0; i < src.Length; i++)
+            {
+                float3 position = math.mul(bones[2], new float4(src[i].Position, 1)).xyz;
+                Assert.IsTrue(math.distance(dest[i].Value.Position, position) < 1e-5f);
+            }
+        }
+
+        // Vertices, bone matrices and skin weights of a made up character: every vertex is weighted to four
+        // bones near it, like a rigged humanoid exported with four bones per vertex.
+        static void CreateCharacter(NativeArray<LitVertex> vertices, NativeArray<SkinnedMeshVertex> skin, NativeArray<float4x4> bones)
+        {
+            var random = new Random(1234);
+            for (int i = 0; i < bones.Length; i++)
+                bones[i] = float4x4.TRS(random.NextFloat3(-1, 1), random.NextQuaternionRotation(), new float3(1));
+            for (int i = 0; i < vertices.Length; i++)
+            {
+                var vertex = new LitVertex();
+                vertex.Position = random.NextFloat3(-1, 1);
+                vertex.Normal = random.NextFloat3Direction();
+                vertex.Tangent = random.NextFloat3Direction();
+                vertices[i] = vertex;
+
+                int bone = i * bones.Length / vertices.Length;
+                float4 weight = random.NextFloat4(0.1f, 1);
+                skin[i] = new SkinnedMeshVertex
+                {
+                    BoneWeight = weight / math.csum(weight),
+                    BoneIndex = math.min(new float4(bone, bone + 1, bone + 2, bone + 3), (float)(bones.Length - 1))
+                };
+            }
+        }
+
+        // Face shapes of the made up character: every shape moves its own run of kShapeVertexCount vertices
+        static BlobAssetReference<BlendShapeData> CreateCharacterShapes(NativeArray<float3> denseDeltas, int vertexCount)
+        {
+            var random = new Random(4321);
+            var builder = new BlobBuilder(Allocator.Temp);
+            ref var root = ref builder.ConstructRoot<BlendShapeData>();
+            var channels = builder.Allocate(ref root.Channels, kCharacterShapeCount);
+            for (int s = 0; s < kCharacterShapeCount; s++)
+            {
+                channels[s].NameHash = (ulong)s;
+                var frames = builder.Allocate(ref channels[s].Frames, 1);
+                frames[0].Weight = 100;
+                var indices = builder.Allocate(ref frames[0].VertexIndices, kShapeVertexCount);
+                var positions = builder.Allocate(ref frames[0].VerticesPosition, kShapeVertexCount);
+                int first = s * (vertexCount - kShapeVertexCount) / kCharacterShapeCount;
+                for (int k = 0; k < kShapeVertexCount; k++)
+                {
+                    float3 delta = random.NextFloat3(-0.05f, 0.05f);
+                    indices[k] = first + k;
+                    positions[k].DeltaPosition = delta;
+                    denseDeltas[s * vertexCount + first + k] = delta;
+                }
+            }
+            var blob = builder.CreateBlobAssetReference<BlendShapeData>(Allocator.Persistent);
+            builder.Dispose();
+            return blob;
+        }
+
+        // Skinning as it was before the bone matrices were gathered and blended by columns, kept as the baseline.
+        // The old code also fetched every bone matrix from its entity, so the real baseline was slower than this.
+        [BurstCompile]
+        struct PerVertexSkinningJob : IJob
+        {
+            [ReadOnly] public NativeArray<LitVertex> Vertices;
+            [ReadOnly] public NativeArray<SkinnedMeshVertex> Skin;
+            [ReadOnly] public NativeArray<float4x4> Bones;
+            public NativeArray<DynamicLitVertex> Result;
+
+            public void Execute()
+            {
+                for (int i = 0; i < Vertices.Length; i++)
+                {
+                    SkinnedMeshVertex skin = Skin[i];
+                    float4x4 mat = skin.BoneWeight.x * Bones[(int)skin.BoneIndex.x];
+                    mat += skin.BoneWeight.y * Bones[(int)skin.BoneIndex.y];
+                    mat += skin.BoneWeight.z * Bones[(int)skin.BoneIndex.z];
+                    mat += skin.BoneWeight.w * Bones[(int)skin.BoneIndex.w];
+                    DynamicLitVertex vertex = Result[i];
+                    vertex.Value.Position = math.mul(mat, new float4(Vertices[i].Position, 1)).xyz;
+                    vertex.Value.Normal = math.mul(mat, new float4(Vertices[i].Normal, 1)).xyz;
+                    Result[i] = vertex;
+                }
+            }
+        }
+
+        [BurstCompile]
+        unsafe struct SkinningJob : IJob
+        {
+            [ReadOnly] public NativeArray<LitVertex> Vertices;
+            [ReadOnly] public NativeArray<SkinnedMeshVertex> Skin;
+            [ReadOnly] public NativeArray<float4x4> Bones;
+            public NativeArray<DynamicLitVertex> Result;
+
+            public void Execute()
+            {
+                CPUMeshSkinningSystem.CPUMeshSkinningJob.SkinVertices((LitVertex*)Vertices.GetUnsafeReadOnlyPtr(),
+                    (SkinnedMeshVertex*)Skin.GetUnsafeReadOnlyPtr(), null, (float4x4*)Bones.GetUnsafeReadOnlyPtr(),
+                    SkinQuality.Bone4, (DynamicLitVertex*)Result.GetUnsafePtr(), Vertices.Length);
+            }
+        }
+
+        // Blend shapes as they were before frames stored only the vertices they move, kept as the baseline
+        [BurstCompile]
+        struct DenseBlendShapeJob : IJob
+        {
+            [ReadOnly] public NativeArray<float3> Deltas;
+            public NativeArray<DynamicLitVertex> Result;
+            public float Weight;
+
+            public void Execute()
+            {
+                for (int s = 0; s < kCharacterShapeCount; s++)
+                {
+                    for (int i = 0; i < Result.Length; i++)
+                    {
+                        DynamicLitVertex vertex = Result[i];
+                        vertex.Value.Position += Weight * Deltas[s * Result.Length + i];
+                        Result[i] = vertex;
+                    }
+                }
+            }
+        }
+
+        [BurstCompile]
+        unsafe struct SparseBlendShapeJob : IJob
+        {
+            public BlobAssetReference<BlendShapeData> Shapes;
+            public NativeArray<DynamicLitVertex> Result;
+            public float Weight;
+
+            public void Execute()
+            {
+                ref BlendShapeData shapes = ref Shapes.Value;
+                for (int s = 0; s < shapes.Channels.Length; s++)
+                    MeshBlendShapingSystem.MeshBlendShapingJob.ApplyBlendShapeToVertices(Weight, ref shapes.Channels[s].Frames[0], (byte*)Result.GetUnsafePtr(), true);
+            }
+        }
+
+        // Records vertices per millisecond, the number to compare between the before and after sample groups
+        static void MeasureVerticesPerMs<T>(string name, T job, int vertexCount) where T : struct, IJob
+        {
+            const int kRunsPerSample = 20;
+            for (int i = 0; i < 5; i++)
+                job.Run();
+
+            var sampleGroup = new SampleGroup(name, SampleUnit.Undefined, true);
+            var stopwatch = new Stopwatch();
+            for (int sample = 0; sample < 10; sample++)
+            {
+                stopwatch.Restart();
+                for (int i = 0; i < kRunsPerSample; i++)
+                    job.Run();
+                stopwatch.Stop();
+                Measure.Custom(sampleGroup, vertexCount * kRunsPerSample / stopwatch.Elapsed.TotalMilliseconds);
+            }
+        }
+
+        [Test, Performance]
+        public void TinyCPUSkinningPerformanceTest()
+        {
+            var vertices = new NativeArray<LitVertex>(kCharacterVertexCount, Allocator.TempJob);
+            var skin = new NativeArray<SkinnedMeshVertex>(kCharacterVertexCount, Allocator.TempJob);
+            var bones = new NativeArray<float4x4>(kCharacterBoneCount, Allocator.TempJob);
+            var result = new NativeArray<DynamicLitVertex>(kCharacterVertexCount, Allocator.TempJob);
+            CreateCharacter(vertices, skin, bones);
+
+            MeasureVerticesPerMs("TinyCPUSkinning_Before_VerticesPerMs",
+                new PerVertexSkinningJob { Vertices = vertices, Skin = skin, Bones = bones, Result = result }, kCharacterVertexCount);
+            MeasureVerticesPerMs("TinyCPUSkinning_After_VerticesPerMs",
+                new SkinningJob { Vertices = vertices, Skin = skin, Bones = bones, Result = result }, kCharacterVertexCount);
+
+            vertices.Dispose();
+            skin.Dispose();
+            bones.Dispose();
+            result.Dispose();
+        }
+
+        [Test, Performance]
+        public void TinyBlendShapePerformanceTest()
+        {
+            var deltas = new NativeArray<float3>(kCharacterShapeCount * kCharacterVertexCount, Allocator.TempJob);
+            var result = new NativeArray<DynamicLitVertex>(kCharacterVertexCount, Allocator.TempJob);
+            var shapes = CreateCharacterShapes(deltas, kCharacterVertexCount);
+
+            // every shape is weighted, as in the worst case of a talking face
+            MeasureVerticesPerMs("TinyBlendShape_Before_VerticesPerMs",
+                new DenseBlendShapeJob { Deltas = deltas, Result = result, Weight = 0.5f }, kCharacterVertexCount);
+            MeasureVerticesPerMs("TinyBlendShape_After_VerticesPerMs",
+                new SparseBlendShapeJob { Shapes = shapes, Result = result, Weight = 0.5f }, kCharacterVertexCount);
+
+            shapes.Dispose();
+            deltas.Dispose();
+            result.Dispose();
+        }
+    }
+}
@@ -1,22 +1,36 @@
-﻿using Unity.Entities;
+﻿using Unity.Collections;
+using Unity.Collections.LowLevel.Unsafe;
+using Unity.Entities;
+using Unity.Mathematics;
 
 using Bgfx;
 using Unity.Jobs;
+using Unity.Tiny.Rendering;
 
 namespace Unity.Tiny
 {
-    internal unsafe struct EndSubmitJob : IJob
+    // encodes the sprites of one camera into the encoder of whatever worker picks it up,
+    // the renderer ends all of them once the frame is submitted
+    internal unsafe struct SubmitSpritesJob : IJob
     {
-        public bgfx.Encoder* Encoder;
+        [NativeSetThreadIndex] internal int ThreadIndex;
+        [NativeDisableUnsafePtrRestriction] public PerThreadDataBGFX* PerThreadData;
+        [NativeDisableUnsafePtrRestriction] public int* BatchStats;
+        public SpriteDefaultShader Shader;
+        public ushort ViewId;
+        public NativeList<SpriteDrawItem> Items;
+
         public void Execute()
         {
-            Native2DUtils.EndSubmit(Encoder);
+            Native2DUtils.SubmitSprites(PerThreadData[ThreadIndex].GetEncoder(), Shader, ViewId, Items.AsArray(), BatchStats);
         }
     }
 
     internal struct SpriteMeshCacheData : IComponentData
     {
         public Hash128 Hash;
+        public BlobAssetReference<SpriteMesh> Mesh;
+        public Entity Texture;
         public bgfx.TextureHandle TextureHandle;
         public ushort IndexBufferHandle;
         public ushort VertexBufferHandle;
@@ -25,6 +39,18 @@ namespace Unity.Tiny
         public bgfx.VertexLayoutHandle VertexLayoutHandle;
     }
 
+    /// <summary>
+    /// A visible sprite of one camera, gathered for batching
+    /// </summary>
+    internal struct SpriteDrawItem
+    {
+        public SpriteMeshCacheData Mesh;
+        public float4x4 LocalToWorld;
+        public float4 Color;
+        public float4 UvScaleOffset; // xy * uv + zw, moves the texture coordinates into an atlas page
+        public uint Depth;
+    }
+
     internal struct SpriteMeshBuffers : ISystemStateComponentData
     {
         public ushort IndexBufferHandle;
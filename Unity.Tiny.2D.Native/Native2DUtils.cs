@@ -1,3 +1,7 @@
+using System.Collections.Generic;
+using System.Threading;
+using Unity.Collections;
+using Unity.Collections.LowLevel.Unsafe;
 using Unity.Entities;
 using Unity.Mathematics;
 using Unity.Tiny.Rendering;
@@ -6,8 +10,21 @@ using bgfx = Bgfx.bgfx;
 
 namespace Unity.Tiny
 {
+    internal struct SpriteDrawItemDepthComparer : IComparer<SpriteDrawItem>
+    {
+        public int Compare(SpriteDrawItem lhs, SpriteDrawItem rhs)
+        {
+            return lhs.Depth.CompareTo(rhs.Depth);
+        }
+    }
+
     internal static class Native2DUtils
     {
+        // batches index into one transient buffer with 16 bit indices
+        private const int k_MaxBatchVertices = ushort.MaxValue + 1;
+
+        public static readonly float4 k_IdentityUvScaleOffset = new float4(1, 1, 0, 0);
+
         private static readonly ulong k_RenderStates = (ulong) (bgfx.StateFlags.WriteRgb | bgfx.StateFlags.WriteA) |
                                                        RendererBGFXStatic.MakeBGFXBlend(
                                                            bgfx.StateFlags.BlendOne,
@@ -32,6 +49,8 @@ namespace Unity.Tiny
             cacheData = new SpriteMeshCacheData
             {
                 Hash = new Hash128((uint)spriteEntity.Index, (uint)spriteEntity.Version, 0 , 0),
+                Mesh = spriteData.Mesh,
+                Texture = spriteData.Texture,
                 TextureHandle = texture.handle,
                 IndexBufferHandle = spriteMesh.IndexBufferHandle,
                 VertexBufferHandle = spriteMesh.VertexBufferHandle,
@@ -43,15 +62,6 @@ namespace Unity.Tiny
             return true;
         }
 
-        public static unsafe bgfx.Encoder* BeginSubmit()
-        {
-            return bgfx.encoder_begin(false);
-        }
-        public static unsafe void EndSubmit(bgfx.Encoder* encoder)
-        {
-            bgfx.encoder_end(encoder);
-        }
-
         public static unsafe void SubmitDrawInstruction(bgfx.Encoder* encoder, float4 color,
             SpriteDefaultShader defaultShader, ushort viewId,
             SpriteMeshCacheData spriteMesh, uint depth,
@@ -70,5 +80,103 @@ namespace Unity.Tiny
             bgfx.encoder_set_texture(encoder, 0, defaultShader.TexColorSamplerHandle, spriteMesh.TextureHandle, System.UInt32.MaxValue);
             bgfx.encoder_submit(encoder, viewId, defaultShader.ProgramHandle, depth, (byte)bgfx.DiscardFlags.All);
         }
+
+        // Walks the sprites of a pass in depth order. Runs of sprites with consecutive depths that share texture and tint are
+        // transformed into one transient buffer and drawn at once; every other 2D renderer takes a depth of its own, so
+        // nothing is drawn in between the sprites of a run. Sprites of images in an atlas page share the page texture, their
+        // texture coordinates only fit the page after the remap, so they always go through the transient buffer.
+        // Adds the sprites and the draws they took to stats[0] and stats[1].
+        public static unsafe void SubmitSprites(bgfx.Encoder* encoder, SpriteDefaultShader defaultShader, ushort viewId,
+            NativeArray<SpriteDrawItem> items, int* stats)
+        {
+            items.Sort(new SpriteDrawItemDepthComparer());
+
+            var draws = 0;
+            var start = 0;
+            while (start < items.Length)
+            {
+                var first = items[start];
+                var vertexCount = first.Mesh.VertexCount;
+                var indexCount = first.Mesh.IndexCount;
+                var end = start + 1;
+                for (; end < items.Length; end++)
+                {
+                    var next = items[end];
+                    if (next.Depth != items[end - 1].Depth + 1
+                        || next.Mesh.TextureHandle.idx != first.Mesh.TextureHandle.idx
+                        || math.any(next.Color != first.Color)
+                        || vertexCount + next.Mesh.VertexCount > k_MaxBatchVertices)
+                        break;
+
+                    vertexCount += next.Mesh.VertexCount;
+                    indexCount += next.Mesh.IndexCount;
+                }
+
+                var remapped = math.any(first.UvScaleOffset != k_IdentityUvScaleOffset);
+                if ((end - start > 1 || remapped) && SubmitBatchedDrawInstruction(encoder, first.Color, defaultShader, viewId, items, start, end, vertexCount, indexCount))
+                {
+                    draws++;
+                }
+                else
+                {
+                    // single sprites draw from their own buffers, and so do runs that did not fit into transient memory.
+                    // Atlas sprites can not, their buffers hold the texture coordinates of the image, they are dropped
+                    // like any other transient draw once transient memory runs out.
+                    for (var i = start; i < end; i++)
+                    {
+                        var item = items[i];
+                        if (math.any(item.UvScaleOffset != k_IdentityUvScaleOffset))
+                            continue;
+                        SubmitDrawInstruction(encoder, item.Color, defaultShader, viewId, item.Mesh, item.Depth, ref item.LocalToWorld);
+                        draws++;
+                    }
+                }
+
+                start = end;
+            }
+
+            Interlocked.Add(ref stats[0], items.Length);
+            Interlocked.Add(ref stats[1], draws);
+        }
+
+        private static unsafe bool SubmitBatchedDrawInstruction(bgfx.Encoder* encoder, float4 color,
+            SpriteDefaultShader defaultShader, ushort viewId,
+            NativeArray<SpriteDrawItem> items, int start, int end,
+            int vertexCount, int indexCount)
+        {
+            bgfx.TransientVertexBuffer tvb;
+            bgfx.TransientIndexBuffer tib;
+            var layout = (bgfx.VertexLayout*)defaultShader.VertexLayout.GetUnsafeReadOnlyPtr();
+            if (!bgfx.alloc_transient_buffers(&tvb, layout, (uint)vertexCount, &tib, (uint)indexCount))
+                return false;
+
+            // vertices are written in world space, the draw keeps the identity transform
+            var vertices = (SpriteVertex*)tvb.data;
+            var indices = (ushort*)tib.data;
+            var baseVertex = 0;
+            for (var i = start; i < end; i++)
+            {
+                var item = items[i];
+                ref var mesh = ref item.Mesh.Mesh.Value;
+                for (var v = 0; v < mesh.Vertices.Length; v++)
+                {
+                    var vertex = mesh.Vertices[v];
+                    vertex.Position = math.transform(item.LocalToWorld, vertex.Position);
+                    vertex.TexCoord0 = vertex.TexCoord0 * item.UvScaleOffset.xy + item.UvScaleOffset.zw;
+                    *vertices++ = vertex;
+                }
+                for (var n = 0; n < mesh.Indices.Length; n++)
+                    *indices++ = (ushort)(mesh.Indices[n] + baseVertex);
+                baseVertex += mesh.Vertices.Length;
+            }
+
+            bgfx.encoder_set_state(encoder, k_RenderStates, 0);
+            bgfx.encoder_set_transient_index_buffer(encoder, &tib, 0, (uint)indexCount);
+            bgfx.encoder_set_transient_vertex_buffer(encoder, 0, &tvb, 0, (uint)vertexCount, defaultShader.LayoutHandle);
+            bgfx.encoder_set_uniform(encoder, defaultShader.TintColorHandle, &color, 1);
+            bgfx.encoder_set_texture(encoder, 0, defaultShader.TexColorSamplerHandle, items[start].Mesh.TextureHandle, System.UInt32.MaxValue);
+            bgfx.encoder_submit(encoder, viewId, defaultShader.ProgramHandle, items[start].Depth, (byte)bgfx.DiscardFlags.All);
+            return true;
+        }
     }
 }
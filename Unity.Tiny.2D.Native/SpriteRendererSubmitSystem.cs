@@ -1,4 +1,5 @@
 ﻿using Unity.Collections;
+using Unity.Collections.LowLevel.Unsafe;
 using Unity.Entities;
 using Unity.Jobs;
 using Unity.Tiny.Rendering;
@@ -13,11 +14,13 @@ namespace Unity.Tiny
     [UpdateInGroup(typeof(PresentationSystemGroup))]
     [UpdateAfter(typeof(RenderNodeSystem))]
     [UpdateAfter(typeof(ShaderSystem))]
+    [UpdateBefore(typeof(SubmitFrameSystem))]
     internal class SpriteRendererSubmitSystem : ResumableSystemBase
     {
         public SpriteDefaultShader DefaultShader => (SpriteDefaultShader)m_DefaultShader;
         private IShader2D m_DefaultShader = new SpriteDefaultShader();
         private EntityQuery m_CameraQuery;
+        private NativeArray<int> m_BatchStats; // sprites and draws, added up by the submit jobs of all cameras
 
         protected override void OnCreate()
         {
@@ -29,6 +32,13 @@ namespace Unity.Tiny
                     ComponentType.ReadOnly<Camera>(),
                 }
             });
+            m_BatchStats = new NativeArray<int>(2, Allocator.Persistent);
+        }
+
+        protected override void OnDestroy()
+        {
+            m_BatchStats.Dispose();
+            base.OnDestroy();
         }
 
         protected override void OnStartRunning()
@@ -59,6 +69,19 @@ namespace Unity.Tiny
             if (!m_DefaultShader.IsInitialized)
                 return;
 
+            // the submit jobs of the last frame were completed by the renderer before it ended the encoders
+            var rendererSystem = World.GetExistingSystem<RendererBGFXSystem>();
+            if (rendererSystem == null || !rendererSystem.IsInitialized())
+                return;
+            unsafe
+            {
+                var sys = rendererSystem.InstancePointer();
+                sys->m_spritesSubmitted = m_BatchStats[0];
+                sys->m_spriteDraws = m_BatchStats[1];
+                m_BatchStats[0] = 0;
+                m_BatchStats[1] = 0;
+            }
+
             var hashMap = new NativeHashMap<Entity, ushort>(1, Allocator.TempJob);
             Entities
                 .WithName("LocateAndStoreSpritePass")
@@ -76,6 +99,7 @@ namespace Unity.Tiny
             var shader = (SpriteDefaultShader)m_DefaultShader;
 
             var renderNodeSystem = World.GetExistingSystem<RenderNodeSystem>();
+            var atlasEntries = GetComponentDataFromEntity<TextureAtlasEntryBGFX>(true);
 
             using (var cameraEntities = m_CameraQuery.ToEntityArray(Allocator.TempJob))
             using (var jobHandles = new NativeList<JobHandle>(Allocator.TempJob))
@@ -92,11 +116,14 @@ namespace Unity.Tiny
 
                     unsafe
                     {
-                        var encoder = Native2DUtils.BeginSubmit();
+                        var items = new NativeList<SpriteDrawItem>(Allocator.TempJob);
+                        var batchStats = (int*)m_BatchStats.GetUnsafePtr();
 
-                        var renderJob = Entities
+                        var gatherJob = Entities
+                            .WithName("GatherVisibleSprites")
                             .WithNativeDisableContainerSafetyRestriction(visibleList)
                             .WithReadOnly(visibleList)
+                            .WithReadOnly(atlasEntries)
                             .ForEach((Entity e,
                                 in SpriteMeshCacheData rd,
                                 in SpriteRenderer sr, in LocalToWorld transform) =>
@@ -108,23 +135,31 @@ namespace Unity.Tiny
                                     ? sr.Color
                                     : Color.SRGBToLinear(sr.Color);
 
-                                var localToWorld = transform;
-                                Native2DUtils.SubmitDrawInstruction(encoder, tintColor,
-                                    shader, passViewId,
-                                    rd, renderNode.Depth,
-                                    ref localToWorld.Value);
-
+                                items.Add(new SpriteDrawItem
+                                {
+                                    Mesh = rd,
+                                    LocalToWorld = transform.Value,
+                                    Color = tintColor,
+                                    UvScaleOffset = atlasEntries.HasComponent(rd.Texture) ? atlasEntries[rd.Texture].uvScaleOffset : Native2DUtils.k_IdentityUvScaleOffset,
+                                    Depth = renderNode.Depth
+                                });
                             }).Schedule(Dependency);
 
-                        var endSubmitJob = new EndSubmitJob
+                        // cameras do not wait on each other, every worker encodes into its own encoder
+                        var submitJob = new SubmitSpritesJob
                         {
-                            Encoder = encoder
-                        }.Schedule(renderJob);
-
-                        jobHandles.Add(endSubmitJob);
+                            PerThreadData = rendererSystem.InstancePointer()->m_perThreadData,
+                            BatchStats = batchStats,
+                            Shader = shader,
+                            ViewId = passViewId,
+                            Items = items
+                        }.Schedule(gatherJob);
+
+                        jobHandles.Add(items.Dispose(submitJob));
                     }
                 }
                 Dependency = JobHandle.CombineDependencies(jobHandles.AsArray());
+                rendererSystem.AddEncodeJobs(Dependency);
                 hashMap.Dispose();
             }
         }
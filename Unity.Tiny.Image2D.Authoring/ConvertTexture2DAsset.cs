@@ -110,6 +110,12 @@ namespace Unity.TinyConversion
                         case TextureFormatType.PNG:
                             Texture2DExportUtils.ExportPng(writer, texture);
                             break;
+                        case TextureFormatType.KTX2:
+                            var flags = DstEntityManager.GetComponentData<Image2D>(GetPrimaryEntity(texture)).flags;
+                            Texture2DExportUtils.ExportKTX2(writer, texture, parameters.GpuFormat,
+                                (flags & TextureFlags.Srgb) == TextureFlags.Srgb,
+                                (flags & TextureFlags.MimapEnabled) == TextureFlags.MimapEnabled);
+                            break;
                     }
                 }
                 else
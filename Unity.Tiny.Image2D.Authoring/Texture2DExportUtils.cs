@@ -10,7 +10,21 @@ namespace Unity.TinyConversion
     public enum TextureFormatType
     {
         PNG,
-        WebP
+        WebP,
+        KTX2
+    }
+
+    /// <summary>
+    /// GPU block compression used for textures exported as KTX2. The runtime hands these blocks to the GPU as-is,
+    /// so the target devices must support the chosen format.
+    /// </summary>
+    public enum KTX2GpuFormat
+    {
+        ETC2,
+        ASTC4x4,
+        ASTC6x6,
+        DXT,
+        BC7
     }
 
    internal static class Texture2DExportUtils
@@ -138,6 +152,158 @@ namespace Unity.TinyConversion
             writer.Dispose();
         }
 
+        struct KTX2FormatInfo
+        {
+            public UnityEngine.TextureFormat unityFormat;
+            public uint vkFormat; // unorm variant, every format exported here has its srgb variant at vkFormat + 1
+            public int blockWidth, blockHeight, blockBytes;
+            public byte colorModel; // khronos data format color model
+            public byte colorChannel;
+            public byte alphaChannel; // 0xff if alpha is not a separate sample
+        }
+
+        static KTX2FormatInfo GetKTX2FormatInfo(KTX2GpuFormat format, bool hasAlpha)
+        {
+            switch (format)
+            {
+                case KTX2GpuFormat.ETC2:
+                    return hasAlpha ?
+                        new KTX2FormatInfo { unityFormat = UnityEngine.TextureFormat.ETC2_RGBA8, vkFormat = 151, blockWidth = 4, blockHeight = 4, blockBytes = 16, colorModel = 161, colorChannel = 2, alphaChannel = 15 } :
+                        new KTX2FormatInfo { unityFormat = UnityEngine.TextureFormat.ETC2_RGB, vkFormat = 147, blockWidth = 4, blockHeight = 4, blockBytes = 8, colorModel = 161, colorChannel = 2, alphaChannel = 0xff };
+                case KTX2GpuFormat.ASTC4x4:
+                    return new KTX2FormatInfo { unityFormat = UnityEngine.TextureFormat.ASTC_4x4, vkFormat = 157, blockWidth = 4, blockHeight = 4, blockBytes = 16, colorModel = 162, colorChannel = 0, alphaChannel = 0xff };
+                case KTX2GpuFormat.ASTC6x6:
+                    return new KTX2FormatInfo { unityFormat = UnityEngine.TextureFormat.ASTC_6x6, vkFormat = 165, blockWidth = 6, blockHeight = 6, blockBytes = 16, colorModel = 162, colorChannel = 0, alphaChannel = 0xff };
+                case KTX2GpuFormat.DXT:
+                    return hasAlpha ?
+                        new KTX2FormatInfo { unityFormat = UnityEngine.TextureFormat.DXT5, vkFormat = 137, blockWidth = 4, blockHeight = 4, blockBytes = 16, colorModel = 130, colorChannel = 0, alphaChannel = 15 } :
+                        new KTX2FormatInfo { unityFormat = UnityEngine.TextureFormat.DXT1, vkFormat = 131, blockWidth = 4, blockHeight = 4, blockBytes = 8, colorModel = 128, colorChannel = 0, alphaChannel = 0xff };
+                case KTX2GpuFormat.BC7:
+                default:
+                    return new KTX2FormatInfo { unityFormat = UnityEngine.TextureFormat.BC7, vkFormat = 145, blockWidth = 4, blockHeight = 4, blockBytes = 16, colorModel = 134, colorChannel = 0, alphaChannel = 0xff };
+            }
+        }
+
+        static readonly byte[] k_KTX2Identifier = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+        static int Align(int value, int alignment)
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        /// <summary>
+        /// Compresses the texture to a GPU block format and writes it as a KTX2 container with all mips prebuilt,
+        /// so the runtime can upload it without decoding anything on the CPU.
+        /// </summary>
+        internal static void ExportKTX2(Stream writer, UnityEngine.Texture2D texture, KTX2GpuFormat gpuFormat, bool srgb, bool mips)
+        {
+            var info = GetKTX2FormatInfo(gpuFormat, HasAlpha(texture));
+            var source = BlitTexture(texture, UnityEngine.TextureFormat.RGBA32);
+            var outputTexture = new UnityEngine.Texture2D(texture.width, texture.height, UnityEngine.TextureFormat.RGBA32, mips, !srgb);
+            outputTexture.SetPixels32(source.GetPixels32());
+            outputTexture.Apply(mips);
+            EditorUtility.CompressTexture(outputTexture, info.unityFormat, TextureCompressionQuality.Normal);
+            if (outputTexture.format != info.unityFormat)
+                throw new ArgumentException($"Texture {texture.name} could not be compressed to {info.unityFormat}. Block compressed formats need the texture size to be a multiple of the block size.");
+
+            // raw data holds all mips, largest first
+            var raw = outputTexture.GetRawTextureData();
+            int levelCount = outputTexture.mipmapCount;
+            var levelSizes = new int[levelCount];
+            int rawOffset = 0;
+            for (int i = 0; i < levelCount; i++)
+            {
+                int w = Math.Max(1, texture.width >> i);
+                int h = Math.Max(1, texture.height >> i);
+                levelSizes[i] = ((w + info.blockWidth - 1) / info.blockWidth) * ((h + info.blockHeight - 1) / info.blockHeight) * info.blockBytes;
+                rawOffset += levelSizes[i];
+            }
+            if (rawOffset != raw.Length)
+                throw new Exception($"Unexpected compressed data size for texture {texture.name}: {raw.Length} bytes instead of {rawOffset}.");
+
+            // data format descriptor: one basic block, one sample per compressed channel group
+            int numSamples = info.alphaChannel != 0xff ? 2 : 1;
+            int dfdBlockSize = 24 + 16 * numSamples;
+            int dfdSize = 4 + dfdBlockSize;
+            const int headerSize = 80;
+            int dfdOffset = headerSize + 24 * levelCount;
+
+            // levels are stored smallest first, each aligned to the block size
+            var levelOffsets = new int[levelCount];
+            int fileOffset = dfdOffset + dfdSize;
+            for (int i = levelCount - 1; i >= 0; i--)
+            {
+                fileOffset = Align(fileOffset, info.blockBytes);
+                levelOffsets[i] = fileOffset;
+                fileOffset += levelSizes[i];
+            }
+
+            using (var bw = new BinaryWriter(writer))
+            {
+                bw.Write(k_KTX2Identifier);
+                bw.Write(srgb ? info.vkFormat + 1 : info.vkFormat);
+                bw.Write(1u);                   // typeSize
+                bw.Write((uint)texture.width);
+                bw.Write((uint)texture.height);
+                bw.Write(0u);                   // pixelDepth
+                bw.Write(0u);                   // layerCount
+                bw.Write(1u);                   // faceCount
+                bw.Write((uint)levelCount);
+                bw.Write(0u);                   // supercompressionScheme
+                bw.Write((uint)dfdOffset);
+                bw.Write((uint)dfdSize);
+                bw.Write(0u);                   // kvdByteOffset
+                bw.Write(0u);                   // kvdByteLength
+                bw.Write(0ul);                  // sgdByteOffset
+                bw.Write(0ul);                  // sgdByteLength
+
+                for (int i = 0; i < levelCount; i++)
+                {
+                    bw.Write((ulong)levelOffsets[i]);
+                    bw.Write((ulong)levelSizes[i]);
+                    bw.Write((ulong)levelSizes[i]);
+                }
+
+                bw.Write((uint)dfdSize);
+                bw.Write(0u);                   // vendorId / descriptorType
+                bw.Write((ushort)2);            // versionNumber
+                bw.Write((ushort)dfdBlockSize);
+                bw.Write(info.colorModel);
+                bw.Write((byte)1);              // BT709 primaries
+                bw.Write((byte)(srgb ? 2 : 1)); // transfer function
+                bw.Write((byte)0);              // straight alpha
+                bw.Write((byte)(info.blockWidth - 1));
+                bw.Write((byte)(info.blockHeight - 1));
+                bw.Write((ushort)0);
+                bw.Write(info.blockBytes);      // bytesPlane0..3
+                bw.Write(0);                    // bytesPlane4..7
+                int sampleBits = info.blockBytes * 8 / numSamples;
+                for (int i = 0; i < numSamples; i++)
+                {
+                    bool isAlpha = numSamples == 2 && i == 0;
+                    bw.Write((ushort)(i * sampleBits));
+                    bw.Write((byte)(sampleBits - 1));
+                    bw.Write((byte)(isAlpha ? info.alphaChannel | (srgb ? 0x10 : 0) : info.colorChannel)); // alpha is always linear
+                    bw.Write(0u);               // sample position
+                    bw.Write(0u);               // sampleLower
+                    bw.Write(uint.MaxValue);    // sampleUpper
+                }
+
+                int written = dfdOffset + dfdSize;
+                for (int i = levelCount - 1; i >= 0; i--)
+                {
+                    for (; written < levelOffsets[i]; written++)
+                        bw.Write((byte)0);
+                    int srcOffset = 0;
+                    for (int j = 0; j < i; j++)
+                        srcOffset += levelSizes[j];
+                    bw.Write(raw, srcOffset, levelSizes[i]);
+                    written += levelSizes[i];
+                }
+            }
+            writer.Dispose();
+        }
+
         const int WEBP_ENCODER_ABI_VERSION = 527;
 
         internal static unsafe void EncodeWebP(Stream writer, Texture2D texture, bool lossless, float quality)
@@ -20,6 +20,9 @@ namespace Unity.Tiny.Texture.Settings
 
         [CreateProperty]
         public bool Lossless = true;
+
+        [CreateProperty]
+        public KTX2GpuFormat GpuFormat = KTX2GpuFormat.ETC2;
     }
 
     public class TinyTextureCompressionSettingsOverride
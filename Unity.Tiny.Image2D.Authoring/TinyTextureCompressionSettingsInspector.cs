@@ -32,6 +32,7 @@ namespace Unity.Tiny.Texture.Settings
         EnumField m_DefaultFormatType;
         FloatField m_CompressionQuality;
         Toggle m_lossless;
+        EnumField m_GpuFormat;
 
         public override void Update()
         {
@@ -53,6 +54,8 @@ namespace Unity.Tiny.Texture.Settings
                 if (m_lossless.value && m_CompressionQuality != null)
                     m_CompressionQuality.SetEnabled(false);
             }
+
+            m_GpuFormat?.SetEnabled((TextureFormatType)m_DefaultFormatType.value == TextureFormatType.KTX2);
         }
 
         public override VisualElement Build()
@@ -67,6 +70,9 @@ namespace Unity.Tiny.Texture.Settings
             DoDefaultGui(root, nameof(TinyTextureCompressionParams.CompressionQuality));
             m_CompressionQuality = root.Q<FloatField>(nameof(TinyTextureCompressionParams.CompressionQuality));
 
+            DoDefaultGui(root, nameof(TinyTextureCompressionParams.GpuFormat));
+            m_GpuFormat = root.Q<EnumField>(nameof(TinyTextureCompressionParams.GpuFormat));
+
             return root;
         }
     }
@@ -1,4 +1,5 @@
 using System;
+using Unity.Collections;
 using Unity.Entities;
 using Unity.Tiny.GenericAssetLoading;
 using Unity.Tiny.Assertions;
@@ -25,6 +26,14 @@ namespace Unity.Tiny.STB
 
     public static class ImageIOSTBNativeCalls
     {
+        // keep this in sync with c++
+        public struct BatchLoadResult
+        {
+            public long requestId;
+            public int status; // 1=ok, 2=fail
+            public int imageHandle;
+        }
+
         [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "startload_stb", CharSet = CharSet.Ansi)]
         public static extern long StartLoad([MarshalAs(UnmanagedType.LPStr)] string imageFile, [MarshalAs(UnmanagedType.LPStr)] string maskFile); // returns loadId
 
@@ -37,6 +46,24 @@ namespace Unity.Tiny.STB
         [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "checkload_stb")]
         public static extern int CheckLoading(long loadId, ref int imageHandle); // 0=still working, 1=ok, 2=fail, imageHandle set when ok
 
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "beginloadbatch_stb")]
+        public static extern long BeginLoadBatch(); // returns batchId
+
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "addloadbatch_stb", CharSet = CharSet.Ansi)]
+        public static extern long AddToLoadBatch(long batchId, [MarshalAs(UnmanagedType.LPStr)] string imageFile, [MarshalAs(UnmanagedType.LPStr)] string maskFile, int priority, int maxDimension, int srgb); // returns requestId
+
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "pollloadbatch_stb")]
+        public static extern unsafe int PollLoadBatches(BatchLoadResult* results, int maxResults); // returns number of completed loads written to results
+
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "abortloadbatch_stb")]
+        public static extern void AbortLoadBatch(long batchId); // 0 aborts all batches
+
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "abortloadrequest_stb")]
+        public static extern void AbortLoadRequest(long requestId);
+
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "getresidentbytes_stb")]
+        public static extern long GetResidentBytes(ref int imageCount); // bytes of image data currently held in memory
+
         [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "finishload_stb")]
         public static extern void FinishLoading();
 
@@ -46,18 +73,123 @@ namespace Unity.Tiny.STB
         [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "getimage_stb")]
         public static extern unsafe byte *GetImageFromHandle(int imageHandle, ref int sizeX, ref int sizeY);
 
+        // image formats reported by GetCompressedImageFromHandle for decoded images
+        public const int kFormatDecodedRGBA8 = -1;
+        public const int kFormatDecodedA8 = -2; // mask only images, one byte per pixel
+
+        // bgfxFormat is one of the kFormatDecoded values if the image was decoded, otherwise a bgfx texture format
+        // and the returned pointer holds the precompressed payload with all mips, largest first
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "getimagecompressed_stb")]
+        public static extern unsafe byte *GetCompressedImageFromHandle(int imageHandle, ref int bgfxFormat, ref int mipCount, ref int dataSize);
+
         [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "freeimagemem_stb")]
         public static extern void FreeBackingMemory(int imageHandle);
+
+        // encodes RGBA8 or BGRA8 pixels to a .png or .webp file on a worker thread. pixels must stay valid until the
+        // encode completes, they are converted in place. quality is used for webp only, 100 means lossless.
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "startencode_stb", CharSet = CharSet.Ansi)]
+        public static extern unsafe long StartEncode(byte* pixels, int width, int height, int pitch, int bgra, int yflip, [MarshalAs(UnmanagedType.LPStr)] string path, int quality); // returns encodeId
+
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "checkencode_stb")]
+        public static extern int CheckEncode(long encodeId); // 0=still working, 1=written, 2=fail
+
+        // Dynamic atlas for small decoded images. Packing runs on a worker thread, entries and pages can only be
+        // read while AtlasPoll returns 1. Call AtlasStart after reading to pack everything queued since the last job.
+        public const int kAtlasQueued = 0;
+        public const int kAtlasPlaced = 1;
+        public const int kAtlasFailed = 2;
+
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "atlasinit_stb")]
+        public static extern void AtlasInit(int pageSize, int maxPages, int padding); // drops everything packed so far
+
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "atlasadd_stb")]
+        public static extern long AtlasAdd(int imageHandle, int kind); // copies the pixels, returns entryId or 0 if the image can not go into the atlas
+
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "atlasremove_stb")]
+        public static extern void AtlasRemove(long entryId);
+
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "atlaspoll_stb")]
+        public static extern int AtlasPoll(); // 1=idle
+
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "atlasstart_stb")]
+        public static extern void AtlasStart();
+
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "atlasreset_stb")]
+        public static extern void AtlasReset(); // waits for a running pack job
+
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "atlasgetentry_stb")]
+        public static extern int AtlasGetEntry(long entryId, ref int page, ref int x, ref int y, ref int w, ref int h, ref int generation); // one of the kAtlas values
+
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "atlasgetpixels_stb")]
+        public static extern unsafe byte* AtlasGetFailedPixels(long entryId, ref int w, ref int h); // RGBA8 pixels of an entry that did not fit
+
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "atlaspagecount_stb")]
+        public static extern int AtlasPageCount(ref int pageSize);
+
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "atlaspagekind_stb")]
+        public static extern int AtlasPageKind(int page);
+
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "atlastakedirty_stb")]
+        public static extern unsafe byte* AtlasTakeDirtyRect(int page, ref int x, ref int y, ref int w, ref int h); // null if unchanged, rows are pageSize pixels apart
+
+        [DllImport("lib_unity_tiny_image2d_native", EntryPoint = "atlasstats_stb")]
+        public static extern int AtlasStats(ref int repacks); // returns the number of placed images
     }
 
+    // Loads started in the same frame go into one native batch. Completed loads of all batches are
+    // fetched with a single native call per frame instead of polling every loading image.
     class ImageIOSTBSystemLoadFromFile : IGenericAssetLoader<Image2D, Image2DSTB, Image2DLoadFromFile, Image2DSTBLoading>
     {
+        const int kMaxResultsPerPoll = 32;
+
+        NativeHashMap<long, ImageIOSTBNativeCalls.BatchLoadResult> m_Completed = new NativeHashMap<long, ImageIOSTBNativeCalls.BatchLoadResult>(64, Allocator.Persistent);
+        long m_BatchId;
+
+        public int MaxDimension;
+
+        public unsafe void PollCompleted()
+        {
+            var results = stackalloc ImageIOSTBNativeCalls.BatchLoadResult[kMaxResultsPerPoll];
+            int n;
+            do
+            {
+                n = ImageIOSTBNativeCalls.PollLoadBatches(results, kMaxResultsPerPoll);
+                for (int i = 0; i < n; i++)
+                    m_Completed.TryAdd(results[i].requestId, results[i]);
+            } while (n == kMaxResultsPerPoll);
+        }
+
+        public void EndFrame()
+        {
+            // results nobody picked up belong to images that were destroyed while loading
+            if (m_Completed.Count() > 0)
+            {
+                using (var leftovers = m_Completed.GetValueArray(Allocator.Temp))
+                {
+                    foreach (var r in leftovers)
+                    {
+                        if (r.status == 1)
+                            ImageIOSTBNativeCalls.FreeNative(r.imageHandle);
+                    }
+                }
+                m_Completed.Clear();
+            }
+            m_BatchId = 0;
+        }
+
+        public void Dispose()
+        {
+            ImageIOSTBNativeCalls.AbortLoadBatch(0);
+            EndFrame();
+            m_Completed.Dispose();
+        }
+
         public void StartLoad(EntityManager man, Entity e, ref Image2D image, ref Image2DSTB imgSTB, ref Image2DLoadFromFile fspec, ref Image2DSTBLoading loading)
         {
             // if there are async still loading, but set to new file stop job
             if (loading.internalId != 0)
             {
-                ImageIOSTBNativeCalls.AbortLoad(loading.internalId);
+                ImageIOSTBNativeCalls.AbortLoadRequest(loading.internalId);
             }
 
             image.status =  ImageStatus.Loading;
@@ -85,15 +217,20 @@ namespace Unity.Tiny.STB
                     Debug.LogFormat("The file one entity {1} contains an empty Image2DLoadFromFileMaskFile string.", e);
             }
 
-            loading.internalId = ImageIOSTBNativeCalls.StartLoad(fnImage, fnMask);
+            int priority = man.HasComponent<Image2DLoadPriority>(e) ? man.GetComponentData<Image2DLoadPriority>(e).Value : 0;
+            if (m_BatchId == 0)
+                m_BatchId = ImageIOSTBNativeCalls.BeginLoadBatch();
+            int srgb = (image.flags & TextureFlags.Srgb) == TextureFlags.Srgb ? 1 : 0;
+            loading.internalId = ImageIOSTBNativeCalls.AddToLoadBatch(m_BatchId, fnImage, fnMask, priority, MaxDimension, srgb);
         }
 
         public LoadResult CheckLoading(IntPtr cppwrapper, EntityManager man, Entity e, ref Image2D image, ref Image2DSTB imgSTB, ref Image2DLoadFromFile unused, ref Image2DSTBLoading loading)
         {
-            int newHandle = 0;
-            int r = ImageIOSTBNativeCalls.CheckLoading(loading.internalId, ref newHandle);
-            if (r == 0)
+            if (!m_Completed.TryGetValue(loading.internalId, out var result))
                 return LoadResult.stillWorking;
+            m_Completed.Remove(loading.internalId);
+            int newHandle = result.imageHandle;
+            int r = result.status;
             FreeNative(man, e, ref imgSTB);
             imgSTB.imageHandle = newHandle;
 
@@ -133,7 +270,7 @@ namespace Unity.Tiny.STB
 #if ENABLE_DOTSRUNTIME_PROFILER
             ProfilerStats.AccumStats.memTextureCount.Accumulate(1);
 
-            long bytes = image.imagePixelWidth * image.imagePixelHeight * 4;
+            long bytes = GetImageBytes(imgSTB.imageHandle, image.imagePixelWidth, image.imagePixelHeight);
 
             ProfilerStats.AccumStats.memTexture.Accumulate(bytes);
             ProfilerStats.AccumStats.memReservedGFX.Accumulate(bytes);
@@ -155,7 +292,7 @@ namespace Unity.Tiny.STB
             {
                 ProfilerStats.AccumStats.memTextureCount.Accumulate(-1);
 
-                long bytes = -w * h * 4;
+                long bytes = -GetImageBytes(imgSTB.imageHandle, w, h);
 
                 ProfilerStats.AccumStats.memTexture.Accumulate(bytes);
                 ProfilerStats.AccumStats.memReservedGFX.Accumulate(bytes);
@@ -165,6 +302,20 @@ namespace Unity.Tiny.STB
             ImageIOSTBNativeCalls.FreeNative(imgSTB.imageHandle);
         }
 
+#if ENABLE_DOTSRUNTIME_PROFILER
+        static long GetImageBytes(int imageHandle, int w, int h)
+        {
+            int format = -1, mipCount = 0, dataSize = 0;
+            unsafe
+            {
+                ImageIOSTBNativeCalls.GetCompressedImageFromHandle(imageHandle, ref format, ref mipCount, ref dataSize);
+            }
+            if (dataSize > 0)
+                return dataSize;
+            return (long)w * h * 4;
+        }
+
+#endif
         public void FinishLoading(EntityManager man, Entity e, ref Image2D img, ref Image2DSTB imgSTB, ref Image2DSTBLoading loading)
         {
             ImageIOSTBNativeCalls.FinishLoading();
@@ -174,16 +325,28 @@ namespace Unity.Tiny.STB
     [UpdateInGroup(typeof(InitializationSystemGroup))]
     public class Image2DIOSTBSystem : GenericAssetLoader<Image2D, Image2DSTB, Image2DLoadFromFile, Image2DSTBLoading>
     {
+        ImageIOSTBSystemLoadFromFile m_Loader;
+
         protected override void OnCreate()
         {
             base.OnCreate();
-            c = new ImageIOSTBSystemLoadFromFile();
+            m_Loader = new ImageIOSTBSystemLoadFromFile();
+            c = m_Loader;
+        }
+
+        protected override void OnDestroy()
+        {
+            m_Loader.Dispose();
+            base.OnDestroy();
         }
 
         protected override void OnUpdate()
         {
             // loading
+            m_Loader.MaxDimension = HasSingleton<Image2DLoadSettings>() ? GetSingleton<Image2DLoadSettings>().MaxDimension : 0;
+            m_Loader.PollCompleted();
             base.OnUpdate();
+            m_Loader.EndFrame();
         }
     }
 }
@@ -0,0 +1,318 @@
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "AtlasPacker.h"
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <limits.h>
+#include <string.h>
+#include <thread>
+
+using namespace ut;
+using namespace ut::ThreadPool;
+
+namespace {
+
+class AtlasPackJob : public ThreadPool::Job {
+public:
+    AtlasPacker* packer = 0;
+    std::vector<int64_t> adds;
+    std::vector<int64_t> removes;
+
+    virtual bool Do()
+    {
+        packer->Pack(adds, removes);
+        return true;
+    }
+};
+
+// copies a w*h image to x,y and repeats its edge pixels into a border of padding pixels around it
+static void
+BlitExtruded(uint32_t* dest, int destPitch, int x, int y, const uint32_t* src, int w, int h, int padding)
+{
+    for (int row = -padding; row < h + padding; row++) {
+        const uint32_t* srcRow = src + (size_t)std::min(std::max(row, 0), h - 1) * w;
+        uint32_t* destRow = dest + (size_t)(y + row) * destPitch + x;
+        for (int col = -padding; col < 0; col++)
+            destRow[col] = srcRow[0];
+        memcpy(destRow, srcRow, w * sizeof(uint32_t));
+        for (int col = w; col < w + padding; col++)
+            destRow[col] = srcRow[w - 1];
+    }
+}
+
+} // namespace
+
+AtlasPacker::AtlasPacker()
+{
+    pageSize = 1024;
+    maxPages = 4;
+    padding = 1;
+    placedCount = 0;
+    repackCount = 0;
+    nextId = 1;
+    jobId = 0;
+}
+
+void
+AtlasPacker::Init(int _pageSize, int _maxPages, int _padding)
+{
+    Reset();
+    pageSize = _pageSize;
+    maxPages = _maxPages;
+    padding = _padding;
+}
+
+int64_t
+AtlasPacker::Add(const uint32_t* pixels, int w, int h, int kind)
+{
+    if (w <= 0 || h <= 0 || w + 2 * padding > pageSize || h + 2 * padding > pageSize)
+        return 0;
+    int64_t id = nextId++;
+    Entry& e = incoming[id];
+    e.status = sQueued;
+    e.kind = kind;
+    e.page = -1;
+    e.x = 0;
+    e.y = 0;
+    e.w = w;
+    e.h = h;
+    e.generation = 0;
+    e.pixels.assign(pixels, pixels + (size_t)w * h);
+    queuedAdds.push_back(id);
+    return id;
+}
+
+void
+AtlasPacker::Remove(int64_t id)
+{
+    if (incoming.erase(id)) {
+        queuedAdds.erase(std::remove(queuedAdds.begin(), queuedAdds.end(), id), queuedAdds.end());
+        return;
+    }
+    queuedRemoves.push_back(id);
+}
+
+bool
+AtlasPacker::Poll()
+{
+    if (!jobId)
+        return true;
+    std::unique_ptr<ThreadPool::Job> job = Pool::GetInstance()->CheckAndRemove(jobId);
+    if (!job)
+        return false;
+    jobId = 0;
+    return true;
+}
+
+void
+AtlasPacker::Start()
+{
+    if (jobId || (queuedAdds.empty() && queuedRemoves.empty()))
+        return;
+    for (auto& kv : incoming)
+        entries[kv.first] = std::move(kv.second);
+    incoming.clear();
+    std::unique_ptr<AtlasPackJob> job(new AtlasPackJob);
+    job->packer = this;
+    job->adds.swap(queuedAdds);
+    job->removes.swap(queuedRemoves);
+    jobId = Pool::GetInstance()->Enqueue(std::move(job));
+}
+
+void
+AtlasPacker::Reset()
+{
+    while (!Poll())
+        std::this_thread::yield();
+    pages.clear();
+    entries.clear();
+    incoming.clear();
+    queuedAdds.clear();
+    queuedRemoves.clear();
+    placedCount = 0;
+    repackCount = 0;
+}
+
+const AtlasPacker::Entry*
+AtlasPacker::Get(int64_t id) const
+{
+    auto it = entries.find(id);
+    if (it != entries.end())
+        return &it->second;
+    it = incoming.find(id);
+    return it != incoming.end() ? &it->second : 0;
+}
+
+const uint8_t*
+AtlasPacker::TakeDirtyRect(int page, int* x, int* y, int* w, int* h)
+{
+    Page& p = *pages[page];
+    if (p.dirtyX0 >= p.dirtyX1 || p.dirtyY0 >= p.dirtyY1)
+        return 0;
+    *x = p.dirtyX0;
+    *y = p.dirtyY0;
+    *w = p.dirtyX1 - p.dirtyX0;
+    *h = p.dirtyY1 - p.dirtyY0;
+    p.dirtyX0 = p.dirtyY0 = INT_MAX;
+    p.dirtyX1 = p.dirtyY1 = 0;
+    return (const uint8_t*)(p.pixels.data() + (size_t)*y * pageSize + *x);
+}
+
+std::unique_ptr<AtlasPacker::Page>
+AtlasPacker::NewPage(int kind) const
+{
+    std::unique_ptr<Page> page(new Page);
+    page->kind = kind;
+    page->nodes.resize(pageSize);
+    stbrp_init_target(&page->context, pageSize, pageSize, page->nodes.data(), pageSize);
+    page->pixels.assign((size_t)pageSize * pageSize, 0);
+    page->removedArea = 0;
+    // the texture is created without contents, the first upload covers all of it
+    page->dirtyX0 = page->dirtyY0 = 0;
+    page->dirtyX1 = page->dirtyY1 = pageSize;
+    return page;
+}
+
+void
+AtlasPacker::MarkDirty(Page& page, int x, int y, int w, int h) const
+{
+    page.dirtyX0 = std::min(page.dirtyX0, x);
+    page.dirtyY0 = std::min(page.dirtyY0, y);
+    page.dirtyX1 = std::max(page.dirtyX1, x + w);
+    page.dirtyY1 = std::max(page.dirtyY1, y + h);
+}
+
+// repacks the entries of a page together with incoming into a fresh page, x and y are set to the padded
+// rect of incoming. The page is left as it was if they do not fit.
+bool
+AtlasPacker::Repack(int pageIndex, const Entry& incomingEntry, int* x, int* y)
+{
+    std::vector<stbrp_rect> rects;
+    std::vector<Entry*> moved;
+    for (auto& kv : entries) {
+        Entry& e = kv.second;
+        if (e.status != sPlaced || e.page != pageIndex)
+            continue;
+        stbrp_rect r;
+        r.id = (int)moved.size();
+        r.w = (stbrp_coord)(e.w + 2 * padding);
+        r.h = (stbrp_coord)(e.h + 2 * padding);
+        rects.push_back(r);
+        moved.push_back(&e);
+    }
+    stbrp_rect r;
+    r.id = (int)moved.size();
+    r.w = (stbrp_coord)(incomingEntry.w + 2 * padding);
+    r.h = (stbrp_coord)(incomingEntry.h + 2 * padding);
+    rects.push_back(r);
+
+    Page& old = *pages[pageIndex];
+    std::unique_ptr<Page> page = NewPage(old.kind);
+    if (!stbrp_pack_rects(&page->context, rects.data(), (int)rects.size()))
+        return false;
+
+    for (const stbrp_rect& packed : rects) {
+        if (packed.id == (int)moved.size()) {
+            *x = packed.x;
+            *y = packed.y;
+            continue;
+        }
+        Entry& e = *moved[packed.id];
+        int pw = e.w + 2 * padding;
+        int sx = e.x - padding;
+        int sy = e.y - padding;
+        for (int row = 0; row < e.h + 2 * padding; row++) {
+            memcpy(page->pixels.data() + (size_t)(packed.y + row) * pageSize + packed.x,
+                old.pixels.data() + (size_t)(sy + row) * pageSize + sx, pw * sizeof(uint32_t));
+        }
+        if (packed.x != sx || packed.y != sy) {
+            e.x = packed.x + padding;
+            e.y = packed.y + padding;
+            e.generation++;
+        }
+    }
+    pages[pageIndex] = std::move(page);
+    repackCount++;
+    return true;
+}
+
+void
+AtlasPacker::Place(Entry& e, int pageIndex, int x, int y)
+{
+    Page& page = *pages[pageIndex];
+    e.page = pageIndex;
+    e.x = x + padding;
+    e.y = y + padding;
+    BlitExtruded(page.pixels.data(), pageSize, e.x, e.y, e.pixels.data(), e.w, e.h, padding);
+    MarkDirty(page, x, y, e.w + 2 * padding, e.h + 2 * padding);
+    std::vector<uint32_t>().swap(e.pixels);
+    e.status = sPlaced;
+    placedCount++;
+}
+
+void
+AtlasPacker::Pack(const std::vector<int64_t>& adds, const std::vector<int64_t>& removes)
+{
+    for (int64_t id : removes) {
+        auto it = entries.find(id);
+        if (it == entries.end())
+            continue;
+        const Entry& e = it->second;
+        if (e.status == sPlaced) {
+            pages[e.page]->removedArea += (e.w + 2 * padding) * (e.h + 2 * padding);
+            placedCount--;
+        }
+        entries.erase(it);
+    }
+
+    // taller images first, the skyline packer wastes less that way
+    std::vector<Entry*> todo;
+    for (int64_t id : adds) {
+        auto it = entries.find(id);
+        if (it != entries.end() && it->second.status == sQueued)
+            todo.push_back(&it->second);
+    }
+    std::stable_sort(todo.begin(), todo.end(), [](const Entry* a, const Entry* b) { return a->h > b->h; });
+
+    for (Entry* e : todo) {
+        stbrp_rect r;
+        r.id = 0;
+        r.w = (stbrp_coord)(e->w + 2 * padding);
+        r.h = (stbrp_coord)(e->h + 2 * padding);
+        int area = r.w * r.h;
+
+        int placed = -1;
+        for (int i = 0; i < (int)pages.size() && placed < 0; i++) {
+            if (pages[i]->kind == e->kind && stbrp_pack_rects(&pages[i]->context, &r, 1))
+                placed = i;
+        }
+        int x = r.x, y = r.y;
+
+        // reclaim removed images, the page with the most removed area is the most likely to fit
+        if (placed < 0) {
+            int best = -1;
+            for (int i = 0; i < (int)pages.size(); i++) {
+                if (pages[i]->kind == e->kind && pages[i]->removedArea >= area && (best < 0 || pages[i]->removedArea > pages[best]->removedArea))
+                    best = i;
+            }
+            if (best >= 0 && Repack(best, *e, &x, &y))
+                placed = best;
+        }
+
+        if (placed < 0 && (int)pages.size() < maxPages) {
+            pages.push_back(NewPage(e->kind));
+            if (stbrp_pack_rects(&pages.back()->context, &r, 1)) {
+                placed = (int)pages.size() - 1;
+                x = r.x;
+                y = r.y;
+            }
+        }
+
+        if (placed < 0) {
+            e->status = sFailed;
+            continue;
+        }
+        Place(*e, placed, x, y);
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "libstb/stb_rect_pack.h"
+
+namespace ut {
+
+// Packs small decoded RGBA8 images into shared square pages with stb_rect_pack. Every image keeps a border of
+// padding pixels that repeat its edge, so bilinear sampling does not bleed in the neighbours. Images only share
+// a page with images of the same kind (sampler and color space settings are per page).
+// Packing and copying pixels into the cpu side page happens on a worker thread. While that job runs it owns
+// the pages and entries, the main thread only queues adds and removes and reads results once the atlas is idle.
+// The skyline packer can not reuse the space of removed images. When a new image does not fit, a page with
+// removed images is repacked from scratch (its entries move and their generation goes up) before a new page is
+// started. Images that do not fit anywhere fail and keep their pixels so the caller can upload them on their own.
+class AtlasPacker {
+public:
+    // keep this in sync with C#
+    static const int sQueued = 0;
+    static const int sPlaced = 1;
+    static const int sFailed = 2;
+
+    struct Entry {
+        int status;
+        int kind;
+        int page;        // -1 unless placed
+        int x, y, w, h;  // image rect in the page, without padding
+        int generation;  // goes up every time the entry moves to another spot
+        std::vector<uint32_t> pixels; // released once placed
+    };
+
+    AtlasPacker();
+
+    // main thread
+    void Init(int pageSize, int maxPages, int padding); // drops everything packed so far
+    int64_t Add(const uint32_t* pixels, int w, int h, int kind); // copies pixels, returns 0 if the image can never fit
+    void Remove(int64_t id);
+    bool Poll();    // finishes a completed pack job, returns true if the atlas is idle
+    void Start();   // starts packing everything added or removed since the last job, if idle
+    void Reset();   // waits for a running job and drops all pages and entries
+
+    // main thread, only while idle
+    const Entry* Get(int64_t id) const;
+    int PageCount() const { return (int)pages.size(); }
+    int PageKind(int page) const { return pages[page]->kind; }
+    int PageSize() const { return pageSize; }
+    const uint8_t* TakeDirtyRect(int page, int* x, int* y, int* w, int* h); // rows are PageSize() pixels apart
+    int PlacedCount() const { return placedCount; }
+    int RepackCount() const { return repackCount; }
+
+    // pack job
+    void Pack(const std::vector<int64_t>& adds, const std::vector<int64_t>& removes);
+
+private:
+    struct Page {
+        int kind;
+        stbrp_context context; // points into itself and nodes, pages are never moved
+        std::vector<stbrp_node> nodes;
+        std::vector<uint32_t> pixels;
+        int removedArea;       // padded area of removed entries, only reclaimed by repacking
+        int dirtyX0, dirtyY0, dirtyX1, dirtyY1;
+    };
+
+    std::unique_ptr<Page> NewPage(int kind) const;
+    bool Repack(int pageIndex, const Entry& incoming, int* x, int* y);
+    void Place(Entry& e, int pageIndex, int x, int y);
+    void MarkDirty(Page& page, int x, int y, int w, int h) const;
+
+    int pageSize;
+    int maxPages;
+    int padding;
+
+    // owned by the pack job while one runs
+    std::vector<std::unique_ptr<Page>> pages;
+    std::unordered_map<int64_t, Entry> entries;
+    int placedCount;
+    int repackCount;
+
+    // main thread only
+    std::unordered_map<int64_t, Entry> incoming; // added since the last job started
+    std::vector<int64_t> queuedAdds;
+    std::vector<int64_t> queuedRemoves;
+    int64_t nextId;
+    int64_t jobId;
+};
+
+} // namespace ut
@@ -23,6 +23,8 @@ public:
     static uint32_t PremultiplyAlpha(uint32_t c);
     static uint32_t UnmultiplyAlpha(uint32_t c);
 
+    static bool IsPowerOfTwo(int x) { return x > 0 && (x & (x - 1)) == 0; }
+
     //static NativeString FormatSourceName(Image2DLoadFromFile& fspec);
     //static bool CheckMemoryImage(ManagerWorld& world, Entity e, Image2DLoadFromMemory& fspec);
 };
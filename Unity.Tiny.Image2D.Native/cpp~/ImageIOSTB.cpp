@@ -2,6 +2,7 @@
 #include <stdint.h>
 #include <allocators.h>
 #include <stdio.h>
+#include <ctype.h>
 
 #define STBI_MALLOC(sz)           unsafeutility_malloc(sz,16,Unity::LowLevel::Allocator::Persistent)
 #define STBI_REALLOC(p,newsz)     unsafeutility_realloc(p,newsz,16,Unity::LowLevel::Allocator::Persistent)
@@ -11,6 +12,8 @@
 #define STBIW_REALLOC(p,newsz)    STBI_REALLOC(p,newsz)
 #define STBIW_FREE(p)             STBI_FREE(p)
 #define STBIW_REALLOC_SIZED(p,oldsz,newsz) STBI_REALLOC_SIZED(p,oldsz,newsz)
+#define STBIR_MALLOC(sz,c)        ((void)(c), STBI_MALLOC(sz))
+#define STBIR_FREE(p,c)           ((void)(c), STBI_FREE(p))
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "libstb/stb_image.h"
@@ -18,13 +21,22 @@
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "libstb/stb_image_write.h"
 
+#define STB_IMAGE_RESIZE_IMPLEMENTATION
+#include "libstb/stb_image_resize.h"
+
 #include "Base64.h"
 #include "ThreadPool.h"
 #include "Image2DHelpers.h"
+#include "KTX2Container.h"
+#include "AtlasPacker.h"
 
 #include <Unity/Runtime.h>
 
+#include <algorithm>
+#include <thread>
+
 #include "src/webp/decode.h"
+#include "src/webp/encode.h"
 
 using namespace ut;
 using namespace ut::ThreadPool;
@@ -32,16 +44,27 @@ using namespace ut::ThreadPool;
 // keep this in sync with C#
 class ImageSTB {
 public:
+    // format values for images decoded to 32 bit RGBA or 8 bit single channel (mask only) pixels.
+    // Anything else is a bgfx::TextureFormat of a precompressed payload that holds mipCount prebuilt mips.
+    static const int sDecodedRGBA8 = -1;
+    static const int sDecodedA8 = -2;
+
     ImageSTB() {
         w = 0;
         h = 0;
         pixels = 0;
+        format = sDecodedRGBA8;
+        mipCount = 1;
+        dataSize = 0;
     }
 
     ImageSTB(int _w, int _h) {
         w = _w;
         h = _h;
         pixels = (uint32_t*)STBI_MALLOC(w*h*sizeof(uint32_t));
+        format = sDecodedRGBA8;
+        mipCount = 1;
+        dataSize = w*h*sizeof(uint32_t);
     }
 
     ~ImageSTB() {
@@ -57,6 +80,9 @@ public:
         pixels = other.pixels;
         w = other.w;
         h = other.h;
+        format = other.format;
+        mipCount = other.mipCount;
+        dataSize = other.dataSize;
         other.pixels = 0;
     }
 
@@ -66,6 +92,9 @@ public:
         pixels = other.pixels;
         w = other.w;
         h = other.h;
+        format = other.format;
+        mipCount = other.mipCount;
+        dataSize = other.dataSize;
         other.pixels = 0;
         return *this;
     }
@@ -75,13 +104,119 @@ public:
         pixels = _pixels;
         w = _w;
         h = _h;
+        format = sDecodedRGBA8;
+        mipCount = 1;
+        dataSize = _w*_h*sizeof(uint32_t);
+    }
+
+    void SetA8(uint8_t *_data, int _w, int _h) {
+        STBI_FREE(pixels);
+        pixels = (uint32_t*)_data;
+        w = _w;
+        h = _h;
+        format = sDecodedA8;
+        mipCount = 1;
+        dataSize = _w*_h;
     }
 
+    void SetCompressed(uint8_t *_data, int _w, int _h, int _format, int _mipCount, uint32_t _dataSize) {
+        STBI_FREE(pixels);
+        pixels = (uint32_t*)_data;
+        w = _w;
+        h = _h;
+        format = _format;
+        mipCount = _mipCount;
+        dataSize = _dataSize;
+    }
+
+    bool IsCompressed() const { return format >= 0; }
+    const uint8_t* Bytes() const { return (const uint8_t*)pixels; }
+
     int w, h;
     uint32_t *pixels;
+    int format;
+    int mipCount;
+    uint32_t dataSize;
+};
+
+// Generational slot map for loaded images. A handle packs the slot index and the generation of the slot,
+// so handles of freed images are detected instead of aliasing a newer image in the same slot.
+// Free slots form a list, allocating and freeing is O(1). Handle 0 is never valid. Main thread only.
+class ImageTable {
+public:
+    static const int sIndexBits = 20;
+    static const uint32_t sIndexMask = (1u << sIndexBits) - 1;
+    static const uint32_t sGenerationMask = (1u << (31 - sIndexBits)) - 1; // keep handles positive
+
+    ImageTable() : slots(1), firstFree(0), residentBytes(0), imageCount(0) {} // reserve slot 0
+
+    int Add(ImageSTB* im) {
+        uint32_t index = firstFree;
+        if (index) {
+            firstFree = slots[index].nextFree;
+        } else {
+            index = (uint32_t)slots.size();
+            if (index > sIndexMask)
+                return 0;
+            slots.push_back(Slot());
+        }
+        Slot& slot = slots[index];
+        slot.image = im;
+        slot.nextFree = 0;
+        if (im->pixels)
+            residentBytes += im->dataSize;
+        imageCount++;
+        return (int)((slot.generation << sIndexBits) | index);
+    }
+
+    ImageSTB* Get(int handle) const {
+        uint32_t index = (uint32_t)handle & sIndexMask;
+        uint32_t generation = ((uint32_t)handle >> sIndexBits) & sGenerationMask;
+        if (handle <= 0 || index >= slots.size())
+            return 0;
+        const Slot& slot = slots[index];
+        return slot.generation == generation ? slot.image : 0;
+    }
+
+    void Remove(int handle) {
+        ImageSTB* im = Get(handle);
+        if (!im)
+            return;
+        FreePixels(im);
+        delete im;
+        uint32_t index = (uint32_t)handle & sIndexMask;
+        Slot& slot = slots[index];
+        slot.image = 0;
+        slot.generation = (slot.generation + 1) & sGenerationMask;
+        slot.nextFree = firstFree;
+        firstFree = index;
+        imageCount--;
+    }
+
+    // release decoded memory but keep the image header
+    void FreePixels(ImageSTB* im) {
+        if (im->pixels)
+            residentBytes -= im->dataSize;
+        im->Free();
+    }
+
+    uint64_t ResidentBytes() const { return residentBytes; }
+    int ImageCount() const { return imageCount; }
+
+private:
+    struct Slot {
+        Slot() : image(0), generation(0), nextFree(0) {}
+        ImageSTB* image;
+        uint32_t generation;
+        uint32_t nextFree;
+    };
+    std::vector<Slot> slots;
+    uint32_t firstFree;
+    uint64_t residentBytes;
+    int imageCount;
 };
 
-static std::vector<ImageSTB*> allImages(1); // by handle, reserve handle 0
+static ImageTable allImages;
 
 #if defined(UNITY_ANDROID)
 extern "C" void* loadAsset(const char *path, int *size, void* (*alloc)(size_t));
@@ -114,9 +249,64 @@ static uint8_t* LoadFile(const char* file_name, size_t* data_size) {
     return file_data;
 }
 
+// Compute the size an image is scaled down to so neither side exceeds maxDimension (0 means no limit).
+// Power of two images are halved so they stay power of two and keep their mips.
+static bool
+GetDownscaledSize(int& w, int& h, int maxDimension)
+{
+    if (maxDimension <= 0 || (w <= maxDimension && h <= maxDimension))
+        return false;
+    if (Image2DHelpers::IsPowerOfTwo(w) && Image2DHelpers::IsPowerOfTwo(h)) {
+        while (w > maxDimension || h > maxDimension) {
+            w = w > 1 ? w >> 1 : 1;
+            h = h > 1 ? h >> 1 : 1;
+        }
+    } else {
+        float scale = (float)maxDimension / (float)(w > h ? w : h);
+        w = (int)(w * scale); if (w < 1) w = 1;
+        h = (int)(h * scale); if (h < 1) h = 1;
+    }
+    return true;
+}
+
+// Downscale decoded RGBA or single channel pixels right after decoding, on the loading thread
+static uint8_t*
+DownscaleImage(uint8_t* pixels, int& w, int& h, int channels, int maxDimension, bool srgb)
+{
+    int nw = w, nh = h;
+    if (!pixels || !GetDownscaledSize(nw, nh, maxDimension))
+        return pixels;
+    uint8_t* scaled = (uint8_t*)STBI_MALLOC(nw * nh * channels);
+    if (!scaled)
+        return pixels;
+    int ok = stbir_resize_uint8_generic(pixels, w, h, 0, scaled, nw, nh, 0,
+        channels, channels == 4 ? 3 : STBIR_ALPHA_CHANNEL_NONE, 0, STBIR_EDGE_CLAMP, STBIR_FILTER_DEFAULT,
+        srgb ? STBIR_COLORSPACE_SRGB : STBIR_COLORSPACE_LINEAR, 0);
+    if (!ok) {
+        STBI_FREE(scaled);
+        return pixels;
+    }
+    STBI_FREE(pixels);
+    w = nw;
+    h = nh;
+    return scaled;
+}
+
+// Keep only the red channel of RGBA pixels, compacted in place, and shrink the allocation
+static uint8_t*
+ExtractRedChannel(uint32_t* pixels, int w, int h)
+{
+    uint8_t* dest = (uint8_t*)pixels;
+    int npix = w * h;
+    for (int i = 0; i < npix; i++)
+        dest[i] = (uint8_t)(pixels[i] & 0xff);
+    uint8_t* shrunk = (uint8_t*)STBI_REALLOC(dest, npix);
+    return shrunk ? shrunk : dest;
+}
+
 //Load/Read a potential webp compressed image file and try to decode it to RGBA
 //TODO: to move to a C# non stb only module
-static uint32_t* LoadWebpImage(uint8_t* data, int size_data, int *width, int *height)
+static uint32_t* LoadWebpImage(uint8_t* data, int size_data, int *width, int *height, int maxDimension)
 {
     //Init webp decoder
     WebPDecoderConfig config;
@@ -130,6 +320,14 @@ static uint32_t* LoadWebpImage(uint8_t* data, int size_data, int *width, int *he
     //We support only 32 bits images for now
     config.output.colorspace = WEBP_CSP_MODE::MODE_RGBA;
 
+    //Let the decoder scale down, so the full size image is never allocated
+    int scaledW = config.input.width, scaledH = config.input.height;
+    if (GetDownscaledSize(scaledW, scaledH, maxDimension)) {
+        config.options.use_scaling = 1;
+        config.options.scaled_width = scaledW;
+        config.options.scaled_height = scaledH;
+    }
+
     //Finally decode the image
     if (WebPDecode(data, size_data, &config) != VP8_STATUS_OK)
         return NULL;
@@ -147,8 +345,58 @@ static uint32_t* LoadWebpImage(uint8_t* data, int size_data, int *width, int *he
     return pixels;
 }
 
+// Load a KTX2 container from memory; the block compressed mips are copied as-is, nothing is decoded
 static bool
-LoadImageFromFile(const char* fn, size_t fnlen, ImageSTB& colorImg)
+LoadKTX2FromMemory(const uint8_t* data, size_t size, ImageSTB& img, int maxDimension)
+{
+    KTX2Container ktx;
+    if (!ktx.ParseHeader(data, size))
+        return false;
+    if (!ktx.ParseLevelIndex(data + KTX2Container::sHeaderSize, size - KTX2Container::sHeaderSize, size))
+        return false;
+    ktx.SkipLevelsAbove(maxDimension);
+    uint8_t* payload = (uint8_t*)STBI_MALLOC((size_t)ktx.payloadSize);
+    if (!payload || !ktx.CopyPayload(data, size, payload)) {
+        STBI_FREE(payload);
+        return false;
+    }
+    img.SetCompressed(payload, ktx.width, ktx.height, ktx.bgfxFormat, ktx.levelCount, (uint32_t)ktx.payloadSize);
+    return true;
+}
+
+// Load a KTX2 container from disk. Only the header and level index are parsed, the mip levels are
+// read straight into the buffer that is later handed to bgfx, so the file is never held twice.
+static bool
+LoadKTX2File(const char* fn, ImageSTB& img, int maxDimension)
+{
+    FILE* in = stbi__fopen(fn, "rb");
+    if (!in)
+        return false;
+    uint8_t header[KTX2Container::sHeaderSize];
+    KTX2Container ktx;
+    bool ok = fread(header, sizeof(header), 1, in) == 1 && ktx.ParseHeader(header, sizeof(header));
+    if (ok) {
+        fseek(in, 0, SEEK_END);
+        size_t fileSize = (size_t)ftell(in);
+        fseek(in, KTX2Container::sHeaderSize, SEEK_SET);
+        std::vector<uint8_t> levelIndex(ktx.LevelIndexSize());
+        ok = fread(levelIndex.data(), levelIndex.size(), 1, in) == 1 &&
+            ktx.ParseLevelIndex(levelIndex.data(), levelIndex.size(), fileSize);
+        ktx.SkipLevelsAbove(maxDimension); // no decoding needed, just do not read the large mips
+    }
+    uint8_t* payload = ok ? (uint8_t*)STBI_MALLOC((size_t)ktx.payloadSize) : 0;
+    if (payload && ktx.ReadPayload(in, payload)) {
+        img.SetCompressed(payload, ktx.width, ktx.height, ktx.bgfxFormat, ktx.levelCount, (uint32_t)ktx.payloadSize);
+    } else {
+        STBI_FREE(payload);
+        ok = false;
+    }
+    fclose(in);
+    return ok;
+}
+
+static bool
+LoadImageFromFile(const char* fn, size_t fnlen, ImageSTB& colorImg, int maxDimension, bool srgb, bool singleChannel)
 {
     int bpp = 0;
     int w = 0, h = 0;
@@ -161,29 +409,55 @@ LoadImageFromFile(const char* fn, size_t fnlen, ImageSTB& colorImg)
 #if defined(UNITY_ANDROID)
     int size;
     void *data = loadAsset(fn, &size, malloc);
+    if (KTX2Container::IsKTX2((uint8_t*)data, size)) { // precompressed gpu payload
+        bool ok = LoadKTX2FromMemory((uint8_t*)data, size, colorImg, maxDimension);
+        free(data);
+        return ok;
+    }
     pixels = (uint32_t*)stbi_load_from_memory((uint8_t*)data, size, &w, &h, &bpp, 4);
     if (!pixels)
-        pixels = LoadWebpImage((uint8_t*)data, size, &w, &h);
+        pixels = LoadWebpImage((uint8_t*)data, size, &w, &h, maxDimension);
     free(data);
+#else
+    if (!pixels && LoadKTX2File(fn, colorImg, maxDimension)) // try loading as precompressed gpu payload
+        return true;
 #endif
-    if (!pixels) // try loading as file (supported STB image file)
+    if (!pixels) { // try loading as file (supported STB image file)
+        // grey scale masks decode straight to one channel
+        int comp = 0;
+        if (singleChannel && stbi_info(fn, &w, &h, &comp) && comp <= 2) {
+            uint8_t* grey = stbi_load(fn, &w, &h, &bpp, 1);
+            if (grey) {
+                grey = DownscaleImage(grey, w, h, 1, maxDimension, false);
+                colorImg.SetA8(grey, w, h);
+                return true;
+            }
+        }
         pixels = (uint32_t*)stbi_load(fn, &w, &h, &bpp, 4);
+    }
     if (!pixels) // try loading as webp image file
     {
         //Read image file
         size_t size;
         uint8_t* data = LoadFile(fn, &size);
-        pixels = LoadWebpImage(data, (int) size, &w, &h);
+        pixels = LoadWebpImage(data, (int) size, &w, &h, maxDimension);
         free(data);
     }
     if (!pixels)
         return false;
+    if (singleChannel) {
+        uint8_t* mask = ExtractRedChannel(pixels, w, h);
+        mask = DownscaleImage(mask, w, h, 1, maxDimension, false);
+        colorImg.SetA8(mask, w, h);
+        return true;
+    }
+    pixels = (uint32_t*)DownscaleImage((uint8_t*)pixels, w, h, 4, maxDimension, srgb);
     colorImg.Set(pixels, w, h);
     return true;
 }
 
 static bool
-LoadSTBImageOnly(ImageSTB& colorImg, const char *imageFile, const char *maskFile)
+LoadSTBImageOnly(ImageSTB& colorImg, const char *imageFile, const char *maskFile, int maxDimension, bool srgb)
 {
     bool hasColorFile = imageFile && imageFile[0];
     bool hasMaskFile = maskFile && maskFile[0];
@@ -201,35 +475,32 @@ LoadSTBImageOnly(ImageSTB& colorImg, const char *imageFile, const char *maskFile
     // color from file first
     ImageSTB maskImg;
     if (hasColorFile) {
-        if (!LoadImageFromFile(imageFile, strlen(imageFile), colorImg))
+        if (!LoadImageFromFile(imageFile, strlen(imageFile), colorImg, maxDimension, srgb, false))
             return false;
     }
     // mask from file
     if (hasMaskFile) {
-        if (!LoadImageFromFile(maskFile, strlen(maskFile), maskImg))
+        if (!LoadImageFromFile(maskFile, strlen(maskFile), maskImg, maxDimension, false, true))
             return false;
         if (hasColorFile && (colorImg.w != maskImg.w || colorImg.h != maskImg.h))
             return false;
+        if (maskImg.IsCompressed() || (hasColorFile && colorImg.IsCompressed())) {
+            printf("Precompressed images can not be combined with a separate mask file '%s'\n", maskFile);
+            return false;
+        }
     }
 
     if (hasMaskFile && hasColorFile) { // merge mask into color if we have both
         // copy alpha from maskImg
         uint32_t* cbits = colorImg.pixels;
-        uint32_t* mbits = maskImg.pixels;
+        const uint8_t* mbits = maskImg.Bytes();
         uint32_t npix = colorImg.w * colorImg.h;
         for (uint32_t i = 0; i < npix; i++) {
             uint32_t c = cbits[i] & 0x00ffffff;
-            uint32_t m = (mbits[i] << 24) & 0xff000000;
+            uint32_t m = (uint32_t)mbits[i] << 24;
             cbits[i] = c | m;
         }
-    } else if (hasMaskFile && !hasColorFile) { // mask only: copy mask to colorImage to all channels
-        uint32_t* mbits = maskImg.pixels;
-        uint32_t npix = maskImg.w*maskImg.h;
-        // take R channel to all
-        for (uint32_t i = 0; i < npix; i++) {
-            uint32_t c = mbits[i] & 0xff;
-            mbits[i] = c | (c << 8) | (c << 16) | (c << 24);
-        }
+    } else if (hasMaskFile && !hasColorFile) { // mask only: keep the single channel, it is uploaded as A8
         colorImg = std::move(maskImg);
     }
     return true;
@@ -238,8 +509,16 @@ LoadSTBImageOnly(ImageSTB& colorImg, const char *imageFile, const char *maskFile
 static void
 initImage2DMask(const ImageSTB& colorImg, uint8_t* dest)
 {
-    const uint32_t* src = colorImg.pixels;
     int size = colorImg.w * colorImg.h;
+    if (colorImg.IsCompressed()) { // blocks are not decoded on the cpu, treat as opaque
+        memset(dest, 0xff, size);
+        return;
+    }
+    if (colorImg.format == ImageSTB::sDecodedA8) { // already a byte mask
+        memcpy(dest, colorImg.Bytes(), size);
+        return;
+    }
+    const uint32_t* src = colorImg.pixels;
     for (int i = 0; i < size; ++i)
         dest[i] = (uint8_t)(src[i]>>24);
 }
@@ -262,6 +541,8 @@ public:
     ImageSTB colorImg;
     std::string imageFile;
     std::string maskFile;
+    int maxDimension = 0; // downscale so no side exceeds this, 0 to keep full size
+    bool srgb = true;
 
     virtual bool Do()
     {
@@ -276,18 +557,105 @@ public:
         }
 #endif
         // actual work
-        return LoadSTBImageOnly(colorImg, imageFile.c_str(), maskFile.c_str());
+        return LoadSTBImageOnly(colorImg, imageFile.c_str(), maskFile.c_str(), maxDimension, srgb);
     }
 };
 
+// put a loaded image into a free handle slot
+static int
+StoreImage(ImageSTB&& img)
+{
+    ImageSTB *im = new ImageSTB(std::move(img));
+    int handle = allImages.Add(im);
+    if (!handle)
+        delete im;
+    return handle;
+}
+
+// Batched loading
+// Requests are queued here ordered by priority, and only as many as there are cores are handed to the
+// thread pool at once. That keeps the pool from being flooded when a scene references hundreds of images
+// and makes sure the important ones decode first. All completed loads are collected with a single call.
+// Only called from the main thread.
+
+// keep this in sync with C#
+struct BatchLoadResult {
+    int64_t requestId;
+    int32_t status; // 1=ok, 2=fail
+    int32_t imageHandle;
+};
+
+struct BatchLoadRequest {
+    int64_t requestId;
+    int64_t batchId;
+    int priority;
+    std::string imageFile;
+    std::string maskFile;
+    int maxDimension;
+    bool srgb;
+    int64_t loadId; // thread pool job, once in flight
+};
+
+static std::vector<BatchLoadRequest> batchPending; // heap, highest priority then oldest request on top
+static std::vector<BatchLoadRequest> batchInFlight;
+static int64_t nextBatchId = 1;
+static int64_t nextRequestId = 1;
+
+static bool
+BatchRequestLess(const BatchLoadRequest& a, const BatchLoadRequest& b)
+{
+    if (a.priority != b.priority)
+        return a.priority < b.priority;
+    return a.requestId > b.requestId;
+}
+
+static int
+MaxLoadsInFlight()
+{
+    int n = (int)std::thread::hardware_concurrency();
+    return n > 0 ? n : 4;
+}
+
+static void
+StartPendingLoads()
+{
+    int maxInFlight = MaxLoadsInFlight();
+    while (!batchPending.empty() && (int)batchInFlight.size() < maxInFlight) {
+        std::pop_heap(batchPending.begin(), batchPending.end(), BatchRequestLess);
+        BatchLoadRequest req = std::move(batchPending.back());
+        batchPending.pop_back();
+        std::unique_ptr<AsyncGLFWImageLoader> loader(new AsyncGLFWImageLoader);
+        loader->imageFile = req.imageFile;
+        loader->maskFile = req.maskFile;
+        loader->maxDimension = req.maxDimension;
+        loader->srgb = req.srgb;
+        req.loadId = Pool::GetInstance()->Enqueue(std::move(loader));
+        batchInFlight.push_back(std::move(req));
+    }
+}
+
+template<typename Pred>
+static void
+AbortBatchRequests(Pred pred)
+{
+    auto pending = std::remove_if(batchPending.begin(), batchPending.end(), pred);
+    if (pending != batchPending.end()) {
+        batchPending.erase(pending, batchPending.end());
+        std::make_heap(batchPending.begin(), batchPending.end(), BatchRequestLess);
+    }
+    for (int i = (int)batchInFlight.size() - 1; i >= 0; i--) {
+        if (pred(batchInFlight[i])) {
+            Pool::GetInstance()->Abort(batchInFlight[i].loadId);
+            batchInFlight.erase(batchInFlight.begin() + i);
+        }
+    }
+}
+
 // zero player API
 DOTS_EXPORT(void)
 freeimage_stb(int imageHandle)
 {
-    if (imageHandle<0 || imageHandle>=(int)allImages.size())
-        return;
-    delete allImages[imageHandle];
-    allImages[imageHandle] = 0;
+    allImages.Remove(imageHandle);
 }
 
 DOTS_EXPORT(int64_t)
@@ -317,52 +685,334 @@ checkload_stb(int64_t loadId, int *imageHandle)
         return 2; // failed
     }
     // put it into a local copy
-    int found = -1;
-    for (int i=1; i<(int)allImages.size(); i++ ) {
-        if (!allImages[i]) {
-            found = i;
-            break;
-        }
-    }
     AsyncGLFWImageLoader* resultGLFW = (AsyncGLFWImageLoader*)resultTemp.get();
-    ImageSTB *im = new ImageSTB(std::move(resultGLFW->colorImg));
-    if (found==-1) {
-        allImages.push_back(im);
-        *imageHandle = (int)allImages.size()-1;
-    } else {
-        allImages[found] = im;
-        *imageHandle = found;
+    *imageHandle = StoreImage(std::move(resultGLFW->colorImg));
+    return *imageHandle ? 1 : 2; // ok
+}
+
+DOTS_EXPORT(int64_t)
+beginloadbatch_stb()
+{
+    return nextBatchId++;
+}
+
+DOTS_EXPORT(int64_t)
+addloadbatch_stb(int64_t batchId, const char *imageFile, const char *maskFile, int priority, int maxDimension, int srgb)
+{
+    int64_t requestId = nextRequestId++;
+    BatchLoadRequest req;
+    req.requestId = requestId;
+    req.batchId = batchId;
+    req.priority = priority;
+    req.imageFile = imageFile;
+    req.maskFile = maskFile;
+    req.maxDimension = maxDimension;
+    req.srgb = srgb != 0;
+    req.loadId = 0;
+    batchPending.push_back(std::move(req));
+    std::push_heap(batchPending.begin(), batchPending.end(), BatchRequestLess);
+    StartPendingLoads();
+    return requestId;
+}
+
+// collect up to maxResults completed loads of all batches, returns the number written to results
+DOTS_EXPORT(int)
+pollloadbatch_stb(BatchLoadResult *results, int maxResults)
+{
+    int n = 0;
+    for (int i = 0; i < (int)batchInFlight.size() && n < maxResults; ) {
+        std::unique_ptr<ThreadPool::Job> job = Pool::GetInstance()->CheckAndRemove(batchInFlight[i].loadId);
+        if (!job) {
+            i++;
+            continue;
+        }
+        BatchLoadResult& r = results[n++];
+        r.requestId = batchInFlight[i].requestId;
+        r.imageHandle = -1;
+        r.status = 2;
+        if (job->GetReturnValue()) {
+            r.imageHandle = StoreImage(std::move(((AsyncGLFWImageLoader*)job.get())->colorImg));
+            r.status = r.imageHandle ? 1 : 2;
+        }
+        batchInFlight.erase(batchInFlight.begin() + i);
     }
-    return 1; // ok
+    StartPendingLoads();
+    return n;
+}
+
+// abort all pending and in flight loads of a batch, batchId 0 aborts every batch
+DOTS_EXPORT(void)
+abortloadbatch_stb(int64_t batchId)
+{
+    AbortBatchRequests([batchId](const BatchLoadRequest& r) { return batchId == 0 || r.batchId == batchId; });
+}
+
+DOTS_EXPORT(void)
+abortloadrequest_stb(int64_t requestId)
+{
+    AbortBatchRequests([requestId](const BatchLoadRequest& r) { return r.requestId == requestId; });
 }
 
 DOTS_EXPORT(void)
 freeimagemem_stb(int imageHandle)
 {
-    if (imageHandle<0 || imageHandle>=(int)allImages.size())
+    ImageSTB* im = allImages.Get(imageHandle);
+    if (!im)
         return;
-    allImages[imageHandle]->Free(); // free mem, but keep image
+    allImages.FreePixels(im); // free mem, but keep image
 }
 
 DOTS_EXPORT(uint8_t*)
 getimage_stb(int imageHandle, int *sizeX, int *sizeY)
 {
-    if (imageHandle<0 || imageHandle>=(int)allImages.size())
+    ImageSTB* im = allImages.Get(imageHandle);
+    if (!im)
         return 0;
-    if (!allImages[imageHandle])
+    *sizeX = im->w;
+    *sizeY = im->h;
+    return (uint8_t*)im->pixels;
+}
+
+DOTS_EXPORT(uint8_t*)
+getimagecompressed_stb(int imageHandle, int *format, int *mipCount, int *dataSize)
+{
+    ImageSTB* im = allImages.Get(imageHandle);
+    if (!im)
         return 0;
-    *sizeX = allImages[imageHandle]->w;
-    *sizeY = allImages[imageHandle]->h;
-    return (uint8_t*)allImages[imageHandle]->pixels;
+    // format and size stay valid after freeimagemem_stb, so memory stats can be undone
+    *format = im->format;
+    *mipCount = im->mipCount;
+    *dataSize = (int)im->dataSize;
+    return im->IsCompressed() ? (uint8_t*)im->pixels : 0;
 }
 
 DOTS_EXPORT(void)
 initmask_stb(int imageHandle, uint8_t* buffer)
 {
-    initImage2DMask(*allImages[imageHandle], buffer);
+    ImageSTB* im = allImages.Get(imageHandle);
+    if (im && im->pixels)
+        initImage2DMask(*im, buffer);
+}
+
+// total bytes of image data that is currently held in memory, and the number of live images
+DOTS_EXPORT(int64_t)
+getresidentbytes_stb(int *imageCount)
+{
+    *imageCount = allImages.ImageCount();
+    return (int64_t)allImages.ResidentBytes();
 }
 
 DOTS_EXPORT(void)
 finishload_stb()
 {
 }
+
+// Encoding captured frames to disk
+// The pixels are owned by the caller (the renderer's capture pool) and must stay alive until the job completes.
+// The job swizzles and flips them in place, so they are not usable afterwards.
+static bool
+HasExtension(const std::string& path, const char* ext)
+{
+    size_t l = strlen(ext);
+    if (path.size() < l)
+        return false;
+    for (size_t i = 0; i < l; i++) {
+        if (tolower((unsigned char)path[path.size() - l + i]) != ext[i])
+            return false;
+    }
+    return true;
+}
+
+static void
+WriteToFile(void* context, void* data, int size)
+{
+    std::vector<uint8_t>* out = (std::vector<uint8_t>*)context;
+    out->insert(out->end(), (uint8_t*)data, (uint8_t*)data + size);
+}
+
+class AsyncImageEncoder : public ThreadPool::Job {
+public:
+    uint8_t* pixels = 0;
+    int w = 0, h = 0, pitch = 0;
+    bool bgra = false;
+    bool yflip = false;
+    int quality = 90; // webp only, 100 is lossless
+    std::string path;
+
+    virtual bool Do()
+    {
+        // to tightly packed, top down RGBA, in place
+        int rowBytes = w * 4;
+        if (yflip) {
+            std::vector<uint8_t> row(rowBytes);
+            for (int y = 0; y < h / 2; y++) {
+                uint8_t* top = pixels + (size_t)y * pitch;
+                uint8_t* bottom = pixels + (size_t)(h - 1 - y) * pitch;
+                memcpy(row.data(), top, rowBytes);
+                memcpy(top, bottom, rowBytes);
+                memcpy(bottom, row.data(), rowBytes);
+            }
+        }
+        for (int y = 0; y < h; y++) {
+            uint8_t* dst = pixels + (size_t)y * rowBytes;
+            if (pitch != rowBytes)
+                memmove(dst, pixels + (size_t)y * pitch, rowBytes);
+            if (bgra) {
+                for (int x = 0; x < w; x++)
+                    std::swap(dst[x * 4], dst[x * 4 + 2]);
+            }
+        }
+
+        std::vector<uint8_t> file;
+        if (HasExtension(path, ".png")) {
+            if (!stbi_write_png_to_func(WriteToFile, &file, w, h, 4, pixels, w * 4))
+                return false;
+        } else if (HasExtension(path, ".webp")) {
+            uint8_t* out = 0;
+            size_t size = quality >= 100 ? WebPEncodeLosslessRGBA(pixels, w, h, w * 4, &out)
+                : WebPEncodeRGBA(pixels, w, h, w * 4, (float)quality, &out);
+            if (!size)
+                return false;
+            file.assign(out, out + size);
+            WebPFree(out);
+        } else {
+            printf("Capture: %s has an unsupported extension, use .png or .webp.\n", path.c_str());
+            return false;
+        }
+
+        FILE* f = fopen(path.c_str(), "wb");
+        if (!f) {
+            printf("Capture: could not open %s for writing.\n", path.c_str());
+            return false;
+        }
+        bool ok = fwrite(file.data(), file.size(), 1, f) == 1;
+        fclose(f);
+        return ok;
+    }
+};
+
+DOTS_EXPORT(int64_t)
+startencode_stb(uint8_t* pixels, int w, int h, int pitch, int bgra, int yflip, const char* path, int quality)
+{
+    std::unique_ptr<AsyncImageEncoder> encoder(new AsyncImageEncoder);
+    encoder->pixels = pixels;
+    encoder->w = w;
+    encoder->h = h;
+    encoder->pitch = pitch;
+    encoder->bgra = bgra != 0;
+    encoder->yflip = yflip != 0;
+    encoder->quality = quality;
+    encoder->path = path;
+    return Pool::GetInstance()->Enqueue(std::move(encoder));
+}
+
+// 0=still working, 1=written, 2=failed
+DOTS_EXPORT(int)
+checkencode_stb(int64_t encodeId)
+{
+    std::unique_ptr<ThreadPool::Job> job = Pool::GetInstance()->CheckAndRemove(encodeId);
+    if (!job)
+        return 0;
+    return job->GetReturnValue() ? 1 : 2;
+}
+
+// Dynamic atlas for small decoded images, see AtlasPacker. Main thread API, packing runs on a worker thread.
+static AtlasPacker atlas;
+
+DOTS_EXPORT(void)
+atlasinit_stb(int pageSize, int maxPages, int padding)
+{
+    atlas.Init(pageSize, maxPages, padding);
+}
+
+// queue a decoded RGBA8 image for packing, the pixels are copied so the image memory can be freed right away.
+// Images only share pages with images of the same kind. Returns 0 if the image can not go into the atlas.
+DOTS_EXPORT(int64_t)
+atlasadd_stb(int imageHandle, int kind)
+{
+    ImageSTB* im = allImages.Get(imageHandle);
+    if (!im || !im->pixels || im->format != ImageSTB::sDecodedRGBA8)
+        return 0;
+    return atlas.Add(im->pixels, im->w, im->h, kind);
+}
+
+DOTS_EXPORT(void)
+atlasremove_stb(int64_t entryId)
+{
+    atlas.Remove(entryId);
+}
+
+// 1 if no pack job is running and entries and pages can be read, 0 otherwise
+DOTS_EXPORT(int)
+atlaspoll_stb()
+{
+    return atlas.Poll() ? 1 : 0;
+}
+
+DOTS_EXPORT(void)
+atlasstart_stb()
+{
+    atlas.Start();
+}
+
+DOTS_EXPORT(void)
+atlasreset_stb()
+{
+    atlas.Reset();
+}
+
+// 0=queued, 1=placed, 2=did not fit or unknown. The rect excludes padding, generation goes up when the entry moves.
+DOTS_EXPORT(int)
+atlasgetentry_stb(int64_t entryId, int *page, int *x, int *y, int *w, int *h, int *generation)
+{
+    const AtlasPacker::Entry* e = atlas.Get(entryId);
+    if (!e)
+        return AtlasPacker::sFailed;
+    *page = e->page;
+    *x = e->x;
+    *y = e->y;
+    *w = e->w;
+    *h = e->h;
+    *generation = e->generation;
+    return e->status;
+}
+
+// pixels of an entry that did not fit, valid until the entry is removed
+DOTS_EXPORT(uint8_t*)
+atlasgetpixels_stb(int64_t entryId, int *w, int *h)
+{
+    const AtlasPacker::Entry* e = atlas.Get(entryId);
+    if (!e || e->status != AtlasPacker::sFailed)
+        return 0;
+    *w = e->w;
+    *h = e->h;
+    return (uint8_t*)e->pixels.data();
+}
+
+DOTS_EXPORT(int)
+atlaspagecount_stb(int *pageSize)
+{
+    *pageSize = atlas.PageSize();
+    return atlas.PageCount();
+}
+
+DOTS_EXPORT(int)
+atlaspagekind_stb(int page)
+{
+    return atlas.PageKind(page);
+}
+
+// the part of a page changed since the last call, 0 if nothing changed. Rows are pageSize pixels apart.
+DOTS_EXPORT(const uint8_t*)
+atlastakedirty_stb(int page, int *x, int *y, int *w, int *h)
+{
+    return atlas.TakeDirtyRect(page, x, y, w, h);
+}
+
+// images currently placed, and how often a page was repacked to make room
+DOTS_EXPORT(int)
+atlasstats_stb(int *repacks)
+{
+    *repacks = atlas.RepackCount();
+    return atlas.PlacedCount();
+}
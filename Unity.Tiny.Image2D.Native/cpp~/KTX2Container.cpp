@@ -0,0 +1,199 @@
+#include "KTX2Container.h"
+
+#include <string.h>
+
+using namespace ut;
+
+namespace {
+
+// must match bgfx::TextureFormat
+enum BGFXTextureFormat {
+    BGFX_BC1 = 0,
+    BGFX_BC2 = 1,
+    BGFX_BC3 = 2,
+    BGFX_BC4 = 3,
+    BGFX_BC5 = 4,
+    BGFX_BC6H = 5,
+    BGFX_BC7 = 6,
+    BGFX_ETC2 = 8,
+    BGFX_ETC2A = 9,
+    BGFX_ETC2A1 = 10,
+    BGFX_ASTC4x4 = 20,
+    BGFX_ASTC5x5 = 21,
+    BGFX_ASTC6x6 = 22,
+    BGFX_ASTC8x5 = 23,
+    BGFX_ASTC8x6 = 24,
+    BGFX_ASTC10x5 = 25
+};
+
+struct FormatInfo {
+    uint32_t vkFormat;      // unorm or ufloat variant
+    uint32_t srgbVkFormat;  // matching srgb variant, 0 if the format has none
+    int bgfxFormat;
+    int blockWidth, blockHeight;
+    int blockBytes;
+};
+
+// srgb is a sampler flag in bgfx, so both vk variants map to the same bgfx format.
+// bgfx has no signed BC4/BC5/BC6H formats, so the SNORM and SFLOAT variants are not listed and get rejected.
+static const FormatInfo sFormats[] = {
+    { 131, 132, BGFX_BC1, 4, 4, 8 },       // VK_FORMAT_BC1_RGB_UNORM_BLOCK / _SRGB_BLOCK
+    { 133, 134, BGFX_BC1, 4, 4, 8 },       // VK_FORMAT_BC1_RGBA_UNORM_BLOCK / _SRGB_BLOCK
+    { 135, 136, BGFX_BC2, 4, 4, 16 },      // VK_FORMAT_BC2_UNORM_BLOCK / _SRGB_BLOCK
+    { 137, 138, BGFX_BC3, 4, 4, 16 },      // VK_FORMAT_BC3_UNORM_BLOCK / _SRGB_BLOCK
+    { 139, 0, BGFX_BC4, 4, 4, 8 },         // VK_FORMAT_BC4_UNORM_BLOCK
+    { 141, 0, BGFX_BC5, 4, 4, 16 },        // VK_FORMAT_BC5_UNORM_BLOCK
+    { 143, 0, BGFX_BC6H, 4, 4, 16 },       // VK_FORMAT_BC6H_UFLOAT_BLOCK
+    { 145, 146, BGFX_BC7, 4, 4, 16 },      // VK_FORMAT_BC7_UNORM_BLOCK / _SRGB_BLOCK
+    { 147, 148, BGFX_ETC2, 4, 4, 8 },      // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK / _SRGB_BLOCK
+    { 149, 150, BGFX_ETC2A1, 4, 4, 8 },    // VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK / _SRGB_BLOCK
+    { 151, 152, BGFX_ETC2A, 4, 4, 16 },    // VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK / _SRGB_BLOCK
+    { 157, 158, BGFX_ASTC4x4, 4, 4, 16 },  // VK_FORMAT_ASTC_4x4_UNORM_BLOCK / _SRGB_BLOCK
+    { 161, 162, BGFX_ASTC5x5, 5, 5, 16 },  // VK_FORMAT_ASTC_5x5_UNORM_BLOCK / _SRGB_BLOCK
+    { 165, 166, BGFX_ASTC6x6, 6, 6, 16 },  // VK_FORMAT_ASTC_6x6_UNORM_BLOCK / _SRGB_BLOCK
+    { 167, 168, BGFX_ASTC8x5, 8, 5, 16 },  // VK_FORMAT_ASTC_8x5_UNORM_BLOCK / _SRGB_BLOCK
+    { 169, 170, BGFX_ASTC8x6, 8, 6, 16 },  // VK_FORMAT_ASTC_8x6_UNORM_BLOCK / _SRGB_BLOCK
+    { 173, 174, BGFX_ASTC10x5, 10, 5, 16 } // VK_FORMAT_ASTC_10x5_UNORM_BLOCK / _SRGB_BLOCK
+};
+
+static const uint8_t sIdentifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+static const FormatInfo*
+FindFormat(uint32_t vkFormat)
+{
+    for (size_t i = 0; i < sizeof(sFormats) / sizeof(sFormats[0]); i++) {
+        if (sFormats[i].vkFormat == vkFormat || (sFormats[i].srgbVkFormat != 0 && sFormats[i].srgbVkFormat == vkFormat))
+            return &sFormats[i];
+    }
+    return 0;
+}
+
+static uint32_t
+ReadU32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t
+ReadU64(const uint8_t* p)
+{
+    return (uint64_t)ReadU32(p) | ((uint64_t)ReadU32(p + 4) << 32);
+}
+
+} // namespace
+
+KTX2Container::KTX2Container()
+{
+    width = 0;
+    height = 0;
+    levelCount = 0;
+    bgfxFormat = -1;
+    vkFormat = 0;
+    payloadSize = 0;
+    memset(levels, 0, sizeof(levels));
+}
+
+bool
+KTX2Container::IsKTX2(const uint8_t* data, size_t size)
+{
+    return data && size >= sizeof(sIdentifier) && memcmp(data, sIdentifier, sizeof(sIdentifier)) == 0;
+}
+
+bool
+KTX2Container::ParseHeader(const uint8_t* data, size_t size)
+{
+    if (size < sHeaderSize || !IsKTX2(data, size))
+        return false;
+    const uint8_t* h = data + sizeof(sIdentifier);
+    vkFormat = ReadU32(h + 0);
+    width = (int)ReadU32(h + 8);
+    height = (int)ReadU32(h + 12);
+    uint32_t depth = ReadU32(h + 16);
+    uint32_t layerCount = ReadU32(h + 20);
+    uint32_t faceCount = ReadU32(h + 24);
+    uint32_t numLevels = ReadU32(h + 28);
+    uint32_t supercompression = ReadU32(h + 32);
+
+    const FormatInfo* fi = FindFormat(vkFormat);
+    if (!fi) {
+        printf("KTX2: unsupported vkFormat %u, only BC, ETC2 and ASTC payloads can be used without transcoding.\n", vkFormat);
+        return false;
+    }
+    if (depth > 1 || layerCount > 1 || faceCount != 1 || supercompression != 0) {
+        printf("KTX2: only plain 2D textures without supercompression are supported.\n");
+        return false;
+    }
+    if (width <= 0 || height <= 0 || numLevels > sMaxLevels)
+        return false;
+    bgfxFormat = fi->bgfxFormat;
+    levelCount = numLevels == 0 ? 1 : (int)numLevels; // 0 means "generate mips", which we do not do for blocks
+    return true;
+}
+
+bool
+KTX2Container::ParseLevelIndex(const uint8_t* data, size_t size, size_t fileSize)
+{
+    if (size < LevelIndexSize())
+        return false;
+    const FormatInfo* fi = FindFormat(vkFormat);
+    payloadSize = 0;
+    for (int i = 0; i < levelCount; i++) {
+        const uint8_t* e = data + i * sLevelIndexEntrySize;
+        levels[i].byteOffset = ReadU64(e);
+        levels[i].byteLength = ReadU64(e + 8);
+        // bgfx reads exactly this many bytes for the level, anything else is a malformed file
+        int lw = width >> i; if (lw < 1) lw = 1;
+        int lh = height >> i; if (lh < 1) lh = 1;
+        uint64_t expected = (uint64_t)((lw + fi->blockWidth - 1) / fi->blockWidth) *
+            (uint64_t)((lh + fi->blockHeight - 1) / fi->blockHeight) * (uint64_t)fi->blockBytes;
+        if (levels[i].byteLength != expected || levels[i].byteOffset + levels[i].byteLength > fileSize)
+            return false;
+        payloadSize += expected;
+    }
+    return payloadSize <= 0x7fffffff;
+}
+
+void
+KTX2Container::SkipLevelsAbove(int maxDimension)
+{
+    if (maxDimension <= 0)
+        return;
+    int skip = 0;
+    while (skip < levelCount - 1 && ((width >> skip) > maxDimension || (height >> skip) > maxDimension))
+        skip++;
+    if (skip == 0)
+        return;
+    for (int i = 0; i < skip; i++)
+        payloadSize -= levels[i].byteLength;
+    for (int i = skip; i < levelCount; i++)
+        levels[i - skip] = levels[i];
+    levelCount -= skip;
+    width = width >> skip; if (width < 1) width = 1;
+    height = height >> skip; if (height < 1) height = 1;
+}
+
+bool
+KTX2Container::CopyPayload(const uint8_t* file, size_t fileSize, uint8_t* dest) const
+{
+    for (int i = 0; i < levelCount; i++) {
+        if (levels[i].byteOffset + levels[i].byteLength > fileSize)
+            return false;
+        memcpy(dest, file + levels[i].byteOffset, (size_t)levels[i].byteLength);
+        dest += levels[i].byteLength;
+    }
+    return true;
+}
+
+bool
+KTX2Container::ReadPayload(FILE* f, uint8_t* dest) const
+{
+    // levels are stored smallest first in the file, read each one straight to its final place
+    for (int i = 0; i < levelCount; i++) {
+        if (fseek(f, (long)levels[i].byteOffset, SEEK_SET) != 0)
+            return false;
+        if (fread(dest, (size_t)levels[i].byteLength, 1, f) != 1)
+            return false;
+        dest += levels[i].byteLength;
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+namespace ut {
+
+// Minimal reader for KTX2 containers that hold GPU ready block compressed payloads (BC, ETC2, ASTC)
+// with prebuilt mips. The payload is handed to the renderer as-is, there is no transcoding.
+// Only 2D, single layer, single face, non supercompressed files are supported.
+class KTX2Container {
+public:
+    static const int sMaxLevels = 16;
+    static const size_t sHeaderSize = 80; // identifier + header + index, level index follows
+    static const size_t sLevelIndexEntrySize = 24;
+
+    KTX2Container();
+
+    static bool IsKTX2(const uint8_t* data, size_t size);
+
+    // parse the fixed header; data must hold at least sHeaderSize bytes
+    bool ParseHeader(const uint8_t* data, size_t size);
+    // parse the level index that directly follows the header; data must hold LevelIndexSize() bytes
+    bool ParseLevelIndex(const uint8_t* data, size_t size, size_t fileSize);
+    size_t LevelIndexSize() const { return (size_t)levelCount * sLevelIndexEntrySize; }
+    // drop the largest mips until neither side exceeds maxDimension (0 means no limit), keeps at least one level
+    void SkipLevelsAbove(int maxDimension);
+
+    // gather all levels into dest, largest mip first, which is the layout bgfx expects
+    bool CopyPayload(const uint8_t* file, size_t fileSize, uint8_t* dest) const;
+    bool ReadPayload(FILE* f, uint8_t* dest) const;
+
+    int width, height;
+    int levelCount;
+    int bgfxFormat;        // bgfx::TextureFormat value
+    uint32_t vkFormat;
+    uint64_t payloadSize;  // sum of all levels
+
+private:
+    struct Level {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+    };
+    Level levels[sMaxLevels];
+};
+
+} // namespace ut
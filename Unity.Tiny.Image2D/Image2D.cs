@@ -78,6 +78,50 @@ namespace Unity.Tiny
         public Hash128 maskAsset;
     }
 
+    /// <summary>
+    /// Optional load priority for an image that is loaded from file.
+    /// </summary>
+    /// <remarks>
+    /// Images with a higher value are decoded first when more images are queued than there are decode workers.
+    /// Images without this component use priority 0.
+    /// </remarks>
+    public struct Image2DLoadPriority : IComponentData
+    {
+        public int Value;
+    }
+
+    /// <summary>
+    /// Singleton with settings applied to all images loaded from file.
+    /// </summary>
+    /// <remarks>
+    /// Set MaxDimension on devices that render at lower resolution. Larger images are scaled down
+    /// while they are loaded, so the full resolution pixels are never kept in memory.
+    /// Power of two images are halved until they fit. Precompressed images drop their largest mip levels instead.
+    /// The reported image size is the size after scaling. Only affects loads started after it changes.
+    /// </remarks>
+    public struct Image2DLoadSettings : IComponentData
+    {
+        /// <summary>
+        /// Maximum width or height of a loaded image in pixels. 0 means no limit.
+        /// </summary>
+        public int MaxDimension;
+    }
+
+    /// <summary>
+    /// Lets the renderer place a small image loaded from file into a shared atlas page instead of giving it
+    /// a texture of its own, so sprites using different images can be drawn together.
+    /// </summary>
+    /// <remarks>
+    /// Only decoded images up to 256 pixels on either side that are clamped on both axes and have no mip maps
+    /// are placed, all other images get a texture of their own as usual. Sprite texture coordinates are moved
+    /// into the image's part of the page. Anything else that samples the texture sees the whole page, so only
+    /// tag images that are drawn by sprites. The space of an image is given back when its entity is destroyed.
+    /// Atlas pages are not supported on WebGL, images get their own texture there.
+    /// </remarks>
+    public struct Image2DAtlas : IComponentData
+    {
+    }
+
     public enum RenderToTextureFormat
     {
         RGBA,
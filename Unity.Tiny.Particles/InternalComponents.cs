@@ -19,6 +19,10 @@ namespace Unity.Tiny.Particles
         internal float3 velocity;
 
         internal float4 color;
+
+        /// <summary> Spawn values that <see cref="LifetimeScale"/> and <see cref="LifetimeColor"/> multiply. </summary>
+        internal float3 initialScale;
+        internal float4 initialColor;
     }
 
     struct DynamicParticle : IBufferElementData
@@ -1,4 +1,5 @@
 using System.Collections.Generic;
+using Unity.Burst;
 using Unity.Entities;
 using Unity.Collections;
 using Unity.Mathematics;
@@ -268,29 +269,72 @@ namespace Unity.Tiny.Particles
         public uint Value;
     }
 
-#if false
     /// <summary>
-    ///  Modifies the SpriteRenderer's color by multiplying it's initial color by
+    ///  Values of a lifetime curve, sampled at evenly spaced points over the normalized
+    ///  particle lifetime. The first value is the value at time 0.0, the last one the
+    ///  value at time 1.0. Values in between are interpolated linearly.
+    /// </summary>
+    public struct LifetimeCurve
+    {
+        public BlobArray<float4> Values;
+
+        /// <summary>Returns the curve value at <paramref name="normalizedLife"/>, clamped to [0.0, 1.0].</summary>
+        public float4 Evaluate(float normalizedLife)
+        {
+            int last = Values.Length - 1;
+            if (last <= 0)
+                return last == 0 ? Values[0] : new float4(1);
+
+            float x = math.saturate(normalizedLife) * last;
+            int i = math.min((int)x, last - 1);
+            return math.lerp(Values[i], Values[i + 1], x - i);
+        }
+
+        /// <summary>
+        ///  Creates a curve blob from <paramref name="values"/>, sampled evenly from time 0.0 to 1.0.
+        ///  The caller owns the blob and must dispose it. Conversion systems go through the BlobAssetStore instead.
+        /// </summary>
+        public static BlobAssetReference<LifetimeCurve> Create(NativeArray<float4> values)
+        {
+            var builder = new BlobBuilder(Allocator.Temp);
+            ref var root = ref builder.ConstructRoot<LifetimeCurve>();
+            var dst = builder.Allocate(ref root.Values, values.Length);
+            for (int i = 0; i < values.Length; i++)
+                dst[i] = values[i];
+            var curve = builder.CreateBlobAssetReference<LifetimeCurve>(Allocator.Persistent);
+            builder.Dispose();
+            return curve;
+        }
+    }
+
+    /// <summary>
+    ///  Modifies the particle's color by multiplying its initial color by
     ///  curve. The value of curve at time 0.0 defines the particle's color at the
     ///  beginning of its lifetime. The value at time 1.0 defines the particle's
     ///  color at the end of its lifetime.
     /// </summary>
+    /// <remarks>
+    /// Should be placed next to <see cref="ParticleEmitter"/>
+    /// </remarks>
     public struct LifetimeColor : IComponentData
     {
-        /// <summary>Entity with the [Bezier|Linear|Step]CurveColor component.</summary>
-        public Entity curve;
+        /// <summary>RGBA multiplier.</summary>
+        public BlobAssetReference<LifetimeCurve> Curve;
     }
 
     /// <summary>
-    ///  Modifies the Transform's scale (uniform x/y/z scaling) by curve. The value
-    ///  of curve at time 0.0 defines the particle's color at the beginning of its
-    ///  lifetime. The value at time 1.0 defines the particle's color at the end
+    ///  Modifies the particle's scale by multiplying its initial scale by curve.
+    ///  The value of curve at time 0.0 defines the particle's scale at the beginning
+    ///  of its lifetime. The value at time 1.0 defines the particle's scale at the end
     ///  of its lifetime.
     /// </summary>
+    /// <remarks>
+    /// Should be placed next to <see cref="ParticleEmitter"/>
+    /// </remarks>
     public struct LifetimeScale : IComponentData
     {
-        /// <summary>Entity with the [Bezier|Linear|Step]CurveFloat component.</summary>
-        public Entity curve;
+        /// <summary>X, Y and Z scale multiplier in xyz.</summary>
+        public BlobAssetReference<LifetimeCurve> Curve;
     }
 
     /// <summary>
@@ -298,21 +342,27 @@ namespace Unity.Tiny.Particles
     ///  the particle's angular velocity at the beginning of its lifetime. The value
     ///  at time 1.0 defines the particle's angular velocity at the end of its lifetime.
     /// </summary>
+    /// <remarks>
+    /// Should be placed next to <see cref="ParticleEmitter"/>
+    /// </remarks>
     public struct LifetimeAngularVelocity : IComponentData
     {
-        /// <summary>Entity with the [Bezier|Linear|Step]CurveFloat component.</summary>
-        public Entity curve;
+        /// <summary>Angular velocity about the particle's Z axis in radians per second, in x.</summary>
+        public BlobAssetReference<LifetimeCurve> Curve;
     }
 
     /// <summary>
-    ///  The velocity over lifetime. The value of curve at time 0.0 defines
-    ///  the particle's velocity at the beginning of its lifetime. The value
-    ///  at time 1.0 defines the particle's velocity at the end of its lifetime.
+    ///  The velocity over lifetime, added to the particle's initial velocity. The value of
+    ///  curve at time 0.0 defines the velocity at the beginning of the particle's lifetime.
+    ///  The value at time 1.0 defines the velocity at the end of its lifetime.
     /// </summary>
+    /// <remarks>
+    /// Should be placed next to <see cref="ParticleEmitter"/>
+    /// </remarks>
     public struct LifetimeVelocity : IComponentData
     {
-        /// <summary>Entity with the [Bezier|Linear|Step]CurveVector3 component.</summary>
-        public Entity curve;
+        /// <summary>Velocity in xyz.</summary>
+        public BlobAssetReference<LifetimeCurve> Curve;
     }
 
     /// <summary>
@@ -320,12 +370,15 @@ namespace Unity.Tiny.Particles
     ///  multiplier at the beginning of the particle's lifetime. The value at time
     ///  1.0 defines the multiplier at the end of the particle's lifetime.
     /// </summary>
+    /// <remarks>
+    /// Should be placed next to <see cref="ParticleEmitter"/>
+    /// </remarks>
     public struct LifetimeSpeedMultiplier : IComponentData
     {
-        /// <summary>Entity with the [Bezier|Linear|Step]CurveFloat component.</summary>
-        public Entity curve;
+        /// <summary>Multiplier in x.</summary>
+        public BlobAssetReference<LifetimeCurve> Curve;
     }
-#endif
+
     /// <summary>
     ///  An emitter with this component emits particles in bursts. A burst is a particle
     ///  event where a number of particles are all emitted at the same time. A cycle
@@ -411,16 +464,9 @@ namespace Unity.Tiny.Particles
 
         private static Entity CreateParticleRenderer(EntityManager mgr, Entity eEmitter)
         {
-            Entity eParticleRenderer = mgr.CreateEntity(typeof(MeshRenderer), typeof(EmitterReferenceForRenderer), typeof(LocalToWorld), typeof(DynamicMeshData));
+            Entity eParticleRenderer = mgr.CreateEntity(typeof(MeshRenderer), typeof(EmitterReferenceForRenderer), typeof(LocalToWorld), typeof(ObjectBounds));
             var material = mgr.GetComponentData<ParticleMaterial>(eEmitter).Material;
             Assert.IsTrue(material != Entity.Null);
-            mgr.AddComponentData(eParticleRenderer, new MeshRenderer
-            {
-                mesh = eParticleRenderer,
-                material = material,
-                startIndex = 0,
-                indexCount = 0
-            });
             mgr.AddComponentData(eParticleRenderer, new EmitterReferenceForRenderer { emitter = eEmitter });
             mgr.AddComponentData(eParticleRenderer, new LocalToWorld { Value = float4x4.identity });
 
@@ -434,15 +480,16 @@ namespace Unity.Tiny.Particles
             }
 
             // Particle mesh
+            Entity mesh;
             if (mgr.HasComponent<ParticleMesh>(eEmitter))
             {
                 ParticleMesh particleMesh = mgr.GetComponentData<ParticleMesh>(eEmitter);
                 Assert.IsTrue(particleMesh.Mesh != Entity.Null);
+                mesh = particleMesh.Mesh;
             }
             else // Billboarded
             {
                 // Add mesh for 1x1 quad
-                Entity mesh;
                 float3 org = new float3(-0.5f, -0.5f, 0);
                 float3 du = new float3(1, 0, 0);
                 float3 dv = new float3(0, 1, 0);
@@ -499,16 +546,16 @@ namespace Unity.Tiny.Particles
                 builder.Dispose();
             }
 
-            if (isLit)
-            {
-                mgr.AddBuffer<DynamicLitVertex>(eParticleRenderer);
-            }
-            else
+            // Every particle draws the whole mesh, the renderer places them from the instance buffer
+            int indexCount = isLit ? mgr.GetComponentData<LitMeshRenderData>(mesh).Mesh.Value.Indices.Length : mgr.GetComponentData<SimpleMeshRenderData>(mesh).Mesh.Value.Indices.Length;
+            mgr.AddComponentData(eParticleRenderer, new MeshRenderer
             {
-                mgr.AddBuffer<DynamicSimpleVertex>(eParticleRenderer);
-            }
-            mgr.AddBuffer<DynamicIndex>(eParticleRenderer);
-            mgr.AddComponent<MeshBounds>(eParticleRenderer);
+                mesh = mesh,
+                material = material,
+                startIndex = 0,
+                indexCount = indexCount
+            });
+            mgr.AddBuffer<ParticleInstance>(eParticleRenderer);
 
             return eParticleRenderer;
         }
@@ -568,494 +615,513 @@ namespace Unity.Tiny.Particles
     /// <summary>
     ///  System that handles spawning new particles for all emitters
     /// </summary>
+    /// <remarks>
+    /// Emitters are spawned in parallel, one chunk of emitters per job. Optional emitter
+    /// components are looked up once per chunk instead of once per emitter.
+    /// </remarks>
     [UpdateInGroup(typeof(SimulationSystemGroup))]
     [UpdateAfter(typeof(EmitterSystem))]
     [UpdateAfter(typeof(TransformSystemGroup))]
     public class ParticleSpawnSystem : SystemBase
     {
-        private void SpawnParticles(EntityManager mgr, float deltaTime, Entity emitter)
+        [BurstCompile]
+        struct SpawnParticlesJob : IJobChunk
         {
-            var particleEmitter = mgr.GetComponentData<ParticleEmitter>(emitter);
-            var particleEmitterInternal = mgr.GetComponentData<ParticleEmitterInternal>(emitter);
-            Random rand = mgr.GetComponentData<Rng>(emitter).rand;
-
-            // For debug
-            //Debug.LogFormatAlways("Emitter: {0}, Particles: {1}, Max: {2}, Emit Rate: {3}, Lifetime: {4}", emitter.Index, (int)particleEmitterInternal.numParticles, (int)particleEmitter.maxParticles, particleEmitter.emitRate.end, particleEmitter.lifetime.end);
-
-            // Burst emission mode
-            uint burstParticleCount = 0;
-            if (mgr.HasComponent<BurstEmissionInternal>(emitter) && mgr.HasComponent<BurstEmission>(emitter))
+            [ReadOnly] public ComponentTypeHandle<ParticleEmitter> ParticleEmitterType;
+            public ComponentTypeHandle<ParticleEmitterInternal> ParticleEmitterInternalType;
+            public ComponentTypeHandle<Rng> RngType;
+            public BufferTypeHandle<DynamicParticle> DynamicParticleType;
+            [ReadOnly] public ComponentTypeHandle<Looping> LoopingType;
+            [ReadOnly] public ComponentTypeHandle<BurstEmission> BurstEmissionType;
+            public ComponentTypeHandle<BurstEmissionInternal> BurstEmissionInternalType;
+            [ReadOnly] public ComponentTypeHandle<EmitterInitialSpeed> EmitterInitialSpeedType;
+            [ReadOnly] public ComponentTypeHandle<EmitterInitialScale> EmitterInitialScaleType;
+            [ReadOnly] public ComponentTypeHandle<EmitterInitialNonUniformScale> EmitterInitialNonUniformScaleType;
+            [ReadOnly] public ComponentTypeHandle<EmitterInitialRotation> EmitterInitialRotationType;
+            [ReadOnly] public ComponentTypeHandle<EmitterInitialNonUniformRotation> EmitterInitialNonUniformRotationType;
+            [ReadOnly] public ComponentTypeHandle<InitialColor> InitialColorType;
+            [ReadOnly] public ComponentTypeHandle<RandomizePosition> RandomizePositionType;
+            [ReadOnly] public ComponentTypeHandle<RandomizeDirection> RandomizeDirectionType;
+            [ReadOnly] public ComponentTypeHandle<LocalToWorld> LocalToWorldType;
+            [ReadOnly] public ComponentTypeHandle<EmitterRectangleSource> EmitterRectangleSourceType;
+            [ReadOnly] public ComponentTypeHandle<EmitterCircleSource> EmitterCircleSourceType;
+            [ReadOnly] public ComponentTypeHandle<EmitterConeSource> EmitterConeSourceType;
+            [ReadOnly] public ComponentTypeHandle<EmitterSphereSource> EmitterSphereSourceType;
+            [ReadOnly] public ComponentTypeHandle<EmitterHemisphereSource> EmitterHemisphereSourceType;
+            [ReadOnly] public ComponentTypeHandle<ParticleMaterial> ParticleMaterialType;
+            [ReadOnly] public ComponentDataFromEntity<LitMaterial> ComponentLitMaterial;
+            [ReadOnly] public ComponentDataFromEntity<SimpleMaterial> ComponentSimpleMaterial;
+            // Every emitter owns its renderer, so emitters in other chunks never touch the same buffer
+            [NativeDisableParallelForRestriction]
+            public BufferFromEntity<ParticleInstance> BufferParticleInstance;
+            public float DeltaTime;
+
+            public void Execute(ArchetypeChunk chunk, int chunkIndex, int firstEntityIndex)
             {
-                var burstEmission = mgr.GetComponentData<BurstEmission>(emitter);
-                var burstEmissionInternal = mgr.GetComponentData<BurstEmissionInternal>(emitter);
-
-                if (ParticlesUtil.ActiveBurstEmitter(burstEmission, burstEmissionInternal))
+                var chunkEmitter = chunk.GetNativeArray(ParticleEmitterType);
+                var chunkEmitterInternal = chunk.GetNativeArray(ParticleEmitterInternalType);
+                var chunkRng = chunk.GetNativeArray(RngType);
+                var chunkParticles = chunk.GetBufferAccessor(DynamicParticleType);
+                bool looping = chunk.Has(LoopingType);
+                bool hasBurstEmission = chunk.Has(BurstEmissionType) && chunk.Has(BurstEmissionInternalType);
+                var chunkBurstEmission = hasBurstEmission ? chunk.GetNativeArray(BurstEmissionType) : default;
+                var chunkBurstEmissionInternal = hasBurstEmission ? chunk.GetNativeArray(BurstEmissionInternalType) : default;
+
+                for (int i = 0; i < chunk.Count; i++)
                 {
-                    burstEmissionInternal.cooldown -= deltaTime;
-                    if (burstEmissionInternal.cooldown < 0.0f)
+                    var emitter = chunkEmitter[i];
+                    var emitterInternal = chunkEmitterInternal[i];
+                    float deltaTime = DeltaTime;
+                    if (emitterInternal.remainingDelay < deltaTime)
+                    {
+                        // Update t
+                        emitterInternal.t += deltaTime - emitterInternal.remainingDelay;
+                        if (looping)
+                        {
+                            while (emitterInternal.t >= emitter.Duration)
+                                emitterInternal.t -= emitter.Duration;
+                        }
+                        else
+                            emitterInternal.t = math.min(emitterInternal.t, emitter.Duration);
+                    }
+                    else
+                    {
+                        emitterInternal.remainingDelay -= deltaTime;
+                        deltaTime = math.max(-emitterInternal.remainingDelay, 0.0f);
+                        emitterInternal.remainingDelay = math.max(emitterInternal.remainingDelay, 0.0f);
+                    }
+
+                    bool activeBurstEmitter = hasBurstEmission && ParticlesUtil.ActiveBurstEmitter(chunkBurstEmission[i], chunkBurstEmissionInternal[i]);
+                    if (!looping && emitterInternal.t >= emitter.Duration
+                        || !ParticlesUtil.ActiveEmitter(emitter) && !activeBurstEmitter)
+                    {
+                        if (emitterInternal.active && emitterInternal.numParticles == 0)
+                        {
+                            // Heap space is limited on some platforms, so free up this memory if it seems like this emitter won't be spawning any particles for a while
+                            if (BufferParticleInstance.HasComponent(emitterInternal.particleRenderer))
+                            {
+                                var instanceBuffer = BufferParticleInstance[emitterInternal.particleRenderer];
+                                instanceBuffer.Clear();
+                                instanceBuffer.TrimExcess();
+                            }
+                            var particleBuffer = chunkParticles[i];
+                            particleBuffer.Clear();
+                            particleBuffer.TrimExcess();
+                            emitterInternal.active = false;
+                        }
+                    }
+                    else
                     {
-                        burstParticleCount = (uint)rand.NextInt((int)burstEmission.Count.Start, (int)burstEmission.Count.End);
-                        if (burstEmission.Cycles != ParticlesUtil.kBurstCycleInfinitely)
-                            burstEmissionInternal.cycle++;
-                        burstEmissionInternal.cooldown = burstEmission.Interval;
+                        emitterInternal.active = true;
+                        Random rand = chunkRng[i].rand;
+                        if (activeBurstEmitter)
+                        {
+                            var burstEmissionInternal = chunkBurstEmissionInternal[i];
+                            uint burstParticleCount = UpdateBurstEmission(chunkBurstEmission[i], ref burstEmissionInternal, deltaTime, ref rand);
+                            chunkBurstEmissionInternal[i] = burstEmissionInternal;
+                            SpawnParticles(chunk, i, emitter, ref emitterInternal, chunkParticles[i].Reinterpret<Particle>(), burstParticleCount, deltaTime, ref rand);
+                        }
+                        else
+                            SpawnParticles(chunk, i, emitter, ref emitterInternal, chunkParticles[i].Reinterpret<Particle>(), 0, deltaTime, ref rand);
+                        chunkRng[i] = new Rng { rand = rand };
                     }
 
-                    mgr.SetComponentData(emitter, burstEmissionInternal);
+                    chunkEmitterInternal[i] = emitterInternal;
                 }
             }
 
-            // Normal emission mode
-            uint particlesToSpawn = 0;
-            if (ParticlesUtil.ActiveEmitter(particleEmitter))
+            static uint UpdateBurstEmission(BurstEmission burstEmission, ref BurstEmissionInternal burstEmissionInternal, float deltaTime, ref Random rand)
             {
-                particleEmitterInternal.particleSpawnCooldown += deltaTime;
-                float particleSpawnDelay = 1.0f / rand.RandomRange(particleEmitter.EmitRate);
-
-                particlesToSpawn = (uint)(particleEmitterInternal.particleSpawnCooldown / particleSpawnDelay);
-
-                if (particlesToSpawn > 0)
-                    particleEmitterInternal.particleSpawnCooldown -= particleSpawnDelay * particlesToSpawn;
-
-                mgr.SetComponentData(emitter, particleEmitterInternal);
-            }
-
-            particlesToSpawn += burstParticleCount;
-            uint maxParticlesToSpawn = particleEmitter.MaxParticles - particleEmitterInternal.numParticles;
-            if (particlesToSpawn > maxParticlesToSpawn)
-                particlesToSpawn = maxParticlesToSpawn;
+                uint burstParticleCount = 0;
+                burstEmissionInternal.cooldown -= deltaTime;
+                if (burstEmissionInternal.cooldown < 0.0f)
+                {
+                    burstParticleCount = (uint)rand.NextInt((int)burstEmission.Count.Start, (int)burstEmission.Count.End);
+                    if (burstEmission.Cycles != ParticlesUtil.kBurstCycleInfinitely)
+                        burstEmissionInternal.cycle++;
+                    burstEmissionInternal.cooldown = burstEmission.Interval;
+                }
 
-            if (particlesToSpawn == 0)
-            {
-                mgr.SetComponentData(emitter, new Rng { rand = rand });
-                return;
+                return burstParticleCount;
             }
 
-            var particles = EntityManager.GetBuffer<DynamicParticle>(emitter).Reinterpret<Particle>();
-            int offset = particles.Length;
-            particles.ResizeUninitialized(particles.Length + (int)particlesToSpawn);
-
-            InitTime(deltaTime, particleEmitter.Lifetime, particles, offset, ref rand);
-#if false
-            if (mgr.HasComponent<EmitterInitialVelocity>(emitter))
-            {
-                var velocity = mgr.GetComponentData<EmitterInitialVelocity>(emitter).velocity;
-                var particleVelocity = new ParticleVelocity { velocity = velocity };
-                foreach (var particle in newParticles)
-                    ecb.AddComponent(particle, particleVelocity);
-            }
-            else if (mgr.HasComponent<LifetimeVelocity>(emitter))
-            {
-                foreach (var particle in newParticles)
-                    ecb.AddComponent(particle, new ParticleVelocity { velocity = float3.zero });
-            }
-#endif
-            InitColor(mgr, emitter, particles, offset, ref rand);
-            InitScale(mgr, emitter, particles, offset, ref rand);
-
-            // Init particle's position and the velocity based on the source
-            Range speed = mgr.GetComponentData<EmitterInitialSpeed>(emitter).Speed;
-            float randomizePos = mgr.HasComponent<RandomizePosition>(emitter) ? mgr.GetComponentData<RandomizePosition>(emitter).Value : 0.0f;
-            float randomizeDir = mgr.HasComponent<RandomizeDirection>(emitter) ? mgr.GetComponentData<RandomizeDirection>(emitter).Value : 0.0f;
-            float4x4 matrix = particleEmitter.AttachToEmitter ? float4x4.identity : mgr.GetComponentData<LocalToWorld>(emitter).Value;
-            if (mgr.HasComponent<EmitterRectangleSource>(emitter))
-            {
-                ParticlesSource.InitEmitterRectangleSource(mgr, emitter, particles, offset, speed, randomizePos, randomizeDir, matrix, ref rand);
-            }
-            else if (mgr.HasComponent<EmitterCircleSource>(emitter))
-            {
-                ParticlesSource.InitEmitterCircleSource(mgr, emitter, particles, offset, speed, randomizePos, randomizeDir, matrix, ref rand);
-            }
-            else if (mgr.HasComponent<EmitterConeSource>(emitter))
-            {
-                ParticlesSource.InitEmitterConeSource(mgr, emitter, particles, offset, speed, randomizePos, randomizeDir, matrix, ref rand);
-            }
-            else if (mgr.HasComponent<EmitterSphereSource>(emitter))
-            {
-                var radius = mgr.GetComponentData<EmitterSphereSource>(emitter).Radius;
-                ParticlesSource.InitEmitterSphereSource(mgr, emitter, particles, offset, radius, false, speed, randomizePos, randomizeDir, matrix, ref rand);
-            }
-            else if (mgr.HasComponent<EmitterHemisphereSource>(emitter))
+            void SpawnParticles(ArchetypeChunk chunk, int i, ParticleEmitter particleEmitter, ref ParticleEmitterInternal particleEmitterInternal, DynamicBuffer<Particle> particles, uint burstParticleCount, float deltaTime, ref Random rand)
             {
-                var radius = mgr.GetComponentData<EmitterHemisphereSource>(emitter).Radius;
-                ParticlesSource.InitEmitterSphereSource(mgr, emitter, particles, offset, radius, true, speed, randomizePos, randomizeDir, matrix, ref rand);
-            }
-
-            mgr.SetComponentData(emitter, new Rng { rand = rand });
-        }
-
-        static void InitTime(float deltaTime, Range lifetime, DynamicBuffer<Particle> particles, int offset, ref Random rand)
-        {
-            // The time is evenly distributted from 0.0 to deltaTime.
+                // Normal emission mode
+                uint particlesToSpawn = 0;
+                if (ParticlesUtil.ActiveEmitter(particleEmitter))
+                {
+                    particleEmitterInternal.particleSpawnCooldown += deltaTime;
+                    float particleSpawnDelay = 1.0f / rand.RandomRange(particleEmitter.EmitRate);
 
-            // The time of each subsequent particle will be increased by this value.
-            // particle.time[0..n] = (0 * timeStep, 1 * timeStep, 2 * timeStep, ..., n * timeStep).
-            int newParticles = particles.Length - offset;
-            float timeStep = newParticles > 1 ? deltaTime / (newParticles - 1) : 0.0f;
+                    particlesToSpawn = (uint)(particleEmitterInternal.particleSpawnCooldown / particleSpawnDelay);
 
-            // We need to subtract deltaTime from the particle's relative time, because later in
-            // the same frame we are adding deltaTime to the particle's relative time when we process
-            // them. This ensures that the first, newly created particle will start at a relative time 0.0.
-            float time = -deltaTime;
-            time += timeStep;
+                    if (particlesToSpawn > 0)
+                        particleEmitterInternal.particleSpawnCooldown -= particleSpawnDelay * particlesToSpawn;
+                }
 
-            for (var i = offset; i < particles.Length; i++)
-            {
-                var particle = particles[i];
-                particle.lifetime = rand.RandomRange(lifetime);
-                particle.time = time;
-                particles[i] = particle;
-            }
-        }
+                particlesToSpawn += burstParticleCount;
+                uint maxParticlesToSpawn = particleEmitter.MaxParticles - particleEmitterInternal.numParticles;
+                if (particlesToSpawn > maxParticlesToSpawn)
+                    particlesToSpawn = maxParticlesToSpawn;
 
-        private static void InitScale(EntityManager mgr, Entity emitter, DynamicBuffer<Particle> particles, int offset, ref Random rand)
-        {
-#if false
-            bool hasInitialUniformScale = mgr.HasComponent<EmitterInitialScale>(emitter);
-            bool hasInitialNonUniformScale = mgr.HasComponent<EmitterInitialNonUniformScale>(emitter);
-            bool hasInitialScale = hasInitialUniformScale || hasInitialNonUniformScale;
-            bool hasLifetimeScale = mgr.HasComponent<LifetimeScale>(emitter);
+                if (particlesToSpawn == 0)
+                    return;
 
-            if (!hasInitialScale && !hasLifetimeScale)
-                return;
+                int offset = particles.Length;
+                particles.ResizeUninitialized(particles.Length + (int)particlesToSpawn);
 
-            if (hasLifetimeScale)
-            {
-                var lifetimeScale = mgr.GetComponentData<LifetimeScale>(emitter);
+                InitTime(deltaTime, particleEmitter.Lifetime, particles, offset, ref rand);
+                InitColor(chunk, i, particles, offset, ref rand);
+                InitScale(chunk, i, particles, offset, ref rand);
 
-                if (hasInitialScale)
+                // Init particle's position and the velocity based on the source
+                Range speed = chunk.Has(EmitterInitialSpeedType) ? chunk.GetNativeArray(EmitterInitialSpeedType)[i].Speed : new Range();
+                float randomizePos = chunk.Has(RandomizePositionType) ? chunk.GetNativeArray(RandomizePositionType)[i].Value : 0.0f;
+                float randomizeDir = chunk.Has(RandomizeDirectionType) ? chunk.GetNativeArray(RandomizeDirectionType)[i].Value : 0.0f;
+                float4x4 matrix = particleEmitter.AttachToEmitter || !chunk.Has(LocalToWorldType) ? float4x4.identity : chunk.GetNativeArray(LocalToWorldType)[i].Value;
+                var rotation = GetRotationSettings(chunk, i);
+                if (chunk.Has(EmitterRectangleSourceType))
                 {
-                    var initialScale = mgr.GetComponentData<EmitterInitialScale>(emitter);
-
-                    // LifetimeScale and EmitterInitialScale are present.
-                    foreach (var particle in newParticles)
-                    {
-                        var localScale = mgr.GetComponentData<NonUniformScale>(particle).Value;
-                        var scale = localScale * ParticlesUtil.RandomRange(initialScale.scale);
-                        mgr.AddComponentData(particle, new ParticleLifetimeScale()
-                        {
-                            initialScale = localScale
-                        });
-                    }
+                    ParticlesSource.InitEmitterRectangleSource(particles, offset, speed, randomizePos, randomizeDir, matrix, rotation, ref rand);
                 }
-                else
+                else if (chunk.Has(EmitterCircleSourceType))
                 {
-                    // Only LifetimeScale is present.
-                    foreach (var particle in newParticles)
-                    {
-                        var localScale = mgr.GetComponentData<NonUniformScale>(particle).Value;
-                        mgr.AddComponentData(particle, new ParticleLifetimeScale()
-                        {
-                            initialScale = localScale
-                        });
-                    }
+                    var radius = chunk.GetNativeArray(EmitterCircleSourceType)[i].Radius;
+                    ParticlesSource.InitEmitterCircleSource(particles, offset, radius, speed, randomizePos, randomizeDir, matrix, rotation, ref rand);
                 }
-            }
-            else if (hasInitialScale)
-#endif
-            {
-                // Only EmitterInitialScale is present
-                if (mgr.HasComponent<EmitterInitialScale>(emitter))
+                else if (chunk.Has(EmitterConeSourceType))
                 {
-                    var initialScale = mgr.GetComponentData<EmitterInitialScale>(emitter);
-                    for (var i = offset; i < particles.Length; i++)
-                    {
-                        var particle = particles[i];
-                        particle.scale = rand.RandomRange(initialScale.Scale);
-                        particles[i] = particle;
-                    }
+                    var source = chunk.GetNativeArray(EmitterConeSourceType)[i];
+                    ParticlesSource.InitEmitterConeSource(particles, offset, source, speed, randomizePos, randomizeDir, matrix, rotation, ref rand);
                 }
-                else if (mgr.HasComponent<EmitterInitialNonUniformScale>(emitter))
+                else if (chunk.Has(EmitterSphereSourceType))
                 {
-                    var initialScale = mgr.GetComponentData<EmitterInitialNonUniformScale>(emitter);
-                    for (var i = offset; i < particles.Length; i++)
-                    {
-                        var particle = particles[i];
-                        particle.scale = new float3(rand.RandomRange(initialScale.ScaleX), rand.RandomRange(initialScale.ScaleY), rand.RandomRange(initialScale.ScaleZ));
-                        particles[i] = particle;
-                    }
+                    var radius = chunk.GetNativeArray(EmitterSphereSourceType)[i].Radius;
+                    ParticlesSource.InitEmitterSphereSource(particles, offset, radius, false, speed, randomizePos, randomizeDir, matrix, rotation, ref rand);
+                }
+                else if (chunk.Has(EmitterHemisphereSourceType))
+                {
+                    var radius = chunk.GetNativeArray(EmitterHemisphereSourceType)[i].Radius;
+                    ParticlesSource.InitEmitterSphereSource(particles, offset, radius, true, speed, randomizePos, randomizeDir, matrix, rotation, ref rand);
                 }
             }
-        }
-
-        private void InitColor(EntityManager mgr, Entity emitter, DynamicBuffer<Particle> particles, int offset, ref Random rand)
-        {
-#if false
-            bool hasInitialColor = mgr.HasComponent<EmitterInitialColor>(emitter);
-            bool hasLifetimeColor = mgr.HasComponent<LifetimeColor>(emitter);
 
-            if (!hasInitialColor && !hasLifetimeColor)
-                return;
-
-            if (hasLifetimeColor)
+            ParticlesSource.RotationSettings GetRotationSettings(ArchetypeChunk chunk, int i)
             {
-                var lifetimeColor = mgr.GetComponentData<LifetimeColor>(emitter);
-
-                if (hasInitialColor)
+                var rotation = new ParticlesSource.RotationSettings();
+                if (chunk.Has(EmitterInitialRotationType))
                 {
-                    // LifetimeColor and EmitterInitialColor are present.
-
-                    var initialColor = mgr.GetComponentData<EmitterInitialColor>(emitter);
-                    foreach (var particle in newParticles)
+                    rotation.uniform = true;
+                    rotation.angle = chunk.GetNativeArray(EmitterInitialRotationType)[i].Angle;
+                    if (chunk.Has(ParticleMaterialType))
                     {
-                        var renderer = mgr.GetComponentData<SpriteRenderer>(particle);
-                        var randomColor = InterpolationService.EvaluateCurveColor(
-                            mgr, m_rand.NextFloat(), initialColor.curve);
-                        var color = renderer.Color * randomColor;
-                        mgr.AddComponentData(particle, new ParticleLifetimeColor()
-                        {
-                            initialColor = color
-                        });
+                        var material = chunk.GetNativeArray(ParticleMaterialType)[i].Material;
+                        if (ComponentLitMaterial.HasComponent(material))
+                            rotation.billboarded = ComponentLitMaterial[material].billboarded;
+                        else if (ComponentSimpleMaterial.HasComponent(material))
+                            rotation.billboarded = ComponentSimpleMaterial[material].billboarded;
                     }
                 }
-                else
+                else if (chunk.Has(EmitterInitialNonUniformRotationType))
                 {
-                    // Only LifetimeColor is present.
-                    foreach (var particle in newParticles)
-                    {
-                        var rendererColor = mgr.GetComponentData<SpriteRenderer>(particle).Color;
-                        mgr.AddComponentData(particle, new ParticleLifetimeColor()
-                        {
-                            initialColor = rendererColor
-                        });
-                    }
+                    rotation.nonUniform = true;
+                    rotation.nonUniformAngle = chunk.GetNativeArray(EmitterInitialNonUniformRotationType)[i];
                 }
+
+                return rotation;
             }
-#endif
 
-            if (mgr.HasComponent<InitialColor>(emitter))
+            static void InitTime(float deltaTime, Range lifetime, DynamicBuffer<Particle> particles, int offset, ref Random rand)
             {
-                // Only InitialColor is present.
-                var initialColor = mgr.GetComponentData<InitialColor>(emitter);
+                // The time is evenly distributted from 0.0 to deltaTime.
+
+                // The time of each subsequent particle will be increased by this value.
+                // particle.time[0..n] = (0 * timeStep, 1 * timeStep, 2 * timeStep, ..., n * timeStep).
+                int newParticles = particles.Length - offset;
+                float timeStep = newParticles > 1 ? deltaTime / (newParticles - 1) : 0.0f;
+
+                // We need to subtract deltaTime from the particle's relative time, because later in
+                // the same frame we are adding deltaTime to the particle's relative time when we process
+                // them. This ensures that the first, newly created particle will start at a relative time 0.0.
+                float time = -deltaTime;
+                time += timeStep;
+
                 for (var i = offset; i < particles.Length; i++)
                 {
                     var particle = particles[i];
-                    particle.color = math.lerp(initialColor.ColorMin, initialColor.ColorMax, rand.Random01());
+                    particle.lifetime = rand.RandomRange(lifetime);
+                    particle.time = time;
                     particles[i] = particle;
                 }
             }
-            else
+
+            void InitScale(ArchetypeChunk chunk, int i, DynamicBuffer<Particle> particles, int offset, ref Random rand)
             {
-                float4 defaultColor = new float4(1);
-                for (var i = offset; i < particles.Length; i++)
+                if (chunk.Has(EmitterInitialScaleType))
                 {
-                    var particle = particles[i];
-                    particle.color = defaultColor;
-                    particles[i] = particle;
+                    var initialScale = chunk.GetNativeArray(EmitterInitialScaleType)[i];
+                    for (var p = offset; p < particles.Length; p++)
+                    {
+                        var particle = particles[p];
+                        particle.initialScale = rand.RandomRange(initialScale.Scale);
+                        particle.scale = particle.initialScale;
+                        particles[p] = particle;
+                    }
                 }
-            }
-        }
-
-        protected override void OnUpdate()
-        {
-            Entities
-                .WithoutBurst()
-                .ForEach((Entity e, ref ParticleEmitterInternal emitterInternal, in ParticleEmitter emitter) =>
+                else if (chunk.Has(EmitterInitialNonUniformScaleType))
                 {
-                    float deltaTime = Time.DeltaTime;
-                    bool looping = EntityManager.HasComponent<Looping>(e);
-                    if (emitterInternal.remainingDelay < deltaTime)
+                    var initialScale = chunk.GetNativeArray(EmitterInitialNonUniformScaleType)[i];
+                    for (var p = offset; p < particles.Length; p++)
                     {
-                        // Update t
-                        emitterInternal.t += deltaTime - emitterInternal.remainingDelay;
-                        if (looping)
-                        {
-                            while (emitterInternal.t >= emitter.Duration)
-                                emitterInternal.t -= emitter.Duration;
-                        }
-                        else
-                            emitterInternal.t = math.min(emitterInternal.t, emitter.Duration);
+                        var particle = particles[p];
+                        particle.initialScale = new float3(rand.RandomRange(initialScale.ScaleX), rand.RandomRange(initialScale.ScaleY), rand.RandomRange(initialScale.ScaleZ));
+                        particle.scale = particle.initialScale;
+                        particles[p] = particle;
                     }
-                    else
+                }
+                else
+                {
+                    float3 defaultScale = new float3(1);
+                    for (var p = offset; p < particles.Length; p++)
                     {
-                        emitterInternal.remainingDelay -= deltaTime;
-                        deltaTime = math.max(-emitterInternal.remainingDelay, 0.0f);
-                        emitterInternal.remainingDelay = math.max(emitterInternal.remainingDelay, 0.0f);
+                        var particle = particles[p];
+                        particle.initialScale = defaultScale;
+                        particle.scale = defaultScale;
+                        particles[p] = particle;
                     }
+                }
+            }
 
-                    if (!looping && emitterInternal.t >= emitter.Duration
-                        || !ParticlesUtil.ActiveEmitter(emitter) && !ParticlesUtil.ActiveBurstEmitter(EntityManager, e))
+            void InitColor(ArchetypeChunk chunk, int i, DynamicBuffer<Particle> particles, int offset, ref Random rand)
+            {
+                if (chunk.Has(InitialColorType))
+                {
+                    var initialColor = chunk.GetNativeArray(InitialColorType)[i];
+                    for (var p = offset; p < particles.Length; p++)
                     {
-                        if (emitterInternal.active && emitterInternal.numParticles == 0)
-                        {
-                            // Heap space is limited on some platforms, so free up this memory if it seems like this emitter won't be spawning any particles for a while
-                            if (EntityManager.HasComponent<LitParticleRenderer>(emitterInternal.particleRenderer))
-                            {
-                                var vBuffer = EntityManager.GetBuffer<DynamicLitVertex>(emitterInternal.particleRenderer);
-                                vBuffer.Clear();
-                                vBuffer.TrimExcess();
-                            }
-                            else
-                            {
-                                Assert.IsTrue(EntityManager.HasComponent<SimpleParticleRenderer>(emitterInternal.particleRenderer));
-                                var vBuffer = EntityManager.GetBuffer<DynamicSimpleVertex>(emitterInternal.particleRenderer);
-                                vBuffer.Clear();
-                                vBuffer.TrimExcess();
-                            }
-
-                            var iBuffer = EntityManager.GetBuffer<DynamicIndex>(emitterInternal.particleRenderer);
-                            iBuffer.Clear();
-                            iBuffer.TrimExcess();
-                            var particleBuffer = EntityManager.GetBuffer<DynamicParticle>(e);
-                            particleBuffer.Clear();
-                            particleBuffer.TrimExcess();
-                            emitterInternal.active = false;
-                        }
+                        var particle = particles[p];
+                        particle.initialColor = math.lerp(initialColor.ColorMin, initialColor.ColorMax, rand.Random01());
+                        particle.color = particle.initialColor;
+                        particles[p] = particle;
                     }
-                    else
+                }
+                else
+                {
+                    float4 defaultColor = new float4(1);
+                    for (var p = offset; p < particles.Length; p++)
                     {
-                        emitterInternal.active = true;
-                        SpawnParticles(EntityManager, deltaTime, e);
+                        var particle = particles[p];
+                        particle.initialColor = defaultColor;
+                        particle.color = defaultColor;
+                        particles[p] = particle;
                     }
-                }).Run();
+                }
+            }
+        }
+
+        EntityQuery m_query;
+
+        protected override void OnCreate()
+        {
+            m_query = GetEntityQuery(
+                ComponentType.ReadOnly<ParticleEmitter>(),
+                typeof(ParticleEmitterInternal),
+                typeof(Rng),
+                typeof(DynamicParticle)
+            );
+        }
+
+        protected override void OnUpdate()
+        {
+            var spawnJob = new SpawnParticlesJob
+            {
+                ParticleEmitterType = GetComponentTypeHandle<ParticleEmitter>(true),
+                ParticleEmitterInternalType = GetComponentTypeHandle<ParticleEmitterInternal>(),
+                RngType = GetComponentTypeHandle<Rng>(),
+                DynamicParticleType = GetBufferTypeHandle<DynamicParticle>(),
+                LoopingType = GetComponentTypeHandle<Looping>(true),
+                BurstEmissionType = GetComponentTypeHandle<BurstEmission>(true),
+                BurstEmissionInternalType = GetComponentTypeHandle<BurstEmissionInternal>(),
+                EmitterInitialSpeedType = GetComponentTypeHandle<EmitterInitialSpeed>(true),
+                EmitterInitialScaleType = GetComponentTypeHandle<EmitterInitialScale>(true),
+                EmitterInitialNonUniformScaleType = GetComponentTypeHandle<EmitterInitialNonUniformScale>(true),
+                EmitterInitialRotationType = GetComponentTypeHandle<EmitterInitialRotation>(true),
+                EmitterInitialNonUniformRotationType = GetComponentTypeHandle<EmitterInitialNonUniformRotation>(true),
+                InitialColorType = GetComponentTypeHandle<InitialColor>(true),
+                RandomizePositionType = GetComponentTypeHandle<RandomizePosition>(true),
+                RandomizeDirectionType = GetComponentTypeHandle<RandomizeDirection>(true),
+                LocalToWorldType = GetComponentTypeHandle<LocalToWorld>(true),
+                EmitterRectangleSourceType = GetComponentTypeHandle<EmitterRectangleSource>(true),
+                EmitterCircleSourceType = GetComponentTypeHandle<EmitterCircleSource>(true),
+                EmitterConeSourceType = GetComponentTypeHandle<EmitterConeSource>(true),
+                EmitterSphereSourceType = GetComponentTypeHandle<EmitterSphereSource>(true),
+                EmitterHemisphereSourceType = GetComponentTypeHandle<EmitterHemisphereSource>(true),
+                ParticleMaterialType = GetComponentTypeHandle<ParticleMaterial>(true),
+                ComponentLitMaterial = GetComponentDataFromEntity<LitMaterial>(true),
+                ComponentSimpleMaterial = GetComponentDataFromEntity<SimpleMaterial>(true),
+                BufferParticleInstance = GetBufferFromEntity<ParticleInstance>(),
+                DeltaTime = Time.DeltaTime
+            };
+
+            Dependency = spawnJob.ScheduleParallel(m_query, Dependency);
         }
     }
 
     /// <summary>
     ///  System that updates all particles
     /// </summary>
+    /// <remarks>
+    /// Emitters only touch their own particles and are simulated in parallel. Lifetime modules
+    /// (<see cref="LifetimeColor"/>, <see cref="LifetimeScale"/>, <see cref="LifetimeVelocity"/>,
+    /// <see cref="LifetimeSpeedMultiplier"/> and <see cref="LifetimeAngularVelocity"/>) are
+    /// evaluated from their sampled curves.
+    /// </remarks>
     [UpdateInGroup(typeof(SimulationSystemGroup))]
     [UpdateAfter(typeof(EmitterSystem))]
     [UpdateAfter(typeof(ParticleSpawnSystem))]
     public class ParticleSystem : SystemBase
     {
-        private static void UpdateParticleLife(DynamicBuffer<Particle> particles, float deltaTime, ref ParticleEmitterInternal emitterInternal)
+        [BurstCompile]
+        struct UpdateParticlesJob : IJobChunk
         {
-            // Reset particle counter for this emitter
-            emitterInternal.numParticles = 0;
-            uint numParticles = 0;
-            for (var i = particles.Length - 1; i >= 0; i--)
+            public ComponentTypeHandle<ParticleEmitterInternal> ParticleEmitterInternalType;
+            public BufferTypeHandle<DynamicParticle> DynamicParticleType;
+            [ReadOnly] public ComponentTypeHandle<LifetimeColor> LifetimeColorType;
+            [ReadOnly] public ComponentTypeHandle<LifetimeScale> LifetimeScaleType;
+            [ReadOnly] public ComponentTypeHandle<LifetimeVelocity> LifetimeVelocityType;
+            [ReadOnly] public ComponentTypeHandle<LifetimeSpeedMultiplier> LifetimeSpeedMultiplierType;
+            [ReadOnly] public ComponentTypeHandle<LifetimeAngularVelocity> LifetimeAngularVelocityType;
+            public float DeltaTime;
+
+            public void Execute(ArchetypeChunk chunk, int chunkIndex, int firstEntityIndex)
             {
-                var particle = particles[i];
-                particle.time += deltaTime;
-                if (particle.time >= particle.lifetime)
-                {
-                    particles.RemoveAt(i);
-                }
-                else
+                var chunkEmitterInternal = chunk.GetNativeArray(ParticleEmitterInternalType);
+                var chunkParticles = chunk.GetBufferAccessor(DynamicParticleType);
+                bool hasColor = chunk.Has(LifetimeColorType);
+                bool hasScale = chunk.Has(LifetimeScaleType);
+                bool hasVelocity = chunk.Has(LifetimeVelocityType);
+                bool hasSpeed = chunk.Has(LifetimeSpeedMultiplierType);
+                bool hasAngularVelocity = chunk.Has(LifetimeAngularVelocityType);
+                bool hasLifetimeModules = hasColor || hasScale || hasVelocity || hasSpeed || hasAngularVelocity;
+
+                for (int i = 0; i < chunk.Count; i++)
                 {
-                    numParticles++;
-                    particles[i] = particle;
+                    var particles = chunkParticles[i].Reinterpret<Particle>();
+                    var emitterInternal = chunkEmitterInternal[i];
+                    UpdateParticleLife(particles, DeltaTime, ref emitterInternal);
+                    chunkEmitterInternal[i] = emitterInternal;
+
+                    if (!hasLifetimeModules)
+                    {
+                        UpdateParticlePosition(particles, DeltaTime);
+                        continue;
+                    }
+
+                    var curves = new LifetimeCurves
+                    {
+                        color = hasColor ? chunk.GetNativeArray(LifetimeColorType)[i].Curve : default,
+                        scale = hasScale ? chunk.GetNativeArray(LifetimeScaleType)[i].Curve : default,
+                        velocity = hasVelocity ? chunk.GetNativeArray(LifetimeVelocityType)[i].Curve : default,
+                        speed = hasSpeed ? chunk.GetNativeArray(LifetimeSpeedMultiplierType)[i].Curve : default,
+                        angularVelocity = hasAngularVelocity ? chunk.GetNativeArray(LifetimeAngularVelocityType)[i].Curve : default
+                    };
+                    UpdateParticleLifetimeModules(particles, DeltaTime, curves);
                 }
             }
+        }
 
-            emitterInternal.numParticles = numParticles;
+        struct LifetimeCurves
+        {
+            internal BlobAssetReference<LifetimeCurve> color;
+            internal BlobAssetReference<LifetimeCurve> scale;
+            internal BlobAssetReference<LifetimeCurve> velocity;
+            internal BlobAssetReference<LifetimeCurve> speed;
+            internal BlobAssetReference<LifetimeCurve> angularVelocity;
         }
 
-        private static void UpdateParticlePosition(DynamicBuffer<Particle> particles, float deltaTime)
+        private static void UpdateParticleLife(DynamicBuffer<Particle> particles, float deltaTime, ref ParticleEmitterInternal emitterInternal)
         {
+            // Compact living particles to the front in one pass, keeps their order
+            int numParticles = 0;
             for (var i = 0; i < particles.Length; i++)
             {
                 var particle = particles[i];
-#if false
-                bool hasLifetimeVelocity = mgr.HasComponent<LifetimeVelocity>(emitterReference.emitter);
-                bool hasLifetimeSpeed = mgr.HasComponent<LifetimeSpeedMultiplier>(emitterReference.emitter);
-                float normalizedLife = cParticle.time / cParticle.lifetime;
-
-                if (hasLifetimeVelocity && hasLifetimeSpeed)
-                {
-                    var lifetimeVel = mgr.GetComponentData<LifetimeVelocity>(emitterReference.emitter);
-                    var lifetimeSpeed = mgr.GetComponentData<LifetimeSpeedMultiplier>(emitterReference.emitter);
-
-                    var velocity = InterpolationService.EvaluateCurveFloat3(mgr, normalizedLife, lifetimeVel.curve);
-                    var speed = InterpolationService.EvaluateCurveFloat(mgr, normalizedLife, lifetimeSpeed.curve);
-
-                    cLocalPos.Value += (cVelocity.velocity + velocity) * speed * deltaTime;
-                }
-                else if (hasLifetimeVelocity)
-                {
-                    var lifetimeVel = mgr.GetComponentData<LifetimeVelocity>(emitterReference.emitter);
+                particle.time += deltaTime;
+                if (particle.time < particle.lifetime)
+                    particles[numParticles++] = particle;
+            }
+            particles.ResizeUninitialized(numParticles);
 
-                    var velocity = InterpolationService.EvaluateCurveFloat3(mgr, normalizedLife, lifetimeVel.curve);
-                    cLocalPos.Value += (cVelocity.velocity + velocity) * deltaTime;
-                }
-                else if (hasLifetimeSpeed)
-                {
-                    var lifetimeSpeed = mgr.GetComponentData<LifetimeSpeedMultiplier>(emitterReference.emitter);
+            emitterInternal.numParticles = (uint)numParticles;
+        }
 
-                    var speed = InterpolationService.EvaluateCurveFloat(mgr, normalizedLife, lifetimeSpeed.curve);
-                    cLocalPos.Value += cVelocity.velocity * speed * deltaTime;
-                }
-                else
-#endif
-                {
-                    particle.position += particle.velocity * deltaTime;
-                }
+        private static void UpdateParticlePosition(DynamicBuffer<Particle> particles, float deltaTime)
+        {
+            for (var i = 0; i < particles.Length; i++)
+            {
+                var particle = particles[i];
+                particle.position += particle.velocity * deltaTime;
                 particles[i] = particle;
             }
         }
 
-#if false
-        private void UpdateParticleScale(EntityManager mgr, EntityCommandBuffer ecb, ParticleEmitterReference emitterReference, float deltaTime)
+        private static void UpdateParticleLifetimeModules(DynamicBuffer<Particle> particles, float deltaTime, LifetimeCurves curves)
         {
-            Entities.WithSharedComponentFilter(emitterReference).ForEach((ref Particle cParticle, ref ParticleLifetimeScale cLifetimeScale, ref NonUniformScale cLocalScale) =>
+            for (var i = 0; i < particles.Length; i++)
             {
-                if (!mgr.HasComponent<LifetimeScale>(emitterReference.emitter))
-                    return;
-
-                var lifetimeScale = mgr.GetComponentData<LifetimeScale>(emitterReference.emitter);
+                var particle = particles[i];
+                float normalizedLife = particle.lifetime > 0.0f ? particle.time / particle.lifetime : 1.0f;
 
-                float normalizedLife = cParticle.time / cParticle.lifetime;
+                float3 velocity = particle.velocity;
+                if (curves.velocity.IsCreated)
+                    velocity += curves.velocity.Value.Evaluate(normalizedLife).xyz;
+                if (curves.speed.IsCreated)
+                    velocity *= curves.speed.Value.Evaluate(normalizedLife).x;
+                particle.position += velocity * deltaTime;
 
-                var scale = InterpolationService.EvaluateCurveFloat(mgr, normalizedLife, lifetimeScale.curve);
-                cLocalScale.Value = cLifetimeScale.initialScale * scale;
-            }).Run();
-        }
-
-        private void UpdateParticleColor(EntityManager mgr, EntityCommandBuffer ecb, ParticleEmitterReference emitterReference, float deltaTime)
-        {
-            Entities.WithSharedComponentFilter(emitterReference).ForEach((ref Particle cParticle, ref SpriteRenderer cRenderer, ref ParticleLifetimeColor cLifetimeColor) =>
-            {
-                if (!mgr.HasComponent<LifetimeColor>(emitterReference.emitter))
-                    return;
+                if (curves.angularVelocity.IsCreated)
+                {
+                    float angle = curves.angularVelocity.Value.Evaluate(normalizedLife).x * deltaTime;
+                    particle.rotation = math.mul(particle.rotation, quaternion.RotateZ(angle));
+                }
 
-                var lifetimeColor = mgr.GetComponentData<LifetimeColor>(emitterReference.emitter);
+                if (curves.scale.IsCreated)
+                    particle.scale = particle.initialScale * curves.scale.Value.Evaluate(normalizedLife).xyz;
 
-                float normalizedLife = cParticle.time / cParticle.lifetime;
+                if (curves.color.IsCreated)
+                    particle.color = particle.initialColor * curves.color.Value.Evaluate(normalizedLife);
 
-                var color = InterpolationService.EvaluateCurveColor(mgr, normalizedLife, lifetimeColor.curve);
-                cRenderer.Color = cLifetimeColor.initialColor * color;
-            }).Run();
+                particles[i] = particle;
+            }
         }
 
-        private void UpdateParticleRotation(EntityManager mgr, EntityCommandBuffer ecb, ParticleEmitterReference emitterReference, float deltaTime)
-        {
-            Entities.WithSharedComponentFilter(emitterReference).ForEach(
-                (ref Particle cParticle, ref Rotation cLocalRotation, ref ParticleAngularVelocity cAngularVelocity) =>
-                {
-                    if (mgr.HasComponent<LifetimeAngularVelocity>(emitterReference.emitter))
-                    {
-                        var lifetime = mgr.GetComponentData<LifetimeAngularVelocity>(emitterReference.emitter);
+        EntityQuery m_query;
 
-                        float normalizedLife = cParticle.time / cParticle.lifetime;
-
-                        var angularVelocity = InterpolationService.EvaluateCurveFloat(mgr, normalizedLife, lifetime.curve);
-                        float angle = (cAngularVelocity.angularVelocity + angularVelocity) * deltaTime;
-                        cLocalRotation.Value = math.mul(cLocalRotation.Value, quaternion.Euler(0, 0, angle));
-                    }
-                    else
-                    {
-                        float angle = cAngularVelocity.angularVelocity * deltaTime;
-                        cLocalRotation.Value = math.mul(cLocalRotation.Value, quaternion.Euler(0, 0, angle));
-                    }
-                }).Run();
+        protected override void OnCreate()
+        {
+            m_query = GetEntityQuery(
+                ComponentType.ReadOnly<ParticleEmitter>(),
+                typeof(ParticleEmitterInternal),
+                typeof(DynamicParticle)
+            );
         }
 
-#endif
         protected override void OnUpdate()
         {
-            BufferFromEntity<DynamicParticle> BufferDynamicParticle = GetBufferFromEntity<DynamicParticle>();
-            float deltaTime = Time.DeltaTime;
-            Entities.ForEach((Entity e, ref ParticleEmitterInternal emitterInternal, in ParticleEmitter emitter) =>
+            var updateJob = new UpdateParticlesJob
             {
-                var particles = BufferDynamicParticle[e].Reinterpret<Particle>();
-                UpdateParticleLife(particles, deltaTime, ref emitterInternal);
-                UpdateParticlePosition(particles, deltaTime);
-#if false
-                UpdateParticleRotation(EntityManager, emitterReference, deltaTime);
-                UpdateParticleScale(EntityManager, emitterReference, deltaTime);
-                UpdateParticleColor(EntityManager, emitterReference, deltaTime);
-#endif
-            }).Run();
+                ParticleEmitterInternalType = GetComponentTypeHandle<ParticleEmitterInternal>(),
+                DynamicParticleType = GetBufferTypeHandle<DynamicParticle>(),
+                LifetimeColorType = GetComponentTypeHandle<LifetimeColor>(true),
+                LifetimeScaleType = GetComponentTypeHandle<LifetimeScale>(true),
+                LifetimeVelocityType = GetComponentTypeHandle<LifetimeVelocity>(true),
+                LifetimeSpeedMultiplierType = GetComponentTypeHandle<LifetimeSpeedMultiplier>(true),
+                LifetimeAngularVelocityType = GetComponentTypeHandle<LifetimeAngularVelocity>(true),
+                DeltaTime = Time.DeltaTime
+            };
+
+            Dependency = updateJob.ScheduleParallel(m_query, Dependency);
         }
     }
 }
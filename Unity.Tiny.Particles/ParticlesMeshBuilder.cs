@@ -7,10 +7,11 @@ using Unity.Transforms;
 namespace Unity.Tiny.Particles
 {
     /// <summary>
-    /// A system that builds the vertex and index buffers for particles by aggregating all the particles from an emitter
+    /// A system that writes the instance data for particles, one ParticleInstance per living particle of an emitter
     /// </summary>
     /// <remarks>
-    /// Buffers will be written every frame unless the emitter does not have any living particles
+    /// Instances and bounds are written every frame unless the emitter does not have any living particles.
+    /// Renderers are filled in parallel, the renderer draws the particle mesh once per instance.
     /// </remarks>
     [UpdateInGroup(typeof(PresentationSystemGroup))]
     [UpdateBefore(typeof(UpdateWorldBoundsSystem))]
@@ -43,9 +44,9 @@ namespace Unity.Tiny.Particles
                 if (!ParticlesUtil.EmitterIsValid(EntityManager, eEmitter))
                     continue;
 
-                DynamicBuffer<Particle> particles = EntityManager.GetBuffer<DynamicParticle>(eEmitter).Reinterpret<Particle>();
+                int numParticles = EntityManager.GetBuffer<DynamicParticle>(eEmitter).Length;
 
-                if (!EntityManager.GetEnabled(eEmitter) || particles.Length == 0)
+                if (!EntityManager.GetEnabled(eEmitter) || numParticles == 0)
                 {
                     if (!EntityManager.HasComponent<Disabled>(renderer))
                         ecb.AddComponent(renderer, new Disabled());
@@ -55,116 +56,56 @@ namespace Unity.Tiny.Particles
 
                 if (EntityManager.HasComponent<Disabled>(renderer))
                     ecb.RemoveComponent<Disabled>(renderer);
+            }
 
-                var particleMesh = EntityManager.GetComponentData<ParticleMesh>(eEmitter);
-                var meshRenderer = EntityManager.GetComponentData<MeshRenderer>(renderer);
-                Entity eMesh = meshRenderer.mesh;
-                var particleEmitter = EntityManager.GetComponentData<ParticleEmitter>(eEmitter);
-                var localToWorldEmitter = particleEmitter.AttachToEmitter ? EntityManager.GetComponentData<LocalToWorld>(eEmitter).Value : float4x4.identity;
-                MinMaxAABB minMaxAABB = MinMaxAABB.Empty;
-                int numVertices, numIndices;
-                if (EntityManager.HasComponent<LitParticleRenderer>(renderer))
+            ecb.Playback(EntityManager);
+            ecb.Dispose();
+            renderers.Dispose();
+
+            var particlesFromEntity = GetBufferFromEntity<DynamicParticle>(true);
+            var emitterFromEntity = GetComponentDataFromEntity<ParticleEmitter>(true);
+            var localToWorldFromEntity = GetComponentDataFromEntity<LocalToWorld>(true);
+            var meshBoundsFromEntity = GetComponentDataFromEntity<MeshBounds>(true);
+            Entities
+                .WithReadOnly(particlesFromEntity)
+                .WithReadOnly(emitterFromEntity)
+                .WithReadOnly(localToWorldFromEntity)
+                .WithReadOnly(meshBoundsFromEntity)
+                .ForEach((DynamicBuffer<ParticleInstance> instances, ref ObjectBounds objectBounds, in MeshRenderer meshRenderer, in EmitterReferenceForRenderer emitterReference) =>
+            {
+                var eEmitter = emitterReference.emitter;
+                if (!particlesFromEntity.HasComponent(eEmitter) || !emitterFromEntity.HasComponent(eEmitter))
                 {
-                    ref LitMeshData lmd = ref EntityManager.GetComponentData<LitMeshRenderData>(particleMesh.Mesh).Mesh.Value;
-                    int numVertsPerParticle = lmd.Vertices.Length;
-                    int numIndicesPerParticle = lmd.Indices.Length;
-                    NativeArray<LitVertex> particleVertices = MeshHelper.AsNativeArray(ref lmd.Vertices);
-                    NativeArray<ushort> particleIndices = MeshHelper.AsNativeArray(ref lmd.Indices);
-                    var vBuffer = EntityManager.GetBuffer<DynamicLitVertex>(eMesh);
-                    var iBuffer = EntityManager.GetBuffer<DynamicIndex>(eMesh);
-                    numVertices = particles.Length * numVertsPerParticle;
-                    numIndices = particles.Length * numIndicesPerParticle;
-                    vBuffer.ResizeUninitialized(numVertices); // Grow buffers as needed
-                    iBuffer.ResizeUninitialized(numIndices);
-                    NativeArray<LitVertex> vertices = vBuffer.AsNativeArray().Reinterpret<DynamicLitVertex, LitVertex>();
-                    NativeArray<ushort> indices = iBuffer.AsNativeArray().Reinterpret<DynamicIndex, ushort>();
-                    bool billboarded = EntityManager.GetComponentData<LitMaterial>(meshRenderer.material).billboarded;
+                    instances.Clear();
+                    return;
+                }
 
-                    for (int particleIndex = 0; particleIndex < particles.Length; particleIndex++)
-                    {
-                        float4x4 localToWorld = GetParticleLocalToWorld(particles[particleIndex], localToWorldEmitter);
-                        float3x3 localToWorldRS = new float3x3(localToWorld.c0.xyz, localToWorld.c1.xyz, localToWorld.c2.xyz);
-                        float3x3 modelInverseTransposeRS = math.transpose(math.inverse(localToWorldRS));
-                        float4x4 modelInverseTranspose = new float4x4(modelInverseTransposeRS, float3.zero);
+                var particles = particlesFromEntity[eEmitter].Reinterpret<Particle>();
+                var particleEmitter = emitterFromEntity[eEmitter];
+                var localToWorldEmitter = particleEmitter.AttachToEmitter && localToWorldFromEntity.HasComponent(eEmitter) ? localToWorldFromEntity[eEmitter].Value : float4x4.identity;
 
-                        // Postpone translate until after additional rotation for billboarding is applied in shader
-                        float4x4 model = billboarded ? new float4x4(localToWorldRS, float3.zero) : localToWorld;
+                // Sphere around the mesh, it holds the mesh under any particle rotation and under billboarding
+                AABB meshBounds = meshBoundsFromEntity.HasComponent(meshRenderer.mesh) ? meshBoundsFromEntity[meshRenderer.mesh].Bounds : new AABB { Extents = new float3(0.5f) };
+                float meshRadius = math.length(math.abs(meshBounds.Center) + meshBounds.Extents);
 
-                        int vertexOffset = particleIndex * numVertsPerParticle;
-                        for (int i = 0; i < numVertsPerParticle; i++)
-                        {
-                            LitVertex vertex = particleVertices[i];
-                            vertex.Position = math.transform(model, vertex.Position);
-                            vertex.Normal = math.transform(modelInverseTranspose, vertex.Normal);
-                            vertex.Tangent = math.transform(modelInverseTranspose, vertex.Tangent);
-                            vertex.BillboardPos = billboarded ? localToWorld.c3.xyz : float3.zero;
-                            vertex.Albedo_Opacity = particles[particleIndex].color;
-                            vertices[vertexOffset + i] = vertex;
-                            minMaxAABB.Encapsulate(vertex.Position + vertex.BillboardPos);
-                        }
-                        UpdateIndicesForParticle(indices, particleIndices, particleIndex, numIndicesPerParticle, vertexOffset);
-                    }
-                }
-                else
+                instances.ResizeUninitialized(particles.Length); // Grow buffer as needed
+                MinMaxAABB minMaxAABB = MinMaxAABB.Empty;
+                for (int particleIndex = 0; particleIndex < particles.Length; particleIndex++)
                 {
-                    ref SimpleMeshData smd = ref EntityManager.GetComponentData<SimpleMeshRenderData>(particleMesh.Mesh).Mesh.Value;
-                    int numVertsPerParticle = smd.Vertices.Length;
-                    int numIndicesPerParticle = smd.Indices.Length;
-                    var particleVertices = MeshHelper.AsNativeArray(ref smd.Vertices);
-                    var particleIndices = MeshHelper.AsNativeArray(ref smd.Indices);
-                    var vBuffer = EntityManager.GetBuffer<DynamicSimpleVertex>(eMesh);
-                    var iBuffer = EntityManager.GetBuffer<DynamicIndex>(eMesh);
-                    numVertices = particles.Length * numVertsPerParticle;
-                    numIndices = particles.Length * numIndicesPerParticle;
-                    vBuffer.ResizeUninitialized(numVertices); // Grow buffers as needed
-                    iBuffer.ResizeUninitialized(numIndices);
-                    var vertices = vBuffer.AsNativeArray().Reinterpret<DynamicSimpleVertex, SimpleVertex>();
-                    var indices = iBuffer.AsNativeArray().Reinterpret<DynamicIndex, ushort>();
-                    bool billboarded = EntityManager.GetComponentData<SimpleMaterial>(meshRenderer.material).billboarded;
-
-                    for (int particleIndex = 0; particleIndex < particles.Length; particleIndex++)
+                    var particle = particles[particleIndex];
+                    float3 position = math.transform(localToWorldEmitter, particle.position);
+                    instances[particleIndex] = new ParticleInstance
                     {
-                        float4x4 localToWorld = GetParticleLocalToWorld(particles[particleIndex], localToWorldEmitter);
-                        float3x3 localToWorldRS = new float3x3(localToWorld.c0.xyz, localToWorld.c1.xyz, localToWorld.c2.xyz);
-
-                        // Postpone translate until after additional rotation for billboarding is applied in shader
-                        float4x4 model = billboarded ? new float4x4(localToWorldRS, float3.zero) : localToWorld;
-
-                        int vertexOffset = particleIndex * numVertsPerParticle;
-                        for (int i = 0; i < numVertsPerParticle; i++)
-                        {
-                            SimpleVertex vertex = particleVertices[i];
-                            vertex.Position = math.transform(model, vertex.Position);
-                            vertex.Color = particles[particleIndex].color;
-                            vertex.BillboardPos = billboarded ? localToWorld.c3.xyz : float3.zero;
-                            vertices[vertexOffset + i] = vertex;
-                            minMaxAABB.Encapsulate(vertex.Position + vertex.BillboardPos);
-                        }
-                        UpdateIndicesForParticle(indices, particleIndices, particleIndex, numIndicesPerParticle, vertexOffset);
-                    }
+                        localToWorld = float4x4.TRS(position, particle.rotation, particle.scale),
+                        color = particle.color
+                    };
+                    float radius = meshRadius * math.cmax(math.abs(particle.scale));
+                    minMaxAABB.Encapsulate(position - radius);
+                    minMaxAABB.Encapsulate(position + radius);
                 }
 
-                MeshBounds mb;
-                mb.Bounds = minMaxAABB;
-                EntityManager.SetComponentData(eMesh, mb);
-            }
-
-            ecb.Playback(EntityManager);
-            ecb.Dispose();
-            renderers.Dispose();
-        }
-
-        static float4x4  GetParticleLocalToWorld(Particle particle, float4x4 localToWorldEmitter)
-        {
-            particle.position = math.transform(localToWorldEmitter, particle.position);
-            return float4x4.TRS(particle.position, particle.rotation, particle.scale);
-        }
-
-        static void UpdateIndicesForParticle(NativeArray<ushort> indices, NativeArray<ushort> particleIndices, int particleIndex, int numIndicesPerParticle, int vertexOffset)
-        {
-            int indexOffset = particleIndex * numIndicesPerParticle;
-            for (int i = 0; i < numIndicesPerParticle; i++)
-                indices[indexOffset + i] = (ushort)(particleIndices[i] + vertexOffset);
+                objectBounds.Bounds = minMaxAABB;
+            }).ScheduleParallel();
         }
     }
 }
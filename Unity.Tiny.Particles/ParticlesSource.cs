@@ -1,32 +1,41 @@
 using Unity.Entities;
 using Unity.Collections;
 using Unity.Mathematics;
-using Unity.Tiny.Rendering;
 
 namespace Unity.Tiny.Particles
 {
     static class ParticlesSource
     {
-        internal static void InitEmitterCircleSource(EntityManager mgr, Entity emitter, DynamicBuffer<Particle> particles, int offset, Range speed, float randomizePos, float randomizeDir, float4x4 matrix, ref Random rand)
+        /// <summary>
+        /// Initial rotation components of an emitter, looked up once per spawn
+        /// </summary>
+        internal struct RotationSettings
+        {
+            internal bool uniform;
+            internal Range angle;
+            internal bool billboarded;
+
+            internal bool nonUniform;
+            internal EmitterInitialNonUniformRotation nonUniformAngle;
+        }
+
+        internal static void InitEmitterCircleSource(DynamicBuffer<Particle> particles, int offset, float radius, Range speed, float randomizePos, float randomizeDir, float4x4 matrix, RotationSettings rotation, ref Random rand)
         {
-            var radius = mgr.GetComponentData<EmitterCircleSource>(emitter).Radius;
             for (var i = offset; i < particles.Length; i++)
             {
                 var particle = particles[i];
                 float randomAngle = rand.NextFloat((float)-math.PI, (float)math.PI);
                 float radiusNormalized = math.sqrt(rand.Random01());
-                radius *= radiusNormalized;
                 var positionNormalized = new float3(math.sin(randomAngle), math.cos(randomAngle), 0.0f);
-                particle.position = GetParticlePosition(positionNormalized * radius, randomizePos, matrix, ref rand);
+                particle.position = GetParticlePosition(positionNormalized * radius * radiusNormalized, randomizePos, matrix, ref rand);
                 particle.velocity = GetParticleVelocity(ref positionNormalized, speed, randomizeDir, matrix, ref rand);
-                particle.rotation = GetParticleRotation(mgr, emitter, positionNormalized, ref rand);
+                particle.rotation = GetParticleRotation(rotation, positionNormalized, ref rand);
                 particles[i] = particle;
             }
         }
 
-        internal static void InitEmitterConeSource(EntityManager mgr, Entity emitter, DynamicBuffer<Particle> particles, int offset, Range speed, float randomizePos, float randomizeDir, float4x4 matrix, ref Random rand)
+        internal static void InitEmitterConeSource(DynamicBuffer<Particle> particles, int offset, EmitterConeSource source, Range speed, float randomizePos, float randomizeDir, float4x4 matrix, RotationSettings rotation, ref Random rand)
         {
-            var source = mgr.GetComponentData<EmitterConeSource>(emitter);
             source.Angle = math.clamp(source.Angle, 0.0f, 90.0f);
             float coneAngle = math.radians(source.Angle);
             for (var i = offset; i < particles.Length; i++)
@@ -44,12 +53,12 @@ namespace Unity.Tiny.Particles
                 float directionHeight = math.cos(coneAngle);
                 float3 direction = new float3(localPositionOnConeBase.x * directionRadius, localPositionOnConeBase.y * directionRadius, directionHeight);
                 particle.velocity = GetParticleVelocity(ref direction, speed, randomizeDir, matrix, ref rand);
-                particle.rotation = GetParticleRotation(mgr, emitter, direction, ref rand);
+                particle.rotation = GetParticleRotation(rotation, direction, ref rand);
                 particles[i] = particle;
             }
         }
 
-        internal static void InitEmitterSphereSource(EntityManager mgr, Entity emitter, DynamicBuffer<Particle> particles, int offset, float radius, bool hemisphere, Range speed, float randomizePos, float randomizeDir, float4x4 matrix, ref Random rand)
+        internal static void InitEmitterSphereSource(DynamicBuffer<Particle> particles, int offset, float radius, bool hemisphere, Range speed, float randomizePos, float randomizeDir, float4x4 matrix, RotationSettings rotation, ref Random rand)
         {
             for (var i = offset; i < particles.Length; i++)
             {
@@ -65,12 +74,12 @@ namespace Unity.Tiny.Particles
 
                 particle.position = GetParticlePosition(position, randomizePos, matrix, ref rand);
                 particle.velocity = GetParticleVelocity(ref positionOnUnitSphere, speed, randomizeDir, matrix, ref rand);
-                particle.rotation = GetParticleRotation(mgr, emitter, positionOnUnitSphere, ref rand);
+                particle.rotation = GetParticleRotation(rotation, positionOnUnitSphere, ref rand);
                 particles[i] = particle;
             }
         }
 
-        internal static void InitEmitterRectangleSource(EntityManager mgr, Entity emitter, DynamicBuffer<Particle> particles, int offset, Range speed, float randomizePos, float randomizeDir, float4x4 matrix, ref Random rand)
+        internal static void InitEmitterRectangleSource(DynamicBuffer<Particle> particles, int offset, Range speed, float randomizePos, float randomizeDir, float4x4 matrix, RotationSettings rotation, ref Random rand)
         {
             // Unit rectangle centered at the origin
             float2 bottomLeft = new float2(-0.5f, -0.5f);
@@ -82,7 +91,7 @@ namespace Unity.Tiny.Particles
                 var position = new float3(rand.NextFloat2(bottomLeft, topRight), 0.0f);
                 particle.position = GetParticlePosition(position, randomizePos, matrix, ref rand);
                 particle.velocity = GetParticleVelocity(ref direction, speed, randomizeDir, matrix, ref rand);
-                particle.rotation = GetParticleRotation(mgr, emitter, direction, ref rand);
+                particle.rotation = GetParticleRotation(rotation, direction, ref rand);
                 particles[i] = particle;
             }
         }
@@ -112,16 +121,12 @@ namespace Unity.Tiny.Particles
 
         }
 
-        private static quaternion GetParticleRotation(EntityManager mgr, Entity emitter, float3 direction, ref Random rand)
+        private static quaternion GetParticleRotation(RotationSettings settings, float3 direction, ref Random rand)
         {
-            if (mgr.HasComponent<EmitterInitialRotation>(emitter))
+            if (settings.uniform)
             {
-                var initialRotation = mgr.GetComponentData<EmitterInitialRotation>(emitter);
-                float rotation = rand.RandomRange(initialRotation.Angle);
-
-                var material = mgr.GetComponentData<ParticleMaterial>(emitter).Material;
-                bool billboarded = mgr.HasComponent<LitMaterial>(material) ? mgr.GetComponentData<LitMaterial>(material).billboarded : mgr.GetComponentData<SimpleMaterial>(material).billboarded;
-                if (billboarded)
+                float rotation = rand.RandomRange(settings.angle);
+                if (settings.billboarded)
                 {
                     return quaternion.RotateZ(rotation);
                 }
@@ -132,9 +137,9 @@ namespace Unity.Tiny.Particles
                 axis = math.dot(axis, axis) <= 0.01f ? new float3(0, 1, 0) : math.normalize(axis);
                 return quaternion.AxisAngle(axis, rotation);
             }
-            if (mgr.HasComponent<EmitterInitialNonUniformRotation>(emitter))
+            if (settings.nonUniform)
             {
-                var initialRotation = mgr.GetComponentData<EmitterInitialNonUniformRotation>(emitter);
+                var initialRotation = settings.nonUniformAngle;
                 return quaternion.Euler(
                     rand.RandomRange(initialRotation.AngleX),
                     rand.RandomRange(initialRotation.AngleY),
@@ -30,14 +30,5 @@ namespace Unity.Tiny.Particles
         {
             return burstEmission.Cycles == kBurstCycleInfinitely || burstEmissionInternal.cycle < burstEmission.Cycles;
         }
-        internal static bool ActiveBurstEmitter(EntityManager mgr, Entity emitter)
-        {
-            if (mgr.HasComponent<BurstEmissionInternal>(emitter) && mgr.HasComponent<BurstEmission>(emitter))
-            {
-                return ActiveBurstEmitter(mgr.GetComponentData<BurstEmission>(emitter), mgr.GetComponentData<BurstEmissionInternal>(emitter));
-            }
-
-            return false;
-        }
     }
 }
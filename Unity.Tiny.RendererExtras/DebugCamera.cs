@@ -276,7 +276,7 @@ namespace Unity.Tiny.Rendering
                 rendererInstance->m_outputDebugSelect = new float4(0, 0, 0, 1);
             if (input.GetKeyDown(KeyCode.Z))
             {
-                renderer.RequestScreenShot(FixedString.Format("screenshot{0}.tga", m_nshots++).ToString());
+                renderer.RequestScreenShot(FixedString.Format("screenshot{0}.png", m_nshots++).ToString());
             }
             if (input.GetKeyDown(KeyCode.Escape))
             {
@@ -290,8 +290,8 @@ namespace Unity.Tiny.Rendering
             }
             if (renderer.HasScreenShot())
             {
-                // TODO: save out 32bpp pixel data:
-                Debug.LogFormat("Write screen shot to disk: {0}, {1}*{2}",
+                // .png screen shots are written to disk by the renderer
+                Debug.LogFormat("Screen shot written to disk: {0}, {1}*{2}",
                     renderer.m_screenShotPath, renderer.m_screenShotWidth, renderer.m_screenShotHeight);
                 renderer.ResetScreenShot();
             }
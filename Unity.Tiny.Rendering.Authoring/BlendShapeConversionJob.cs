@@ -31,18 +31,6 @@ namespace Unity.TinyConversion
             BlobAssets = blobArray;
         }
 
-        public bool HasValueInBlendShapeVertex(NativeArray<Vector3> deltaValues)
-        {
-            int valuesCount = deltaValues.Length;
-            for (int i = 0; i < valuesCount; i++)
-            {
-                if (deltaValues[i] != Vector3.zero)
-                    return true;
-            }
-
-            return false;
-        }
-
         public void Execute()
         {
             BlobBuilder allocator = new BlobBuilder(Allocator.Temp);
@@ -56,10 +44,7 @@ namespace Unity.TinyConversion
                 int sizeOfVector3 = UnsafeUtility.SizeOf<Vector3>();
                 int totalVertexSize = MeshSettings.vertexCount * sizeOfVector3;
 
-                NativeArray<Vector3> deltaNormals = new NativeArray<Vector3>(MeshSettings.vertexCount, Allocator.Temp);
-                void* normalDestAddr = deltaNormals.GetUnsafePtr();
-                NativeArray<Vector3> deltaTangents = new NativeArray<Vector3>(MeshSettings.vertexCount, Allocator.Temp);
-                void* tangentDestAddr = deltaNormals.GetUnsafePtr();
+                NativeArray<int> touchedVertices = new NativeArray<int>(MeshSettings.vertexCount, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
 
                 for (int i = 0; i < Channels.Length; i++)
                 {
@@ -75,40 +60,53 @@ namespace Unity.TinyConversion
                         frame.Weight = Weights[weightsOffset];
                         weightsOffset++;
 
-                        BlobBuilderArray<BlendShapeVertexPosition> positionBuilder =
-                            allocator.Allocate(ref frame.VerticesPosition, MeshSettings.vertexCount);
-                        void* positionPtr = positionBuilder.GetUnsafePtr();
-                        UnsafeUtility.MemCpy(positionPtr, deltaValues + deltaValuesOffset, totalVertexSize);
-                        deltaValuesOffset += totalVertexSize;
+                        Vector3* deltaPositions = (Vector3*)(deltaValues + deltaValuesOffset);
+                        Vector3* deltaNormals = deltaPositions + MeshSettings.vertexCount;
+                        Vector3* deltaTangents = deltaNormals + MeshSettings.vertexCount;
+                        deltaValuesOffset += 3 * totalVertexSize;
 
-                        UnsafeUtility.MemCpy(normalDestAddr, deltaValues + deltaValuesOffset, totalVertexSize);
-                        deltaValuesOffset += totalVertexSize;
+                        // only vertices the frame moves are stored, the delta arrays run parallel to VertexIndices
+                        int touchedCount = 0;
+                        frame.HasNormals = false;
+                        frame.HasTangents = false;
+                        for (int v = 0; v < MeshSettings.vertexCount; v++)
+                        {
+                            bool hasNormal = deltaNormals[v] != Vector3.zero;
+                            bool hasTangent = deltaTangents[v] != Vector3.zero;
+                            frame.HasNormals |= hasNormal;
+                            frame.HasTangents |= hasTangent;
+                            if (hasNormal || hasTangent || deltaPositions[v] != Vector3.zero)
+                                touchedVertices[touchedCount++] = v;
+                        }
 
-                        UnsafeUtility.MemCpy(tangentDestAddr, deltaValues + deltaValuesOffset, totalVertexSize);
-                        deltaValuesOffset += totalVertexSize;
+                        BlobBuilderArray<int> indexBuilder = allocator.Allocate(ref frame.VertexIndices, touchedCount);
+                        BlobBuilderArray<BlendShapeVertexPosition> positionBuilder =
+                            allocator.Allocate(ref frame.VerticesPosition, touchedCount);
+                        for (int k = 0; k < touchedCount; k++)
+                        {
+                            indexBuilder[k] = touchedVertices[k];
+                            positionBuilder[k].DeltaPosition = deltaPositions[touchedVertices[k]];
+                        }
 
-                        frame.HasNormals = HasValueInBlendShapeVertex(deltaNormals);
-                        frame.HasTangents = HasValueInBlendShapeVertex(deltaTangents);
                         if (frame.HasNormals)
                         {
                             BlobBuilderArray<BlendShapeVertexNormal> normalBuilder =
-                                allocator.Allocate(ref frame.VerticesNormal, MeshSettings.vertexCount);
-                            void* normalPtr = normalBuilder.GetUnsafePtr();
-                            UnsafeUtility.MemCpy(normalPtr, normalDestAddr, totalVertexSize);
+                                allocator.Allocate(ref frame.VerticesNormal, touchedCount);
+                            for (int k = 0; k < touchedCount; k++)
+                                normalBuilder[k].DeltaNormal = deltaNormals[touchedVertices[k]];
                         }
 
                         if (frame.HasTangents)
                         {
                             BlobBuilderArray<BlendShapeVertexTangent> tangentBuilder =
-                                allocator.Allocate(ref frame.VerticesTangent, MeshSettings.vertexCount);
-                            void* tangentPtr = tangentBuilder.GetUnsafePtr();
-                            UnsafeUtility.MemCpy(tangentPtr, tangentDestAddr, totalVertexSize);
+                                allocator.Allocate(ref frame.VerticesTangent, touchedCount);
+                            for (int k = 0; k < touchedCount; k++)
+                                tangentBuilder[k].DeltaTangent = deltaTangents[touchedVertices[k]];
                         }
                     }
                 }
 
-                deltaNormals.Dispose();
-                deltaTangents.Dispose();
+                touchedVertices.Dispose();
             }
 
             BlobAssets[MeshSettings.blobIndex] = allocator.CreateBlobAssetReference<BlendShapeData>(Allocator.Persistent);
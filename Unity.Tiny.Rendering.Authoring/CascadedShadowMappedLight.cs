@@ -12,6 +12,8 @@ namespace Unity.Tiny.Authoring
     {
         public float3 cascadeScale = new float3(.5f, .15f, .020f);
         public GameObject mainCamera;
+        [Tooltip("Re-render the two far cascades only every this many frames. 0 or 1 updates them every frame.")]
+        public int farCascadeUpdateInterval = 1;
     }
 
     [WorldSystemFilter(WorldSystemFilterFlags.DotsRuntimeGameObjectConversion)]
@@ -33,6 +35,7 @@ namespace Unity.Tiny.Authoring
                 comp.cascadeScale = uLight.cascadeScale;
                 comp.cascadeBlendWidth = 0.0f;
                 comp.camera = entityCamera;
+                comp.farCascadeUpdateInterval = math.max(uLight.farCascadeUpdateInterval, 0);
                 var entity = GetPrimaryEntity(uLight);
                 DstEntityManager.AddComponentData(entity, comp);
 
@@ -42,6 +42,7 @@ namespace Unity.TinyConversion
         public NativeArray<Vector4> uBoneIndices;
         public NativeArray<Color> uColors;
         public NativeArray<ushort> uIndices;
+        public NativeArray<int2> uTriangleRanges;
 
         public unsafe void RetrieveSimpleMeshData(Mesh uMesh, int vertexCapacity = 0)
         {
@@ -67,6 +68,12 @@ namespace Unity.TinyConversion
                 indexCount += (int)uMesh.GetIndexCount(i);
             }
 
+            int skinDataCount = uMesh.boneWeights.Length;
+
+            //Skinning and blend shape data is per vertex in the original order, only reorder meshes without them
+            bool optimize = skinDataCount == 0 && uMesh.blendShapeCount == 0;
+            var triangleRanges = new List<int2>();
+
             int offset = 0;
             uIndices = new NativeArray<ushort>(indexCount, Allocator.TempJob);
             for (int i = 0; i < uMesh.subMeshCount; i++)
@@ -76,10 +83,15 @@ namespace Unity.TinyConversion
                 {
                     uIndices[offset + j] = Convert.ToUInt16(indices[j]);
                 }
+                if (optimize && uMesh.GetTopology(i) == MeshTopology.Triangles)
+                    triangleRanges.Add(new int2(offset, indices.Length));
                 offset += indices.Length;
             }
 
-            int skinDataCount = uMesh.boneWeights.Length;
+            uTriangleRanges = new NativeArray<int2>(triangleRanges.Count, Allocator.TempJob);
+            for (int i = 0; i < triangleRanges.Count; i++)
+                uTriangleRanges[i] = triangleRanges[i];
+
             if (skinDataCount > 0)
             {
                 uBoneWeights = new NativeArray<Vector4>(vertexCapacity, Allocator.TempJob);
@@ -396,7 +408,7 @@ namespace Unity.TinyConversion
 
     [UpdateInGroup(typeof(GameObjectConversionGroup))]
     [WorldSystemFilter(WorldSystemFilterFlags.DotsRuntimeGameObjectConversion)]
-    [ConverterVersion("WeixianLiu", 1)]
+    [ConverterVersion("WeixianLiu", 2)]
     public class MeshConversion : GameObjectConversionSystem
     {
         void CheckForMeshLimitations(Mesh uMesh)
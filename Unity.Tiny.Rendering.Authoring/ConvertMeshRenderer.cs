@@ -1,5 +1,6 @@
 using System;
 using System.Collections.Generic;
+using Unity.Collections;
 using Unity.Entities;
 using UnityEngine;
 using Unity.Tiny;
@@ -165,4 +166,66 @@ namespace Unity.TinyConversion
             });
         }
     }
+
+    // The levels of detail are generated with the mesh blob assets, copy those of each sub mesh next to its renderers
+    [UpdateInGroup(typeof(GameObjectConversionGroup))]
+    [UpdateAfter(typeof(MeshConversion))]
+    [WorldSystemFilter(WorldSystemFilterFlags.DotsRuntimeGameObjectConversion)]
+    public class MeshRendererLODConversion : GameObjectConversionSystem
+    {
+        static bool GetLevels(ref BlobArray<MeshLOD> lods, ref Unity.Tiny.Rendering.MeshRenderer meshRenderer, out MeshRendererLOD rendererLOD)
+        {
+            rendererLOD = default;
+            rendererLOD.mesh = meshRenderer.mesh;
+            rendererLOD.startIndex.x = meshRenderer.startIndex;
+            rendererLOD.indexCount.x = meshRenderer.indexCount;
+            bool found = false;
+            for (int i = 0; i < lods.Length; i++)
+            {
+                if (lods[i].SubMeshStartIndex != meshRenderer.startIndex || lods[i].Level >= MeshRendererLOD.kMaxLevels)
+                    continue;
+                rendererLOD.startIndex[lods[i].Level] = lods[i].StartIndex;
+                rendererLOD.indexCount[lods[i].Level] = lods[i].IndexCount;
+                rendererLOD.error[lods[i].Level] = lods[i].Error;
+                found = true;
+            }
+            return found;
+        }
+
+        protected override void OnUpdate()
+        {
+            var query = DstEntityManager.CreateEntityQuery(new EntityQueryDesc
+            {
+                All = new[] { ComponentType.ReadOnly<Unity.Tiny.Rendering.MeshRenderer>() },
+                None = new[] { ComponentType.ReadOnly<SimpleParticleRenderer>(), ComponentType.ReadOnly<LitParticleRenderer>() }
+            });
+            using (var renderers = query.ToEntityArray(Allocator.TempJob))
+            {
+                foreach (var e in renderers)
+                {
+                    var meshRenderer = DstEntityManager.GetComponentData<Unity.Tiny.Rendering.MeshRenderer>(e);
+                    var meshEntity = meshRenderer.mesh;
+                    MeshRendererLOD rendererLOD = default;
+                    bool found = false;
+                    if (DstEntityManager.HasComponent<LitMeshRenderData>(meshEntity))
+                    {
+                        if (!DstEntityManager.GetComponentData<LitMeshRenderData>(meshEntity).Mesh.IsCreated)
+                            continue;
+                        ref LitMeshData mesh = ref DstEntityManager.GetComponentData<LitMeshRenderData>(meshEntity).Mesh.Value;
+                        found = GetLevels(ref mesh.LODs, ref meshRenderer, out rendererLOD);
+                    }
+                    else if (DstEntityManager.HasComponent<SimpleMeshRenderData>(meshEntity))
+                    {
+                        if (!DstEntityManager.GetComponentData<SimpleMeshRenderData>(meshEntity).Mesh.IsCreated)
+                            continue;
+                        ref SimpleMeshData mesh = ref DstEntityManager.GetComponentData<SimpleMeshRenderData>(meshEntity).Mesh.Value;
+                        found = GetLevels(ref mesh.LODs, ref meshRenderer, out rendererLOD);
+                    }
+                    if (found)
+                        DstEntityManager.AddComponentData(e, rendererLOD);
+                }
+            }
+            query.Dispose();
+        }
+    }
 }
@@ -1,11 +1,14 @@
 using System;
 using UnityEngine;
+using Unity.Collections;
+using Unity.Collections.LowLevel.Unsafe;
 using Unity.Entities;
 using Unity.Mathematics;
 using Unity.Tiny.Rendering;
 using Unity.Transforms;
 using Unity.Entities.Runtime.Build;
 using Unity.Tiny.Particles;
+using Hash128 = Unity.Entities.Hash128;
 
 namespace Unity.TinyConversion
 {
@@ -97,6 +100,9 @@ namespace Unity.TinyConversion
                 DstEntityManager.AddComponentData(eParticleSystem, new RandomizeDirection { Value = uParticleSystem.shape.randomDirectionAmount });
                 DstEntityManager.AddComponentData(eParticleSystem, new RandomizePosition { Value = uParticleSystem.shape.randomPositionAmount });
 
+                // Lifetime settings
+                AddLifetimeModules(ref uParticleSystem, eParticleSystem);
+
                 // Renderer settings
                 ParticleSystemRenderer uParticleSystemRenderer = uParticleSystem.gameObject.GetComponent<ParticleSystemRenderer>();
                 DstEntityManager.AddComponentData(eParticleSystem, new ParticleMaterial { Material = GetPrimaryEntity(uParticleSystemRenderer.sharedMaterial) });
@@ -196,6 +202,111 @@ namespace Unity.TinyConversion
             }
         }
 
+        private void AddLifetimeModules(ref UnityEngine.ParticleSystem uParticleSystem, Entity eParticleSystem)
+        {
+            var colorOverLifetime = uParticleSystem.colorOverLifetime;
+            if (colorOverLifetime.enabled)
+            {
+                var color = colorOverLifetime.color;
+                WarnIfRandomBetweenTwo(color.mode == ParticleSystemGradientMode.TwoColors || color.mode == ParticleSystemGradientMode.TwoGradients || color.mode == ParticleSystemGradientMode.RandomColor, nameof(colorOverLifetime));
+                DstEntityManager.AddComponentData(eParticleSystem, new LifetimeColor
+                {
+                    Curve = SampleLifetimeCurve(t =>
+                    {
+                        var c = color.Evaluate(t, 0.5f);
+                        return new float4(c.r, c.g, c.b, c.a);
+                    })
+                });
+            }
+
+            var sizeOverLifetime = uParticleSystem.sizeOverLifetime;
+            if (sizeOverLifetime.enabled)
+            {
+                var x = sizeOverLifetime.separateAxes ? sizeOverLifetime.x : sizeOverLifetime.size;
+                var y = sizeOverLifetime.separateAxes ? sizeOverLifetime.y : sizeOverLifetime.size;
+                var z = sizeOverLifetime.separateAxes ? sizeOverLifetime.z : sizeOverLifetime.size;
+                WarnIfRandomBetweenTwo(IsRandomBetweenTwo(x) || IsRandomBetweenTwo(y) || IsRandomBetweenTwo(z), nameof(sizeOverLifetime));
+                DstEntityManager.AddComponentData(eParticleSystem, new LifetimeScale
+                {
+                    Curve = SampleLifetimeCurve(t => new float4(x.Evaluate(t, 0.5f), y.Evaluate(t, 0.5f), z.Evaluate(t, 0.5f), 1.0f))
+                });
+            }
+
+            var velocityOverLifetime = uParticleSystem.velocityOverLifetime;
+            if (velocityOverLifetime.enabled)
+            {
+                var x = velocityOverLifetime.x;
+                var y = velocityOverLifetime.y;
+                var z = velocityOverLifetime.z;
+                var speedModifier = velocityOverLifetime.speedModifier;
+                WarnIfRandomBetweenTwo(IsRandomBetweenTwo(x) || IsRandomBetweenTwo(y) || IsRandomBetweenTwo(z) || IsRandomBetweenTwo(speedModifier), nameof(velocityOverLifetime));
+                if (velocityOverLifetime.space == ParticleSystemSimulationSpace.World)
+                    UnityEngine.Debug.LogWarning("World space velocityOverLifetime is not supported, it is applied in the particle simulation space.");
+
+                DstEntityManager.AddComponentData(eParticleSystem, new LifetimeVelocity
+                {
+                    Curve = SampleLifetimeCurve(t => new float4(x.Evaluate(t, 0.5f), y.Evaluate(t, 0.5f), z.Evaluate(t, 0.5f), 0.0f))
+                });
+                if (speedModifier.mode != ParticleSystemCurveMode.Constant || speedModifier.constant != 1.0f)
+                {
+                    DstEntityManager.AddComponentData(eParticleSystem, new LifetimeSpeedMultiplier
+                    {
+                        Curve = SampleLifetimeCurve(t => new float4(speedModifier.Evaluate(t, 0.5f)))
+                    });
+                }
+            }
+
+            var rotationOverLifetime = uParticleSystem.rotationOverLifetime;
+            if (rotationOverLifetime.enabled)
+            {
+                var z = rotationOverLifetime.z;
+                WarnIfRandomBetweenTwo(IsRandomBetweenTwo(z), nameof(rotationOverLifetime));
+                if (rotationOverLifetime.separateAxes)
+                    UnityEngine.Debug.LogWarning("Separate axes in rotationOverLifetime are not supported, only the Z axis is converted.");
+
+                DstEntityManager.AddComponentData(eParticleSystem, new LifetimeAngularVelocity
+                {
+                    Curve = SampleLifetimeCurve(t => new float4(z.Evaluate(t, 0.5f)))
+                });
+            }
+        }
+
+        // Lifetime curves are sampled at conversion time, the runtime interpolates linearly between samples
+        private const int kLifetimeCurveSamples = 32;
+
+        // Curves are keyed by their samples, so identical curves share one blob and the BlobAssetStore owns it
+        private unsafe BlobAssetReference<LifetimeCurve> SampleLifetimeCurve(Func<float, float4> evaluate)
+        {
+            var values = new NativeArray<float4>(kLifetimeCurveSamples, Allocator.Temp);
+            for (int i = 0; i < kLifetimeCurveSamples; i++)
+                values[i] = evaluate((float)i / (kLifetimeCurveSamples - 1));
+
+            var data = values.GetUnsafeReadOnlyPtr();
+            var bytes = values.Length * UnsafeUtility.SizeOf<float4>();
+            var hash = new Hash128(math.hash(data, bytes, 0), math.hash(data, bytes, 1), math.hash(data, bytes, 2), math.hash(data, bytes, 3));
+
+            if (!BlobAssetStore.TryGet(hash, out BlobAssetReference<LifetimeCurve> curve))
+            {
+                curve = LifetimeCurve.Create(values);
+                if (!BlobAssetStore.TryAdd(hash, curve))
+                    throw new InvalidOperationException("Failed to add lifetime curve blob to BlobAssetStore");
+            }
+            values.Dispose();
+            return curve;
+        }
+
+        private static bool IsRandomBetweenTwo(UnityEngine.ParticleSystem.MinMaxCurve curve)
+        {
+            return curve.mode == ParticleSystemCurveMode.TwoConstants || curve.mode == ParticleSystemCurveMode.TwoCurves;
+        }
+
+        private static void WarnIfRandomBetweenTwo(bool randomBetweenTwo, string module)
+        {
+            // A curve per particle is not stored, the value halfway between both is used for every particle
+            if (randomBetweenTwo)
+                UnityEngine.Debug.LogWarning("Random between two values in " + module + " is not supported, the average is used.");
+        }
+
         // TODO support curves
         private static Range ConvertMinMaxCurve(UnityEngine.ParticleSystem.MinMaxCurve curve)
         {
@@ -43,6 +43,10 @@ namespace Unity.TinyConversion
             CreateShaderDataEntity(BuiltInShaderType.blitsrgb, @"Packages/com.unity.tiny/Unity.Tiny.Rendering.Native/shadersrc~/blitsrgb.cg", platforms);
             CreateShaderDataEntity(BuiltInShaderType.shadowmap, @"Packages/com.unity.tiny/Unity.Tiny.Rendering.Native/shadersrc~/shadowmap.cg", platforms);
             CreateShaderDataEntity(BuiltInShaderType.shadowmapgpuskinning, @"Packages/com.unity.tiny/Unity.Tiny.Rendering.Native/shadersrc~/shadowmapgpuskinning.cg", platforms);
+            CreateShaderDataEntity(BuiltInShaderType.simplelitinstanced, @"Packages/com.unity.tiny/Unity.Tiny.Rendering.Native/shadersrc~/simplelitinstanced.cg", platforms);
+            CreateShaderDataEntity(BuiltInShaderType.shadowmapinstanced, @"Packages/com.unity.tiny/Unity.Tiny.Rendering.Native/shadersrc~/shadowmapinstanced.cg", platforms);
+            CreateShaderDataEntity(BuiltInShaderType.simpleparticleinstanced, @"Packages/com.unity.tiny/Unity.Tiny.Rendering.Native/shadersrc~/simpleparticleinstanced.cg", platforms);
+            CreateShaderDataEntity(BuiltInShaderType.simplelitparticleinstanced, @"Packages/com.unity.tiny/Unity.Tiny.Rendering.Native/shadersrc~/simplelitparticleinstanced.cg", platforms);
 
             ShutdownShaderCompiler();
         }
@@ -16,6 +16,7 @@ namespace Unity.Tiny.Authoring
     public class LightConfigurationSystem : ConfigurationSystemBase
     {
         int m_NumberOfPointOrDirLights;
+        int m_NumberOfPointLights;
         int m_NumberOfShadowMappedLights;
         int m_NumberOfCascadedShadowMappedLights;
         void CalculateNumberOfLights(Hash128 sceneGuid)
@@ -35,6 +36,8 @@ namespace Unity.Tiny.Authoring
                         var cascadeComp = light.gameObject.GetComponent<Tiny.Authoring.CascadedShadowMappedLight>();
                         if (light.type == LightType.Directional || light.type == LightType.Point)
                             m_NumberOfPointOrDirLights++;
+                        if (light.type == LightType.Point)
+                            m_NumberOfPointLights++;
                         if (light.type == LightType.Directional || light.type == LightType.Spot)
                         {
                             if (light.shadows != LightShadows.None)
@@ -60,6 +63,7 @@ namespace Unity.Tiny.Authoring
         protected override void OnUpdate()
         {
             m_NumberOfPointOrDirLights = 0;
+            m_NumberOfPointLights = 0;
             m_NumberOfShadowMappedLights = 0;
             m_NumberOfCascadedShadowMappedLights = 0;
 
@@ -70,9 +74,13 @@ namespace Unity.Tiny.Authoring
             foreach (var scene in autoLoadedScenes)
                 CalculateNumberOfLights(scene);
 
-            if (m_NumberOfPointOrDirLights > LightingSetup.maxPointOrDirLights)
-                throw new ArgumentException($"Only a maximum of a total of {LightingSetup.maxPointOrDirLights} directional or point lights is supported at once on the runtime, " +
-                    $"and there is currently a total of {m_NumberOfPointOrDirLights} directional or point lights in your auto-loaded scenes. Reduce this number");
+            // past the plain light limit point lights are clustered at runtime, directional lights still have to fit
+            if (m_NumberOfPointOrDirLights > LightingSetup.maxPointOrDirLights && m_NumberOfPointOrDirLights - m_NumberOfPointLights > LightingSetup.maxPointOrDirLights)
+                throw new ArgumentException($"Only a maximum of a total of {LightingSetup.maxPointOrDirLights} directional lights is supported at once on the runtime, " +
+                    $"and there is currently a total of {m_NumberOfPointOrDirLights - m_NumberOfPointLights} directional lights in your auto-loaded scenes. Reduce this number");
+            if (m_NumberOfPointOrDirLights > LightingSetup.maxPointOrDirLights && m_NumberOfPointLights > LightingSetup.maxClusteredLights)
+                throw new ArgumentException($"Only a maximum of a total of {LightingSetup.maxClusteredLights} point lights is supported at once on the runtime, " +
+                    $"and there is currently a total of {m_NumberOfPointLights} point lights in your auto-loaded scenes. Reduce this number");
             if (m_NumberOfShadowMappedLights > LightingSetup.maxMappedLights)
                 throw new ArgumentException($"Only a maximum of {LightingSetup.maxMappedLights} shadow mapped lights (directional or spot) is supported at once on the runtime, " +
                     $"and there is currently {m_NumberOfShadowMappedLights} shadow mapped lights in your auto-loaded scenes. Reduce this number");
@@ -21,6 +21,7 @@ namespace Unity.TinyConversion
         [DeallocateOnJobCompletion] public NativeArray<Vector3> BiTangents;
         [DeallocateOnJobCompletion] public NativeArray<Color> Colors;
         [DeallocateOnJobCompletion] public NativeArray<ushort> Indices;
+        [DeallocateOnJobCompletion] public NativeArray<int2> TriangleRanges;
 
         public LitMeshConversionJob(UMeshDataCache data, int meshBlobIndex, NativeArray<BlobAssetReference<LitMeshData>> meshBlob)
         {
@@ -34,6 +35,7 @@ namespace Unity.TinyConversion
             BiTangents = data.uBiTangents;
             Colors = data.uColors;
             Indices = data.uIndices;
+            TriangleRanges = data.uTriangleRanges;
         }
 
         public unsafe void CheckVertexLayout()
@@ -54,11 +56,32 @@ namespace Unity.TinyConversion
         public void Execute()
         {
             CheckVertexLayout();
+            OptimizeForGPU();
             CreateBlobAssetForLitVertex();
         }
 
+        private void OptimizeForGPU()
+        {
+            if (TriangleRanges.Length == 0)
+                return;
+
+            var remap = MeshOptimizer.OptimizeForGPU(Indices, TriangleRanges, Positions.Length);
+            MeshOptimizer.RemapVertices(Positions, remap);
+            MeshOptimizer.RemapVertices(UVs, remap);
+            MeshOptimizer.RemapVertices(Normals, remap);
+            MeshOptimizer.RemapVertices(Tangents, remap);
+            MeshOptimizer.RemapVertices(BiTangents, remap);
+            MeshOptimizer.RemapVertices(Colors, remap);
+            remap.Dispose();
+        }
+
         private void CreateBlobAssetForLitVertex()
         {
+            // levels of detail only for the meshes OptimizeForGPU reorders, they have no per vertex skinning or blend shape data
+            var lodIndices = new NativeList<ushort>(Allocator.Temp);
+            var lods = new NativeList<MeshLOD>(Allocator.Temp);
+            MeshSimplifier.GenerateLODs(Positions, Indices, TriangleRanges, lodIndices, lods);
+
             var allocator = new BlobBuilder(Allocator.Temp);
             ref var root = ref allocator.ConstructRoot<LitMeshData>();
             var vertices = allocator.Allocate(ref root.Vertices, Positions.Length);
@@ -109,9 +132,20 @@ namespace Unity.TinyConversion
                     byte* desti = (byte*)dIndices.GetUnsafePtr();
                     UnsafeUtility.MemCpy(desti, indices, sizeof(ushort) * Indices.Length);
                 }
+
+                //Copy levels of detail
+                if (lods.Length != 0)
+                {
+                    var dLODIndices = allocator.Allocate(ref root.LODIndices, lodIndices.Length);
+                    UnsafeUtility.MemCpy(dLODIndices.GetUnsafePtr(), lodIndices.GetUnsafePtr(), sizeof(ushort) * lodIndices.Length);
+                    var dLODs = allocator.Allocate(ref root.LODs, lods.Length);
+                    UnsafeUtility.MemCpy(dLODs.GetUnsafePtr(), lods.GetUnsafePtr(), sizeof(MeshLOD) * lods.Length);
+                }
             }
             MeshBlobAssets[MeshBlobIndex] = allocator.CreateBlobAssetReference<LitMeshData>(Allocator.Persistent);
             allocator.Dispose();
+            lods.Dispose();
+            lodIndices.Dispose();
         }
     }
 }
@@ -0,0 +1,230 @@
+using Unity.Mathematics;
+using Unity.Collections;
+
+namespace Unity.TinyConversion
+{
+    // Reorders mesh data for the gpu at conversion time. Only the order changes, the rendered result is the same.
+    // Called from the burst conversion jobs, so everything in here has to stay burst compatible.
+    internal static class MeshOptimizer
+    {
+        // Size of the simulated post transform cache, a bit larger than most gpus so it works well everywhere
+        const int kCacheSize = 32;
+        const float kCacheDecayPower = 1.5f;
+        const float kLastTriangleScore = 0.75f;
+        const float kValenceBoostScale = 2.0f;
+        const float kValenceBoostPower = 0.5f;
+
+        // Reorders the triangles of every range for vertex cache hits, then renumbers the vertices in the order
+        // they are first used so vertex fetch walks the vertex buffer linearly. Returns the old to new vertex index
+        // table, apply it to every vertex attribute with RemapVertices. Ranges are (first index, index count) of
+        // triangle list submeshes, triangles never move between ranges so submesh draw ranges stay valid.
+        public static NativeArray<int> OptimizeForGPU(NativeArray<ushort> indices, NativeArray<int2> triangleRanges, int vertexCount)
+        {
+            for (int i = 0; i < triangleRanges.Length; i++)
+                OptimizeVertexCache(indices, triangleRanges[i].x, triangleRanges[i].y, vertexCount);
+
+            var remap = new NativeArray<int>(vertexCount, Allocator.Temp);
+            OptimizeVertexFetch(indices, remap);
+            return remap;
+        }
+
+        public static void RemapVertices<T>(NativeArray<T> vertices, NativeArray<int> remap) where T : struct
+        {
+            var src = new NativeArray<T>(vertices, Allocator.Temp);
+            for (int i = 0; i < remap.Length; i++)
+                vertices[remap[i]] = src[i];
+            src.Dispose();
+        }
+
+        // Assigns new vertex indices in order of first use and rewrites the indices, unused vertices go to the end
+        public static void OptimizeVertexFetch(NativeArray<ushort> indices, NativeArray<int> remap)
+        {
+            for (int i = 0; i < remap.Length; i++)
+                remap[i] = -1;
+
+            int next = 0;
+            for (int i = 0; i < indices.Length; i++)
+            {
+                int v = indices[i];
+                if (remap[v] < 0)
+                    remap[v] = next++;
+                indices[i] = (ushort)remap[v];
+            }
+
+            for (int i = 0; i < remap.Length; i++)
+            {
+                if (remap[i] < 0)
+                    remap[i] = next++;
+            }
+        }
+
+        static float VertexScore(int cachePosition, int remainingTriangles)
+        {
+            if (remainingTriangles == 0)
+                return -1.0f;
+
+            float score = 0.0f;
+            if (cachePosition >= 0)
+            {
+                // The last triangle is still in flight, give its vertices a fixed score so the next triangle does
+                // not just reuse its edge and walk in a strip
+                if (cachePosition < 3)
+                    score = kLastTriangleScore;
+                else
+                    score = math.pow(1.0f - (cachePosition - 3) * (1.0f / (kCacheSize - 3)), kCacheDecayPower);
+            }
+
+            // Finish off vertices with few triangles left so they do not linger as lone triangles
+            return score + kValenceBoostScale * math.pow(remainingTriangles, -kValenceBoostPower);
+        }
+
+        // Tom Forsyth's linear speed vertex cache optimisation: greedily emits the triangle with the best score,
+        // scores come from the vertex positions in a simulated lru cache and the number of triangles they have left.
+        public static void OptimizeVertexCache(NativeArray<ushort> indices, int start, int count, int vertexCount)
+        {
+            int triangleCount = count / 3;
+            if (triangleCount < 2)
+                return;
+
+            // Triangles of every vertex, the live ones of v are vertexTriangles[firstTriangle[v] .. firstTriangle[v] + remaining[v]]
+            var remaining = new NativeArray<int>(vertexCount, Allocator.Temp);
+            var firstTriangle = new NativeArray<int>(vertexCount, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+            var vertexTriangles = new NativeArray<int>(triangleCount * 3, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+            for (int i = 0; i < triangleCount * 3; i++)
+                remaining[indices[start + i]]++;
+            int offset = 0;
+            for (int v = 0; v < vertexCount; v++)
+            {
+                firstTriangle[v] = offset;
+                offset += remaining[v];
+                remaining[v] = 0;
+            }
+            for (int t = 0; t < triangleCount; t++)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    int v = indices[start + t * 3 + k];
+                    vertexTriangles[firstTriangle[v] + remaining[v]++] = t;
+                }
+            }
+
+            var cachePosition = new NativeArray<int>(vertexCount, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+            var vertexScore = new NativeArray<float>(vertexCount, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+            for (int v = 0; v < vertexCount; v++)
+            {
+                cachePosition[v] = -1;
+                vertexScore[v] = VertexScore(-1, remaining[v]);
+            }
+
+            var emitted = new NativeArray<bool>(triangleCount, Allocator.Temp);
+            int best = 0;
+            float bestScore = -1.0f;
+            for (int t = 0; t < triangleCount; t++)
+            {
+                int i = start + t * 3;
+                float score = vertexScore[indices[i]] + vertexScore[indices[i + 1]] + vertexScore[indices[i + 2]];
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    best = t;
+                }
+            }
+
+            var cache = new NativeArray<int>(kCacheSize + 3, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+            var newCache = new NativeArray<int>(kCacheSize + 3, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+            int cacheCount = 0;
+            var output = new NativeArray<ushort>(triangleCount * 3, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+            int cursor = 0;
+
+            for (int n = 0; n < triangleCount; n++)
+            {
+                // Nothing in the cache has triangles left, continue with the next triangle in the original order
+                if (best < 0)
+                {
+                    while (emitted[cursor])
+                        cursor++;
+                    best = cursor;
+                }
+
+                int tri = best;
+                emitted[tri] = true;
+                int newCount = 0;
+                for (int k = 0; k < 3; k++)
+                {
+                    int v = indices[start + tri * 3 + k];
+                    output[n * 3 + k] = (ushort)v;
+
+                    // Swap the triangle out of the live part of the vertex's list
+                    int first = firstTriangle[v];
+                    int last = first + remaining[v] - 1;
+                    for (int j = first; j <= last; j++)
+                    {
+                        if (vertexTriangles[j] == tri)
+                        {
+                            vertexTriangles[j] = vertexTriangles[last];
+                            vertexTriangles[last] = tri;
+                            break;
+                        }
+                    }
+                    remaining[v]--;
+
+                    bool added = false;
+                    for (int j = 0; j < newCount; j++)
+                        added |= newCache[j] == v;
+                    if (!added)
+                        newCache[newCount++] = v;
+                }
+
+                // The emitted vertices move to the front, everything else shifts back and falls off the end
+                for (int j = 0; j < cacheCount; j++)
+                {
+                    int v = cache[j];
+                    if (v != newCache[0] && (newCount < 2 || v != newCache[1]) && (newCount < 3 || v != newCache[2]))
+                        newCache[newCount++] = v;
+                }
+                for (int j = 0; j < newCount; j++)
+                {
+                    int v = newCache[j];
+                    cachePosition[v] = j < kCacheSize ? j : -1;
+                    vertexScore[v] = VertexScore(cachePosition[v], remaining[v]);
+                }
+
+                best = -1;
+                bestScore = -1.0f;
+                for (int j = 0; j < newCount; j++)
+                {
+                    int v = newCache[j];
+                    int first = firstTriangle[v];
+                    for (int l = first; l < first + remaining[v]; l++)
+                    {
+                        int t = vertexTriangles[l];
+                        int i = start + t * 3;
+                        float score = vertexScore[indices[i]] + vertexScore[indices[i + 1]] + vertexScore[indices[i + 2]];
+                        if (score > bestScore)
+                        {
+                            bestScore = score;
+                            best = t;
+                        }
+                    }
+                }
+
+                cacheCount = math.min(newCount, kCacheSize);
+                for (int j = 0; j < cacheCount; j++)
+                    cache[j] = newCache[j];
+            }
+
+            for (int i = 0; i < triangleCount * 3; i++)
+                indices[start + i] = output[i];
+
+            output.Dispose();
+            newCache.Dispose();
+            cache.Dispose();
+            emitted.Dispose();
+            vertexScore.Dispose();
+            cachePosition.Dispose();
+            vertexTriangles.Dispose();
+            firstTriangle.Dispose();
+            remaining.Dispose();
+        }
+    }
+}
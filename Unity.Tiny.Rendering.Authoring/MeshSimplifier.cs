@@ -0,0 +1,387 @@
+using System;
+using Unity.Mathematics;
+using Unity.Collections;
+using Unity.Tiny.Rendering;
+using UnityEngine;
+
+namespace Unity.TinyConversion
+{
+    // Generates levels of detail for sub meshes at conversion time, with quadric error metrics (Garland and Heckbert).
+    // Vertices are collapsed onto one of their neighbors, so every level reuses the vertices of the full mesh and
+    // only needs its own indices. Vertices on open borders, and vertices that share their position with another
+    // vertex (uv seams, hard edges) never move, so levels do not crack or tear the texture mapping.
+    // Called from the burst conversion jobs, so everything in here has to stay burst compatible.
+    internal static class MeshSimplifier
+    {
+        const int kMinTriangles = 128;      // smaller sub meshes are cheap enough at full detail
+        const float kMaxError = 0.1f;       // relative to the bounds radius, largest root mean square plane distance of a collapse
+        const float kMinReduction = 0.75f;  // a level is only kept if it has at most this fraction of the triangles of the level before
+        const float kMinFlipDot = 0.25f;    // cosine of the largest change of a triangle normal a collapse may cause
+
+        struct Quadric
+        {
+            public float a00, a01, a02, a11, a12, a22;
+            public float b0, b1, b2;
+            public float c;
+            public float w;
+
+            // plane through p0, p1 and p2, weighted by the triangle area
+            public static Quadric FromTriangle(float3 p0, float3 p1, float3 p2)
+            {
+                float3 n = math.cross(p1 - p0, p2 - p0);
+                float area = math.length(n);
+                if (area > 0.0f)
+                    n /= area;
+                float d = -math.dot(n, p0);
+                area *= 0.5f;
+                return new Quadric
+                {
+                    a00 = n.x * n.x * area, a01 = n.x * n.y * area, a02 = n.x * n.z * area,
+                    a11 = n.y * n.y * area, a12 = n.y * n.z * area, a22 = n.z * n.z * area,
+                    b0 = n.x * d * area, b1 = n.y * d * area, b2 = n.z * d * area,
+                    c = d * d * area,
+                    w = area
+                };
+            }
+
+            public void Add(in Quadric q)
+            {
+                a00 += q.a00; a01 += q.a01; a02 += q.a02;
+                a11 += q.a11; a12 += q.a12; a22 += q.a22;
+                b0 += q.b0; b1 += q.b1; b2 += q.b2;
+                c += q.c;
+                w += q.w;
+            }
+
+            // area weighted mean of the squared distances of p to the planes
+            public float Error(float3 p)
+            {
+                float e = a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z
+                    + 2.0f * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z)
+                    + 2.0f * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+                return math.max(e, 0.0f) / math.max(w, 1e-12f);
+            }
+        }
+
+        struct Collapse : IComparable<Collapse>
+        {
+            public float error;
+            public int from;
+            public int to;
+
+            public int CompareTo(Collapse o)
+            {
+                return error.CompareTo(o.error);
+            }
+        }
+
+        // Generates the levels of every triangle range (first index, index count) of a mesh, for the LODIndices and
+        // LODs of its blob. Their indices are placed after all indices of the mesh.
+        public static void GenerateLODs(NativeArray<Vector3> positions, NativeArray<ushort> indices, NativeArray<int2> triangleRanges, NativeList<ushort> lodIndices, NativeList<MeshLOD> lods)
+        {
+            if (triangleRanges.Length == 0 || positions.Length == 0)
+                return;
+
+            float3 min = positions[0];
+            float3 max = positions[0];
+            for (int i = 1; i < positions.Length; i++)
+            {
+                min = math.min(min, positions[i]);
+                max = math.max(max, positions[i]);
+            }
+            float3 center = (min + max) * 0.5f;
+            float radius = math.length(max - min) * 0.5f;
+            if (radius <= 0.0f)
+                return;
+
+            var normalized = new NativeArray<float3>(positions.Length, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+            for (int i = 0; i < positions.Length; i++)
+                normalized[i] = ((float3)positions[i] - center) / radius;
+            for (int i = 0; i < triangleRanges.Length; i++)
+                GenerateLODs(normalized, indices, triangleRanges[i].x, triangleRanges[i].y, indices.Length, lodIndices, lods);
+            normalized.Dispose();
+        }
+
+        // Appends the simplified levels of indices[start .. start + count) to lodIndices and describes them in lods,
+        // firstLODIndex is the index buffer position of lodIndices[0]. Positions have to be relative to the bounds
+        // center and divided by the bounds radius, so errors come out relative to the radius.
+        public static void GenerateLODs(NativeArray<float3> positions, NativeArray<ushort> indices, int start, int count, int firstLODIndex, NativeList<ushort> lodIndices, NativeList<MeshLOD> lods)
+        {
+            int triangleCount = count / 3;
+            if (triangleCount < kMinTriangles)
+                return;
+
+            int vertexCount = positions.Length;
+            var triangles = new NativeArray<int>(triangleCount * 3, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+            for (int i = 0; i < triangleCount * 3; i++)
+                triangles[i] = indices[start + i];
+
+            var locked = new NativeArray<bool>(vertexCount, Allocator.Temp);
+            LockBorderAndSeamVertices(positions, triangles, triangleCount, locked);
+
+            var quadrics = new NativeArray<Quadric>(vertexCount, Allocator.Temp);
+            for (int t = 0; t < triangleCount; t++)
+            {
+                int i0 = triangles[t * 3], i1 = triangles[t * 3 + 1], i2 = triangles[t * 3 + 2];
+                var q = Quadric.FromTriangle(positions[i0], positions[i1], positions[i2]);
+                for (int k = 0; k < 3; k++)
+                {
+                    var qv = quadrics[triangles[t * 3 + k]];
+                    qv.Add(in q);
+                    quadrics[triangles[t * 3 + k]] = qv;
+                }
+            }
+
+            int liveCount = triangleCount;
+            float error = 0.0f;
+            for (int level = 1; level < MeshRendererLOD.kMaxLevels; level++)
+            {
+                int previousCount = liveCount;
+                int target = triangleCount >> level;
+                while (liveCount > target)
+                {
+                    int removed = SimplifyPass(positions, triangles, ref liveCount, target, locked, quadrics, ref error);
+                    if (removed == 0)
+                        break;
+                }
+                if (liveCount > previousCount * kMinReduction)
+                    break;
+
+                int lodStart = lodIndices.Length;
+                for (int i = 0; i < liveCount * 3; i++)
+                    lodIndices.Add((ushort)triangles[i]);
+                MeshOptimizer.OptimizeVertexCache(lodIndices.AsArray(), lodStart, liveCount * 3, vertexCount);
+                lods.Add(new MeshLOD
+                {
+                    SubMeshStartIndex = start,
+                    Level = level,
+                    StartIndex = firstLODIndex + lodStart,
+                    IndexCount = liveCount * 3,
+                    Error = math.sqrt(error)
+                });
+            }
+
+            quadrics.Dispose();
+            locked.Dispose();
+            triangles.Dispose();
+        }
+
+        static ulong EdgeKey(int a, int b)
+        {
+            return a < b ? ((ulong)a << 32) | (uint)b : ((ulong)b << 32) | (uint)a;
+        }
+
+        static void LockBorderAndSeamVertices(NativeArray<float3> positions, NativeArray<int> triangles, int triangleCount, NativeArray<bool> locked)
+        {
+            var firstAtPosition = new NativeHashMap<float3, int>(triangleCount * 3, Allocator.Temp);
+            var edgeUses = new NativeHashMap<ulong, int>(triangleCount * 3, Allocator.Temp);
+            for (int t = 0; t < triangleCount; t++)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    int v = triangles[t * 3 + k];
+                    if (firstAtPosition.TryGetValue(positions[v], out int other))
+                    {
+                        if (other != v)
+                        {
+                            locked[v] = true;
+                            locked[other] = true;
+                        }
+                    }
+                    else
+                        firstAtPosition.TryAdd(positions[v], v);
+
+                    ulong key = EdgeKey(v, triangles[t * 3 + (k + 1) % 3]);
+                    edgeUses.TryGetValue(key, out int uses);
+                    edgeUses[key] = uses + 1;
+                }
+            }
+
+            // edges of a closed surface have exactly two triangles
+            for (int t = 0; t < triangleCount; t++)
+            {
+                for (int k = 0; k < 3; k++)
+                {
+                    int a = triangles[t * 3 + k];
+                    int b = triangles[t * 3 + (k + 1) % 3];
+                    if (edgeUses[EdgeKey(a, b)] != 2)
+                    {
+                        locked[a] = true;
+                        locked[b] = true;
+                    }
+                }
+            }
+
+            edgeUses.Dispose();
+            firstAtPosition.Dispose();
+        }
+
+        static bool Contains(NativeArray<int> triangles, int t, int v)
+        {
+            return triangles[t * 3] == v || triangles[t * 3 + 1] == v || triangles[t * 3 + 2] == v;
+        }
+
+        // Collapses the cheapest vertices onto a neighbor until target is reached. Vertices around a collapse are not
+        // touched again in the same pass, so the adjacency built at the start of the pass stays valid for the rest.
+        // Returns the number of triangles removed.
+        static int SimplifyPass(NativeArray<float3> positions, NativeArray<int> triangles, ref int liveCount, int target,
+            NativeArray<bool> locked, NativeArray<Quadric> quadrics, ref float error)
+        {
+            int vertexCount = positions.Length;
+
+            // triangles around each vertex, those of v are adjacency[firstAdjacent[v] .. firstAdjacent[v + 1]]
+            var firstAdjacent = new NativeArray<int>(vertexCount + 1, Allocator.Temp);
+            for (int i = 0; i < liveCount * 3; i++)
+                firstAdjacent[triangles[i] + 1]++;
+            for (int v = 0; v < vertexCount; v++)
+                firstAdjacent[v + 1] += firstAdjacent[v];
+            var fill = new NativeArray<int>(vertexCount, Allocator.Temp);
+            var adjacency = new NativeArray<int>(liveCount * 3, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+            for (int i = 0; i < liveCount * 3; i++)
+            {
+                int v = triangles[i];
+                adjacency[firstAdjacent[v] + fill[v]++] = i / 3;
+            }
+
+            var collapses = new NativeList<Collapse>(vertexCount, Allocator.Temp);
+            for (int v = 0; v < vertexCount; v++)
+            {
+                if (locked[v] || firstAdjacent[v] == firstAdjacent[v + 1])
+                    continue;
+                var best = new Collapse { error = float.MaxValue, from = v, to = -1 };
+                for (int a = firstAdjacent[v]; a < firstAdjacent[v + 1]; a++)
+                {
+                    int t = adjacency[a];
+                    for (int k = 0; k < 3; k++)
+                    {
+                        int u = triangles[t * 3 + k];
+                        if (u == v)
+                            continue;
+                        float e = quadrics[v].Error(positions[u]);
+                        if (e < best.error)
+                        {
+                            best.error = e;
+                            best.to = u;
+                        }
+                    }
+                }
+                if (best.to >= 0 && best.error <= kMaxError * kMaxError)
+                    collapses.Add(best);
+            }
+            collapses.Sort();
+
+            var touched = new NativeArray<bool>(vertexCount, Allocator.Temp);
+            var dead = new NativeArray<bool>(liveCount, Allocator.Temp);
+            int removed = 0;
+            for (int c = 0; c < collapses.Length && liveCount - removed > target; c++)
+            {
+                int v = collapses[c].from;
+                int u = collapses[c].to;
+                if (touched[v] || touched[u])
+                    continue;
+                if (!CanCollapse(positions, triangles, firstAdjacent, adjacency, v, u))
+                    continue;
+
+                for (int a = firstAdjacent[v]; a < firstAdjacent[v + 1]; a++)
+                {
+                    int t = adjacency[a];
+                    for (int k = 0; k < 3; k++)
+                        touched[triangles[t * 3 + k]] = true;
+                    if (Contains(triangles, t, u))
+                    {
+                        dead[t] = true;
+                        removed++;
+                        continue;
+                    }
+                    for (int k = 0; k < 3; k++)
+                    {
+                        if (triangles[t * 3 + k] == v)
+                            triangles[t * 3 + k] = u;
+                    }
+                }
+                var qu = quadrics[u];
+                qu.Add(quadrics[v]);
+                quadrics[u] = qu;
+                error = math.max(error, collapses[c].error);
+            }
+
+            int live = 0;
+            for (int t = 0; t < liveCount; t++)
+            {
+                if (dead[t])
+                    continue;
+                for (int k = 0; k < 3; k++)
+                    triangles[live * 3 + k] = triangles[t * 3 + k];
+                live++;
+            }
+            liveCount = live;
+
+            dead.Dispose();
+            touched.Dispose();
+            collapses.Dispose();
+            adjacency.Dispose();
+            fill.Dispose();
+            firstAdjacent.Dispose();
+            return removed;
+        }
+
+        // Rejects collapses of v onto u that fold a triangle over, or that would join two surfaces that only touch
+        // at u and v (the neighbors v and u share must all be corners of the triangles that die).
+        static bool CanCollapse(NativeArray<float3> positions, NativeArray<int> triangles, NativeArray<int> firstAdjacent, NativeArray<int> adjacency, int v, int u)
+        {
+            for (int a = firstAdjacent[v]; a < firstAdjacent[v + 1]; a++)
+            {
+                int t = adjacency[a];
+                if (Contains(triangles, t, u))
+                    continue;
+                float3 p0 = positions[triangles[t * 3]];
+                float3 p1 = positions[triangles[t * 3 + 1]];
+                float3 p2 = positions[triangles[t * 3 + 2]];
+                float3 before = math.cross(p1 - p0, p2 - p0);
+                if (triangles[t * 3] == v) p0 = positions[u];
+                if (triangles[t * 3 + 1] == v) p1 = positions[u];
+                if (triangles[t * 3 + 2] == v) p2 = positions[u];
+                float3 after = math.cross(p1 - p0, p2 - p0);
+                if (math.dot(before, after) <= kMinFlipDot * math.length(before) * math.length(after))
+                    return false;
+            }
+
+            for (int a = firstAdjacent[u]; a < firstAdjacent[u + 1]; a++)
+            {
+                int t = adjacency[a];
+                if (Contains(triangles, t, v))
+                    continue;
+                for (int k = 0; k < 3; k++)
+                {
+                    int w = triangles[t * 3 + k];
+                    if (w == u || !IsNeighbor(triangles, firstAdjacent, adjacency, v, w))
+                        continue;
+                    if (!SharesTriangle(triangles, firstAdjacent, adjacency, v, u, w))
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        static bool IsNeighbor(NativeArray<int> triangles, NativeArray<int> firstAdjacent, NativeArray<int> adjacency, int v, int w)
+        {
+            for (int a = firstAdjacent[v]; a < firstAdjacent[v + 1]; a++)
+            {
+                if (Contains(triangles, adjacency[a], w))
+                    return true;
+            }
+            return false;
+        }
+
+        static bool SharesTriangle(NativeArray<int> triangles, NativeArray<int> firstAdjacent, NativeArray<int> adjacency, int v, int u, int w)
+        {
+            for (int a = firstAdjacent[v]; a < firstAdjacent[v + 1]; a++)
+            {
+                int t = adjacency[a];
+                if (Contains(triangles, t, u) && Contains(triangles, t, w))
+                    return true;
+            }
+            return false;
+        }
+    }
+}
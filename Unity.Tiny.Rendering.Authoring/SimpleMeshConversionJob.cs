@@ -17,6 +17,7 @@ namespace Unity.TinyConversion
         [DeallocateOnJobCompletion] public NativeArray<Vector3> Positions;
         [DeallocateOnJobCompletion] public NativeArray<Vector2> UVs;
         [DeallocateOnJobCompletion] public NativeArray<ushort> Indices;
+        [DeallocateOnJobCompletion] public NativeArray<int2> TriangleRanges;
 
         public SimpleMeshConversionJob(UMeshDataCache data, int meshBlobIndex, NativeArray<BlobAssetReference<SimpleMeshData>> meshBlob)
         {
@@ -26,6 +27,7 @@ namespace Unity.TinyConversion
             Positions = data.uPositions;
             UVs = data.uUVs;
             Indices = data.uIndices;
+            TriangleRanges = data.uTriangleRanges;
         }
 
         public unsafe void CheckVertexLayout()
@@ -43,11 +45,28 @@ namespace Unity.TinyConversion
         public void Execute()
         {
             CheckVertexLayout();
+            OptimizeForGPU();
             CreateBlobAssetForSimpleVertex();
         }
 
+        private void OptimizeForGPU()
+        {
+            if (TriangleRanges.Length == 0)
+                return;
+
+            var remap = MeshOptimizer.OptimizeForGPU(Indices, TriangleRanges, Positions.Length);
+            MeshOptimizer.RemapVertices(Positions, remap);
+            MeshOptimizer.RemapVertices(UVs, remap);
+            remap.Dispose();
+        }
+
         private void CreateBlobAssetForSimpleVertex()
         {
+            // levels of detail only for the meshes OptimizeForGPU reorders, they have no per vertex skinning or blend shape data
+            var lodIndices = new NativeList<ushort>(Allocator.Temp);
+            var lods = new NativeList<MeshLOD>(Allocator.Temp);
+            MeshSimplifier.GenerateLODs(Positions, Indices, TriangleRanges, lodIndices, lods);
+
             var allocator = new BlobBuilder(Allocator.Temp);
             ref var root = ref allocator.ConstructRoot<SimpleMeshData>();
             var vertices = allocator.Allocate(ref root.Vertices, Positions.Length);
@@ -85,9 +104,20 @@ namespace Unity.TinyConversion
                     byte* desti = (byte*)dIndices.GetUnsafePtr();
                     UnsafeUtility.MemCpy(desti, indices, sizeof(ushort) * Indices.Length);
                 }
+
+                //Copy levels of detail
+                if (lods.Length != 0)
+                {
+                    var dLODIndices = allocator.Allocate(ref root.LODIndices, lodIndices.Length);
+                    UnsafeUtility.MemCpy(dLODIndices.GetUnsafePtr(), lodIndices.GetUnsafePtr(), sizeof(ushort) * lodIndices.Length);
+                    var dLODs = allocator.Allocate(ref root.LODs, lods.Length);
+                    UnsafeUtility.MemCpy(dLODs.GetUnsafePtr(), lods.GetUnsafePtr(), sizeof(MeshLOD) * lods.Length);
+                }
             }
             MeshBlobAssets[MeshBlobIndex] = allocator.CreateBlobAssetReference<SimpleMeshData>(Allocator.Persistent);
             allocator.Dispose();
+            lods.Dispose();
+            lodIndices.Dispose();
         }
     }
 }
@@ -26,6 +26,6 @@ namespace Unity.Tiny.Rendering.Settings
         public bool DisableVsync = false;
 
         [CreateProperty]
-        public bool GPUSkinning = false;
+        public bool GPUSkinning = true;
     }
 }
@@ -11,10 +11,7 @@ namespace Bgfx
             Trace = 1,
             ProfilerBegin = 2,
             ProfilerBeginLiteral = 3,
-            ProfilerEnd = 4,
-            ScreenShot = 5,
-            ScreenShotFilename = 6,
-            ScreenShotDesc = 7
+            ProfilerEnd = 4
         }
 
         public struct CallbackEntry
@@ -24,13 +21,34 @@ namespace Bgfx
             public int additionalAllocatedDataSize;
         }
 
-        public struct ScreenShotDesc
+        // keep this in sync with native ut::CapturedFrame
+        public unsafe struct CapturedFrame
         {
+            public byte* pixels;
+            public int slot;
             public int width;
             public int height;
             public int pitch;
-            public int size;
+            public int bgra;
             public int yflip;
+            public int screenShot;
+            public byte* path;
+        }
+
+        // keep this in sync with native ut::PooledAllocatorStats
+        public unsafe struct AllocatorStats
+        {
+            public const int kSizeClassCount = 12; // block sizes 32 << class, header included
+
+            public fixed long classLiveBytes[kSizeClassCount];
+            public fixed long classReservedBytes[kSizeClassCount];
+            public long largeLiveBytes;
+            public long liveBytes;
+            public long peakLiveBytes;
+            public int allocationsLastFrame;
+            public int frameArenaBytesLastFrame;
+            public int frameArenaCapacity;
+            public int frameArenaOverflowsLastFrame;
         }
 
         public unsafe delegate void ProfilerBeginCallback(byte* name, int bytes);
@@ -39,16 +57,59 @@ namespace Bgfx
         [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXAllocator_Init", CallingConvention = CallingConvention.StdCall)]
         public static extern unsafe IntPtr AllocatorInit();
 
+        [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXAllocator_FrameAlloc", CallingConvention = CallingConvention.StdCall)]
+        public static extern unsafe void* AllocatorFrameAlloc(int size);
+
+        [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXAllocator_EndFrame", CallingConvention = CallingConvention.StdCall)]
+        public static extern void AllocatorEndFrame();
+
+        [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXAllocator_Stats", CallingConvention = CallingConvention.StdCall)]
+        public static extern unsafe void GetAllocatorStats(AllocatorStats* stats);
+
         [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXCB_Init", CallingConvention = CallingConvention.StdCall)]
         public static extern unsafe IntPtr CallbacksInit(IntPtr funcBegin, IntPtr funcEnd);
 
         [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXCB_DeInit", CallingConvention = CallingConvention.StdCall)]
         public static extern void CallbacksDeInit();
 
-        [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXCB_Lock", CallingConvention = CallingConvention.StdCall)]
-        public static extern unsafe int CallbacksLock(byte** destMem, CallbackEntry** destLog);
+        [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXCB_CaptureStart", CallingConvention = CallingConvention.StdCall)]
+        public static extern unsafe int CaptureStart(byte* path, int frameCount);
+
+        [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXCB_CaptureStop", CallingConvention = CallingConvention.StdCall)]
+        public static extern void CaptureStop();
+
+        [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXCB_CaptureAcquire", CallingConvention = CallingConvention.StdCall)]
+        public static extern unsafe int CaptureAcquire(CapturedFrame* frame);
+
+        [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXCB_CaptureRelease", CallingConvention = CallingConvention.StdCall)]
+        public static extern void CaptureRelease(int slot);
+
+        [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXCB_CaptureStats", CallingConvention = CallingConvention.StdCall)]
+        public static extern unsafe void CaptureStats(int* captured, int* dropped, int* remaining);
+
+        [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXCB_ShaderCacheOpen", CallingConvention = CallingConvention.StdCall)]
+        public static extern unsafe int ShaderCacheOpen(byte* path, ulong driverKey);
+
+        [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXCB_ShaderCacheClose", CallingConvention = CallingConvention.StdCall)]
+        public static extern void ShaderCacheClose();
+
+        [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXCB_ShaderCacheStats", CallingConvention = CallingConvention.StdCall)]
+        public static extern unsafe void ShaderCacheStats(int* hits, int* misses, int* writes, int* entries);
+
+        [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXCB_ProfilerSetForwarding", CallingConvention = CallingConvention.StdCall)]
+        public static extern void ProfilerSetForwarding(int enabled);
+
+        [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXCB_ProfilerRecordStart", CallingConvention = CallingConvention.StdCall)]
+        public static extern int ProfilerRecordStart(int maxEvents);
+
+        [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXCB_ProfilerRecordStop", CallingConvention = CallingConvention.StdCall)]
+        public static extern unsafe int ProfilerRecordStop(byte* path);
+
+        [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXCB_ProfilerRecordStats", CallingConvention = CallingConvention.StdCall)]
+        public static extern unsafe void ProfilerRecordStats(int* recorded, int* dropped);
 
-        [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXCB_UnlockAndClear", CallingConvention = CallingConvention.StdCall)]
-        public static extern void CallbacksUnlockAndClear();
+        // returned memory is owned by native code and stays valid until the next call
+        [DllImport("lib_unity_tiny_rendering_native.dll", EntryPoint = "BGFXCB_Drain", CallingConvention = CallingConvention.StdCall)]
+        public static extern unsafe int CallbacksDrain(byte** destMem, CallbackEntry** destLog, int* dropped);
     }
 }
@@ -1,5 +1,9 @@
 using System;
 using System.Runtime.InteropServices;
+using Unity.Burst;
+using Unity.Collections;
+using Unity.Collections.LowLevel.Unsafe;
+using Unity.Jobs;
 using Unity.Mathematics;
 using Unity.Entities;
 using Unity.Tiny.Assertions;
@@ -83,6 +87,9 @@ namespace Unity.Tiny.Rendering
         public fixed float podl_positionOrDir[LightingSetup.maxPointOrDirLights * 4];
         public fixed float podl_colorIVR[LightingSetup.maxPointOrDirLights * 4];
 
+        // index into RendererBGFXInstance.m_lightClusterViews, -1 if the setup has no clustered lights this frame
+        public int clusterIndex;
+
         public void TransformToViewSpace(ref float4x4 viewTx, ref LightingViewSpaceBGFX dest, ushort viewId)
         {
             if (dest.cacheTag == viewId)
@@ -148,6 +155,8 @@ namespace Unity.Tiny.Rendering
     [UpdateAfter(typeof(AssignLightingSetupTrivialSystem))]
     public unsafe class UpdateBGFXLightSetups : SystemBase
     {
+        bool m_loggedNoClusters;
+
         private void AddCascadeMappedLight(ref LightingBGFX r, ref ShadowmappedLight sml, ref Light l, ref float4x4 tx, ref LightMatrices txCache,
             ref CascadeShadowmappedLight csm, ref CascadeShadowmappedLightCache csmData, RendererBGFXInstance *sys, bool srgbColors)
         {
@@ -226,6 +235,17 @@ namespace Unity.Tiny.Rendering
             }
         }
 
+        private void SetPlainLight(ref LightingBGFX r, int idx, Entity e, bool srgbColors)
+        {
+            Light l = EntityManager.GetComponentData<Light>(e);
+            LocalToWorld tx = EntityManager.GetComponentData<LocalToWorld>(e);
+            float3 c = srgbColors?Color.LinearToSRGB(l.color) :l.color;
+            if ( EntityManager.HasComponent<DirectionalLight>(e) )
+                r.SetDirLight(idx, math.normalize(tx.Value.c2.xyz), c * l.intensity);
+            else
+                r.SetPointLight(idx, tx.Value.c3.xyz, l.clipZFar, c * l.intensity);
+        }
+
         protected override void OnUpdate()
         {
             var sys = World.GetExistingSystem<RendererBGFXSystem>().InstancePointer();
@@ -252,6 +272,7 @@ namespace Unity.Tiny.Rendering
                 r.mappedLight0.shadowMap = sys->m_noShadow;
                 r.mappedLight1.shadowMap = sys->m_noShadow;
                 r.csmLight.shadowMap = sys->m_noShadow;
+                r.clusterIndex = -1;
                 // ambient
                 if ( s.AmbientLight != Entity.Null ) {
                     var l = EntityManager.GetComponentData<AmbientLight>(s.AmbientLight);
@@ -267,16 +288,19 @@ namespace Unity.Tiny.Rendering
                     r.fogParams = new float4((float)fog.mode, fog.density, fog.endDistance, 1.0f / linearFogRange);
                 }
                 // regular
-                for ( int i=0; i<s.PlainLights.Length; i++ ) {
-                    Light l = EntityManager.GetComponentData<Light>(s.PlainLights[i]);
-                    LocalToWorld tx = EntityManager.GetComponentData<LocalToWorld>(s.PlainLights[i]);
-                    float3 c = srgbColors?Color.LinearToSRGB(l.color) :l.color;
-                    if ( EntityManager.HasComponent<DirectionalLight>(s.PlainLights[i]) )
-                        r.SetDirLight(i, math.normalize(tx.Value.c2.xyz), c * l.intensity);
-                    else
-                        r.SetPointLight(i, tx.Value.c3.xyz, l.clipZFar, c * l.intensity);
-                }
+                for ( int i=0; i<s.PlainLights.Length; i++ )
+                    SetPlainLight(ref r, i, s.PlainLights[i], srgbColors);
                 r.numPointOrDirLights = s.PlainLights.Length;
+                // clustered, UpdateBGFXLightClusters picks these up. without cluster support they take the free plain slots
+                if ( !sys->m_lightClusterSupported && EntityManager.HasComponent<ClusteredLight>(e) ) {
+                    var clustered = EntityManager.GetBuffer<ClusteredLight>(e);
+                    for ( int i=0; i<clustered.Length && r.numPointOrDirLights<LightingSetup.maxPointOrDirLights; i++ )
+                        SetPlainLight(ref r, r.numPointOrDirLights++, clustered[i].e, srgbColors);
+                    if ( s.PlainLights.Length + clustered.Length > LightingSetup.maxPointOrDirLights && !m_loggedNoClusters ) {
+                        RenderDebug.LogFormatAlways("Clustered lights are not supported on this device, only the first {0} point or directional lights are used.", LightingSetup.maxPointOrDirLights);
+                        m_loggedNoClusters = true;
+                    }
+                }
                 // mapped
                 AddMappedLightFromEntity (s.MappedLight0,ref r, srgbColors, sys);
                 AddMappedLightFromEntity (s.MappedLight1,ref r, srgbColors, sys);
@@ -294,4 +318,274 @@ namespace Unity.Tiny.Rendering
         }
     }
 
+    // One light grid to build, for one lighting setup seen from one view
+    internal struct LightClusterBlock
+    {
+        public int clusterIndex;
+        public ushort viewId;
+        public float4x4 projection;
+        public float4x4 view;
+        public int firstLight;
+        public int lightCount;
+    }
+
+    // Bins the clustered point lights of every block into a tiles x slices grid and writes the blocks one after the other into Texels.
+    // Block layout, in texels from its start:
+    //   one header per cluster:   first index texel, light count
+    //   two texels per light:     view space position and 1/range^2, color
+    //   index runs per cluster:   four light texel offsets per texel
+    [BurstCompile]
+    internal unsafe struct BuildLightClustersJob : IJob
+    {
+        public const int kTilesX = 16;
+        public const int kTilesY = 9;
+        public const int kSlices = 24;
+        public const int kClusterCount = kTilesX * kTilesY * kSlices;
+        public const int kMaxLightsPerCluster = 16; // the shader loop is unrolled for this many
+
+        [ReadOnly] public NativeArray<LightClusterBlock> Blocks;
+        [ReadOnly] public NativeArray<float4> LightPosRange; // world space position, range
+        [ReadOnly] public NativeArray<float4> LightColor;
+        public NativeList<float4> Texels;
+        [NativeDisableUnsafePtrRestriction] public LightClusterViewBGFX* Views;
+
+        static int Slice(float z, float near, float sliceScale, bool logSlices)
+        {
+            float s = logSlices ? math.log(math.max(z / near, 1.0f)) * sliceScale : (z - near) * sliceScale;
+            return math.clamp((int)math.floor(s), 0, kSlices - 1);
+        }
+
+        static int Tile(float ndc, int tiles)
+        {
+            return math.clamp((int)math.floor((ndc * 0.5f + 0.5f) * tiles), 0, tiles - 1);
+        }
+
+        public void Execute()
+        {
+            var counts = new NativeArray<int>(kClusterCount, Allocator.Temp);
+            var runStart = new NativeArray<int>(kClusterCount, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+            var boundsMin = new NativeArray<int3>(LightingSetup.maxClusteredLights, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+            var boundsMax = new NativeArray<int3>(LightingSetup.maxClusteredLights, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+            var viewPos = new NativeArray<float3>(LightingSetup.maxClusteredLights, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+            var lightSlot = new NativeArray<int>(LightingSetup.maxClusteredLights, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+
+            for (int b = 0; b < Blocks.Length; b++)
+            {
+                LightClusterBlock block = Blocks[b];
+                float4x4 proj = block.projection;
+                bool perspective = proj.c3.w == 0.0f;
+                float near, far;
+                if (perspective)
+                {
+                    near = -proj.c3.z / (proj.c2.z + 1.0f);
+                    far = proj.c3.z / (1.0f - proj.c2.z);
+                }
+                else
+                {
+                    near = (-1.0f - proj.c3.z) / proj.c2.z;
+                    far = (1.0f - proj.c3.z) / proj.c2.z;
+                }
+                bool logSlices = perspective && near > 0.0f;
+                float sliceScale = logSlices ? kSlices / math.log(far / near) : kSlices / (far - near);
+
+                // cluster range of every light, lights that miss the frustum get no slot
+                int nVisible = 0;
+                for (int i = 0; i < block.lightCount; i++)
+                {
+                    lightSlot[i] = -1;
+                    float4 posRange = LightPosRange[block.firstLight + i];
+                    float3 c = math.mul(block.view, new float4(posRange.xyz, 1.0f)).xyz;
+                    float r = posRange.w;
+                    if (c.z + r < near || c.z - r > far)
+                        continue;
+                    float2 ndcMin = new float2(-1.0f);
+                    float2 ndcMax = new float2(1.0f);
+                    bool inFront = true;
+                    float2 projMin = new float2(float.MaxValue);
+                    float2 projMax = new float2(-float.MaxValue);
+                    for (int k = 0; k < 8 && inFront; k++)
+                    {
+                        float3 corner = c + r * new float3((k & 1) != 0 ? 1.0f : -1.0f, (k & 2) != 0 ? 1.0f : -1.0f, (k & 4) != 0 ? 1.0f : -1.0f);
+                        float4 p = math.mul(proj, new float4(corner, 1.0f));
+                        inFront = p.w > 1e-5f;
+                        projMin = math.min(projMin, p.xy / p.w);
+                        projMax = math.max(projMax, p.xy / p.w);
+                    }
+                    if (inFront)
+                    {
+                        // a corner behind the camera spreads the light over the whole screen
+                        if (math.any(projMin > 1.0f) || math.any(projMax < -1.0f))
+                            continue;
+                        ndcMin = projMin;
+                        ndcMax = projMax;
+                    }
+                    boundsMin[i] = new int3(Tile(ndcMin.x, kTilesX), Tile(ndcMin.y, kTilesY), Slice(c.z - r, near, sliceScale, logSlices));
+                    boundsMax[i] = new int3(Tile(ndcMax.x, kTilesX), Tile(ndcMax.y, kTilesY), Slice(c.z + r, near, sliceScale, logSlices));
+                    viewPos[i] = c;
+                    lightSlot[i] = nVisible++;
+                }
+
+                if (nVisible == 0)
+                    continue; // the view stays disabled
+
+                // count, lights past kMaxLightsPerCluster in a cluster are dropped in light order
+                UnsafeUtility.MemClear(counts.GetUnsafePtr(), kClusterCount * sizeof(int));
+                for (int i = 0; i < block.lightCount; i++)
+                {
+                    if (lightSlot[i] < 0)
+                        continue;
+                    for (int z = boundsMin[i].z; z <= boundsMax[i].z; z++)
+                        for (int y = boundsMin[i].y; y <= boundsMax[i].y; y++)
+                            for (int x = boundsMin[i].x; x <= boundsMax[i].x; x++)
+                            {
+                                int ci = x + kTilesX * (y + kTilesY * z);
+                                counts[ci] = math.min(counts[ci] + 1, kMaxLightsPerCluster);
+                            }
+                }
+                int blockTexels = kClusterCount + nVisible * 2;
+                for (int ci = 0; ci < kClusterCount; ci++)
+                {
+                    runStart[ci] = blockTexels;
+                    blockTexels += (counts[ci] + 3) >> 2;
+                }
+
+                int blockBase = Texels.Length;
+                Texels.ResizeUninitialized(blockBase + blockTexels);
+                float4* texels = (float4*)Texels.GetUnsafePtr() + blockBase;
+                UnsafeUtility.MemClear(texels, blockTexels * sizeof(float4));
+                for (int ci = 0; ci < kClusterCount; ci++)
+                    texels[ci] = new float4(runStart[ci], counts[ci], 0.0f, 0.0f);
+                for (int i = 0; i < block.lightCount; i++)
+                {
+                    if (lightSlot[i] < 0)
+                        continue;
+                    float range = LightPosRange[block.firstLight + i].w;
+                    texels[kClusterCount + lightSlot[i] * 2] = new float4(viewPos[i], LightingBGFX.InverseSquare(range));
+                    texels[kClusterCount + lightSlot[i] * 2 + 1] = LightColor[block.firstLight + i];
+                }
+
+                // fill, counts are reused as the number of lights written so far
+                UnsafeUtility.MemClear(counts.GetUnsafePtr(), kClusterCount * sizeof(int));
+                for (int i = 0; i < block.lightCount; i++)
+                {
+                    if (lightSlot[i] < 0)
+                        continue;
+                    float lightTexel = kClusterCount + lightSlot[i] * 2;
+                    for (int z = boundsMin[i].z; z <= boundsMax[i].z; z++)
+                        for (int y = boundsMin[i].y; y <= boundsMax[i].y; y++)
+                            for (int x = boundsMin[i].x; x <= boundsMax[i].x; x++)
+                            {
+                                int ci = x + kTilesX * (y + kTilesY * z);
+                                int n = counts[ci];
+                                if (n >= kMaxLightsPerCluster)
+                                    continue;
+                                ((float*)(texels + runStart[ci]))[n] = lightTexel;
+                                counts[ci] = n + 1;
+                            }
+                }
+
+                Views[block.clusterIndex * 256 + block.viewId] = new LightClusterViewBGFX {
+                    projX = new float4(proj.c0.x, proj.c1.x, proj.c2.x, proj.c3.x),
+                    projY = new float4(proj.c0.y, proj.c1.y, proj.c2.y, proj.c3.y),
+                    projW = new float4(proj.c0.w, proj.c1.w, proj.c2.w, proj.c3.w),
+                    grid = new float4(kTilesX, kTilesY, kSlices, 1.0f),
+                    depth = new float4(near, sliceScale, logSlices ? 1.0f : 0.0f, 0.0f),
+                    location = new float4(blockBase, 1.0f / FrameDataTextureBGFX.kWidth, 0.0f, FrameDataTextureBGFX.kWidth) // 1/height is known after upload
+                };
+            }
+        }
+    }
+
+    // Builds the light grids for all lighting setups with clustered lights, for every view that draws lit meshes.
+    // Everything goes into RendererBGFXInstance.m_lightCluster with one texture update per frame.
+    [UpdateInGroup(typeof(PresentationSystemGroup))]
+    [UpdateAfter(typeof(UpdateBGFXLightSetups))]
+    [UpdateAfter(typeof(PreparePassesSystem))]
+    [UpdateBefore(typeof(SubmitSystemGroup))]
+    public unsafe class UpdateBGFXLightClusters : SystemBase
+    {
+        EntityQuery m_passQuery;
+        bool m_loggedTooManySetups;
+
+        protected override void OnCreate()
+        {
+            m_passQuery = GetEntityQuery(ComponentType.ReadOnly<RenderPass>());
+        }
+
+        protected override void OnUpdate()
+        {
+            var sys = World.GetExistingSystem<RendererBGFXSystem>().InstancePointer();
+            if (!sys->m_lightClusterSupported)
+                return;
+            Dependency.Complete();
+
+            var di = GetSingleton<DisplayInfo>();
+            bool srgbColors = di.colorSpace==ColorSpace.Gamma;
+
+            var passes = m_passQuery.ToComponentDataArray<RenderPass>(Allocator.TempJob);
+            var blocks = new NativeList<LightClusterBlock>(Allocator.TempJob);
+            var lightPosRange = new NativeList<float4>(Allocator.TempJob);
+            var lightColor = new NativeList<float4>(Allocator.TempJob);
+            int nSetups = 0;
+            Entities.WithoutBurst().ForEach((Entity e, ref LightingBGFX r, in DynamicBuffer<ClusteredLight> clustered) => {
+                if ( clustered.Length == 0 )
+                    return;
+                if ( nSetups >= RendererBGFXInstance.kMaxLightClusterSetups ) {
+                    if ( !m_loggedTooManySetups ) {
+                        RenderDebug.LogFormatAlways("More than {0} lighting setups with clustered lights, the clustered lights of the others are not drawn.", RendererBGFXInstance.kMaxLightClusterSetups);
+                        m_loggedTooManySetups = true;
+                    }
+                    return;
+                }
+                r.clusterIndex = nSetups++;
+                int firstLight = lightPosRange.Length;
+                for ( int i=0; i<clustered.Length; i++ ) {
+                    Light l = EntityManager.GetComponentData<Light>(clustered[i].e);
+                    LocalToWorld tx = EntityManager.GetComponentData<LocalToWorld>(clustered[i].e);
+                    float3 c = srgbColors?Color.LinearToSRGB(l.color) :l.color;
+                    lightPosRange.Add(new float4(tx.Value.c3.xyz, l.clipZFar));
+                    lightColor.Add(new float4(c * l.intensity, 0.0f));
+                }
+                for ( int i=0; i<passes.Length; i++ ) {
+                    if ( (passes[i].passType & (RenderPassType.Opaque | RenderPassType.Transparent)) == 0 )
+                        continue;
+                    blocks.Add(new LightClusterBlock {
+                        clusterIndex = r.clusterIndex,
+                        viewId = passes[i].viewId,
+                        projection = passes[i].projectionTransform,
+                        view = passes[i].viewTransform,
+                        firstLight = firstLight,
+                        lightCount = clustered.Length
+                    });
+                }
+            }).Run();
+            passes.Dispose();
+
+            if ( nSetups > 0 ) {
+                // views that are not built this frame must not read last frame's grids
+                UnsafeUtility.MemClear(sys->m_lightClusterViews, nSetups * 256 * sizeof(LightClusterViewBGFX));
+                var texels = new NativeList<float4>(Allocator.TempJob);
+                new BuildLightClustersJob {
+                    Blocks = blocks,
+                    LightPosRange = lightPosRange,
+                    LightColor = lightColor,
+                    Texels = texels,
+                    Views = sys->m_lightClusterViews
+                }.Run();
+                if ( texels.Length > 0 ) {
+                    int rows = sys->m_lightCluster.Reserve(texels.Length);
+                    bgfx.Memory* mem = bgfx.alloc((uint)(rows * FrameDataTextureBGFX.kWidth * sizeof(float4)));
+                    UnsafeUtility.MemCpy(mem->data, texels.GetUnsafePtr(), texels.Length * sizeof(float4));
+                    UnsafeUtility.MemClear(mem->data + texels.Length * sizeof(float4), (rows * FrameDataTextureBGFX.kWidth - texels.Length) * sizeof(float4));
+                    sys->m_lightCluster.Update(mem, rows);
+                    for ( int i=0; i<blocks.Length; i++ )
+                        sys->m_lightClusterViews[blocks[i].clusterIndex * 256 + blocks[i].viewId].location.z = 1.0f / sys->m_lightCluster.height;
+                }
+                texels.Dispose();
+            }
+            blocks.Dispose();
+            lightPosRange.Dispose();
+            lightColor.Dispose();
+        }
+    }
 }
@@ -4,6 +4,7 @@ using Bgfx;
 using System.Runtime.CompilerServices;
 using Unity.Collections;
 using Unity.Collections.LowLevel.Unsafe;
+using Unity.Mathematics;
 
 #if ENABLE_DOTSRUNTIME_PROFILER
 using Unity.Development.Profiling;
@@ -28,10 +29,11 @@ namespace Unity.Tiny.Rendering
         [MethodImpl(MethodImplOptions.AggressiveInlining)]
         public bool IsValidFor(DynamicMeshData dmd)
         {
+            // the shared dynamic buffers fit whatever the meshes in them need, capacities do not matter
+            if (dmd.UseDynamicGPUBuffer || isDynamic)
+                return dmd.UseDynamicGPUBuffer == isDynamic;
             if (!IsValid())
                 return false;
-            if (dmd.UseDynamicGPUBuffer != isDynamic)
-                return false;
             if (dmd.IndexCapacity != maxIndexCount)
                 return false;
             if (dmd.VertexCapacity != maxVertexCount)
@@ -74,8 +76,9 @@ namespace Unity.Tiny.Rendering
             Assert.IsTrue(startIndex >= 0 && actualIndexCount + startIndex <= indexCount);
             if (isDynamic)
             {
-                bgfx.encoder_set_dynamic_index_buffer(encoder, GetDynamicIndexBufferHandle(), (uint)startIndex, (uint)actualIndexCount);
-                bgfx.encoder_set_dynamic_vertex_buffer(encoder, 0, GetDynamicVertexBufferHandle(), 0, (uint)vertexCount, vertexLayoutHandle);
+                // indices are relative to the first vertex of the mesh, bgfx applies it as base vertex
+                bgfx.encoder_set_dynamic_index_buffer(encoder, GetDynamicIndexBufferHandle(), (uint)(firstIndex + startIndex), (uint)actualIndexCount);
+                bgfx.encoder_set_dynamic_vertex_buffer(encoder, 0, GetDynamicVertexBufferHandle(), (uint)firstVertex, (uint)vertexCount, vertexLayoutHandle);
             }
             else
             {
@@ -112,13 +115,17 @@ namespace Unity.Tiny.Rendering
         {
 #if ENABLE_DOTSRUNTIME_PROFILER
             ProfilerStats.AccumStats.memMeshCount.Accumulate(-1);
-            long bytesReserved = maxVertexCount * vertexSize + maxIndexCount * sizeof(ushort);
-            ProfilerStats.AccumStats.memMesh.Accumulate(-bytesReserved);
-            ProfilerStats.AccumStats.memReservedGFX.Accumulate(-bytesReserved);
-            long bytesUsed = vertexCount * vertexSize + indexCount * sizeof(ushort);
-            ProfilerStats.AccumStats.memUsedGFX.Accumulate(-bytesUsed);
+            if (!isDynamic)
+            {
+                long bytesReserved = maxVertexCount * vertexSize + maxIndexCount * sizeof(ushort);
+                ProfilerStats.AccumStats.memMesh.Accumulate(-bytesReserved);
+                ProfilerStats.AccumStats.memReservedGFX.Accumulate(-bytesReserved);
+                long bytesUsed = vertexCount * vertexSize + indexCount * sizeof(ushort);
+                ProfilerStats.AccumStats.memUsedGFX.Accumulate(-bytesUsed);
+            }
 #endif
 
+            // the buffers of dynamic meshes belong to SharedDynamicMeshBuffersBGFX
             if (!isDynamic)
             {
                 if (indexBufferHandle != 0xffff)
@@ -126,101 +133,28 @@ namespace Unity.Tiny.Rendering
                 if (vertexBufferHandle != 0xffff)
                     bgfx.destroy_vertex_buffer(GetVertexBufferHandle());
             }
-            else
-            {
-                if (indexBufferHandle != 0xffff)
-                    bgfx.destroy_dynamic_index_buffer(GetDynamicIndexBufferHandle());
-                if (vertexBufferHandle != 0xffff)
-                    bgfx.destroy_dynamic_vertex_buffer(GetDynamicVertexBufferHandle());
-            }
 
             this = CreateEmpty();
         }
 
-        public static unsafe MeshBGFX CreateDynamicMeshLit(RendererBGFXInstance* inst, int maxVertices, int maxIndices, bool hasSkinningData)
-        {
-            Assert.IsTrue(maxVertices <= 0x10000 && maxVertices > 0 && maxIndices > 0 && maxIndices <= 0xf0000);
-#if ENABLE_DOTSRUNTIME_PROFILER
-            ProfilerStats.AccumStats.memMeshCount.Accumulate(1);
-            long bytes = maxVertices * sizeof(LitVertex) + maxIndices * sizeof(ushort);
-            if (hasSkinningData)
-                bytes += maxVertices * sizeof(SkinnedMeshVertex);
-            ProfilerStats.AccumStats.memMesh.Accumulate(bytes);
-            ProfilerStats.AccumStats.memReservedGFX.Accumulate(bytes);
-#endif
-            if (hasSkinningData)
-            {
-                return new MeshBGFX
-                {
-                    maxVertexCount = maxVertices,
-                    maxIndexCount = maxIndices,
-                    vertexCount = 0,
-                    indexCount = 0,
-                    vertexBufferHandle = bgfx.create_dynamic_vertex_buffer((uint)maxVertices, &inst->m_litSkinnedVertexBufferDecl, (ushort)bgfx.BufferFlags.None).idx,
-                    indexBufferHandle = bgfx.create_dynamic_index_buffer((uint)maxIndices, (ushort)bgfx.BufferFlags.None).idx,
-                    vertexLayoutHandle = inst->m_litSkinnedVertexBufferDeclHandle,
-                    isDynamic = true,
-                    vertexSize = sizeof(LitVertex) + sizeof(SkinnedMeshVertex),
-                };
-            }
-            else
-            {
-                return new MeshBGFX
-                {
-                    maxVertexCount = maxVertices,
-                    maxIndexCount = maxIndices,
-                    vertexCount = 0,
-                    indexCount = 0,
-                    vertexBufferHandle = bgfx.create_dynamic_vertex_buffer((uint)maxVertices, &inst->m_litVertexBufferDecl, (ushort)bgfx.BufferFlags.None).idx,
-                    indexBufferHandle = bgfx.create_dynamic_index_buffer((uint)maxIndices, (ushort)bgfx.BufferFlags.None).idx,
-                    vertexLayoutHandle = inst->m_litVertexBufferDeclHandle,
-                    isDynamic = true,
-                    vertexSize = sizeof(LitVertex),
-                };
-            }
-        }
-
-        public static unsafe MeshBGFX CreateDynamicMeshSimple(RendererBGFXInstance* inst, int maxVertices, int maxIndices, bool hasSkinningData)
+        // dynamic meshes only hold a range of the buffers shared by all of them, see SharedDynamicMeshBuffersBGFX
+        public static MeshBGFX CreateInSharedBuffers(bgfx.DynamicVertexBufferHandle vb, bgfx.DynamicIndexBufferHandle ib, bgfx.VertexLayoutHandle layout, int vertexSize,
+            int firstVertex, int numVertices, int firstIndex, int numIndices)
         {
-            Assert.IsTrue(maxVertices <= 0x10000 && maxVertices > 0 && maxIndices > 0 && maxIndices <= 0xf0000);
-#if ENABLE_DOTSRUNTIME_PROFILER
-            ProfilerStats.AccumStats.memMeshCount.Accumulate(1);
-            long bytes = maxVertices * sizeof(SimpleVertex) + maxIndices * sizeof(ushort);
-            if (hasSkinningData)
-                bytes += maxVertices * sizeof(SkinnedMeshVertex);
-            ProfilerStats.AccumStats.memMesh.Accumulate(bytes);
-            ProfilerStats.AccumStats.memReservedGFX.Accumulate(bytes);
-#endif
-            if (hasSkinningData)
-            {
-                return new MeshBGFX
-                {
-                    maxVertexCount = maxVertices,
-                    maxIndexCount = maxIndices,
-                    vertexCount = 0,
-                    indexCount = 0,
-                    vertexBufferHandle = bgfx.create_dynamic_vertex_buffer((uint)maxVertices, &inst->m_simpleSkinnedVertexBufferDecl, (ushort)bgfx.BufferFlags.None).idx,
-                    indexBufferHandle = bgfx.create_dynamic_index_buffer((uint)maxIndices, (ushort)bgfx.BufferFlags.None).idx,
-                    vertexLayoutHandle = inst->m_simpleSkinnedVertexBufferDeclHandle,
-                    isDynamic = true,
-                    vertexSize = sizeof(SimpleVertex) + sizeof(SkinnedMeshVertex),
-                };
-            }
-            else
+            return new MeshBGFX
             {
-                return new MeshBGFX
-                {
-                    maxVertexCount = maxVertices,
-                    maxIndexCount = maxIndices,
-                    vertexCount = 0,
-                    indexCount = 0,
-                    vertexBufferHandle = bgfx.create_dynamic_vertex_buffer((uint)maxVertices, &inst->m_simpleVertexBufferDecl, (ushort)bgfx.BufferFlags.None).idx,
-                    indexBufferHandle = bgfx.create_dynamic_index_buffer((uint)maxIndices, (ushort)bgfx.BufferFlags.None).idx,
-                    vertexLayoutHandle = inst->m_simpleVertexBufferDeclHandle,
-                    isDynamic = true,
-                    vertexSize = sizeof(SimpleVertex),
-                };
-            }
+                maxVertexCount = numVertices,
+                maxIndexCount = numIndices,
+                vertexCount = numVertices,
+                indexCount = numIndices,
+                firstVertex = firstVertex,
+                firstIndex = firstIndex,
+                vertexBufferHandle = vb.idx,
+                indexBufferHandle = ib.idx,
+                vertexLayoutHandle = layout,
+                isDynamic = true,
+                vertexSize = vertexSize,
+            };
         }
 
         public static unsafe MeshBGFX CreateStaticMesh(RendererBGFXInstance* inst, ushort* indices, int nindices, SimpleVertex* vertices, int nvertices, SkinnedMeshVertex* skinningdata = null)
@@ -276,13 +210,27 @@ namespace Unity.Tiny.Rendering
             }
         }
 
+        // the simplified levels of detail are drawn from the same index buffer, right after the full detail indices
+        static unsafe ushort* AppendLODIndices(ref BlobArray<ushort> indices, ref BlobArray<ushort> lodIndices, out int nindices)
+        {
+            nindices = indices.Length + lodIndices.Length;
+            ushort* all = (ushort*)UnsafeUtility.Malloc(nindices * sizeof(ushort), 4, Allocator.Temp);
+            UnsafeUtility.MemCpy(all, indices.GetUnsafePtr(), indices.Length * sizeof(ushort));
+            UnsafeUtility.MemCpy(all + indices.Length, lodIndices.GetUnsafePtr(), lodIndices.Length * sizeof(ushort));
+            return all;
+        }
+
         public static unsafe MeshBGFX CreateStaticMeshFromBlobAsset(RendererBGFXInstance* inst, SimpleMeshRenderData meshData)
         {
-            ushort* indices = (ushort*)meshData.Mesh.Value.Indices.GetUnsafePtr();
-            SimpleVertex* vertices = (SimpleVertex*)meshData.Mesh.Value.Vertices.GetUnsafePtr();
-            int nindices = meshData.Mesh.Value.Indices.Length;
-            int nvertices = meshData.Mesh.Value.Vertices.Length;
-            return CreateStaticMesh(inst, indices, nindices, vertices, nvertices);
+            ref SimpleMeshData data = ref meshData.Mesh.Value;
+            SimpleVertex* vertices = (SimpleVertex*)data.Vertices.GetUnsafePtr();
+            int nvertices = data.Vertices.Length;
+            if (data.LODIndices.Length == 0)
+                return CreateStaticMesh(inst, (ushort*)data.Indices.GetUnsafePtr(), data.Indices.Length, vertices, nvertices);
+            ushort* indices = AppendLODIndices(ref data.Indices, ref data.LODIndices, out int nindices);
+            var mesh = CreateStaticMesh(inst, indices, nindices, vertices, nvertices);
+            UnsafeUtility.Free(indices, Allocator.Temp);
+            return mesh;
         }
 
         public static unsafe MeshBGFX CreateStaticSkinnedMeshFromBlobAsset(RendererBGFXInstance* inst,
@@ -357,11 +305,15 @@ namespace Unity.Tiny.Rendering
 
         public static unsafe MeshBGFX CreateStaticMeshFromBlobAsset(RendererBGFXInstance* inst, LitMeshRenderData mesh)
         {
-            ushort* indices = (ushort*)mesh.Mesh.Value.Indices.GetUnsafePtr();
-            int nindices = mesh.Mesh.Value.Indices.Length;
-            LitVertex* vertices = (LitVertex*)mesh.Mesh.Value.Vertices.GetUnsafePtr();
-            int nvertices = mesh.Mesh.Value.Vertices.Length;
-            return CreateStaticMesh(inst, indices, nindices, vertices, nvertices);
+            ref LitMeshData data = ref mesh.Mesh.Value;
+            LitVertex* vertices = (LitVertex*)data.Vertices.GetUnsafePtr();
+            int nvertices = data.Vertices.Length;
+            if (data.LODIndices.Length == 0)
+                return CreateStaticMesh(inst, (ushort*)data.Indices.GetUnsafePtr(), data.Indices.Length, vertices, nvertices);
+            ushort* indices = AppendLODIndices(ref data.Indices, ref data.LODIndices, out int nindices);
+            var result = CreateStaticMesh(inst, indices, nindices, vertices, nvertices);
+            UnsafeUtility.Free(indices, Allocator.Temp);
+            return result;
         }
 
         public static unsafe MeshBGFX CreateStaticSkinnedMeshFromBlobAsset(RendererBGFXInstance* inst,
@@ -375,22 +327,6 @@ namespace Unity.Tiny.Rendering
             return CreateStaticMesh(inst, indices, nindices, vertices, nvertices, skinningdata);
         }
 
-        public unsafe void UpdateDynamic(ushort* indexSrc, int numIndices, byte* vertexSrc, int numVertices, int sizeofVertex)
-        {
-            Assert.IsTrue(isDynamic);
-            Assert.IsTrue(numVertices <= maxVertexCount);
-            Assert.IsTrue(numIndices <= maxIndexCount);
-#if ENABLE_DOTSRUNTIME_PROFILER
-            Assert.IsTrue(vertexSize == sizeofVertex);
-            ProfilerStats.AccumStats.memUsedGFX.Accumulate(-(vertexCount * vertexSize + indexCount * sizeof(ushort)));
-            ProfilerStats.AccumStats.memUsedGFX.Accumulate(numVertices * vertexSize + numIndices * sizeof(ushort));
-#endif
-            bgfx.update_dynamic_index_buffer(GetDynamicIndexBufferHandle(), 0, RendererBGFXStatic.CreateMemoryBlock((byte*)indexSrc, numIndices * 2));
-            indexCount = numIndices;
-            bgfx.update_dynamic_vertex_buffer(GetDynamicVertexBufferHandle(), 0, RendererBGFXStatic.CreateMemoryBlock(vertexSrc, numVertices * sizeofVertex));
-            vertexCount = numVertices;
-        }
-
         public int IndexCapacity => maxIndexCount;
         public int VertexCapacity => maxVertexCount;
 
@@ -403,8 +339,205 @@ namespace Unity.Tiny.Rendering
         private int maxIndexCount;
         private int vertexCount;
         private int maxVertexCount;
+        private int firstVertex;   // dynamic only, range in the shared buffers
+        private int firstIndex;
         private bgfx.VertexLayoutHandle vertexLayoutHandle;
         private bool isDynamic;
         private int vertexSize;  // For tracking memory usage
     }
+
+    // All dynamic meshes with a dynamic gpu buffer share one dynamic vertex buffer per vertex layout and one index buffer.
+    // Nothing is written in frames where none of them changed. Otherwise all of them are copied again back to back from
+    // the start into frame memory, which is uploaded with one update per buffer. Buffers only ever grow, to half again
+    // what was needed, so meshes that change size every frame do not create or destroy anything.
+    internal unsafe struct SharedDynamicMeshBuffersBGFX
+    {
+        public const int kSimple = 0;
+        public const int kSimpleSkinned = 1;
+        public const int kLit = 2;
+        public const int kLitSkinned = 3;
+        public const int kLayoutCount = 4;
+
+        const int kMinVertices = 4096;
+        const int kMinIndices = 3 * 4096;
+
+        fixed ushort m_vertexBuffers[kLayoutCount];
+        fixed int m_vertexCapacity[kLayoutCount];
+        fixed int m_vertexNeeded[kLayoutCount];
+        fixed int m_vertexWritten[kLayoutCount];
+        fixed long m_vertexMemory[kLayoutCount]; // bgfx.Memory* while writing
+        bgfx.DynamicIndexBufferHandle m_indexBuffer;
+        int m_indexCapacity;
+        int m_indexNeeded;
+        int m_indexWritten;
+        bgfx.Memory* m_indexMemory;
+        RendererBGFXInstance* m_inst;
+
+        public int bytesLastWrite;  // vertex and index bytes of the last frame that wrote the buffers
+        public int bytesHighWater;
+        public int bytesCapacity;
+        public int grows;
+
+        public static int Layout(bool lit, bool skinned)
+        {
+            return lit ? (skinned ? kLitSkinned : kLit) : (skinned ? kSimpleSkinned : kSimple);
+        }
+
+        public static int VertexSize(int layout)
+        {
+            switch (layout)
+            {
+                case kSimple: return sizeof(SimpleVertex);
+                case kSimpleSkinned: return sizeof(SimpleVertex) + sizeof(SkinnedMeshVertex);
+                case kLit: return sizeof(LitVertex);
+                default: return sizeof(LitVertex) + sizeof(SkinnedMeshVertex);
+            }
+        }
+
+        static void GetLayout(RendererBGFXInstance* inst, int layout, out bgfx.VertexLayout* decl, out bgfx.VertexLayoutHandle handle)
+        {
+            switch (layout)
+            {
+                case kSimple: decl = &inst->m_simpleVertexBufferDecl; handle = inst->m_simpleVertexBufferDeclHandle; break;
+                case kSimpleSkinned: decl = &inst->m_simpleSkinnedVertexBufferDecl; handle = inst->m_simpleSkinnedVertexBufferDeclHandle; break;
+                case kLit: decl = &inst->m_litVertexBufferDecl; handle = inst->m_litVertexBufferDeclHandle; break;
+                default: decl = &inst->m_litSkinnedVertexBufferDecl; handle = inst->m_litSkinnedVertexBufferDeclHandle; break;
+            }
+        }
+
+        void AddCapacity(int bytes)
+        {
+            bytesCapacity += bytes;
+#if ENABLE_DOTSRUNTIME_PROFILER
+            ProfilerStats.AccumStats.memMesh.Accumulate(bytes);
+            ProfilerStats.AccumStats.memReservedGFX.Accumulate(bytes);
+#endif
+        }
+
+        // counts a mesh for the next Begin, every dynamic mesh has to be reserved every frame
+        public void Reserve(int layout, int numVertices, int numIndices)
+        {
+            m_vertexNeeded[layout] += numVertices;
+            m_indexNeeded += numIndices;
+        }
+
+        // drops what was reserved when nothing is written this frame
+        public void Skip()
+        {
+            for (int i = 0; i < kLayoutCount; i++)
+                m_vertexNeeded[i] = 0;
+            m_indexNeeded = 0;
+        }
+
+        // grows the buffers to what was reserved and allocates the frame memory to write into
+        public void Begin(RendererBGFXInstance* inst)
+        {
+            m_inst = inst;
+            int bytes = 0;
+            for (int i = 0; i < kLayoutCount; i++)
+            {
+                int needed = m_vertexNeeded[i];
+                m_vertexWritten[i] = 0;
+                m_vertexMemory[i] = 0;
+                if (needed == 0)
+                    continue;
+                if (needed > m_vertexCapacity[i])
+                {
+                    if (m_vertexCapacity[i] > 0)
+                        bgfx.destroy_dynamic_vertex_buffer(new bgfx.DynamicVertexBufferHandle { idx = m_vertexBuffers[i] });
+                    int capacity = math.max(kMinVertices, needed + needed / 2);
+                    AddCapacity((capacity - m_vertexCapacity[i]) * VertexSize(i));
+                    m_vertexCapacity[i] = capacity;
+                    GetLayout(inst, i, out var decl, out var handle);
+                    m_vertexBuffers[i] = bgfx.create_dynamic_vertex_buffer((uint)m_vertexCapacity[i], decl, (ushort)bgfx.BufferFlags.None).idx;
+                    grows++;
+                }
+                m_vertexMemory[i] = (long)RendererBGFXStatic.AllocFrameMemoryBlock(needed * VertexSize(i));
+                bytes += needed * VertexSize(i);
+            }
+            m_indexWritten = 0;
+            m_indexMemory = null;
+            if (m_indexNeeded > 0)
+            {
+                if (m_indexNeeded > m_indexCapacity)
+                {
+                    if (m_indexCapacity > 0)
+                        bgfx.destroy_dynamic_index_buffer(m_indexBuffer);
+                    int capacity = math.max(kMinIndices, m_indexNeeded + m_indexNeeded / 2);
+                    AddCapacity((capacity - m_indexCapacity) * sizeof(ushort));
+                    m_indexCapacity = capacity;
+                    m_indexBuffer = bgfx.create_dynamic_index_buffer((uint)m_indexCapacity, (ushort)bgfx.BufferFlags.None);
+                    grows++;
+                }
+                m_indexMemory = RendererBGFXStatic.AllocFrameMemoryBlock(m_indexNeeded * sizeof(ushort));
+                bytes += m_indexNeeded * sizeof(ushort);
+            }
+            bytesLastWrite = bytes;
+            bytesHighWater = math.max(bytesHighWater, bytes);
+        }
+
+        // copies one mesh behind the ones written so far, skinning data is interleaved after each vertex when there is some
+        public MeshBGFX Write(int layout, byte* vertices, int sizeofVertex, SkinnedMeshVertex* skinning, int numVertices, ushort* indices, int numIndices)
+        {
+            Assert.IsTrue(m_vertexWritten[layout] + numVertices <= m_vertexNeeded[layout] && m_indexWritten + numIndices <= m_indexNeeded);
+            int stride = VertexSize(layout);
+            if (numVertices > 0)
+            {
+                byte* dest = ((bgfx.Memory*)m_vertexMemory[layout])->data + m_vertexWritten[layout] * stride;
+                if (skinning != null)
+                {
+                    UnsafeUtility.MemCpyStride(dest, stride, vertices, sizeofVertex, sizeofVertex, numVertices);
+                    UnsafeUtility.MemCpyStride(dest + sizeofVertex, stride, skinning, sizeof(SkinnedMeshVertex), sizeof(SkinnedMeshVertex), numVertices);
+                }
+                else
+                {
+                    Assert.IsTrue(sizeofVertex == stride);
+                    UnsafeUtility.MemCpy(dest, vertices, numVertices * stride);
+                }
+            }
+            if (numIndices > 0)
+                UnsafeUtility.MemCpy(m_indexMemory->data + m_indexWritten * sizeof(ushort), indices, numIndices * sizeof(ushort));
+
+            // meshes without vertices or indices can get here before any buffer exists
+            GetLayout(m_inst, layout, out _, out var handle);
+            var vb = new bgfx.DynamicVertexBufferHandle { idx = m_vertexCapacity[layout] > 0 ? m_vertexBuffers[layout] : (ushort)0xffff };
+            var ib = new bgfx.DynamicIndexBufferHandle { idx = m_indexCapacity > 0 ? m_indexBuffer.idx : (ushort)0xffff };
+            var mesh = MeshBGFX.CreateInSharedBuffers(vb, ib, handle, stride, m_vertexWritten[layout], numVertices, m_indexWritten, numIndices);
+            m_vertexWritten[layout] += numVertices;
+            m_indexWritten += numIndices;
+            return mesh;
+        }
+
+        // uploads everything written since Begin
+        public void End()
+        {
+            for (int i = 0; i < kLayoutCount; i++)
+            {
+                Assert.IsTrue(m_vertexWritten[i] == m_vertexNeeded[i]);
+                if (m_vertexMemory[i] != 0)
+                    bgfx.update_dynamic_vertex_buffer(new bgfx.DynamicVertexBufferHandle { idx = m_vertexBuffers[i] }, 0, (bgfx.Memory*)m_vertexMemory[i]);
+                m_vertexMemory[i] = 0;
+            }
+            Assert.IsTrue(m_indexWritten == m_indexNeeded);
+            if (m_indexMemory != null)
+                bgfx.update_dynamic_index_buffer(m_indexBuffer, 0, m_indexMemory);
+            m_indexMemory = null;
+            Skip();
+        }
+
+        public void Destroy()
+        {
+            for (int i = 0; i < kLayoutCount; i++)
+            {
+                if (m_vertexCapacity[i] > 0)
+                    bgfx.destroy_dynamic_vertex_buffer(new bgfx.DynamicVertexBufferHandle { idx = m_vertexBuffers[i] });
+                m_vertexCapacity[i] = 0;
+            }
+            if (m_indexCapacity > 0)
+                bgfx.destroy_dynamic_index_buffer(m_indexBuffer);
+            m_indexCapacity = 0;
+            AddCapacity(-bytesCapacity);
+            Skip();
+        }
+    }
 }
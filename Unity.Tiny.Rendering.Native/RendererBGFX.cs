@@ -49,6 +49,28 @@ namespace Unity.Tiny.Rendering
         public abstract void Shutdown();
         public abstract void Resume();
         public abstract void ReloadAllImages();
+
+        // culling counters of the last submitted frame
+        public abstract CullingStats GetCullingStats();
+
+        // lit material and lighting uniforms set and skipped as unchanged in the last submitted frame
+        public abstract void GetLitUniformStats(out int set, out int skipped);
+
+        // shadow map passes rendered and kept from an earlier frame, and shadow caster draws, in the last submitted frame
+        public abstract void GetShadowStats(out int passesRendered, out int passesCached, out int draws);
+
+        // sprites submitted and the draws they took after batching, in the last submitted frame
+        public abstract void GetSpriteBatchStats(out int sprites, out int draws);
+
+        // images placed in the shared atlas pages, the pages, and how often a page was repacked to make room
+        public abstract void GetTextureAtlasStats(out int images, out int pages, out int repacks);
+
+        // bytes of dynamic mesh data written to the shared dynamic buffers the last time one changed, the most written
+        // at once, the size of the buffers and how often one of them had to grow
+        public abstract void GetDynamicMeshStats(out int bytesLastWrite, out int bytesHighWater, out int bytesCapacity, out int grows);
+
+        // triangles of static meshes drawn at each level of detail in the last submitted frame, x is full detail
+        public abstract int4 GetMeshLODStats();
     }
 
     internal struct TextureBGFX : ISystemStateComponentData
@@ -67,10 +89,35 @@ namespace Unity.Tiny.Rendering
         public bgfx.FrameBufferHandle handle;
     }
 
+    // lit draw state last set on one thread's encoder, see SubmitHelper.EncodeLitUniforms
+    internal struct LitUniformCacheBGFX
+    {
+        public uint stateKey; // 0 when nothing is cached
+        public ushort viewId;
+        public ushort program;
+        public int uniformsSet;
+        public int uniformsSkipped;
+    }
+
     internal unsafe struct PerThreadDataBGFX
     {
         public LightingViewSpaceBGFX viewSpaceLightCache;
         public bgfx.Encoder *encoder;
+        public LitUniformCacheBGFX litUniformCache; // reset when the encoder ends
+        public CullingStats cullingStats; // this frame so far, summed up in CollectFrameStats
+        public int shadowDraws;           // same
+        public int4 lodTriangles;         // same
+
+        // begins the encoder of this thread on first use, they all end together in WaitForEncoders
+        public bgfx.Encoder* GetEncoder()
+        {
+            if (encoder == null)
+            {
+                encoder = bgfx.encoder_begin(true);
+                Assert.IsTrue(encoder != null);
+            }
+            return encoder;
+        }
     }
 
     internal struct ShaderBGFX : ISystemStateComponentData
@@ -104,6 +151,15 @@ namespace Unity.Tiny.Rendering
             return bgfx.copy(mem, (uint)size);
         }
 
+        // for data that is uploaded every frame: memory in the native frame arena instead of a heap block, the caller fills it
+        public static unsafe bgfx.Memory* AllocFrameMemoryBlock(int size)
+        {
+            void* dest = bgfx.AllocatorFrameAlloc(size);
+            if (dest == null)
+                return bgfx.alloc((uint)size);
+            return bgfx.make_ref(dest, (uint)size);
+        }
+
         public static string GetBackendString()
         {
             var backend = bgfx.get_renderer_type();
@@ -179,7 +235,7 @@ namespace Unity.Tiny.Rendering
             }
         }
 
-        public static bgfx.Memory* InitMipMapChain32(int w, int h)
+        public static int MipMapChainPixelCount(int w, int h)
         {
             int countPixels = w * h;
             int wl = w, hl = h;
@@ -190,7 +246,12 @@ namespace Unity.Tiny.Rendering
                 countPixels += wl * hl;
                 if (wl == 1 && hl == 1) break;
             }
-            return bgfx.alloc((uint)countPixels * 4);
+            return countPixels;
+        }
+
+        public static bgfx.Memory* InitMipMapChain32(int w, int h)
+        {
+            return bgfx.alloc((uint)MipMapChainPixelCount(w, h) * 4);
         }
 
         public static bgfx.Memory* CreateMipMapChain32(int w, int h, uint* src, bool srgb)
@@ -202,6 +263,14 @@ namespace Unity.Tiny.Rendering
             return r;
         }
 
+        public static bgfx.Memory* CreateMipMapChain8(int w, int h, byte* src)
+        {
+            bgfx.Memory* r = bgfx.alloc((uint)MipMapChainPixelCount(w, h));
+            UnsafeUtility.MemCpy(r->data, src, w * h);
+            MipMapHelper.FillMipMapChain8(w, h, r->data);
+            return r;
+        }
+
 #if RENDERING_ENABLE_TRACE
         public static string BGFXSamplerFlagsToString(ulong flags)
         {
@@ -233,6 +302,61 @@ namespace Unity.Tiny.Rendering
     // ---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
     // ---------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
+    // A RGBA32F texture that is rewritten from the start every frame, for data the shaders look up by texel index.
+    // It only grows, the old texture is only released by bgfx after the frames using it are done.
+    internal unsafe struct FrameDataTextureBGFX
+    {
+        public const int kWidth = 1024; // power of two, the shaders rely on it
+
+        public bgfx.TextureHandle handle;
+        public int height; // 0 until first used
+
+        // Returns the number of rows needed for texelCount texels and grows the texture to hold them
+        public int Reserve(int texelCount)
+        {
+            int rows = (texelCount + kWidth - 1) / kWidth;
+            if (rows > height)
+            {
+                int newHeight = math.max(height, 16);
+                while (newHeight < rows)
+                    newHeight *= 2;
+                Assert.IsTrue(newHeight <= bgfx.get_caps()->limits.maxTextureSize, "Too much per frame data for a frame data texture.");
+                if (height > 0)
+                    bgfx.destroy_texture(handle);
+                handle = bgfx.create_texture_2d(kWidth, (ushort)newHeight, false, 1, bgfx.TextureFormat.RGBA32F,
+                    (ulong)bgfx.SamplerFlags.UClamp | (ulong)bgfx.SamplerFlags.VClamp |
+                    (ulong)bgfx.SamplerFlags.MinPoint | (ulong)bgfx.SamplerFlags.MagPoint | (ulong)bgfx.SamplerFlags.MipPoint, null);
+                height = newHeight;
+            }
+            return rows;
+        }
+
+        // Uploads the first rows, mem has to hold rows * kWidth texels
+        public void Update(bgfx.Memory* mem, int rows)
+        {
+            Assert.IsTrue(rows > 0 && rows <= height);
+            bgfx.update_texture_2d(handle, 0, 0, 0, 0, kWidth, (ushort)rows, mem, (ushort)(kWidth * sizeof(float4)));
+        }
+
+        public void Destroy()
+        {
+            if (height > 0)
+                bgfx.destroy_texture(handle);
+            height = 0;
+        }
+    }
+
+    // Per view uniforms of a clustered LightingBGFX, see common/simplelit.cginc u_lightCluster
+    internal struct LightClusterViewBGFX
+    {
+        public float4 projX;
+        public float4 projY;
+        public float4 projW;
+        public float4 grid;     // tiles x, tiles y, slices, 1 if enabled
+        public float4 depth;    // near, slice scale, 1 for logarithmic slices
+        public float4 location; // first texel of the cluster block, 1/width, 1/height, width
+    }
+
     internal unsafe struct RendererBGFXInstance
     {
         public bgfx.VertexLayoutHandle m_simpleVertexBufferDeclHandle;
@@ -252,6 +376,19 @@ namespace Unity.Tiny.Rendering
         public bgfx.TextureHandle m_upTexture;
         public bgfx.TextureHandle m_noShadow;
 
+        // bone matrices of all gpu skinned draws in a frame, three texels per bone, see common/skinning.cginc
+        public bool m_bonePaletteSupported;
+        public FrameDataTextureBGFX m_bonePalette;
+
+        // light grids of all lighting setups with clustered lights, one block per setup and view, see UpdateBGFXLightClusters
+        public const int kMaxLightClusterSetups = 4;
+        public bool m_lightClusterSupported;
+        public FrameDataTextureBGFX m_lightCluster;
+        public LightClusterViewBGFX* m_lightClusterViews; // [kMaxLightClusterSetups * 256], indexed by LightingBGFX.clusterIndex * 256 + viewId
+
+        // shared pages for small images tagged with Image2DAtlas, see UploadTextures
+        public TextureAtlasBGFX m_textureAtlas;
+
         public SimpleShader m_simpleShader;
         public SimpleSkinnedMeshShader m_simpleSkinnedMeshShader;
         public LineShader m_lineShader;
@@ -260,12 +397,21 @@ namespace Unity.Tiny.Rendering
         public BlitShader m_blitShader;
         public ShadowMapShader m_shadowMapShader;
         public SkinnedMeshShadowMapShader m_skinnedMeshShadowMapShader;
+        public LitShader m_litInstancedShader;
+        public ShadowMapShader m_shadowMapInstancedShader;
+        public SimpleShader m_simpleParticleInstancedShader;
+        public LitShader m_litParticleInstancedShader;
 
         public MeshBGFX m_quadMesh;
         public AABB m_quadMeshBounds;
+        public SharedDynamicMeshBuffersBGFX m_dynamicMeshBuffers;
 
         public bool m_initialized;
         public bgfx.RendererType m_rendererType;
+        public bool m_shaderCacheOpen;
+        public bool m_instancingSupported;
+        public bool m_captureRequested; // continuous frame capture, applied as a reset flag in ResetIfNeeded
+        public bool m_captureActive;
 
         public bool m_resume;
         public int m_fbWidth;
@@ -275,6 +421,17 @@ namespace Unity.Tiny.Rendering
 
         public int m_maxPerThreadData;
         public PerThreadDataBGFX* m_perThreadData; // base pointer to all decls, needs to be allocated before init
+        public CullingStats m_cullingStats; // last submitted frame
+        public int m_litUniformsSet;
+        public int m_litUniformsSkipped;
+        public int m_shadowDraws;
+        public int m_shadowDrawsDirect;     // this frame so far, from main thread submits that have no per thread data
+        public int4 m_lodTriangles;
+        public int4 m_lodTrianglesDirect;   // same
+        public int m_shadowPassesRendered;  // set by UpdateBGFXShadowMapCache
+        public int m_shadowPassesCached;
+        public int m_spritesSubmitted;      // set by the 2D sprite submit system
+        public int m_spriteDraws;
 
         public uint m_persistentFlags;
         public uint m_frameFlags;
@@ -384,6 +541,24 @@ namespace Unity.Tiny.Rendering
 #endif
         }
 
+        // bgfx scopes only go through the managed callbacks while a profiler is connected, recording them
+        // for a trace file does not need them
+        private bool m_profilerForwarding;
+
+        public void UpdateProfilerForwarding()
+        {
+            bool enabled = PlayerConnectionProfiler.Enabled;
+            if (enabled == m_profilerForwarding)
+                return;
+            m_profilerForwarding = enabled;
+#if !UNITY_WEBGL
+            // the render thread has to wait for its next root scope again, see ProfilerBeginCallbackFunc
+            if (enabled)
+                s_profilerInit.Data.m_renderThreadInitialized = false;
+#endif
+            bgfx.ProfilerSetForwarding(enabled ? 1 : 0);
+        }
+
         static class Managed {
             public static bgfx.ProfilerBeginCallback m_profilerBeginCallback = ProfilerBeginCallbackFunc;
 
@@ -434,6 +609,8 @@ namespace Unity.Tiny.Rendering
             bgfx.destroy_texture(m_blackTexture);
             bgfx.destroy_texture(m_upTexture);
             bgfx.destroy_texture(m_noShadow);
+            m_bonePalette.Destroy();
+            m_lightCluster.Destroy();
             m_simpleShader.Destroy();
             m_litShader.Destroy();
             m_litSkinnedMeshShader.Destroy();
@@ -441,13 +618,26 @@ namespace Unity.Tiny.Rendering
             m_blitShader.Destroy();
             m_shadowMapShader.Destroy();
             m_skinnedMeshShadowMapShader.Destroy();
+            m_litInstancedShader.Destroy();
+            m_shadowMapInstancedShader.Destroy();
+            m_simpleParticleInstancedShader.Destroy();
+            m_litParticleInstancedShader.Destroy();
             m_quadMesh.Destroy();
+            m_dynamicMeshBuffers.Destroy();
             bgfx.shutdown();
+            if (m_shaderCacheOpen)
+            {
+                int hits, misses, writes, entries;
+                bgfx.ShaderCacheStats(&hits, &misses, &writes, &entries);
+                RenderDebug.LogFormat("Shader cache: {0} hits, {1} misses, {2} programs written, {3} programs stored.", hits, misses, writes, entries);
+                bgfx.ShaderCacheClose();
+                m_shaderCacheOpen = false;
+            }
             MipMapHelper.Shutdown();
             m_initialized = false;
         }
 
-        public void InitInstance(World world, DisplayInfo di)
+        public void InitInstance(World world, DisplayInfo di, ShaderCacheConfig shaderCache)
         {
             Assert.IsTrue(m_perThreadData != null);
 
@@ -513,6 +703,7 @@ namespace Unity.Tiny.Rendering
 #if ENABLE_DOTSRUNTIME_PROFILER
             init.profile = 1;
             init.callback = bgfx.CallbacksInit(Marshal.GetFunctionPointerForDelegate(Managed.m_profilerBeginCallback), Marshal.GetFunctionPointerForDelegate(Managed.m_profilerEndCallback));
+            m_profilerForwarding = true;
 #else
             init.profile = 0;
             init.callback = bgfx.CallbacksInit(IntPtr.Zero, IntPtr.Zero);
@@ -554,6 +745,29 @@ namespace Unity.Tiny.Rendering
             RenderDebug.LogFormatAlways("  Depth: {0} Origin: {1}", m_homogeneousDepth ? "[-1..1]" : "[0..1]", m_originBottomLeft ? "bottom left" : "top left");
             if ((caps->supported & (ulong)bgfx.CapsFlags.TextureCompareLequal) == 0)
                 RenderDebug.LogFormatAlways("  No direct shadow map support.");
+            m_instancingSupported = (caps->supported & (ulong)bgfx.CapsFlags.Instancing) != 0;
+            if (!m_instancingSupported)
+                RenderDebug.LogFormatAlways("  No instancing support.");
+            m_bonePaletteSupported = (caps->formats[(int)bgfx.TextureFormat.RGBA32F] & (ushort)bgfx.CapsFormatFlags.TextureVertex) != 0;
+            if (!m_bonePaletteSupported)
+                RenderDebug.LogFormatAlways("  No vertex texture fetch, skinning on the cpu.");
+            // the lit shaders already use sampler stages 0 to 7
+            m_lightClusterSupported = (caps->formats[(int)bgfx.TextureFormat.RGBA32F] & (ushort)bgfx.CapsFormatFlags.Texture2D) != 0 &&
+                caps->limits.maxTextureSamplers > 8;
+            if (!m_lightClusterSupported)
+                RenderDebug.LogFormatAlways("  No float textures or too few samplers, at most {0} point or directional lights.", LightingSetup.maxPointOrDirLights);
+#if UNITY_DOTSRUNTIME && !UNITY_WEBGL
+            m_textureAtlas.Init();
+#endif
+
+            // bgfx does not expose the driver version, the device ids plus the app supplied version stand in for it
+            if (shaderCache.Path.Length > 0)
+            {
+                ulong driverKey = ((ulong)caps->vendorId << 48) | ((ulong)caps->deviceId << 32) |
+                    ((ulong)(byte)m_rendererType << 24) | (shaderCache.Version & 0xffffff);
+                m_shaderCacheOpen = bgfx.ShaderCacheOpen(shaderCache.Path.GetUnsafePtr(), driverKey) != 0;
+                RenderDebug.LogFormatAlways("  Shader cache: {0}", m_shaderCacheOpen ? "on" : "off");
+            }
 
             var backend = bgfx.get_renderer_type();
 
@@ -646,6 +860,14 @@ namespace Unity.Tiny.Rendering
                             m_shadowMapShader.Init(BGFXShaderHelper.GetPrecompiledShaderData(backend, shaders, ref builtInShader.Name));
                         else if (builtInShader.Guid == BuiltInShaderType.shadowmapgpuskinning)
                             m_skinnedMeshShadowMapShader.Init(BGFXShaderHelper.GetPrecompiledShaderData(backend, shaders, ref builtInShader.Name));
+                        else if (builtInShader.Guid == BuiltInShaderType.simplelitinstanced)
+                            m_litInstancedShader.Init(BGFXShaderHelper.GetPrecompiledShaderData(backend, shaders, ref builtInShader.Name));
+                        else if (builtInShader.Guid == BuiltInShaderType.shadowmapinstanced)
+                            m_shadowMapInstancedShader.Init(BGFXShaderHelper.GetPrecompiledShaderData(backend, shaders, ref builtInShader.Name));
+                        else if (builtInShader.Guid == BuiltInShaderType.simpleparticleinstanced)
+                            m_simpleParticleInstancedShader.Init(BGFXShaderHelper.GetPrecompiledShaderData(backend, shaders, ref builtInShader.Name));
+                        else if (builtInShader.Guid == BuiltInShaderType.simplelitparticleinstanced)
+                            m_litParticleInstancedShader.Init(BGFXShaderHelper.GetPrecompiledShaderData(backend, shaders, ref builtInShader.Name));
                         else
                             foundShaders--;
                     }
@@ -653,7 +875,7 @@ namespace Unity.Tiny.Rendering
             }
 
             // must have all shaders
-            int totalShadersCount = 8;
+            int totalShadersCount = 12;
             if (foundShaders != totalShadersCount)
                 throw new Exception("Couldn't find all needed core precompiled shaders, only found " + foundShaders + "/" + totalShadersCount);
 
@@ -710,6 +932,7 @@ namespace Unity.Tiny.Rendering
                     bgfx.encoder_end(m_perThreadData[i].encoder);
                     m_perThreadData[i].encoder = null;
                 }
+                m_perThreadData[i].litUniformCache.stateKey = 0;
             }
 #if ENABLE_DOTSRUNTIME_PROFILER
             ProfilerUnsafeUtility.EndSample(m_markerEncoders);
@@ -725,6 +948,7 @@ namespace Unity.Tiny.Rendering
 #endif
             // go bgfx!
             bgfx.frame(false);
+            bgfx.AllocatorEndFrame();
 
             m_frameFlags = 0;
             bgfx.set_debug(m_persistentFlags);
@@ -733,6 +957,31 @@ namespace Unity.Tiny.Rendering
 #endif
         }
 
+        // all encoders must be done, call before Frame
+        public void CollectFrameStats()
+        {
+            m_cullingStats = default;
+            m_litUniformsSet = 0;
+            m_litUniformsSkipped = 0;
+            m_shadowDraws = m_shadowDrawsDirect;
+            m_shadowDrawsDirect = 0;
+            m_lodTriangles = m_lodTrianglesDirect;
+            m_lodTrianglesDirect = 0;
+            for (int i = 0; i < m_maxPerThreadData; i++)
+            {
+                m_cullingStats.Add(in m_perThreadData[i].cullingStats);
+                m_perThreadData[i].cullingStats = default;
+                m_shadowDraws += m_perThreadData[i].shadowDraws;
+                m_perThreadData[i].shadowDraws = 0;
+                m_lodTriangles += m_perThreadData[i].lodTriangles;
+                m_perThreadData[i].lodTriangles = 0;
+                m_litUniformsSet += m_perThreadData[i].litUniformCache.uniformsSet;
+                m_litUniformsSkipped += m_perThreadData[i].litUniformCache.uniformsSkipped;
+                m_perThreadData[i].litUniformCache.uniformsSet = 0;
+                m_perThreadData[i].litUniformCache.uniformsSkipped = 0;
+            }
+        }
+
         public void FlushViewSpaceCache()
         {
             for (int i = 0; i < m_maxPerThreadData; i++)
@@ -742,6 +991,7 @@ namespace Unity.Tiny.Rendering
         public void ResetIfNeeded(DisplayInfo di, IntPtr nativeWindowHandle)
         {
             bool needReset = di.framebufferWidth != m_fbWidth || di.framebufferHeight != m_fbHeight || di.disableVSync != m_disableVSync || di.colorSpace != m_colorSpace;
+            needReset |= m_captureRequested != m_captureActive;
             if (m_platformData.nwh != nativeWindowHandle.ToPointer())
             {
                 m_platformData.nwh = nativeWindowHandle.ToPointer();
@@ -754,7 +1004,11 @@ namespace Unity.Tiny.Rendering
             }
             if (needReset)
             {
-                bgfx.reset((uint)di.framebufferWidth, (uint)di.framebufferHeight, RendererBGFXStatic.GetResetFlags(ref di), bgfx.TextureFormat.RGBA8);
+                uint resetFlags = RendererBGFXStatic.GetResetFlags(ref di);
+                if (m_captureRequested)
+                    resetFlags |= (uint)bgfx.ResetFlags.Capture;
+                bgfx.reset((uint)di.framebufferWidth, (uint)di.framebufferHeight, resetFlags, bgfx.TextureFormat.RGBA8);
+                m_captureActive = m_captureRequested;
                 m_fbWidth = di.framebufferWidth;
                 m_fbHeight = di.framebufferHeight;
                 m_disableVSync = di.disableVSync;
@@ -787,6 +1041,38 @@ namespace Unity.Tiny.Rendering
             return samplerFlags;
         }
 
+        public bool IsTextureFormatSupported(bgfx.TextureFormat format, bool srgb)
+        {
+            var caps = bgfx.get_caps();
+            var required = srgb ? bgfx.CapsFormatFlags.Texture2dSrgb : bgfx.CapsFormatFlags.Texture2d;
+            return (caps->formats[(int)format] & (ushort)required) != 0;
+        }
+
+        // Upload a precompressed (KTX2) payload as-is. The data holds mipCount prebuilt mips, largest first.
+        // Returns an invalid handle if the gpu can not sample the format, there is no cpu fallback decoder.
+        public bgfx.TextureHandle CreatePrecompressedTexture(Image2D im2d, bgfx.TextureFormat format, int mipCount, byte* data, int dataSize)
+        {
+            int w = im2d.imagePixelWidth;
+            int h = im2d.imagePixelHeight;
+            ulong flags = TextureFlagsToBGFXSamplerFlags(im2d);
+            if (!IsTextureFormatSupported(format, (flags & (ulong)bgfx.TextureFlags.Srgb) != 0))
+            {
+                RenderDebug.LogFormatAlways("Precompressed texture format {0} is not supported by this GPU.", format.ToString());
+                return new bgfx.TextureHandle { idx = 0xffff };
+            }
+            // mips might have been turned off for npot textures, in that case only upload the top level
+            bool hasMips = mipCount > 1 && (im2d.flags & TextureFlags.MimapEnabled) == TextureFlags.MimapEnabled;
+            bgfx.TextureInfo info;
+            bgfx.calc_texture_size(&info, (ushort)w, (ushort)h, 1, false, hasMips, 1, format);
+            if (info.storageSize > dataSize)
+            {
+                RenderDebug.LogFormatAlways("Precompressed texture {0},{1} has {2} bytes of data but needs {3}.", w, h, dataSize, (int)info.storageSize);
+                return new bgfx.TextureHandle { idx = 0xffff };
+            }
+            bgfx.Memory* bgfxblock = RendererBGFXStatic.CreateMemoryBlock(data, (int)info.storageSize);
+            return bgfx.create_texture_2d((ushort)w, (ushort)h, hasMips, 1, format, flags, bgfxblock);
+        }
+
         public float4x4 GetAdjustedProjection(ref RenderPass pass)
         {
             bool rtt = (pass.passFlags & RenderPassFlags.RenderToTexture) == RenderPassFlags.RenderToTexture;
@@ -806,6 +1092,7 @@ namespace Unity.Tiny.Rendering
     {
         private RendererBGFXInstance *m_instancePtr;
         private NativeArray<PerThreadDataBGFX> m_allocPerThreadData;
+        private NativeArray<LightClusterViewBGFX> m_allocLightClusterViews;
 
 #if ENABLE_DOTSRUNTIME_PROFILER
         private IntPtr m_markerUpdate = ProfilerUnsafeUtility.CreateMarker("RendererBGFXSystem.OnUpdate", ProfilerUnsafeUtility.CategoryRender, Profiling.LowLevel.MarkerFlags.Default, 0);
@@ -820,6 +1107,17 @@ namespace Unity.Tiny.Rendering
         public string m_screenShotPath;
         public NativeList<byte> m_screenShot;
 
+        // captured frames that are being written to disk, the native capture slot is released once done
+        private struct PendingCaptureEncode
+        {
+            public int slot;
+            public long encodeId;
+        }
+        private NativeList<PendingCaptureEncode> m_pendingCaptureEncodes;
+
+        // webp quality for screen shots and captures, 100 is lossless. png is always lossless.
+        public int m_captureQuality = 90;
+
         public RendererBGFXInstance* InstancePointer()
         {
             return m_instancePtr;
@@ -830,9 +1128,73 @@ namespace Unity.Tiny.Rendering
             return m_instancePtr != null && m_instancePtr->m_initialized;
         }
 
+        // jobs that encode draws into the per thread encoders, they run until the frame is submitted
+        private JobHandle m_encodeJobs;
+
+        /// <summary>
+        /// Hands over jobs that encode into the per thread encoders. Nothing waits for them before
+        /// SubmitFrameSystem, which completes them right before ending the encoders.
+        /// </summary>
+        public void AddEncodeJobs(JobHandle jobs)
+        {
+            m_encodeJobs = JobHandle.CombineDependencies(m_encodeJobs, jobs);
+        }
+
+        public void CompleteEncodeJobs()
+        {
+            m_encodeJobs.Complete();
+            m_encodeJobs = default;
+        }
+
         // helper: useful for triggering images from disk reload
         // call DestroyAllTextures() followed by ReloadAllImages() to force reload all textures
         // or ReloadAllImages() after a deinit and reinit to re-create textures
+        public override CullingStats GetCullingStats()
+        {
+            if (m_instancePtr == null)
+                return default;
+            return m_instancePtr->m_cullingStats;
+        }
+
+        public override void GetLitUniformStats(out int set, out int skipped)
+        {
+            set = m_instancePtr == null ? 0 : m_instancePtr->m_litUniformsSet;
+            skipped = m_instancePtr == null ? 0 : m_instancePtr->m_litUniformsSkipped;
+        }
+
+        public override void GetShadowStats(out int passesRendered, out int passesCached, out int draws)
+        {
+            passesRendered = m_instancePtr == null ? 0 : m_instancePtr->m_shadowPassesRendered;
+            passesCached = m_instancePtr == null ? 0 : m_instancePtr->m_shadowPassesCached;
+            draws = m_instancePtr == null ? 0 : m_instancePtr->m_shadowDraws;
+        }
+
+        public override void GetSpriteBatchStats(out int sprites, out int draws)
+        {
+            sprites = m_instancePtr == null ? 0 : m_instancePtr->m_spritesSubmitted;
+            draws = m_instancePtr == null ? 0 : m_instancePtr->m_spriteDraws;
+        }
+
+        public override void GetTextureAtlasStats(out int images, out int pages, out int repacks)
+        {
+            images = m_instancePtr == null ? 0 : m_instancePtr->m_textureAtlas.placedImages;
+            pages = m_instancePtr == null ? 0 : m_instancePtr->m_textureAtlas.pageCount;
+            repacks = m_instancePtr == null ? 0 : m_instancePtr->m_textureAtlas.repacks;
+        }
+
+        public override void GetDynamicMeshStats(out int bytesLastWrite, out int bytesHighWater, out int bytesCapacity, out int grows)
+        {
+            bytesLastWrite = m_instancePtr == null ? 0 : m_instancePtr->m_dynamicMeshBuffers.bytesLastWrite;
+            bytesHighWater = m_instancePtr == null ? 0 : m_instancePtr->m_dynamicMeshBuffers.bytesHighWater;
+            bytesCapacity = m_instancePtr == null ? 0 : m_instancePtr->m_dynamicMeshBuffers.bytesCapacity;
+            grows = m_instancePtr == null ? 0 : m_instancePtr->m_dynamicMeshBuffers.grows;
+        }
+
+        public override int4 GetMeshLODStats()
+        {
+            return m_instancePtr == null ? 0 : m_instancePtr->m_lodTriangles;
+        }
+
         public override void ReloadAllImages()
         {
             EntityCommandBuffer ecb = new EntityCommandBuffer(Allocator.TempJob);
@@ -889,6 +1251,19 @@ namespace Unity.Tiny.Rendering
                 ecb.RemoveComponent<TextureBGFX>(e);
             }).Run();
 
+            // atlas pages are owned by the instance, reloaded images are packed again
+            Entities.WithAll<TextureAtlasEntryBGFX>().ForEach((Entity e) =>
+            {
+                ecb.RemoveComponent<TextureAtlasEntryBGFX>(e);
+            }).Run();
+            Entities.WithAll<TextureAtlasPendingBGFX>().ForEach((Entity e) =>
+            {
+                ecb.RemoveComponent<TextureAtlasPendingBGFX>(e);
+            }).Run();
+#if UNITY_DOTSRUNTIME && !UNITY_WEBGL
+            m_instancePtr->m_textureAtlas.Destroy();
+#endif
+
 #if ENABLE_DOTSRUNTIME_PROFILER
             ProfilerStats.Stats.drawStats.renderTextureCount = 0;
 #endif
@@ -916,6 +1291,7 @@ namespace Unity.Tiny.Rendering
 
         public override void Shutdown()
         {
+            CompleteEncodeJobs();
             DestroyAllShaders();
             DestroyAllTextures();
             EntityCommandBuffer ecb = new EntityCommandBuffer(Allocator.TempJob);
@@ -947,7 +1323,9 @@ namespace Unity.Tiny.Rendering
         {
             base.OnCreate();
             m_allocPerThreadData = new NativeArray<PerThreadDataBGFX>(JobsUtility.MaxJobThreadCount, Allocator.Persistent);
+            m_allocLightClusterViews = new NativeArray<LightClusterViewBGFX>(RendererBGFXInstance.kMaxLightClusterSetups * 256, Allocator.Persistent);
             m_screenShot = new NativeList<byte>(Allocator.Persistent);
+            m_pendingCaptureEncodes = new NativeList<PendingCaptureEncode>(Allocator.Persistent);
             m_instancePtr = (RendererBGFXInstance*)Memory.Unmanaged.Allocate(sizeof(RendererBGFXInstance), 32, Allocator.Persistent);
             UnsafeUtility.MemClear(m_instancePtr, sizeof(RendererBGFXInstance));
         }
@@ -957,7 +1335,14 @@ namespace Unity.Tiny.Rendering
             if (IsInitialized())
                 Shutdown();
             m_screenShot.Dispose();
+            // the encoder works on native capture memory, let it finish
+            while (m_pendingCaptureEncodes.Length > 0)
+                PollCaptureEncodes();
+            m_pendingCaptureEncodes.Dispose();
+            // no slot is held anymore, frees the capture pool
+            bgfx.CallbacksDeInit();
             m_allocPerThreadData.Dispose();
+            m_allocLightClusterViews.Dispose();
             Memory.Unmanaged.Free(m_instancePtr, Allocator.Persistent);
             base.OnDestroy();
         }
@@ -967,7 +1352,9 @@ namespace Unity.Tiny.Rendering
             if (IsInitialized())
                 return;
             m_instancePtr->m_perThreadData = (PerThreadDataBGFX*)m_allocPerThreadData.GetUnsafePtr();
-            m_instancePtr->InitInstance(World, GetSingleton<DisplayInfo>());
+            m_instancePtr->m_lightClusterViews = (LightClusterViewBGFX*)m_allocLightClusterViews.GetUnsafePtr();
+            var shaderCache = HasSingleton<ShaderCacheConfig>() ? GetSingleton<ShaderCacheConfig>() : default;
+            m_instancePtr->InitInstance(World, GetSingleton<DisplayInfo>(), shaderCache);
         }
 
         protected override void OnStartRunning()
@@ -995,9 +1382,13 @@ namespace Unity.Tiny.Rendering
         {
             byte* callbackMem = null;
             bgfx.CallbackEntry* callbackLog = null;
-            int n = bgfx.CallbacksLock(&callbackMem, &callbackLog);
+            int dropped = 0;
+            int n = bgfx.CallbacksDrain(&callbackMem, &callbackLog, &dropped);
             string s;
 
+            if (dropped > 0)
+                RenderDebug.LogFormatAlways("{0} BGFX log messages were dropped because the log buffer was full.", dropped);
+
             for (int i = 0; i < n; i++)
             {
                 bgfx.CallbackEntry e = callbackLog[i];
@@ -1006,37 +1397,136 @@ namespace Unity.Tiny.Rendering
                     case bgfx.CallbackType.Fatal:
                         s = StringFromCString(callbackMem + e.additionalAllocatedDataStart);
                         RenderDebug.LogAlways(s);
-                        bgfx.CallbacksUnlockAndClear();
                         throw new InvalidOperationException(s);
                     case bgfx.CallbackType.Trace:
                         s = StringFromCString(callbackMem + e.additionalAllocatedDataStart);
                         RenderDebug.LogAlways(s);
                         break;
-                    case bgfx.CallbackType.ScreenShotDesc:
-                        bgfx.ScreenShotDesc* desc = (bgfx.ScreenShotDesc*)(callbackMem + e.additionalAllocatedDataStart);
-                        RenderDebug.LogFormatAlways("Screenshot captured: {0}*{1} {2} pitch={3}", desc->width, desc->height, desc->yflip != 0 ? "flipped" : "", desc->pitch);
-                        Assert.IsTrue(desc->width * 4 == desc->pitch);
-                        Assert.IsTrue(desc->width * desc->height * 4 == desc->size);
-                        m_screenShotWidth = desc->width;
-                        m_screenShotHeight = desc->height;
-                        break;
-                    case bgfx.CallbackType.ScreenShotFilename:
-                        s = StringFromCString(callbackMem + e.additionalAllocatedDataStart);
-                        RenderDebug.LogFormatAlways("  Filename is {0}", s);
-                        m_screenShotPath = s;
-                        break;
-                    case bgfx.CallbackType.ScreenShot:
-                        RenderDebug.LogFormatAlways("  Data available {0} bytes.", e.additionalAllocatedDataSize);
-                        m_screenShot.ResizeUninitialized(e.additionalAllocatedDataSize);
-                        UnsafeUtility.MemCpy(m_screenShot.GetUnsafePtr(), callbackMem + e.additionalAllocatedDataStart, e.additionalAllocatedDataSize);
-                        break;
                     default:
                         RenderDebug.Log("Unknown BGFX callback type!");
                         break;
                 }
             }
+        }
+
+        static bool IsEncodablePath(string path)
+        {
+#if UNITY_WEBGL
+            return false;
+#else
+            return path.EndsWith(".png", StringComparison.OrdinalIgnoreCase) || path.EndsWith(".webp", StringComparison.OrdinalIgnoreCase);
+#endif
+        }
 
-            bgfx.CallbacksUnlockAndClear();
+        private void PollCaptureEncodes()
+        {
+#if !UNITY_WEBGL
+            for (int i = m_pendingCaptureEncodes.Length - 1; i >= 0; i--)
+            {
+                var pending = m_pendingCaptureEncodes[i];
+                int status = ImageIOSTBNativeCalls.CheckEncode(pending.encodeId);
+                if (status == 0)
+                    continue;
+                if (status == 2)
+                    RenderDebug.LogAlways("Failed to write captured frame to disk.");
+                bgfx.CaptureRelease(pending.slot);
+                m_pendingCaptureEncodes.RemoveAtSwapBack(i);
+            }
+#endif
+        }
+
+        // Frames are copied out of bgfx into a small native pool on the render thread. Here they are handed to
+        // an encoder job that writes them to disk, the main thread never touches the pixels except for screen shots
+        // that are kept in m_screenShot.
+        protected void HandleCaptures()
+        {
+            PollCaptureEncodes();
+
+            bgfx.CapturedFrame frame;
+            while (bgfx.CaptureAcquire(&frame) != 0)
+            {
+                string path = StringFromCString(frame.path);
+                if (frame.screenShot != 0)
+                {
+                    RenderDebug.LogFormatAlways("Screenshot captured: {0}*{1} {2} pitch={3}", frame.width, frame.height, frame.yflip != 0 ? "flipped" : "", frame.pitch);
+                    RenderDebug.LogFormatAlways("  Filename is {0}", path);
+                    m_screenShotWidth = frame.width;
+                    m_screenShotHeight = frame.height;
+                    m_screenShotPath = path;
+                    m_screenShot.ResizeUninitialized(frame.pitch * frame.height);
+                    UnsafeUtility.MemCpy(m_screenShot.GetUnsafePtr(), frame.pixels, frame.pitch * frame.height);
+                }
+                if (!IsEncodablePath(path))
+                {
+                    if (frame.screenShot == 0)
+                        RenderDebug.LogFormat("Captured frame {0} not written, only .png and .webp files are supported.", path);
+                    bgfx.CaptureRelease(frame.slot);
+                    continue;
+                }
+#if !UNITY_WEBGL
+                long encodeId = ImageIOSTBNativeCalls.StartEncode(frame.pixels, frame.width, frame.height, frame.pitch, frame.bgra, frame.yflip, path, m_captureQuality);
+                m_pendingCaptureEncodes.Add(new PendingCaptureEncode { slot = frame.slot, encodeId = encodeId });
+#endif
+            }
+
+            if (m_instancePtr->m_captureRequested)
+            {
+                int captured, dropped, remaining;
+                bgfx.CaptureStats(&captured, &dropped, &remaining);
+                if (remaining == 0)
+                {
+                    RenderDebug.LogFormatAlways("Frame capture done, {0} frames captured in total, {1} dropped because the encoder fell behind.", captured, dropped);
+                    m_instancePtr->m_captureRequested = false;
+                }
+            }
+        }
+
+        /// <summary>
+        /// Records the next frameCount frames to disk, as path_00000.png, path_00001.png, ... for a path of path.png.
+        /// Use a .png or a .webp extension. Frames are encoded and written on worker threads, rendering never waits for them.
+        /// When the encoder falls behind, frames are dropped instead.
+        /// </summary>
+        public bool StartCapture(string path, int frameCount)
+        {
+            if (!IsInitialized() || m_instancePtr->m_captureRequested)
+                return false;
+            var fixedPath = new FixedString512(path);
+            if (bgfx.CaptureStart(fixedPath.GetUnsafePtr(), frameCount) == 0)
+                return false;
+            m_instancePtr->m_captureRequested = true;
+            return true;
+        }
+
+        public void StopCapture()
+        {
+            bgfx.CaptureStop();
+            m_instancePtr->m_captureRequested = false;
+        }
+
+        /// <summary>
+        /// Starts recording bgfx profiler scopes from all threads, keeping at most maxEvents scope begins and ends.
+        /// Only builds with ENABLE_DOTSRUNTIME_PROFILER emit bgfx scopes.
+        /// </summary>
+        public bool StartProfilerTrace(int maxEvents = 1 << 20)
+        {
+            return bgfx.ProfilerRecordStart(maxEvents) != 0;
+        }
+
+        /// <summary>
+        /// Stops recording bgfx profiler scopes and writes them to path in the Chrome trace event format,
+        /// which chrome://tracing and Perfetto can open.
+        /// </summary>
+        public bool StopProfilerTrace(string path)
+        {
+            var fixedPath = new FixedString512(path);
+            bool ok = bgfx.ProfilerRecordStop(fixedPath.GetUnsafePtr()) != 0;
+            int recorded, dropped;
+            bgfx.ProfilerRecordStats(&recorded, &dropped);
+            if (ok)
+                RenderDebug.LogFormatAlways("Profiler trace written to {0}, {1} events, {2} dropped.", path, recorded, dropped);
+            else
+                RenderDebug.LogFormatAlways("Failed to write profiler trace to {0}.", path);
+            return ok;
         }
 
         protected override void OnUpdate()
@@ -1074,6 +1564,12 @@ namespace Unity.Tiny.Rendering
 
             Assert.IsTrue(m_instancePtr->m_maxPerThreadData >= JobsUtility.JobWorkerCount + 1, "Tiny Rendering does not handle increasing JobWorkerCount at runtime yet.");
             var di = GetSingleton<DisplayInfo>();
+            if (di.gpuSkinning && !m_instancePtr->m_bonePaletteSupported)
+            {
+                // the skinning shaders can not read the bone palette, let the cpu skinning systems take over
+                di.gpuSkinning = false;
+                SetSingleton(di);
+            }
             var nwh = World.GetExistingSystem<WindowSystem>().GetPlatformWindowHandle();
             m_instancePtr->ResetIfNeeded(di, nwh);
             m_instancePtr->FlushViewSpaceCache();
@@ -1088,8 +1584,10 @@ namespace Unity.Tiny.Rendering
 #if ENABLE_DOTSRUNTIME_PROFILER
             ProfilerUnsafeUtility.EndSample(m_markerUpdateUpload);
             ProfilerUnsafeUtility.BeginSample(m_markerUpdateCallbacks);
+            m_instancePtr->UpdateProfilerForwarding();
 #endif
             HandleCallbacks();
+            HandleCaptures();
 #if ENABLE_DOTSRUNTIME_PROFILER
             ProfilerUnsafeUtility.EndSample(m_markerUpdateCallbacks);
             ProfilerUnsafeUtility.EndSample(m_markerUpdate);
@@ -1189,128 +1687,109 @@ namespace Unity.Tiny.Rendering
             ecb.Dispose();
 
             ComponentSkinnedRenderMeshData = GetComponentDataFromEntity<SkinnedMeshRenderData>();
-            // then actually create dynamic buffers, re-creating or re-sizing if needed
+            // drop buffers that no longer match, dynamic gpu buffers are shared and never destroyed here
             Entities
-                .WithAll<DynamicSimpleVertex, DynamicIndex>()
+                .WithAll<DynamicIndex>()
                 .WithChangeFilter<DynamicMeshData>()
                 .ForEach((Entity e, ref MeshBGFX mb, ref DynamicMeshData dnm) =>
             {
                 if (mb.IsValidFor(dnm))
                     return;
                 mb.Destroy();
-                bool hasSkinningData = false;
-                if (dnm.CopyFrom != Entity.Null)
-                    hasSkinningData = ComponentSkinnedRenderMeshData.HasComponent(dnm.CopyFrom);
-                if (dnm.UseDynamicGPUBuffer)
-                    mb = MeshBGFX.CreateDynamicMeshSimple(inst, dnm.VertexCapacity, dnm.IndexCapacity, hasSkinningData);
             }).Run();
 
-            Entities
-                .WithAll<DynamicLitVertex, DynamicIndex>()
-                .WithChangeFilter<DynamicMeshData>()
-                .ForEach((Entity e, ref MeshBGFX mb, ref DynamicMeshData dnm) =>
-            {
-                if (mb.IsValidFor(dnm))
+            // dynamic meshes, dynamic buffer: all of them are written to the shared buffers again when one changed
+            var shared = &inst->m_dynamicMeshBuffers;
+            bool sharedDirty = false;
+            Entities.WithAll<DynamicSimpleVertex, DynamicIndex>().ForEach((in MeshBGFX mb, in DynamicMeshData src) => {
+                if (!src.UseDynamicGPUBuffer)
                     return;
-
-                mb.Destroy();
-
-                bool hasSkinningData = false;
-                if (dnm.CopyFrom != Entity.Null)
-                    hasSkinningData = ComponentSkinnedRenderMeshData.HasComponent(dnm.CopyFrom);
-                if (dnm.UseDynamicGPUBuffer)
-                    mb = MeshBGFX.CreateDynamicMeshLit(inst, dnm.VertexCapacity, dnm.IndexCapacity, hasSkinningData);
+                if (src.Dirty || !mb.IsDynamic() || src.NumIndices != mb.IndexCount || src.NumVertices != mb.VertexCount)
+                    sharedDirty = true;
+                bool hasSkinningData = src.CopyFrom != Entity.Null && ComponentSkinnedRenderMeshData.HasComponent(src.CopyFrom);
+                shared->Reserve(SharedDynamicMeshBuffersBGFX.Layout(false, hasSkinningData), src.NumVertices, src.NumIndices);
             }).Run();
+            Entities.WithAll<DynamicLitVertex, DynamicIndex>().ForEach((in MeshBGFX mb, in DynamicMeshData src) => {
+                if (!src.UseDynamicGPUBuffer)
+                    return;
+                if (src.Dirty || !mb.IsDynamic() || src.NumIndices != mb.IndexCount || src.NumVertices != mb.VertexCount)
+                    sharedDirty = true;
+                bool hasSkinningData = src.CopyFrom != Entity.Null && ComponentSkinnedRenderMeshData.HasComponent(src.CopyFrom);
+                shared->Reserve(SharedDynamicMeshBuffersBGFX.Layout(true, hasSkinningData), src.NumVertices, src.NumIndices);
+            }).Run();
+
+            if (sharedDirty)
+            {
+                shared->Begin(inst);
+                Entities.ForEach((DynamicBuffer<DynamicSimpleVertex> vertexSrc, DynamicBuffer<DynamicIndex> indexSrc, ref MeshBGFX dest, ref DynamicMeshData src) => {
+                    if (!src.UseDynamicGPUBuffer)
+                        return;
+                    Assert.IsTrue(src.NumIndices <= indexSrc.Length);
+                    Assert.IsTrue(src.NumVertices <= vertexSrc.Length);
+                    SkinnedMeshVertex* skinningdata = null;
+                    if (src.CopyFrom != Entity.Null && ComponentSkinnedRenderMeshData.HasComponent(src.CopyFrom))
+                        skinningdata = (SkinnedMeshVertex*)ComponentSkinnedRenderMeshData[src.CopyFrom].SkinnedMeshDataRef.Value.Vertices.GetUnsafePtr();
+                    dest = shared->Write(SharedDynamicMeshBuffersBGFX.Layout(false, skinningdata != null), (byte*)vertexSrc.GetUnsafePtr(), sizeof(SimpleVertex), skinningdata,
+                        src.NumVertices, (ushort*)indexSrc.GetUnsafePtr(), src.NumIndices);
+                    src.Dirty = false;
+                }).Run();
+                Entities.ForEach((DynamicBuffer<DynamicLitVertex> vertexSrc, DynamicBuffer<DynamicIndex> indexSrc, ref MeshBGFX dest, ref DynamicMeshData src) => {
+                    if (!src.UseDynamicGPUBuffer)
+                        return;
+                    Assert.IsTrue(src.NumIndices <= indexSrc.Length);
+                    Assert.IsTrue(src.NumVertices <= vertexSrc.Length);
+                    SkinnedMeshVertex* skinningdata = null;
+                    if (src.CopyFrom != Entity.Null && ComponentSkinnedRenderMeshData.HasComponent(src.CopyFrom))
+                        skinningdata = (SkinnedMeshVertex*)ComponentSkinnedRenderMeshData[src.CopyFrom].SkinnedMeshDataRef.Value.Vertices.GetUnsafePtr();
+                    dest = shared->Write(SharedDynamicMeshBuffersBGFX.Layout(true, skinningdata != null), (byte*)vertexSrc.GetUnsafePtr(), sizeof(LitVertex), skinningdata,
+                        src.NumVertices, (ushort*)indexSrc.GetUnsafePtr(), src.NumIndices);
+                    src.Dirty = false;
+                }).Run();
+                shared->End();
+            }
+            else
+                shared->Skip();
 
-            // dynamic meshes, dynamic buffer: re-upload if dirty
             // static meshes, dynamic buffer: re-create if dirty
             Entities.ForEach((Entity e, DynamicBuffer<DynamicSimpleVertex> vertexSrc, DynamicBuffer<DynamicIndex> indexSrc, ref MeshBGFX dest, ref DynamicMeshData src) => {
+                if (src.UseDynamicGPUBuffer)
+                    return;
                 if (!src.Dirty && src.NumIndices == dest.IndexCount && src.NumVertices == dest.VertexCount)
                     return;
                 bool hasSkinningData = false;
                 if (src.CopyFrom != Entity.Null)
                     hasSkinningData = ComponentSkinnedRenderMeshData.HasComponent(src.CopyFrom);
-                if (src.UseDynamicGPUBuffer)
+                Assert.IsTrue(!dest.IsDynamic());
+                dest.Destroy();
+                if (hasSkinningData)
                 {
-                    Assert.IsTrue(dest.IsDynamic());
-                    Assert.IsTrue(src.NumIndices <= indexSrc.Length);
-                    Assert.IsTrue(src.NumVertices <= vertexSrc.Length);
-                    Assert.IsTrue(src.NumVertices <= src.VertexCapacity);
-                    Assert.IsTrue(src.NumIndices <= src.IndexCapacity);
-                    if (hasSkinningData)
-                    {
-                        int vertexSize = sizeof(DynamicSimpleVertex);
-                        int skinningVertexSize = sizeof(SkinnedMeshVertex);
-                        int totalVertexSize = vertexSize + skinningVertexSize;
-                        byte* tmpBlock = (byte*)UnsafeUtility.Malloc(totalVertexSize * src.NumVertices, 4, Allocator.Temp);
-                        SkinnedMeshRenderData skinnedMeshRenderData = ComponentSkinnedRenderMeshData[src.CopyFrom];
-                        SkinnedMeshVertex* skinningdata = (SkinnedMeshVertex*)skinnedMeshRenderData.SkinnedMeshDataRef.Value.Vertices.GetUnsafePtr();
-                        UnsafeUtility.MemCpyStride(tmpBlock, totalVertexSize, vertexSrc.GetUnsafePtr(), vertexSize, vertexSize, src.NumVertices);
-                        UnsafeUtility.MemCpyStride(tmpBlock + vertexSize, totalVertexSize, skinningdata, skinningVertexSize, skinningVertexSize, src.NumVertices);
-                        dest.UpdateDynamic((ushort*)indexSrc.GetUnsafePtr(), src.NumIndices, (byte*)tmpBlock, src.NumVertices, totalVertexSize);
-                        UnsafeUtility.Free(tmpBlock, Allocator.Temp);
-                    }
-                    else
-                        dest.UpdateDynamic((ushort*)indexSrc.GetUnsafePtr(), src.NumIndices, (byte*)vertexSrc.GetUnsafePtr(), src.NumVertices, sizeof(SimpleVertex));
+                    SkinnedMeshRenderData skinnedMeshRenderData = ComponentSkinnedRenderMeshData[src.CopyFrom];
+                    SkinnedMeshVertex* skinningdata = (SkinnedMeshVertex*)skinnedMeshRenderData.SkinnedMeshDataRef.Value.Vertices.GetUnsafePtr();
+                    dest = MeshBGFX.CreateStaticMesh(inst, (ushort*)indexSrc.GetUnsafePtr(), src.NumIndices, (SimpleVertex*)vertexSrc.GetUnsafePtr(), src.NumVertices, skinningdata);
                 }
                 else
-                {
-                    Assert.IsTrue(!dest.IsDynamic());
-                    dest.Destroy();
-                    if (hasSkinningData)
-                    {
-                        SkinnedMeshRenderData skinnedMeshRenderData = ComponentSkinnedRenderMeshData[src.CopyFrom];
-                        SkinnedMeshVertex* skinningdata = (SkinnedMeshVertex*)skinnedMeshRenderData.SkinnedMeshDataRef.Value.Vertices.GetUnsafePtr();
-                        dest = MeshBGFX.CreateStaticMesh(inst, (ushort*)indexSrc.GetUnsafePtr(), src.NumIndices, (SimpleVertex*)vertexSrc.GetUnsafePtr(), src.NumVertices, skinningdata);
-                    }
-                    else
-                        dest = MeshBGFX.CreateStaticMesh(inst, (ushort*)indexSrc.GetUnsafePtr(), src.NumIndices, (SimpleVertex*)vertexSrc.GetUnsafePtr(), src.NumVertices);
-                }
+                    dest = MeshBGFX.CreateStaticMesh(inst, (ushort*)indexSrc.GetUnsafePtr(), src.NumIndices, (SimpleVertex*)vertexSrc.GetUnsafePtr(), src.NumVertices);
                 src.Dirty = false;
             }).Run();
 
             Entities.ForEach((Entity e, DynamicBuffer<DynamicLitVertex> vertexSrc, DynamicBuffer<DynamicIndex> indexSrc, ref MeshBGFX dest, ref DynamicMeshData src) => {
+                if (src.UseDynamicGPUBuffer)
+                    return;
                 if (!src.Dirty && src.NumIndices == dest.IndexCount && src.NumVertices == dest.VertexCount)
                     return;
                 bool hasSkinningData = false;
                 if (src.CopyFrom != Entity.Null)
                     hasSkinningData = ComponentSkinnedRenderMeshData.HasComponent(src.CopyFrom);
-                if (src.UseDynamicGPUBuffer)
+                Assert.IsTrue(!dest.IsDynamic());
+                dest.Destroy();
+                if (hasSkinningData)
                 {
-                    Assert.IsTrue(dest.IsDynamic());
-                    Assert.IsTrue(src.NumIndices <= indexSrc.Length);
-                    Assert.IsTrue(src.NumVertices <= vertexSrc.Length);
-                    Assert.IsTrue(src.NumVertices <= src.VertexCapacity);
-                    Assert.IsTrue(src.NumIndices <= src.IndexCapacity);
-                    if (hasSkinningData)
-                    {
-                        int vertexSize = sizeof(DynamicLitVertex);
-                        int skinningVertexSize = sizeof(SkinnedMeshVertex);
-                        int totalVertexSize = vertexSize + skinningVertexSize;
-                        byte* tmpBlock = (byte*)UnsafeUtility.Malloc(totalVertexSize * src.NumVertices, 4, Allocator.Temp);
-                        SkinnedMeshRenderData skinnedMeshRenderData = ComponentSkinnedRenderMeshData[src.CopyFrom];
-                        SkinnedMeshVertex* skinningdata = (SkinnedMeshVertex*)skinnedMeshRenderData.SkinnedMeshDataRef.Value.Vertices.GetUnsafePtr();
-                        UnsafeUtility.MemCpyStride(tmpBlock, totalVertexSize, vertexSrc.GetUnsafePtr(), vertexSize, vertexSize, src.NumVertices);
-                        UnsafeUtility.MemCpyStride(tmpBlock + vertexSize, totalVertexSize, skinningdata, skinningVertexSize, skinningVertexSize, src.NumVertices);
-                        dest.UpdateDynamic((ushort*)indexSrc.GetUnsafePtr(), src.NumIndices, (byte*)tmpBlock, src.NumVertices, totalVertexSize);
-                        UnsafeUtility.Free(tmpBlock, Allocator.Temp);
-                    }
-                    else
-                        dest.UpdateDynamic((ushort*)indexSrc.GetUnsafePtr(), src.NumIndices, (byte*)vertexSrc.GetUnsafePtr(), src.NumVertices, sizeof(LitVertex));
+                    SkinnedMeshRenderData skinnedMeshRenderData = ComponentSkinnedRenderMeshData[src.CopyFrom];
+                    SkinnedMeshVertex* skinningdata = (SkinnedMeshVertex*)skinnedMeshRenderData.SkinnedMeshDataRef.Value.Vertices.GetUnsafePtr();
+                    dest = MeshBGFX.CreateStaticMesh(inst, (ushort*)indexSrc.GetUnsafePtr(), src.NumIndices, (SimpleVertex*)vertexSrc.GetUnsafePtr(), src.NumVertices, skinningdata);
                 }
                 else
-                {
-                    Assert.IsTrue(!dest.IsDynamic());
-                    dest.Destroy();
-                    if (hasSkinningData)
-                    {
-                        SkinnedMeshRenderData skinnedMeshRenderData = ComponentSkinnedRenderMeshData[src.CopyFrom];
-                        SkinnedMeshVertex* skinningdata = (SkinnedMeshVertex*)skinnedMeshRenderData.SkinnedMeshDataRef.Value.Vertices.GetUnsafePtr();
-                        dest = MeshBGFX.CreateStaticMesh(inst, (ushort*)indexSrc.GetUnsafePtr(), src.NumIndices, (SimpleVertex*)vertexSrc.GetUnsafePtr(), src.NumVertices, skinningdata);
-                    }
-                    else
-                        dest = MeshBGFX.CreateStaticMesh(inst, (ushort*)indexSrc.GetUnsafePtr(), src.NumIndices, (LitVertex*)vertexSrc.GetUnsafePtr(), src.NumVertices);
-                }
+                    dest = MeshBGFX.CreateStaticMesh(inst, (ushort*)indexSrc.GetUnsafePtr(), src.NumIndices, (LitVertex*)vertexSrc.GetUnsafePtr(), src.NumVertices);
                 src.Dirty = false;
             }).Run();
         }
@@ -1324,6 +1803,125 @@ namespace Unity.Tiny.Rendering
             }).Run();
         }
 
+#if UNITY_DOTSRUNTIME && !UNITY_WEBGL
+        // Creates the texture of a decoded or precompressed image loaded by stb, falls back to the grey texture if the gpu can not use it
+        private static bgfx.TextureHandle UploadImageSTB(RendererBGFXInstance* instPtr, ref Image2D im2d, int imageHandle, out bool externalOwner)
+        {
+            bgfx.TextureHandle texHandle;
+            externalOwner = false;
+            int w = 0;
+            int h = 0;
+            int format = -1, mipCount = 0, dataSize = 0;
+            byte* compressed = ImageIOSTBNativeCalls.GetCompressedImageFromHandle(imageHandle, ref format, ref mipCount, ref dataSize);
+            byte* pixels = ImageIOSTBNativeCalls.GetImageFromHandle(imageHandle, ref w, ref h);
+            if (compressed != null)
+            {
+                texHandle = instPtr->CreatePrecompressedTexture(im2d, (bgfx.TextureFormat)format, mipCount, compressed, dataSize);
+                if (!texHandle.Valid)
+                {
+                    texHandle = instPtr->m_greyTexture;
+                    externalOwner = true;
+                }
+                RenderDebug.LogFormat("Uploaded precompressed BGFX texture {0},{1} from image handle {2} to bgfx index {3}", w, h, imageHandle, (int)texHandle.idx);
+            }
+            else if (format == ImageIOSTBNativeCalls.kFormatDecodedA8)
+            {
+                // mask only image, keep it single channel on the gpu as well
+                bool makeMips = (im2d.flags & TextureFlags.MimapEnabled) == TextureFlags.MimapEnabled;
+                ulong flags = instPtr->TextureFlagsToBGFXSamplerFlags(im2d) & ~(ulong)bgfx.TextureFlags.Srgb;
+                bgfx.Memory* bgfxblock = makeMips ? RendererBGFXStatic.CreateMipMapChain8(w, h, pixels) : RendererBGFXStatic.CreateMemoryBlock(pixels, w * h);
+                texHandle = bgfx.create_texture_2d((ushort)w, (ushort)h, makeMips, 1, bgfx.TextureFormat.A8, flags, bgfxblock);
+                RenderDebug.LogFormat("Uploaded A8 BGFX texture {0},{1} from image handle {2} to bgfx index {3}", w, h, imageHandle, (int)texHandle.idx);
+            }
+            else
+            {
+                bool isSRGB = (im2d.flags & TextureFlags.Srgb) == TextureFlags.Srgb;
+                bool makeMips = (im2d.flags & TextureFlags.MimapEnabled) == TextureFlags.MimapEnabled;
+                ulong flags = instPtr->TextureFlagsToBGFXSamplerFlags(im2d);
+                bgfx.Memory* bgfxblock = makeMips ? RendererBGFXStatic.CreateMipMapChain32(w, h, (uint*)pixels, isSRGB) : RendererBGFXStatic.CreateMemoryBlock(pixels, w * h * 4);
+                texHandle = bgfx.create_texture_2d((ushort)w, (ushort)h, makeMips, 1, bgfx.TextureFormat.RGBA8, flags, bgfxblock);
+                RenderDebug.LogFormat("Uploaded BGFX texture {0},{1} from image handle {2} to bgfx index {3}", w, h, imageHandle, (int)texHandle.idx);
+            }
+            return texHandle;
+        }
+
+        // Gives back the space of destroyed images and, once the pack job is done, uploads the changed parts of the pages,
+        // moves the texture coordinates of repacked images, hands placed images their page and starts packing what came in since
+        private void UpdateTextureAtlas(EntityCommandBuffer ecb)
+        {
+            var instPtr = InstancePointer();
+            Entities.WithoutBurst().WithNone<Image2D>().ForEach((Entity e, ref TextureAtlasEntryBGFX entry) =>
+            {
+                ImageIOSTBNativeCalls.AtlasRemove(entry.entryId);
+                ecb.RemoveComponent<TextureAtlasEntryBGFX>(e);
+                ecb.RemoveComponent<TextureBGFX>(e);
+            }).Run();
+            Entities.WithoutBurst().WithNone<Image2D>().ForEach((Entity e, ref TextureAtlasPendingBGFX pending) =>
+            {
+                ImageIOSTBNativeCalls.AtlasRemove(pending.entryId);
+                ecb.RemoveComponent<TextureAtlasPendingBGFX>(e);
+            }).Run();
+
+            if (ImageIOSTBNativeCalls.AtlasPoll() == 0)
+                return;
+
+            instPtr->m_textureAtlas.UploadPages();
+
+            Entities.WithoutBurst().ForEach((ref TextureAtlasEntryBGFX entry) =>
+            {
+                int page = 0, x = 0, y = 0, w = 0, h = 0, generation = 0;
+                if (ImageIOSTBNativeCalls.AtlasGetEntry(entry.entryId, ref page, ref x, ref y, ref w, ref h, ref generation) != ImageIOSTBNativeCalls.kAtlasPlaced)
+                    return;
+                if (generation == entry.generation)
+                    return;
+                entry.generation = generation;
+                entry.uvScaleOffset = TextureAtlasBGFX.UvScaleOffset(x, y, w, h);
+            }).Run();
+
+            Entities.WithoutBurst().WithNone<TextureBGFX>().ForEach((Entity e, ref Image2D im2d, ref TextureAtlasPendingBGFX pending) =>
+            {
+                int page = 0, x = 0, y = 0, w = 0, h = 0, generation = 0;
+                int status = ImageIOSTBNativeCalls.AtlasGetEntry(pending.entryId, ref page, ref x, ref y, ref w, ref h, ref generation);
+                if (status == ImageIOSTBNativeCalls.kAtlasQueued)
+                    return;
+                ecb.RemoveComponent<TextureAtlasPendingBGFX>(e);
+                if (status == ImageIOSTBNativeCalls.kAtlasPlaced)
+                {
+                    ecb.AddComponent(e, new TextureBGFX
+                    {
+                        handle = instPtr->m_textureAtlas.PageTexture(page),
+                        externalOwner = true
+                    });
+                    ecb.AddComponent(e, new TextureAtlasEntryBGFX
+                    {
+                        entryId = pending.entryId,
+                        generation = generation,
+                        uvScaleOffset = TextureAtlasBGFX.UvScaleOffset(x, y, w, h)
+                    });
+                    return;
+                }
+
+                // all pages are full, the image gets a texture of its own from the pixels the atlas kept
+                byte* pixels = ImageIOSTBNativeCalls.AtlasGetFailedPixels(pending.entryId, ref w, ref h);
+                bgfx.TextureHandle texHandle = instPtr->m_greyTexture;
+                if (pixels != null)
+                {
+                    ulong flags = instPtr->TextureFlagsToBGFXSamplerFlags(im2d);
+                    texHandle = bgfx.create_texture_2d((ushort)w, (ushort)h, false, 1, bgfx.TextureFormat.RGBA8, flags, RendererBGFXStatic.CreateMemoryBlock(pixels, w * h * 4));
+                    RenderDebug.LogFormat("Atlas pages are full, uploaded BGFX texture {0},{1} to bgfx index {2}", w, h, (int)texHandle.idx);
+                }
+                ImageIOSTBNativeCalls.AtlasRemove(pending.entryId);
+                ecb.AddComponent(e, new TextureBGFX
+                {
+                    handle = texHandle,
+                    externalOwner = pixels == null
+                });
+            }).Run();
+
+            ImageIOSTBNativeCalls.AtlasStart();
+        }
+#endif
+
         private void UploadTextures()
         {
             // upload all texture that need uploading - we do not track changes to images here. need a different mechanic for that.
@@ -1353,31 +1951,46 @@ namespace Unity.Tiny.Rendering
             }).Run();
 #if UNITY_DOTSRUNTIME
 #if !UNITY_WEBGL
-            Entities.WithoutBurst().WithNone<TextureBGFX>().ForEach((Entity e, ref Image2D im2d, ref Image2DSTB imstb) =>
+            // images that may share an atlas page are handed to the pack job, the pixels are copied so the image memory goes right away
+            Entities.WithoutBurst().WithAll<Image2DAtlas>().WithNone<TextureBGFX, TextureAtlasPendingBGFX>().ForEach((Entity e, ref Image2D im2d, ref Image2DSTB imstb) =>
             {
                 if (im2d.status != ImageStatus.Loaded)
                     return;
                 RendererBGFXStatic.AdjustFlagsForPot(ref im2d);
-                bgfx.TextureHandle texHandle;
-                int w = 0;
-                int h = 0;
-                unsafe {
-                    byte* pixels = ImageIOSTBNativeCalls.GetImageFromHandle(imstb.imageHandle, ref w, ref h);
-                    bool isSRGB = (im2d.flags & TextureFlags.Srgb) == TextureFlags.Srgb;
-                    bool makeMips = (im2d.flags & TextureFlags.MimapEnabled) == TextureFlags.MimapEnabled;
-                    ulong flags = instPtr->TextureFlagsToBGFXSamplerFlags(im2d);
-                    bgfx.Memory* bgfxblock = makeMips ? RendererBGFXStatic.CreateMipMapChain32(w, h, (uint*)pixels, isSRGB) : RendererBGFXStatic.CreateMemoryBlock(pixels, w * h * 4);
-                    texHandle = bgfx.create_texture_2d((ushort)w, (ushort)h, makeMips, 1, bgfx.TextureFormat.RGBA8, flags, bgfxblock);
-                    RenderDebug.LogFormat("Uploaded BGFX texture {0},{1} from image handle {2} to bgfx index {3}", w, h, imstb.imageHandle, (int)texHandle.idx);
+                long entryId = 0;
+                if (TextureAtlasBGFX.TryGetKind(instPtr, im2d, out int kind))
+                    entryId = ImageIOSTBNativeCalls.AtlasAdd(imstb.imageHandle, kind);
+                if (entryId != 0)
+                {
+                    ecb.AddComponent(e, new TextureAtlasPendingBGFX { entryId = entryId });
+                }
+                else
+                {
+                    var texHandle = UploadImageSTB(instPtr, ref im2d, imstb.imageHandle, out bool externalOwner);
+                    ecb.AddComponent(e, new TextureBGFX
+                    {
+                        handle = texHandle,
+                        externalOwner = externalOwner
+                    });
                 }
                 ImageIOSTBNativeCalls.FreeBackingMemory(imstb.imageHandle);
                 ecb.RemoveComponent<Image2DSTB>(e);
+            }).Run();
+            Entities.WithoutBurst().WithNone<TextureBGFX, Image2DAtlas>().ForEach((Entity e, ref Image2D im2d, ref Image2DSTB imstb) =>
+            {
+                if (im2d.status != ImageStatus.Loaded)
+                    return;
+                RendererBGFXStatic.AdjustFlagsForPot(ref im2d);
+                var texHandle = UploadImageSTB(instPtr, ref im2d, imstb.imageHandle, out bool externalOwner);
+                ImageIOSTBNativeCalls.FreeBackingMemory(imstb.imageHandle);
+                ecb.RemoveComponent<Image2DSTB>(e);
                 ecb.AddComponent(e, new TextureBGFX
                 {
                     handle = texHandle,
-                    externalOwner = false
+                    externalOwner = externalOwner
                 });
             }).Run();
+            UpdateTextureAtlas(ecb);
 #else
             Entities.WithoutBurst().WithNone<TextureBGFX>().ForEach((Entity e, ref Image2D im2d, ref Image2DHTML imhtml) =>
             {
@@ -1611,7 +2224,7 @@ namespace Unity.Tiny.Rendering
             ProfilerStats.Stats.drawStats.triangles1024 = (int)stats->numPrims[0] / 1024;
             ProfilerStats.Stats.drawStats.vertices1024 = (int)(stats->numPrims[0] * 3 / 6) / 1024;  // 3 vertices per triangle, divided by average valence of 6 which is optimal for a good mesh
             ProfilerStats.Stats.drawStats.hasInstancing = 0;
-            ProfilerStats.Stats.drawStats.shadowCasters = 0;
+            ProfilerStats.Stats.drawStats.shadowCasters = instance->m_shadowDraws;
             ProfilerStats.Stats.drawStats.usedTextureCount = stats->numTextures;
             ProfilerStats.Stats.drawStats.usedTextureKB = (int)stats->textureMemoryUsed / 1024;
             //ProfilerStats.stats.drawStats.renderTextureCount;   // Calculated in RendererBGFXSystem.UpdateRTT()
@@ -1652,11 +2265,14 @@ namespace Unity.Tiny.Rendering
         {
             CompleteDependency();
             var sys = World.GetExistingSystem<RendererBGFXSystem>();
+            // the one point where draw encoding of all passes has to be done
+            sys.CompleteEncodeJobs();
             if (sys.IsInitialized())
             {
                 CheckState();
                 var instancePointer = sys.InstancePointer();
                 instancePointer->WaitForEncoders();
+                instancePointer->CollectFrameStats();
                 CollectProfilerStats(instancePointer);
                 instancePointer->Frame();
             }
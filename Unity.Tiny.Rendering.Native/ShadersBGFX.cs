@@ -109,6 +109,10 @@ namespace Unity.Tiny.Rendering
         public bgfx.UniformHandle m_simplelightPosOrDir;
         public bgfx.UniformHandle m_simplelightColorIVR;
 
+        // clustered point lights, see RendererBGFXInstance.m_lightCluster
+        public bgfx.UniformHandle m_uniformLightCluster;
+        public bgfx.UniformHandle m_samplerLightCluster;
+
         public MappedLight m_mappedLight0;
         public MappedLight m_mappedLight1;
         public bgfx.UniformHandle m_texShadow01sis;
@@ -197,6 +201,9 @@ namespace Unity.Tiny.Rendering
             m_simplelightPosOrDir = bgfx.create_uniform("u_simplelight_posordir", bgfx.UniformType.Vec4, 8);
             m_simplelightColorIVR = bgfx.create_uniform("u_simplelight_color_ivr", bgfx.UniformType.Vec4, 8);
 
+            m_uniformLightCluster = bgfx.create_uniform("u_lightCluster", bgfx.UniformType.Vec4, 6);
+            m_samplerLightCluster = bgfx.create_uniform("s_lightCluster", bgfx.UniformType.Sampler, 1);
+
             m_numLights = bgfx.create_uniform("u_numlights", bgfx.UniformType.Vec4, 1);
 
             m_uniformOutputDebugSelect = bgfx.create_uniform("u_outputdebugselect", bgfx.UniformType.Vec4, 1);
@@ -233,6 +240,8 @@ namespace Unity.Tiny.Rendering
 
             bgfx.destroy_uniform(m_simplelightPosOrDir);
             bgfx.destroy_uniform(m_simplelightColorIVR);
+            bgfx.destroy_uniform(m_uniformLightCluster);
+            bgfx.destroy_uniform(m_samplerLightCluster);
 
             bgfx.destroy_uniform(m_samplerShadowCSM);
             bgfx.destroy_uniform(m_offsetScaleCSM);
@@ -251,18 +260,21 @@ namespace Unity.Tiny.Rendering
     public struct LitSkinnedMeshShader
     {
         public LitShader m_litShader;
-        // mesh skinning
-        public bgfx.UniformHandle m_uniformBoneMatrices;
+        // mesh skinning, see RendererBGFXInstance.m_bonePalette
+        public bgfx.UniformHandle m_uniformBonePalette;
+        public bgfx.UniformHandle m_samplerBonePalette;
 
         public void Init(bgfx.ProgramHandle program)
         {
             m_litShader.Init(program);
-            m_uniformBoneMatrices = bgfx.create_uniform("u_bone_matrices", bgfx.UniformType.Mat4, 32);
+            m_uniformBonePalette = bgfx.create_uniform("u_bonePalette", bgfx.UniformType.Vec4, 1);
+            m_samplerBonePalette = bgfx.create_uniform("s_bonePalette", bgfx.UniformType.Sampler, 1);
         }
 
         public void Destroy()
         {
-            bgfx.destroy_uniform(m_uniformBoneMatrices);
+            bgfx.destroy_uniform(m_uniformBonePalette);
+            bgfx.destroy_uniform(m_samplerBonePalette);
             m_litShader.Destroy();
         }
     }
@@ -297,18 +309,21 @@ namespace Unity.Tiny.Rendering
     public struct SimpleSkinnedMeshShader
     {
         public SimpleShader m_simpleShader;
-        // mesh skinning
-        public bgfx.UniformHandle m_uniformBoneMatrices;
+        // mesh skinning, see RendererBGFXInstance.m_bonePalette
+        public bgfx.UniformHandle m_uniformBonePalette;
+        public bgfx.UniformHandle m_samplerBonePalette;
 
         public void Init(bgfx.ProgramHandle program)
         {
             m_simpleShader.Init(program);
-            m_uniformBoneMatrices = bgfx.create_uniform("u_bone_matrices", bgfx.UniformType.Mat4, 32);
+            m_uniformBonePalette = bgfx.create_uniform("u_bonePalette", bgfx.UniformType.Vec4, 1);
+            m_samplerBonePalette = bgfx.create_uniform("s_bonePalette", bgfx.UniformType.Sampler, 1);
         }
 
         public void Destroy()
         {
-            bgfx.destroy_uniform(m_uniformBoneMatrices);
+            bgfx.destroy_uniform(m_uniformBonePalette);
+            bgfx.destroy_uniform(m_samplerBonePalette);
             m_simpleShader.Destroy();
         }
     }
@@ -385,18 +400,21 @@ namespace Unity.Tiny.Rendering
     {
         public ShadowMapShader m_shadowMapShader;
 
-        // mesh skinning
-        public bgfx.UniformHandle m_uniformBoneMatrices;
+        // mesh skinning, see RendererBGFXInstance.m_bonePalette
+        public bgfx.UniformHandle m_uniformBonePalette;
+        public bgfx.UniformHandle m_samplerBonePalette;
 
         public void Init(bgfx.ProgramHandle program)
         {
             m_shadowMapShader.Init(program);
-            m_uniformBoneMatrices = bgfx.create_uniform("u_bone_matrices", bgfx.UniformType.Mat4, 32);
+            m_uniformBonePalette = bgfx.create_uniform("u_bonePalette", bgfx.UniformType.Vec4, 1);
+            m_samplerBonePalette = bgfx.create_uniform("s_bonePalette", bgfx.UniformType.Sampler, 1);
         }
 
         public void Destroy()
         {
-            bgfx.destroy_uniform(m_uniformBoneMatrices);
+            bgfx.destroy_uniform(m_uniformBonePalette);
+            bgfx.destroy_uniform(m_samplerBonePalette);
             m_shadowMapShader.Destroy();
         }
     }
@@ -0,0 +1,229 @@
+using System;
+using Unity.Burst;
+using Unity.Collections;
+using Unity.Mathematics;
+using Unity.Entities;
+using Unity.Transforms;
+using Bgfx;
+
+namespace Unity.Tiny.Rendering
+{
+    // What a shadow map pass rendered into its part of the shadow map the last time it was submitted, see UpdateBGFXShadowMapCache
+    internal struct ShadowMapPassCacheBGFX : IComponentData
+    {
+        public float4x4 viewProjection;
+        public ushort frameBuffer;
+        public uint casterHash;
+        public bool valid;
+    }
+
+    internal struct ShadowCasterPass
+    {
+        public Entity pass;
+        public Frustum frustum;
+        public uint casterHash;     // sum over the caster chunks that touch the pass, so chunk order does not matter
+        public bool dynamicCasters; // skinned, particle or dynamic mesh casters touch the pass, those change without anything we can track
+    }
+
+    // Hashes the shadow casters every shadow map pass would draw. Transforms count as changed when a system wrote
+    // to their chunk, entities coming and going and mesh swaps are caught by hashing every entity of a touching chunk.
+    [BurstCompile]
+    internal struct HashShadowCastersJob : IJob
+    {
+        [ReadOnly] public NativeArray<ArchetypeChunk> Chunks;
+        [ReadOnly] public NativeArray<Entity> SharedRenderToPass;
+        [ReadOnly] public EntityTypeHandle EntityType;
+        [ReadOnly] public ComponentTypeHandle<LocalToWorld> LocalToWorldType;
+        [ReadOnly] public ComponentTypeHandle<MeshRenderer> MeshRendererType;
+        [ReadOnly] public ComponentTypeHandle<SkinnedMeshRenderer> SkinnedMeshRendererType;
+        [ReadOnly] public ComponentTypeHandle<SimpleParticleRenderer> SimpleParticleRendererType;
+        [ReadOnly] public ComponentTypeHandle<LitParticleRenderer> LitParticleRendererType;
+        [ReadOnly] public ComponentTypeHandle<ChunkWorldBounds> ChunkWorldBoundsType;
+        [ReadOnly] public BufferFromEntity<RenderToPassesEntry> BufferRenderToPassesEntry;
+        [ReadOnly] public ComponentDataFromEntity<MeshBGFX> ComponentMeshBGFX;
+        [ReadOnly] public ComponentDataFromEntity<DynamicMeshData> ComponentDynamicMeshData;
+        public NativeArray<ShadowCasterPass> Passes;
+
+        static bool RendersTo(DynamicBuffer<RenderToPassesEntry> toPasses, Entity ePass)
+        {
+            for (int i = 0; i < toPasses.Length; i++)
+            {
+                if (toPasses[i].e == ePass)
+                    return true;
+            }
+            return false;
+        }
+
+        uint HashChunk(ArchetypeChunk chunk, ref bool dynamicCasters)
+        {
+            var entities = chunk.GetNativeArray(EntityType);
+            uint h = math.hash(new uint2((uint)chunk.Count, chunk.GetChangeVersion(LocalToWorldType)));
+            var meshRenderers = chunk.GetNativeArray(MeshRendererType);
+            for (int j = 0; j < chunk.Count; j++)
+            {
+                var mr = meshRenderers[j];
+                if (ComponentDynamicMeshData.HasComponent(mr.mesh))
+                {
+                    dynamicCasters = true;
+                    return 0;
+                }
+                int meshState = ComponentMeshBGFX.HasComponent(mr.mesh) ? mr.mesh.Index : -1;
+                h = h * 16777619u ^ math.hash(new int4(entities[j].Index, meshState, mr.startIndex, mr.indexCount));
+            }
+            return h;
+        }
+
+        public void Execute()
+        {
+            for (int c = 0; c < Chunks.Length; c++)
+            {
+                var chunk = Chunks[c];
+                var bounds = chunk.GetChunkComponentData(ChunkWorldBoundsType).Value;
+                var toPasses = BufferRenderToPassesEntry[SharedRenderToPass[c]];
+                bool dynamicCasters = chunk.Has(SkinnedMeshRendererType) || chunk.Has(SimpleParticleRendererType) || chunk.Has(LitParticleRendererType);
+                bool hashed = false;
+                uint chunkHash = 0;
+                for (int i = 0; i < Passes.Length; i++)
+                {
+                    var p = Passes[i];
+                    if (p.dynamicCasters || !RendersTo(toPasses, p.pass))
+                        continue;
+                    if (Culling.Cull(in bounds, in p.frustum) == Culling.CullingResult.Outside)
+                        continue;
+                    if (!hashed && !dynamicCasters)
+                        chunkHash = HashChunk(chunk, ref dynamicCasters);
+                    hashed = true;
+                    if (dynamicCasters)
+                        p.dynamicCasters = true;
+                    else
+                        p.casterHash += chunkHash;
+                    Passes[i] = p;
+                }
+            }
+        }
+    }
+
+    // Shadow map passes whose casters, view and target did not change since they were last rendered keep what is in the
+    // shadow map: they are flagged RenderPassFlags.Cached, submit systems skip them and their view does not clear.
+    // Far cascades that CascadeShadowmappedLightCache.dueCascades does not list are kept even when their casters changed.
+    // The whole pass is kept or re-rendered, static and dynamic casters are not split into separate maps.
+    [UpdateInGroup(typeof(PresentationSystemGroup))]
+    [UpdateAfter(typeof(PreparePassesFroBGFXSystem))]
+    [UpdateAfter(typeof(UpdateWorldBoundsSystem))]
+    [UpdateBefore(typeof(SubmitSystemGroup))]
+    public unsafe class UpdateBGFXShadowMapCache : SystemBase
+    {
+        EntityQuery m_casterQuery;
+        bool m_wasInitialized;
+
+        protected override void OnCreate()
+        {
+            m_casterQuery = GetEntityQuery(new EntityQueryDesc
+            {
+                All = new[] {ComponentType.ReadOnly<LocalToWorld>(), ComponentType.ReadOnly<RenderToPasses>(), ComponentType.ChunkComponentReadOnly<ChunkWorldBounds>()},
+                Any = new[] {ComponentType.ReadOnly<MeshRenderer>(), ComponentType.ReadOnly<SkinnedMeshRenderer>()},
+                None = new[] {ComponentType.ReadOnly<DisableRendering>()}
+            });
+        }
+
+        protected override void OnUpdate()
+        {
+            var sys = World.GetExistingSystem<RendererBGFXSystem>().InstancePointer();
+            sys->m_shadowPassesRendered = 0;
+            sys->m_shadowPassesCached = 0;
+            if (!sys->m_initialized)
+            {
+                m_wasInitialized = false;
+                return;
+            }
+            // render targets are new after an init, nothing from before can be kept
+            bool flush = !m_wasInitialized;
+            m_wasInitialized = true;
+            Dependency.Complete();
+
+            EntityCommandBuffer ecb = new EntityCommandBuffer(Allocator.TempJob);
+            Entities.WithNone<ShadowMapPassCacheBGFX>().ForEach((Entity e, in RenderPass pass) =>
+            {
+                if (pass.passType == RenderPassType.ShadowMap)
+                    ecb.AddComponent<ShadowMapPassCacheBGFX>(e);
+            }).Run();
+            ecb.Playback(EntityManager);
+            ecb.Dispose();
+
+            var passes = new NativeList<ShadowCasterPass>(Allocator.TempJob);
+            Entities.WithoutBurst().WithAll<ShadowMapPassCacheBGFX>().ForEach((Entity e, in RenderPass pass) =>
+            {
+                passes.Add(new ShadowCasterPass { pass = e, frustum = pass.frustum });
+            }).Run();
+            if (passes.Length == 0)
+            {
+                passes.Dispose();
+                return;
+            }
+
+            var chunks = m_casterQuery.CreateArchetypeChunkArray(Allocator.TempJob);
+            var sharedRenderToPass = new NativeArray<Entity>(chunks.Length, Allocator.TempJob, NativeArrayOptions.UninitializedMemory);
+            var renderToPassesType = GetSharedComponentTypeHandle<RenderToPasses>();
+            for (int i = 0; i < chunks.Length; i++)
+                sharedRenderToPass[i] = chunks[i].GetSharedComponentData<RenderToPasses>(renderToPassesType, EntityManager).e;
+            new HashShadowCastersJob
+            {
+                Chunks = chunks,
+                SharedRenderToPass = sharedRenderToPass,
+                EntityType = GetEntityTypeHandle(),
+                LocalToWorldType = GetComponentTypeHandle<LocalToWorld>(true),
+                MeshRendererType = GetComponentTypeHandle<MeshRenderer>(true),
+                SkinnedMeshRendererType = GetComponentTypeHandle<SkinnedMeshRenderer>(true),
+                SimpleParticleRendererType = GetComponentTypeHandle<SimpleParticleRenderer>(true),
+                LitParticleRendererType = GetComponentTypeHandle<LitParticleRenderer>(true),
+                ChunkWorldBoundsType = GetComponentTypeHandle<ChunkWorldBounds>(true),
+                BufferRenderToPassesEntry = GetBufferFromEntity<RenderToPassesEntry>(true),
+                ComponentMeshBGFX = GetComponentDataFromEntity<MeshBGFX>(true),
+                ComponentDynamicMeshData = GetComponentDataFromEntity<DynamicMeshData>(true),
+                Passes = passes.AsArray()
+            }.Run();
+            chunks.Dispose();
+            sharedRenderToPass.Dispose();
+
+            for (int i = 0; i < passes.Length; i++)
+            {
+                var p = passes[i];
+                var pass = EntityManager.GetComponentData<RenderPass>(p.pass);
+                var cache = EntityManager.GetComponentData<ShadowMapPassCacheBGFX>(p.pass);
+                ushort frameBuffer = 0xffff;
+                if (EntityManager.HasComponent<FramebufferBGFX>(pass.inNode))
+                    frameBuffer = EntityManager.GetComponentData<FramebufferBGFX>(pass.inNode).handle.idx;
+                bool due = true;
+                if (EntityManager.HasComponent<RenderPassUpdateFromCascade>(p.pass))
+                {
+                    var fromCascade = EntityManager.GetComponentData<RenderPassUpdateFromCascade>(p.pass);
+                    var csmData = EntityManager.GetComponentData<CascadeShadowmappedLightCache>(fromCascade.light);
+                    due = (csmData.dueCascades & (1 << fromCascade.cascade)) != 0;
+                }
+
+                bool keep = cache.valid && !flush && cache.frameBuffer == frameBuffer && cache.viewProjection.Equals(pass.viewProjectionTransform);
+                if (keep && due)
+                    keep = !p.dynamicCasters && cache.casterHash == p.casterHash;
+                if (keep)
+                {
+                    pass.passFlags |= RenderPassFlags.Cached;
+                    bgfx.set_view_clear(pass.viewId, 0, 0, 1.0f, 0);
+                    EntityManager.SetComponentData(p.pass, pass);
+                    sys->m_shadowPassesCached++;
+                }
+                else
+                {
+                    EntityManager.SetComponentData(p.pass, new ShadowMapPassCacheBGFX
+                    {
+                        viewProjection = pass.viewProjectionTransform,
+                        frameBuffer = frameBuffer,
+                        casterHash = p.casterHash,
+                        valid = true
+                    });
+                    sys->m_shadowPassesRendered++;
+                }
+            }
+            passes.Dispose();
+        }
+    }
+}
@@ -82,24 +82,40 @@ namespace Unity.Tiny.Rendering
                 {
                     Entity ePass = toPasses[i].e;
                     var pass = EntityManager.GetComponentData<RenderPass>(ePass);
+                    if ((pass.passFlags & RenderPassFlags.Cached) != 0)
+                        continue;
                     if (Culling.Cull(in wbs, in pass.frustum) == Culling.CullingResult.Outside)
                         continue;
                     // double cull as example only
                     if (Culling.IsCulled(in wb, in pass.frustum))
                         continue;
                     var mesh = EntityManager.GetComponentData<MeshBGFX>(mr.mesh);
+                    int level = 0;
+                    int startIndex = mr.startIndex;
+                    int indexCount = mr.indexCount;
+                    if (EntityManager.HasComponent<MeshRendererLOD>(e))
+                    {
+                        var lod = EntityManager.GetComponentData<MeshRendererLOD>(e);
+                        if (lod.Matches(in mr))
+                        {
+                            level = lod.SelectLevel(pass.ComputeScreenRadius(wbs.position, wbs.radius));
+                            startIndex = lod.startIndex[level];
+                            indexCount = lod.indexCount[level];
+                        }
+                    }
+                    sys->m_lodTrianglesDirect[level] += indexCount / 3;
                     uint depth = 0;
                     switch (pass.passType)
                     {
                         case RenderPassType.ShadowMap:
-                            SubmitHelper.SubmitShadowMapMeshDirect(sys, pass.viewId, ref mesh, ref tx.Value, mr.startIndex, mr.indexCount, pass.GetFlipCullingInverse(), default);
+                            SubmitHelper.SubmitShadowMapMeshDirect(sys, pass.viewId, ref mesh, ref tx.Value, startIndex, indexCount, pass.GetFlipCullingInverse(), default);
                             break;
                         case RenderPassType.Transparent:
                             depth = pass.ComputeSortDepth(tx.Value.c3);
                             goto case RenderPassType.Opaque;
                         case RenderPassType.Opaque:
                             var material = EntityManager.GetComponentData<SimpleMaterialBGFX>(mr.material);
-                            SubmitHelper.SubmitSimpleMeshDirect(sys, pass.viewId, ref mesh, ref tx.Value, ref material, mr.startIndex, mr.indexCount, pass.GetFlipCulling(), depth);
+                            SubmitHelper.SubmitSimpleMeshDirect(sys, pass.viewId, ref mesh, ref tx.Value, ref material, startIndex, indexCount, pass.GetFlipCulling(), depth);
                             break;
                         default:
                             Assert.IsTrue(false);
@@ -113,10 +129,39 @@ namespace Unity.Tiny.Rendering
     [UpdateInGroup(typeof(SubmitSystemGroup))]
     public class SubmitStaticLitMeshChunked : SystemBase
     {
+        // runs shorter than this are not worth an instance data buffer
+        const int kMinInstanceCount = 4;
+
+        // sorting by this puts renderers that can share one instanced draw next to each other,
+        // and renderers with the same material next to each other so they can share material uniforms
+        struct InstanceKey : IComparable<InstanceKey>
+        {
+            public int mesh;
+            public int material;
+            public int startIndex;
+            public int indexCount;
+            public int entityIndex; // in chunk
+
+            public bool SameDraw(InstanceKey o)
+            {
+                return mesh == o.mesh && material == o.material && startIndex == o.startIndex && indexCount == o.indexCount;
+            }
+
+            public int CompareTo(InstanceKey o)
+            {
+                if (material != o.material) return material < o.material ? -1 : 1;
+                if (mesh != o.mesh) return mesh < o.mesh ? -1 : 1;
+                if (startIndex != o.startIndex) return startIndex < o.startIndex ? -1 : 1;
+                if (indexCount != o.indexCount) return indexCount < o.indexCount ? -1 : 1;
+                return entityIndex.CompareTo(o.entityIndex);
+            }
+        }
+
         unsafe struct SubmitStaticLitMeshJob : IJobChunk
         {
             [ReadOnly] public ComponentTypeHandle<LocalToWorld> LocalToWorldType;
             [ReadOnly] public ComponentTypeHandle<MeshRenderer> MeshRendererType;
+            [ReadOnly] public ComponentTypeHandle<MeshRendererLOD> MeshRendererLODType;
             [ReadOnly] public ComponentTypeHandle<WorldBounds> WorldBoundsType;
             [ReadOnly] public ComponentTypeHandle<WorldBoundingSphere> WorldBoundingSphereType;
             [ReadOnly] public ComponentTypeHandle<ChunkWorldBoundingSphere> ChunkWorldBoundingSphereType;
@@ -134,6 +179,99 @@ namespace Unity.Tiny.Rendering
             [ReadOnly] public PerThreadDataBGFX* PerThreadData;
             [ReadOnly] public int MaxPerThreadData;
             [ReadOnly] public RendererBGFXInstance* BGFXInstancePtr;
+            [ReadOnly] public bool UseInstancing;
+
+            // chunkLOD is not created for chunks without levels of detail, those always draw level 0,
+            // as do renderers whose levels were built for another mesh or sub mesh
+            private static int SelectLevel(ref RenderPass pass, NativeArray<MeshRenderer> chunkMeshRenderer, NativeArray<MeshRendererLOD> chunkLOD, NativeArray<WorldBoundingSphere> worldBoundingSphere, int j)
+            {
+                if (!chunkLOD.IsCreated || !chunkLOD[j].Matches(chunkMeshRenderer[j]))
+                    return 0;
+                var sphere = worldBoundingSphere[j];
+                return chunkLOD[j].SelectLevel(pass.ComputeScreenRadius(sphere.position, sphere.radius));
+            }
+
+            private static void GetDrawRange(in MeshRenderer meshRenderer, NativeArray<MeshRendererLOD> chunkLOD, int j, int level, out int startIndex, out int indexCount)
+            {
+                startIndex = level == 0 ? meshRenderer.startIndex : chunkLOD[j].startIndex[level];
+                indexCount = level == 0 ? meshRenderer.indexCount : chunkLOD[j].indexCount[level];
+            }
+
+            private void EncodeOne(bgfx.Encoder* encoder, ref RenderPass pass, ref LightingBGFX lighting, Entity lightingEntity, NativeArray<LocalToWorld> chunkLocalToWorld, NativeArray<MeshRenderer> chunkMeshRenderer, NativeArray<MeshRendererLOD> chunkLOD, int j, int level)
+            {
+                var tx = chunkLocalToWorld[j].Value;
+                var meshRenderer = chunkMeshRenderer[j];
+                GetDrawRange(in meshRenderer, chunkLOD, j, level, out int startIndex, out int indexCount);
+                if (indexCount > 0 && ComponentMeshBGFX.HasComponent(meshRenderer.mesh))
+                {
+                    var mesh = ComponentMeshBGFX[meshRenderer.mesh];
+                    PerThreadData[ThreadIndex].lodTriangles[level] += indexCount / 3;
+                    Assert.IsTrue(mesh.IsValid());
+                    uint depth = 0;
+                    switch (pass.passType)
+                    {
+                        case RenderPassType.ShadowMap:
+                            float4 bias = new float4(0);
+                            SubmitHelper.EncodeShadowMapMesh(BGFXInstancePtr, encoder, pass.viewId, ref mesh, ref tx, startIndex, indexCount, pass.GetFlipCullingInverse(), bias);
+                            PerThreadData[ThreadIndex].shadowDraws++;
+                            break;
+                        case RenderPassType.Transparent:
+                            depth = pass.ComputeSortDepth(tx.c3);
+                            goto case RenderPassType.Opaque;
+                        case RenderPassType.Opaque:
+                            var material = ComponentLitMaterialBGFX[meshRenderer.material];
+                            SubmitHelper.EncodeLitMesh(BGFXInstancePtr, encoder, pass.viewId, ref mesh, ref tx, ref material, ref lighting, ref pass.viewTransform, startIndex, indexCount, pass.GetFlipCulling(), ref PerThreadData[ThreadIndex].viewSpaceLightCache, depth,
+                                SubmitHelper.LitUniformCache(&PerThreadData[ThreadIndex], ref pass), SubmitHelper.LitStateKey(meshRenderer.material, lightingEntity));
+                            break;
+                        default:
+                            Assert.IsTrue(false);
+                            break;
+                    }
+                }
+            }
+
+            // visible holds count in chunk indices of renderers that share mesh, sub mesh, material and level of detail
+            private void EncodeInstanced(bgfx.Encoder* encoder, ref RenderPass pass, ref LightingBGFX lighting, Entity lightingEntity, NativeArray<LocalToWorld> chunkLocalToWorld, NativeArray<MeshRenderer> chunkMeshRenderer, NativeArray<MeshRendererLOD> chunkLOD, NativeArray<int> visible, int count, int level)
+            {
+                var meshRenderer = chunkMeshRenderer[visible[0]];
+                GetDrawRange(in meshRenderer, chunkLOD, visible[0], level, out int startIndex, out int indexCount);
+                bool canInstance = count >= kMinInstanceCount && indexCount > 0 && ComponentMeshBGFX.HasComponent(meshRenderer.mesh);
+                if (canInstance && pass.passType == RenderPassType.Opaque)
+                {
+                    // custom shaders have no instanced variant
+                    var material = ComponentLitMaterialBGFX[meshRenderer.material];
+                    canInstance = material.shaderProgram.idx == BGFXInstancePtr->m_litShader.m_prog.idx;
+                }
+                if (canInstance)
+                    canInstance = bgfx.get_avail_instance_data_buffer((uint)count, (ushort)sizeof(float4x4)) >= (uint)count;
+                if (!canInstance)
+                {
+                    for (int k = 0; k < count; k++)
+                        EncodeOne(encoder, ref pass, ref lighting, lightingEntity, chunkLocalToWorld, chunkMeshRenderer, chunkLOD, visible[k], level);
+                    return;
+                }
+
+                bgfx.InstanceDataBuffer idb;
+                bgfx.alloc_instance_data_buffer(&idb, (uint)count, (ushort)sizeof(float4x4));
+                float4x4* dest = (float4x4*)idb.data;
+                for (int k = 0; k < count; k++)
+                    dest[k] = chunkLocalToWorld[visible[k]].Value;
+
+                var mesh = ComponentMeshBGFX[meshRenderer.mesh];
+                Assert.IsTrue(mesh.IsValid());
+                PerThreadData[ThreadIndex].lodTriangles[level] += count * (indexCount / 3);
+                if (pass.passType == RenderPassType.ShadowMap)
+                {
+                    SubmitHelper.EncodeShadowMapMeshInstanced(BGFXInstancePtr, encoder, pass.viewId, ref mesh, &idb, startIndex, indexCount, pass.GetFlipCullingInverse(), new float4(0));
+                    PerThreadData[ThreadIndex].shadowDraws++;
+                }
+                else
+                {
+                    var material = ComponentLitMaterialBGFX[meshRenderer.material];
+                    SubmitHelper.EncodeLitMeshInstanced(BGFXInstancePtr, encoder, pass.viewId, ref mesh, &idb, ref material, ref lighting, ref pass.viewTransform, startIndex, indexCount, pass.GetFlipCulling(), ref PerThreadData[ThreadIndex].viewSpaceLightCache,
+                        SubmitHelper.LitUniformCache(&PerThreadData[ThreadIndex], ref pass), SubmitHelper.LitStateKey(meshRenderer.material, lightingEntity));
+                }
+            }
 
             public unsafe void Execute(ArchetypeChunk chunk, int chunkIndex, int firstEntityIndex)
             {
@@ -150,58 +288,100 @@ namespace Unity.Tiny.Rendering
                 Entity rtpe = SharedRenderToPass[chunkIndex];
 
                 Assert.IsTrue(ThreadIndex >= 0 && ThreadIndex < MaxPerThreadData);
-                bgfx.Encoder* encoder = PerThreadData[ThreadIndex].encoder;
-                if (encoder == null)
+                bgfx.Encoder* encoder = PerThreadData[ThreadIndex].GetEncoder();
+                DynamicBuffer<RenderToPassesEntry> toPasses = BufferRenderToPassesEntry[rtpe];
+
+                var chunkLOD = chunk.Has(MeshRendererLODType) ? chunk.GetNativeArray(MeshRendererLODType) : default;
+
+                // sort once per chunk, every opaque and shadow map pass walks the same runs of mesh and material
+                bool instancing = UseInstancing && chunk.Count >= kMinInstanceCount;
+                bool sorted = chunk.Count > 1;
+                NativeArray<InstanceKey> keys = default;
+                NativeArray<int> visible = default;
+                NativeArray<int> visibleLevel = default;
+                NativeArray<int> visibleAtLevel = default;
+                if (sorted)
                 {
-                    encoder = bgfx.encoder_begin(true);
-                    Assert.IsTrue(encoder != null);
-                    PerThreadData[ThreadIndex].encoder = encoder;
+                    keys = new NativeArray<InstanceKey>(chunk.Count, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+                    visible = new NativeArray<int>(chunk.Count, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+                    if (chunkLOD.IsCreated)
+                    {
+                        visibleLevel = new NativeArray<int>(chunk.Count, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+                        visibleAtLevel = new NativeArray<int>(chunk.Count, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+                    }
+                    for (int j = 0; j < chunk.Count; j++)
+                    {
+                        var meshRenderer = chunkMeshRenderer[j];
+                        keys[j] = new InstanceKey { mesh = meshRenderer.mesh.Index, material = meshRenderer.material.Index, startIndex = meshRenderer.startIndex, indexCount = meshRenderer.indexCount, entityIndex = j };
+                    }
+                    keys.Sort();
                 }
-                DynamicBuffer<RenderToPassesEntry> toPasses = BufferRenderToPassesEntry[rtpe];
 
                 // we can do this loop either way, passes first or renderers first.
                 // TODO: profile what is better!
+                CullingStats cullingStats = default;
                 for (int i = 0; i < toPasses.Length; i++)   // for all passes this chunk renderer to
                 {
                     Entity ePass = toPasses[i].e;
                     var pass = ComponentRenderPass[ePass];
                     Assert.IsTrue(encoder != null);
-                    for (int j = 0; j < chunk.Count; j++)   // for every renderer in chunk
+                    if ((pass.passFlags & RenderPassFlags.Cached) != 0)
+                        continue;
+                    var chunkCull = Culling.CullChunk(in chunkWorldBoundingSphere, in bounds, in pass.frustum, ref cullingStats);
+                    if (chunkCull == Culling.CullingResult.Outside)
+                        continue;
+                    bool fineCull = chunkCull != Culling.CullingResult.Inside;
+                    if (sorted && pass.passType != RenderPassType.Transparent)   // transparent draws need a sort depth each
                     {
-                        var wbs = worldBoundingSphere[j];
-                        var tx = chunkLocalToWorld[j].Value;
-                        if (wbs.radius > 0.0f && Culling.Cull(in wbs, in pass.frustum) == Culling.CullingResult.Outside) // TODO: fine cull only if rough culling was !Inside
-                            continue;
-                        var meshRenderer = chunkMeshRenderer[j];
-                        if (meshRenderer.indexCount > 0 && ComponentMeshBGFX.HasComponent(meshRenderer.mesh))
+                        for (int r = 0; r < chunk.Count;)
                         {
-                            var mesh = ComponentMeshBGFX[meshRenderer.mesh];
-                            Assert.IsTrue(mesh.IsValid());
-                            uint depth = 0;
-                            switch (pass.passType)   // TODO: we can hoist this out of the loop
+                            int end = r + 1;
+                            while (end < chunk.Count && keys[end].SameDraw(keys[r]))
+                                end++;
+                            int count = 0;
+                            for (int k = r; k < end; k++)
                             {
-                                case RenderPassType.ShadowMap:
-                                    float4 bias = new float4(0);
-                                    SubmitHelper.EncodeShadowMapMesh(BGFXInstancePtr, encoder, pass.viewId, ref mesh, ref tx, meshRenderer.startIndex, meshRenderer.indexCount, pass.GetFlipCullingInverse(), bias);
-                                    break;
-                                case RenderPassType.Transparent:
-                                    depth = pass.ComputeSortDepth(tx.c3);
-                                    goto case RenderPassType.Opaque;
-                                case RenderPassType.Opaque:
-                                    var material = ComponentLitMaterialBGFX[meshRenderer.material];
-                                    SubmitHelper.EncodeLitMesh(BGFXInstancePtr, encoder, pass.viewId, ref mesh, ref tx, ref material, ref lighting, ref pass.viewTransform, meshRenderer.startIndex, meshRenderer.indexCount, pass.GetFlipCulling(), ref PerThreadData[ThreadIndex].viewSpaceLightCache, depth);
-                                    break;
-                                default:
-                                    Assert.IsTrue(false);
-                                    break;
+                                int j = keys[k].entityIndex;
+                                if (fineCull && Culling.IsCulledInChunk(worldBoundingSphere[j], in pass.frustum, ref cullingStats))
+                                    continue;
+                                visible[count++] = j;
                             }
+                            if (instancing && count > 0 && chunkLOD.IsCreated)
+                            {
+                                // renderers of one run share their levels of detail, split it into one instanced draw per level
+                                for (int k = 0; k < count; k++)
+                                    visibleLevel[k] = SelectLevel(ref pass, chunkMeshRenderer, chunkLOD, worldBoundingSphere, visible[k]);
+                                for (int level = 0; level < MeshRendererLOD.kMaxLevels; level++)
+                                {
+                                    int levelCount = 0;
+                                    for (int k = 0; k < count; k++)
+                                    {
+                                        if (visibleLevel[k] == level)
+                                            visibleAtLevel[levelCount++] = visible[k];
+                                    }
+                                    if (levelCount > 0)
+                                        EncodeInstanced(encoder, ref pass, ref lighting, lighte, chunkLocalToWorld, chunkMeshRenderer, chunkLOD, visibleAtLevel, levelCount, level);
+                                }
+                            }
+                            else if (instancing && count > 0)
+                                EncodeInstanced(encoder, ref pass, ref lighting, lighte, chunkLocalToWorld, chunkMeshRenderer, chunkLOD, visible, count, 0);
+                            else
+                            {
+                                for (int k = 0; k < count; k++)
+                                    EncodeOne(encoder, ref pass, ref lighting, lighte, chunkLocalToWorld, chunkMeshRenderer, chunkLOD, visible[k], SelectLevel(ref pass, chunkMeshRenderer, chunkLOD, worldBoundingSphere, visible[k]));
+                            }
+                            r = end;
                         }
-                        else
-                        {
-                            //var mesh = ComponentDynamicMeshBGFX[meshRenderer.mesh];
-                        }
+                        continue;
+                    }
+                    for (int j = 0; j < chunk.Count; j++)   // for every renderer in chunk
+                    {
+                        if (fineCull && Culling.IsCulledInChunk(worldBoundingSphere[j], in pass.frustum, ref cullingStats))
+                            continue;
+                        EncodeOne(encoder, ref pass, ref lighting, lighte, chunkLocalToWorld, chunkMeshRenderer, chunkLOD, j, SelectLevel(ref pass, chunkMeshRenderer, chunkLOD, worldBoundingSphere, j));
                     }
                 }
+                PerThreadData[ThreadIndex].cullingStats.Add(in cullingStats);
             }
         }
 
@@ -250,6 +430,7 @@ namespace Unity.Tiny.Rendering
             {
                 LocalToWorldType = GetComponentTypeHandle<LocalToWorld>(true),
                 MeshRendererType = GetComponentTypeHandle<MeshRenderer>(true),
+                MeshRendererLODType = GetComponentTypeHandle<MeshRendererLOD>(true),
                 WorldBoundsType = GetComponentTypeHandle<WorldBounds>(true),
                 WorldBoundingSphereType = GetComponentTypeHandle<WorldBoundingSphere>(true),
                 ChunkWorldBoundingSphereType = GetComponentTypeHandle<ChunkWorldBoundingSphere>(true),
@@ -263,13 +444,14 @@ namespace Unity.Tiny.Rendering
                 ComponentLightingBGFX = GetComponentDataFromEntity<LightingBGFX>(true),
                 PerThreadData = sys->m_perThreadData,
                 MaxPerThreadData = sys->m_maxPerThreadData,
-                BGFXInstancePtr = sys
+                BGFXInstancePtr = sys,
+                UseInstancing = sys->m_instancingSupported
             };
             Assert.IsTrue(sys->m_maxPerThreadData > 0 && encodejob.MaxPerThreadData > 0);
 
             Dependency = encodejob.ScheduleParallel(m_query, Dependency);
-            // Temporary workaround until dependencies bugs are fixed.
-            Dependency.Complete();
+            // keeps encoding alongside the other submit systems, the frame waits for it
+            World.GetExistingSystem<RendererBGFXSystem>().AddEncodeJobs(Dependency);
         }
     }
 
@@ -294,37 +476,61 @@ namespace Unity.Tiny.Rendering
 
                 RenderToPasses toPassesRef = EntityManager.GetSharedComponentData<RenderToPasses>(e);
                 DynamicBuffer<RenderToPassesEntry> toPasses = EntityManager.GetBufferRO<RenderToPassesEntry>(toPassesRef.e);
-                DynamicBuffer<DynamicSimpleVertex> vBuffer = EntityManager.GetBufferRO<DynamicSimpleVertex>(mr.mesh);
-                DynamicBuffer<DynamicIndex> iBuffer = EntityManager.GetBufferRO<DynamicIndex>(mr.mesh);
-                int nindices = iBuffer.Length;
-                int nvertices = vBuffer.Length;
-                bgfx.TransientIndexBuffer tib;
-                bgfx.TransientVertexBuffer tvb;
-                if (!SubmitHelper.SubmitSimpleTransientAlloc(sys, &tib, &tvb, nvertices, nindices))
+                DynamicBuffer<ParticleInstance> instances = EntityManager.GetBufferRO<ParticleInstance>(e);
+                int count = instances.Length;
+                if (count == 0)
                     return;
-                SimpleVertex* destVertices = (SimpleVertex*)tvb.data;
-                ushort* destIndices = (ushort*)tib.data;
-                UnsafeUtility.MemCpy(destIndices, iBuffer.GetUnsafeReadOnlyPtr(), nindices * 2);
-                UnsafeUtility.MemCpy(destVertices, vBuffer.GetUnsafeReadOnlyPtr(), nvertices * sizeof(SimpleVertex));
+                var material = EntityManager.GetComponentData<SimpleMaterialBGFX>(mr.material);
+
+                // the instances are uploaded once and shared by the draws into all passes, without instancing the mesh is written out per particle
+                MeshBGFX mesh = EntityManager.HasComponent<MeshBGFX>(mr.mesh) ? EntityManager.GetComponentData<MeshBGFX>(mr.mesh) : MeshBGFX.CreateEmpty();
+                bool instanced = sys->m_instancingSupported && mesh.IsValid() &&
+                    bgfx.get_avail_instance_data_buffer((uint)count, (ushort)sizeof(ParticleInstance)) >= (uint)count;
+                bgfx.InstanceDataBuffer idb = default;
+                bgfx.TransientIndexBuffer tib = default;
+                bgfx.TransientVertexBuffer tvb = default;
+                int nindices = 0;
+                int nvertices = 0;
+                if (instanced)
+                {
+                    bgfx.alloc_instance_data_buffer(&idb, (uint)count, (ushort)sizeof(ParticleInstance));
+                    UnsafeUtility.MemCpy(idb.data, instances.GetUnsafeReadOnlyPtr(), count * sizeof(ParticleInstance));
+                }
+                else
+                {
+                    ref SimpleMeshData smd = ref EntityManager.GetComponentData<SimpleMeshRenderData>(mr.mesh).Mesh.Value;
+                    nindices = count * smd.Indices.Length;
+                    nvertices = count * smd.Vertices.Length;
+                    if (!SubmitHelper.SubmitSimpleTransientAlloc(sys, &tib, &tvb, nvertices, nindices))
+                        return;
+                    SubmitHelper.ExpandSimpleParticles((SimpleVertex*)tvb.data, (ushort*)tib.data, ref smd, (ParticleInstance*)instances.GetUnsafeReadOnlyPtr(), count, material.billboarded.x == 1.0f);
+                }
 
                 for (int i = 0; i < toPasses.Length; i++)
                 {
                     Entity ePass = toPasses[i].e;
                     var pass = EntityManager.GetComponentData<RenderPass>(ePass);
+                    if ((pass.passFlags & RenderPassFlags.Cached) != 0)
+                        continue;
                     if (Culling.Cull(in wbs, in pass.frustum) == Culling.CullingResult.Outside)
                         continue;
                     uint depth = 0;
                     switch (pass.passType)
                     {
                         case RenderPassType.ShadowMap:
-                            SubmitHelper.SubmitSimpleShadowMapTransientDirect(sys, &tib, &tvb, nvertices, nindices, pass.viewId, ref tx.Value, pass.GetFlipCullingInverse(), default);
+                            if (instanced)
+                                SubmitHelper.SubmitShadowMapMeshInstancedDirect(sys, pass.viewId, ref mesh, &idb, mr.startIndex, mr.indexCount, pass.GetFlipCullingInverse(), default);
+                            else
+                                SubmitHelper.SubmitSimpleShadowMapTransientDirect(sys, &tib, &tvb, nvertices, nindices, pass.viewId, ref tx.Value, pass.GetFlipCullingInverse(), default);
                             break;
                         case RenderPassType.Transparent:
                             depth = pass.ComputeSortDepth(new float4(wbs.position, 1.0f));
                             goto case RenderPassType.Opaque;
                         case RenderPassType.Opaque:
-                            var material = EntityManager.GetComponentData<SimpleMaterialBGFX>(mr.material);
-                            SubmitHelper.SubmitSimpleTransientDirect(sys, &tib, &tvb, nvertices, nindices, pass.viewId, ref tx.Value, ref material, pass.GetFlipCulling(), depth);
+                            if (instanced)
+                                SubmitHelper.SubmitSimpleParticlesInstancedDirect(sys, pass.viewId, ref mesh, &idb, ref material, mr.startIndex, mr.indexCount, pass.GetFlipCulling(), depth);
+                            else
+                                SubmitHelper.SubmitSimpleTransientDirect(sys, &tib, &tvb, nvertices, nindices, pass.viewId, ref tx.Value, ref material, pass.GetFlipCulling(), depth);
                             break;
                         default:
                             Assert.IsTrue(false);
@@ -344,26 +550,31 @@ namespace Unity.Tiny.Rendering
             [ReadOnly] public ComponentTypeHandle<MeshRenderer> MeshRendererType;
             [ReadOnly] public ComponentTypeHandle<WorldBoundingSphere> WorldBoundingSphereType;
             [ReadOnly] public ComponentTypeHandle<ChunkWorldBoundingSphere> ChunkWorldBoundingSphereType;
-            [ReadOnly] public BufferTypeHandle<DynamicLitVertex> DynamicLitVertexBufferType;
-            [ReadOnly] public BufferTypeHandle<DynamicIndex> DynamicIndexBufferType;
+            [ReadOnly] public ComponentTypeHandle<ChunkWorldBounds> ChunkWorldBoundsType;
+            [ReadOnly] public BufferTypeHandle<ParticleInstance> ParticleInstanceBufferType;
             [DeallocateOnJobCompletion] [ReadOnly] public NativeArray<Entity> SharedRenderToPass;
             [DeallocateOnJobCompletion] [ReadOnly] public NativeArray<Entity> SharedLightingRef;
             [ReadOnly] public BufferFromEntity<RenderToPassesEntry> BufferRenderToPassesEntry;
             [ReadOnly] public ComponentDataFromEntity<RenderPass> ComponentRenderPass;
             [ReadOnly] public ComponentDataFromEntity<LitMaterialBGFX> ComponentLitMaterialBGFX;
             [ReadOnly] public ComponentDataFromEntity<LightingBGFX> ComponentLightingBGFX;
+            [ReadOnly] public ComponentDataFromEntity<MeshBGFX> ComponentMeshBGFX;
+            [ReadOnly] public ComponentDataFromEntity<LitMeshRenderData> ComponentLitMeshRenderData;
 #pragma warning disable 0649
             [NativeSetThreadIndex] internal int ThreadIndex;
 #pragma warning restore 0649
             [ReadOnly] public PerThreadDataBGFX* PerThreadData;
             [ReadOnly] public int MaxPerThreadData;
             [ReadOnly] public RendererBGFXInstance* BGFXInstancePtr;
+            [ReadOnly] public bool UseInstancing;
 
             public unsafe void Execute(ArchetypeChunk chunk, int chunkIndex, int firstEntityIndex)
             {
                 var chunkLocalToWorld = chunk.GetNativeArray(LocalToWorldType);
                 var chunkMeshRenderer = chunk.GetNativeArray(MeshRendererType);
                 var worldBoundingSphere = chunk.GetNativeArray(WorldBoundingSphereType);
+                var chunkWorldBoundingSphere = chunk.GetChunkComponentData(ChunkWorldBoundingSphereType).Value;
+                var bounds = chunk.GetChunkComponentData(ChunkWorldBoundsType).Value;
 
                 Assert.IsTrue(chunk.HasChunkComponent(ChunkWorldBoundingSphereType));
 
@@ -372,54 +583,93 @@ namespace Unity.Tiny.Rendering
                 Entity rtpe = SharedRenderToPass[chunkIndex];
 
                 Assert.IsTrue(ThreadIndex >= 0 && ThreadIndex < MaxPerThreadData);
-                bgfx.Encoder* encoder = PerThreadData[ThreadIndex].encoder;
-                if (encoder == null)
+                bgfx.Encoder* encoder = PerThreadData[ThreadIndex].GetEncoder();
+                DynamicBuffer<RenderToPassesEntry> toPasses = BufferRenderToPassesEntry[rtpe];
+
+                // chunk level culling once per pass, rejected passes are never looked at again
+                CullingStats cullingStats = default;
+                var chunkCull = new NativeArray<Culling.CullingResult>(toPasses.Length, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+                bool anyPass = false;
+                for (int j = 0; j < toPasses.Length; j++)
                 {
-                    encoder = bgfx.encoder_begin(true);
-                    Assert.IsTrue(encoder != null);
-                    PerThreadData[ThreadIndex].encoder = encoder;
+                    var pass = ComponentRenderPass[toPasses[j].e];
+                    if ((pass.passFlags & RenderPassFlags.Cached) != 0)
+                    {
+                        chunkCull[j] = Culling.CullingResult.Outside;
+                        continue;
+                    }
+                    chunkCull[j] = Culling.CullChunk(in chunkWorldBoundingSphere, in bounds, in pass.frustum, ref cullingStats);
+                    anyPass |= chunkCull[j] != Culling.CullingResult.Outside;
                 }
-                DynamicBuffer<RenderToPassesEntry> toPasses = BufferRenderToPassesEntry[rtpe];
 
-                for (int i = 0; i < chunk.Count; i++)   // for every renderer in chunk
+                var chunkInstances = chunk.GetBufferAccessor(ParticleInstanceBufferType);
+                for (int i = 0; anyPass && i < chunk.Count; i++)   // for every renderer in chunk
                 {
-                    DynamicBuffer<DynamicLitVertex> vBuffer = chunk.GetBufferAccessor(DynamicLitVertexBufferType)[i];
-                    DynamicBuffer<DynamicIndex> iBuffer = chunk.GetBufferAccessor(DynamicIndexBufferType)[i];
-                    int nindices = iBuffer.Length;
-                    int nvertices = vBuffer.Length;
-                    bgfx.TransientIndexBuffer tib;
-                    bgfx.TransientVertexBuffer tvb;
-                    if (!SubmitHelper.SubmitLitTransientAlloc(BGFXInstancePtr, &tib, &tvb, nvertices, nindices))
-                        return;
-                    LitVertex* destVertices = (LitVertex*)tvb.data;
-                    ushort* destIndices = (ushort*)tib.data;
-                    UnsafeUtility.MemCpy(destIndices, iBuffer.GetUnsafeReadOnlyPtr(), nindices * 2);
-                    UnsafeUtility.MemCpy(destVertices, vBuffer.GetUnsafeReadOnlyPtr(), nvertices * sizeof(LitVertex));
+                    DynamicBuffer<ParticleInstance> instances = chunkInstances[i];
+                    int count = instances.Length;
+                    if (count == 0)
+                        continue;
+                    var meshRenderer = chunkMeshRenderer[i];
+                    var material = ComponentLitMaterialBGFX[meshRenderer.material];
+
+                    // the instances are uploaded once and shared by the draws into all passes, custom shaders have no instanced variant
+                    MeshBGFX mesh = ComponentMeshBGFX.HasComponent(meshRenderer.mesh) ? ComponentMeshBGFX[meshRenderer.mesh] : MeshBGFX.CreateEmpty();
+                    bool instanced = UseInstancing && mesh.IsValid() && material.shaderProgram.idx == BGFXInstancePtr->m_litShader.m_prog.idx &&
+                        bgfx.get_avail_instance_data_buffer((uint)count, (ushort)sizeof(ParticleInstance)) >= (uint)count;
+                    bgfx.InstanceDataBuffer idb = default;
+                    bgfx.TransientIndexBuffer tib = default;
+                    bgfx.TransientVertexBuffer tvb = default;
+                    int nindices = 0;
+                    int nvertices = 0;
+                    if (instanced)
+                    {
+                        bgfx.alloc_instance_data_buffer(&idb, (uint)count, (ushort)sizeof(ParticleInstance));
+                        UnsafeUtility.MemCpy(idb.data, instances.GetUnsafeReadOnlyPtr(), count * sizeof(ParticleInstance));
+                    }
+                    else
+                    {
+                        var meshData = ComponentLitMeshRenderData[meshRenderer.mesh];
+                        ref LitMeshData lmd = ref meshData.Mesh.Value;
+                        nindices = count * lmd.Indices.Length;
+                        nvertices = count * lmd.Vertices.Length;
+                        if (!SubmitHelper.SubmitLitTransientAlloc(BGFXInstancePtr, &tib, &tvb, nvertices, nindices))
+                            break;
+                        SubmitHelper.ExpandLitParticles((LitVertex*)tvb.data, (ushort*)tib.data, ref lmd, (ParticleInstance*)instances.GetUnsafeReadOnlyPtr(), count, material.constMetal_Smoothness_Billboarded.z == 1.0f);
+                    }
 
                     for (int j = 0; j < toPasses.Length; j++)   // for all passes this chunk renderer to
                     {
+                        if (chunkCull[j] == Culling.CullingResult.Outside)
+                            continue;
                         Entity ePass = toPasses[j].e;
                         var pass = ComponentRenderPass[ePass];
                         Assert.IsTrue(encoder != null);
 
                         var wbs = worldBoundingSphere[i];
                         var tx = chunkLocalToWorld[i].Value;
-                        if (wbs.radius > 0.0f && Culling.Cull(in wbs, in pass.frustum) == Culling.CullingResult.Outside) // TODO: fine cull only if rough culling was !Inside
+                        if (chunkCull[j] != Culling.CullingResult.Inside && Culling.IsCulledInChunk(in wbs, in pass.frustum, ref cullingStats))
                             continue;
-                        var meshRenderer = chunkMeshRenderer[i];
                         uint depth = 0;
                         switch (pass.passType)   // TODO: we can hoist this out of the loop
                         {
                             case RenderPassType.ShadowMap:
                                 float4 bias = new float4(0);
-                                SubmitHelper.EncodeShadowMapTransient(BGFXInstancePtr, encoder, &tib, &tvb, nvertices, nindices, pass.viewId, ref tx, pass.GetFlipCullingInverse(), bias);
+                                if (instanced)
+                                    SubmitHelper.EncodeShadowMapMeshInstanced(BGFXInstancePtr, encoder, pass.viewId, ref mesh, &idb, meshRenderer.startIndex, meshRenderer.indexCount, pass.GetFlipCullingInverse(), bias);
+                                else
+                                    SubmitHelper.EncodeShadowMapTransient(BGFXInstancePtr, encoder, &tib, &tvb, nvertices, nindices, pass.viewId, ref tx, pass.GetFlipCullingInverse(), bias);
+                                PerThreadData[ThreadIndex].shadowDraws++;
                                 break;
                             case RenderPassType.Transparent:
                                 depth = pass.ComputeSortDepth(new float4(wbs.position, 1.0f));
                                 goto case RenderPassType.Opaque;
                             case RenderPassType.Opaque:
-                                var material = ComponentLitMaterialBGFX[meshRenderer.material];
-                                SubmitHelper.EncodeLitTransient(BGFXInstancePtr, encoder, &tib, &tvb, nvertices, nindices, pass.viewId, ref tx, ref material, ref lighting, ref pass.viewTransform, pass.GetFlipCulling(), ref PerThreadData[ThreadIndex].viewSpaceLightCache, depth);
+                                if (instanced)
+                                    SubmitHelper.EncodeLitParticlesInstanced(BGFXInstancePtr, encoder, pass.viewId, ref mesh, &idb, ref material, ref lighting, ref pass.viewTransform, meshRenderer.startIndex, meshRenderer.indexCount, pass.GetFlipCulling(), ref PerThreadData[ThreadIndex].viewSpaceLightCache, depth,
+                                        SubmitHelper.LitUniformCache(&PerThreadData[ThreadIndex], ref pass), SubmitHelper.LitStateKey(meshRenderer.material, lighte));
+                                else
+                                    SubmitHelper.EncodeLitTransient(BGFXInstancePtr, encoder, &tib, &tvb, nvertices, nindices, pass.viewId, ref tx, ref material, ref lighting, ref pass.viewTransform, pass.GetFlipCulling(), ref PerThreadData[ThreadIndex].viewSpaceLightCache, depth,
+                                        SubmitHelper.LitUniformCache(&PerThreadData[ThreadIndex], ref pass), SubmitHelper.LitStateKey(meshRenderer.material, lighte));
                                 break;
                             default:
                                 Assert.IsTrue(false);
@@ -427,6 +677,8 @@ namespace Unity.Tiny.Rendering
                         }
                     }
                 }
+                chunkCull.Dispose();
+                PerThreadData[ThreadIndex].cullingStats.Add(in cullingStats);
             }
         }
 
@@ -436,6 +688,7 @@ namespace Unity.Tiny.Rendering
         {
             m_query = GetEntityQuery(
                 ComponentType.ReadOnly<LitParticleRenderer>(),
+                ComponentType.ReadOnly<ParticleInstance>(),
                 ComponentType.ReadOnly<MeshRenderer>(),
                 ComponentType.ReadOnly<LocalToWorld>(),
                 ComponentType.ReadOnly<WorldBounds>(),
@@ -477,23 +730,26 @@ namespace Unity.Tiny.Rendering
                 MeshRendererType = GetComponentTypeHandle<MeshRenderer>(true),
                 WorldBoundingSphereType = GetComponentTypeHandle<WorldBoundingSphere>(true),
                 ChunkWorldBoundingSphereType = GetComponentTypeHandle<ChunkWorldBoundingSphere>(true),
-                DynamicLitVertexBufferType = GetBufferTypeHandle<DynamicLitVertex>(true),
-                DynamicIndexBufferType = GetBufferTypeHandle<DynamicIndex>(true),
+                ChunkWorldBoundsType = GetComponentTypeHandle<ChunkWorldBounds>(true),
+                ParticleInstanceBufferType = GetBufferTypeHandle<ParticleInstance>(true),
                 SharedRenderToPass = sharedRenderToPass,
                 SharedLightingRef = sharedLightingRef,
                 BufferRenderToPassesEntry = GetBufferFromEntity<RenderToPassesEntry>(true),
                 ComponentRenderPass = GetComponentDataFromEntity<RenderPass>(true),
                 ComponentLitMaterialBGFX = GetComponentDataFromEntity<LitMaterialBGFX>(true),
                 ComponentLightingBGFX = GetComponentDataFromEntity<LightingBGFX>(true),
+                ComponentMeshBGFX = GetComponentDataFromEntity<MeshBGFX>(true),
+                ComponentLitMeshRenderData = GetComponentDataFromEntity<LitMeshRenderData>(true),
                 PerThreadData = sys->m_perThreadData,
                 MaxPerThreadData = sys->m_maxPerThreadData,
-                BGFXInstancePtr = sys
+                BGFXInstancePtr = sys,
+                UseInstancing = sys->m_instancingSupported
             };
             Assert.IsTrue(sys->m_maxPerThreadData > 0 && encodejob.MaxPerThreadData > 0);
 
             Dependency = encodejob.ScheduleParallel(m_query, Dependency);
-            // Temporary workaround until dependencies bugs are fixed.
-            Dependency.Complete();
+            // keeps encoding alongside the other submit systems, the frame waits for it
+            World.GetExistingSystem<RendererBGFXSystem>().AddEncodeJobs(Dependency);
         }
     }
 
@@ -508,6 +764,7 @@ namespace Unity.Tiny.Rendering
             [ReadOnly] public ComponentDataFromEntity<SkinnedMeshBoneInfo> ComponentSkinnedMeshBoneInfo;
             [ReadOnly] public ComponentTypeHandle<WorldBoundingSphere> WorldBoundingSphereType;
             [ReadOnly] public ComponentTypeHandle<ChunkWorldBoundingSphere> ChunkWorldBoundingSphereType;
+            [ReadOnly] public ComponentTypeHandle<ChunkWorldBounds> ChunkWorldBoundsType;
             [DeallocateOnJobCompletion] [ReadOnly] public NativeArray<Entity> SharedRenderToPass;
             [DeallocateOnJobCompletion] [ReadOnly] public NativeArray<Entity> SharedLightingRef;
             [ReadOnly] public BufferFromEntity<RenderToPassesEntry> BufferRenderToPassesEntry;
@@ -523,13 +780,37 @@ namespace Unity.Tiny.Rendering
             [ReadOnly] public int MaxPerThreadData;
             [ReadOnly] public RendererBGFXInstance* BGFXInstancePtr;
             [ReadOnly] public bool UsingGPUSkinning;
+            [DeallocateOnJobCompletion] [ReadOnly] public NativeArray<int> ChunkBonePaletteBase;
+            public float4* BonePalette; // chunks write disjoint ranges starting at ChunkBonePaletteBase
 
             public unsafe void Execute(ArchetypeChunk chunk, int chunkIndex, int firstEntityIndex)
             {
                 var chunkLocalToWorld = chunk.GetNativeArray(LocalToWorldType);
                 var chunkMeshRenderer = chunk.GetNativeArray(SkinnedMeshRendererType);
                 BufferAccessor<SkinnedMeshBoneRef> smbrBufferAccessor = chunk.GetBufferAccessor(SkinnedMeshBoneRefType);
+
+                // bone matrices go to the palette once per renderer, no matter how many passes draw it
+                var bonePaletteOffset = new NativeArray<int>(chunk.Count, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+                int paletteBone = ChunkBonePaletteBase[chunkIndex];
+                for (int j = 0; j < chunk.Count; j++) {
+                    DynamicBuffer<SkinnedMeshBoneRef> smbrBuffer = smbrBufferAccessor[j];
+                    if (!UsingGPUSkinning || !UsesBonePalette(chunkMeshRenderer[j], smbrBuffer.Length)) {
+                        bonePaletteOffset[j] = -1;
+                        continue;
+                    }
+                    bonePaletteOffset[j] = paletteBone;
+                    for (int k = 0; k < smbrBuffer.Length; k++) {
+                        float4x4 rows = math.transpose(ComponentSkinnedMeshBoneInfo[smbrBuffer[k].bone].bonematrix);
+                        float4* dest = BonePalette + (paletteBone + k) * 3;
+                        dest[0] = rows.c0;
+                        dest[1] = rows.c1;
+                        dest[2] = rows.c2;
+                    }
+                    paletteBone += smbrBuffer.Length;
+                }
                 var worldBoundingSphere = chunk.GetNativeArray(WorldBoundingSphereType);
+                var chunkWorldBoundingSphere = chunk.GetChunkComponentData(ChunkWorldBoundingSphereType).Value;
+                var bounds = chunk.GetChunkComponentData(ChunkWorldBoundsType).Value;
                 Assert.IsTrue (chunk.HasChunkComponent(ChunkWorldBoundingSphereType));
 
                 Entity lighte = SharedLightingRef[chunkIndex];
@@ -537,20 +818,22 @@ namespace Unity.Tiny.Rendering
                 Entity rtpe = SharedRenderToPass[chunkIndex];
 
                 Assert.IsTrue(ThreadIndex >= 0 && ThreadIndex < MaxPerThreadData);
-                bgfx.Encoder* encoder = PerThreadData[ThreadIndex].encoder;
-                if (encoder == null) {
-                    encoder = bgfx.encoder_begin(true);
-                    Assert.IsTrue(encoder != null);
-                    PerThreadData[ThreadIndex].encoder = encoder;
-                }
+                bgfx.Encoder* encoder = PerThreadData[ThreadIndex].GetEncoder();
                 DynamicBuffer<RenderToPassesEntry> toPasses = BufferRenderToPassesEntry[rtpe];
 
                 // we can do this loop either way, passes first or renderers first.
                 // TODO: profile what is better!
+                CullingStats cullingStats = default;
                 for (int i = 0; i < toPasses.Length; i++) { // for all passes this chunk renderer to
                     Entity ePass = toPasses[i].e;
                     var pass = ComponentRenderPass[ePass];
                     Assert.IsTrue(encoder != null);
+                    if ((pass.passFlags & RenderPassFlags.Cached) != 0)
+                        continue;
+                    var chunkCull = Culling.CullChunk(in chunkWorldBoundingSphere, in bounds, in pass.frustum, ref cullingStats);
+                    if (chunkCull == Culling.CullingResult.Outside)
+                        continue;
+                    bool fineCull = chunkCull != Culling.CullingResult.Inside;
                     for (int j = 0; j < chunk.Count; j++) { // for every renderer in chunk
                         var meshRenderer = chunkMeshRenderer[j];
                         if (UsingGPUSkinning && meshRenderer.canUseCPUSkinning && !meshRenderer.canUseGPUSkinning)
@@ -558,9 +841,8 @@ namespace Unity.Tiny.Rendering
                         if (!UsingGPUSkinning && !meshRenderer.canUseCPUSkinning && meshRenderer.canUseGPUSkinning)
                             continue;
 
-                        var wbs = worldBoundingSphere[j];
                         var tx = chunkLocalToWorld[j].Value;
-                        if (wbs.radius > 0.0f && Culling.Cull(in wbs, in pass.frustum) == Culling.CullingResult.Outside) // TODO: fine cull only if rough culling was !Inside
+                        if (fineCull && Culling.IsCulledInChunk(worldBoundingSphere[j], in pass.frustum, ref cullingStats))
                             continue;
 
                         MeshBGFX mesh = new MeshBGFX();
@@ -574,24 +856,11 @@ namespace Unity.Tiny.Rendering
                                 mesh = ComponentMeshBGFX[meshRenderer.sharedMesh];
                         }
 
-                        float4x4[] boneMatrices = null;
                         if (meshRenderer.indexCount > 0 && hasMeshBGFX)
                         {
                             Assert.IsTrue(mesh.IsValid());
 
-                            DynamicBuffer<SkinnedMeshBoneRef> smbrBuffer = smbrBufferAccessor[j];
-                            int boneCount = smbrBuffer.Length;
-                            bool needGPUSkinning = UsingGPUSkinning && boneCount > 0;
-                            if (needGPUSkinning)
-                            {
-                                boneMatrices = new float4x4[boneCount];
-                                for (int k = 0; k < boneCount; k++)
-                                {
-                                    SkinnedMeshBoneRef smbr = smbrBuffer[k];
-                                    SkinnedMeshBoneInfo smbi = ComponentSkinnedMeshBoneInfo[smbr.bone];
-                                    boneMatrices[k] = smbi.bonematrix;
-                                }
-                            }
+                            bool needGPUSkinning = bonePaletteOffset[j] >= 0;
 
                             uint depth = 0;
                             switch (pass.passType) { // TODO: we can hoist this out of the loop
@@ -602,7 +871,8 @@ namespace Unity.Tiny.Rendering
                                         if (!needGPUSkinning)
                                             SubmitHelper.EncodeShadowMapMesh(BGFXInstancePtr, encoder, pass.viewId, ref mesh, ref tx, meshRenderer.startIndex, meshRenderer.indexCount, pass.GetFlipCullingInverse(), bias);
                                         else
-                                            SubmitHelper.EncodeShadowMapSkinnedMesh(BGFXInstancePtr, encoder, pass.viewId, ref mesh, ref tx, meshRenderer.startIndex, meshRenderer.indexCount, pass.GetFlipCullingInverse(), bias, boneMatrices);
+                                            SubmitHelper.EncodeShadowMapSkinnedMesh(BGFXInstancePtr, encoder, pass.viewId, ref mesh, ref tx, meshRenderer.startIndex, meshRenderer.indexCount, pass.GetFlipCullingInverse(), bias, bonePaletteOffset[j]);
+                                        PerThreadData[ThreadIndex].shadowDraws++;
                                     }
                                     break;
                                 case RenderPassType.Transparent:
@@ -615,9 +885,11 @@ namespace Unity.Tiny.Rendering
 										{
                                     		var material = ComponentLitMaterialBGFX[meshRenderer.material];
                                     		if (!needGPUSkinning)
-                                        		SubmitHelper.EncodeLitMesh(BGFXInstancePtr, encoder, pass.viewId, ref mesh, ref tx, ref material, ref lighting, ref pass.viewTransform, meshRenderer.startIndex, meshRenderer.indexCount, pass.GetFlipCulling(), ref PerThreadData[ThreadIndex].viewSpaceLightCache, depth);
+                                        		SubmitHelper.EncodeLitMesh(BGFXInstancePtr, encoder, pass.viewId, ref mesh, ref tx, ref material, ref lighting, ref pass.viewTransform, meshRenderer.startIndex, meshRenderer.indexCount, pass.GetFlipCulling(), ref PerThreadData[ThreadIndex].viewSpaceLightCache, depth,
+                                                    SubmitHelper.LitUniformCache(&PerThreadData[ThreadIndex], ref pass), SubmitHelper.LitStateKey(meshRenderer.material, lighte));
                                     		else
-                                        		SubmitHelper.EncodeLitSkinnedMesh(BGFXInstancePtr, encoder, pass.viewId, ref mesh, ref tx, ref material, ref lighting, ref pass.viewTransform, meshRenderer.startIndex, meshRenderer.indexCount, pass.GetFlipCulling(), ref PerThreadData[ThreadIndex].viewSpaceLightCache, depth, boneMatrices);
+                                        		SubmitHelper.EncodeLitSkinnedMesh(BGFXInstancePtr, encoder, pass.viewId, ref mesh, ref tx, ref material, ref lighting, ref pass.viewTransform, meshRenderer.startIndex, meshRenderer.indexCount, pass.GetFlipCulling(), ref PerThreadData[ThreadIndex].viewSpaceLightCache, depth, bonePaletteOffset[j],
+                                                    SubmitHelper.LitUniformCache(&PerThreadData[ThreadIndex], ref pass), SubmitHelper.LitStateKey(meshRenderer.material, lighte));
 										}
 										else if (ComponentSimpleMaterialBGFX.HasComponent(meshRenderer.material))
 										{
@@ -625,7 +897,7 @@ namespace Unity.Tiny.Rendering
 											if (!needGPUSkinning)
                                         		SubmitHelper.EncodeSimpleMesh(BGFXInstancePtr, encoder, pass.viewId, ref mesh, ref tx, ref material, meshRenderer.startIndex, meshRenderer.indexCount, pass.GetFlipCulling(), depth);
                                     		else
-                                                SubmitHelper.EncodeSimpleSkinnedmesh(BGFXInstancePtr, encoder, pass.viewId, ref mesh, ref tx, ref material, meshRenderer.startIndex, meshRenderer.indexCount, pass.GetFlipCulling(), depth, boneMatrices);
+                                                SubmitHelper.EncodeSimpleSkinnedmesh(BGFXInstancePtr, encoder, pass.viewId, ref mesh, ref tx, ref material, meshRenderer.startIndex, meshRenderer.indexCount, pass.GetFlipCulling(), depth, bonePaletteOffset[j]);
 										}
                                     }
                                     break;
@@ -639,9 +911,17 @@ namespace Unity.Tiny.Rendering
                         }
                     }
                 }
+                PerThreadData[ThreadIndex].cullingStats.Add(in cullingStats);
+                bonePaletteOffset.Dispose();
             }
         }
 
+        // Renderers that only exist for cpu skinning are not drawn while gpu skinning is on
+        static bool UsesBonePalette(in SkinnedMeshRenderer meshRenderer, int boneCount)
+        {
+            return boneCount > 0 && !(meshRenderer.canUseCPUSkinning && !meshRenderer.canUseGPUSkinning);
+        }
+
         EntityQuery m_query;
 
         protected override void OnCreate()
@@ -673,23 +953,49 @@ namespace Unity.Tiny.Rendering
             NativeArray<Entity> sharedLightingRef = new NativeArray<Entity>(chunks.Length, Allocator.TempJob, NativeArrayOptions.UninitializedMemory);
             SharedComponentTypeHandle<RenderToPasses> renderToPassesType = GetSharedComponentTypeHandle<RenderToPasses>();
             SharedComponentTypeHandle<LightingRef> lightingRefType = GetSharedComponentTypeHandle<LightingRef>();
+            var di = GetSingleton<DisplayInfo>();
+
+            // lay out the frame's bone palette, every chunk gets the range for its gpu skinned renderers
+            NativeArray<int> chunkBonePaletteBase = new NativeArray<int>(chunks.Length, Allocator.TempJob, NativeArrayOptions.UninitializedMemory);
+            var skinnedMeshRendererType = GetComponentTypeHandle<SkinnedMeshRenderer>(true);
+            var skinnedMeshBoneRefType = GetBufferTypeHandle<SkinnedMeshBoneRef>(true);
+            int paletteBones = 0;
 
             // it really sucks we can't get shared components in the job itself
             for (int i = 0; i < chunks.Length; i++)
             {
                 sharedRenderToPass[i] = chunks[i].GetSharedComponentData<RenderToPasses>(renderToPassesType, EntityManager).e;
                 sharedLightingRef[i] = chunks[i].GetSharedComponentData<LightingRef>(lightingRefType, EntityManager).e;
+                chunkBonePaletteBase[i] = paletteBones;
+                if (!di.gpuSkinning)
+                    continue;
+                var chunkMeshRenderer = chunks[i].GetNativeArray(skinnedMeshRendererType);
+                var smbrBufferAccessor = chunks[i].GetBufferAccessor(skinnedMeshBoneRefType);
+                for (int j = 0; j < chunks[i].Count; j++)
+                {
+                    int boneCount = smbrBufferAccessor[j].Length;
+                    if (UsesBonePalette(chunkMeshRenderer[j], boneCount))
+                        paletteBones += boneCount;
+                }
             }
             chunks.Dispose();
 
-            var di = GetSingleton<DisplayInfo>();
+            bgfx.Memory* bonePaletteMemory = null;
+            int bonePaletteRows = 0;
+            if (paletteBones > 0)
+            {
+                bonePaletteRows = sys->m_bonePalette.Reserve(paletteBones * 3);
+                bonePaletteMemory = bgfx.alloc((uint)(bonePaletteRows * FrameDataTextureBGFX.kWidth * sizeof(float4)));
+            }
+
             var encodejob = new SubmitStaticLitSkinnedMeshJob {
                 LocalToWorldType = GetComponentTypeHandle<LocalToWorld>(true),
-                SkinnedMeshRendererType = GetComponentTypeHandle<SkinnedMeshRenderer>(true),
-                SkinnedMeshBoneRefType = GetBufferTypeHandle<SkinnedMeshBoneRef>(true),
+                SkinnedMeshRendererType = skinnedMeshRendererType,
+                SkinnedMeshBoneRefType = skinnedMeshBoneRefType,
                 ComponentSkinnedMeshBoneInfo = GetComponentDataFromEntity<SkinnedMeshBoneInfo>(true),
                 WorldBoundingSphereType = GetComponentTypeHandle<WorldBoundingSphere>(true),
                 ChunkWorldBoundingSphereType = GetComponentTypeHandle<ChunkWorldBoundingSphere>(true),
+                ChunkWorldBoundsType = GetComponentTypeHandle<ChunkWorldBounds>(true),
                 SharedRenderToPass = sharedRenderToPass,
                 SharedLightingRef = sharedLightingRef,
                 BufferRenderToPassesEntry = GetBufferFromEntity<RenderToPassesEntry>(true),
@@ -701,13 +1007,19 @@ namespace Unity.Tiny.Rendering
                 PerThreadData = sys->m_perThreadData,
                 MaxPerThreadData = sys->m_maxPerThreadData,
                 BGFXInstancePtr = sys,
-                UsingGPUSkinning = di.gpuSkinning
+                UsingGPUSkinning = di.gpuSkinning,
+                ChunkBonePaletteBase = chunkBonePaletteBase,
+                BonePalette = bonePaletteMemory != null ? (float4*)bonePaletteMemory->data : null
             };
             Assert.IsTrue(sys->m_maxPerThreadData>0 && encodejob.MaxPerThreadData>0);
 
             Dependency = encodejob.ScheduleParallel(m_query, Dependency);
-            // Temporary workaround until dependencies bugs are fixed.
+            // the palette rows are written by the job, they have to be there before the upload
             Dependency.Complete();
+
+            // the draws above were only recorded, uploading the palette now is still in time for this frame
+            if (bonePaletteMemory != null)
+                sys->m_bonePalette.Update(bonePaletteMemory, bonePaletteRows);
         }
     }
 }
@@ -1,5 +1,6 @@
 using System;
 using Unity.Mathematics;
+using Unity.Entities;
 using Unity.Collections.LowLevel.Unsafe;
 using Bgfx;
 
@@ -15,6 +16,15 @@ namespace Unity.Tiny.Rendering
             bgfx.Encoder* encoder = bgfx.encoder_begin(false);
             EncodeShadowMapMesh(sys, encoder, viewId, ref mesh, ref tx, startIndex, indexCount, flipCulling, bias);
             bgfx.encoder_end(encoder);
+            sys->m_shadowDrawsDirect++;
+        }
+
+        public static unsafe void SubmitShadowMapMeshInstancedDirect(RendererBGFXInstance* sys, ushort viewId, ref MeshBGFX mesh, bgfx.InstanceDataBuffer* instances, int startIndex, int indexCount, byte flipCulling, float4 bias)
+        {
+            bgfx.Encoder* encoder = bgfx.encoder_begin(false);
+            EncodeShadowMapMeshInstanced(sys, encoder, viewId, ref mesh, instances, startIndex, indexCount, flipCulling, bias);
+            bgfx.encoder_end(encoder);
+            sys->m_shadowDrawsDirect++;
         }
 
         public static unsafe void SubmitSimpleShadowMapTransientDirect(RendererBGFXInstance* sys, bgfx.TransientIndexBuffer* tib, bgfx.TransientVertexBuffer* tvb, int nvertices, int nindices, ushort viewId, ref float4x4 tx, byte flipCulling, float4 bias)
@@ -22,6 +32,7 @@ namespace Unity.Tiny.Rendering
             bgfx.Encoder* encoder = bgfx.encoder_begin(false);
             EncodeSimpleShadowMapTransient(sys, encoder, tib, tvb, nvertices, nindices, viewId, ref tx, flipCulling, bias);
             bgfx.encoder_end(encoder);
+            sys->m_shadowDrawsDirect++;
         }
 
 
@@ -33,12 +44,10 @@ namespace Unity.Tiny.Rendering
         }
 
         public static unsafe void EncodeShadowMapSkinnedMesh(RendererBGFXInstance* sys, bgfx.Encoder* encoder, ushort viewId, ref MeshBGFX mesh, ref float4x4 tx,
-            int startIndex, int indexCount, byte flipCulling, float4 bias, float4x4[] boneMatrices)
+            int startIndex, int indexCount, byte flipCulling, float4 bias, int bonePaletteOffset)
         {
             mesh.SetForSubmit(encoder, startIndex, indexCount);
-            fixed (float4x4* p = boneMatrices) {
-                bgfx.encoder_set_uniform(encoder, sys->m_skinnedMeshShadowMapShader.m_uniformBoneMatrices, p, (ushort)boneMatrices.Length);
-            }
+            EncodeBonePalette(sys, encoder, sys->m_skinnedMeshShadowMapShader.m_uniformBonePalette, sys->m_skinnedMeshShadowMapShader.m_samplerBonePalette, bonePaletteOffset);
             EncodeShadowMap(sys, encoder, ref sys->m_skinnedMeshShadowMapShader.m_shadowMapShader, viewId, ref tx, flipCulling, bias);
         }
 
@@ -56,6 +65,23 @@ namespace Unity.Tiny.Rendering
             EncodeShadowMap(sys, encoder, ref sys->m_shadowMapShader, viewId, ref tx, flipCulling, bias);
         }
 
+        public static unsafe void EncodeShadowMapMeshInstanced(RendererBGFXInstance* sys, bgfx.Encoder* encoder, ushort viewId, ref MeshBGFX mesh, bgfx.InstanceDataBuffer* instances,
+            int startIndex, int indexCount, byte flipCulling, float4 bias)
+        {
+            mesh.SetForSubmit(encoder, startIndex, indexCount);
+            bgfx.encoder_set_instance_data_buffer(encoder, instances, 0, instances->num);
+            ulong state = (ulong)(bgfx.StateFlags.WriteZ | bgfx.StateFlags.DepthTestLess | bgfx.StateFlags.CullCcw);
+            if (flipCulling != 0) state = FlipCulling(state);
+#if DEBUG
+            state |= (ulong)bgfx.StateFlags.WriteRgb | (ulong)bgfx.StateFlags.WriteA;
+            float4 c = new float4(1);
+            bgfx.encoder_set_uniform(encoder, sys->m_shadowMapInstancedShader.m_uniformDebugColor, &c, 1);
+#endif
+            bgfx.encoder_set_state(encoder, state, 0);
+            bgfx.encoder_set_uniform(encoder, sys->m_shadowMapInstancedShader.m_uniformBias, &bias, 1);
+            bgfx.encoder_submit(encoder, viewId, sys->m_shadowMapInstancedShader.m_prog, 0, (byte)bgfx.DiscardFlags.All);
+        }
+
         // For uniforms and shaders setup. Does not handle vertex/index buffers
         private static unsafe void EncodeShadowMap(RendererBGFXInstance* sys, bgfx.Encoder* encoder, ref ShadowMapShader shadowMapShader, ushort viewId, ref float4x4 tx, byte flipCulling, float4 bias)
         {
@@ -182,7 +208,7 @@ namespace Unity.Tiny.Rendering
             return r;
         }
 
-        private unsafe static void EncodeMappedLight(bgfx.Encoder* encoder, ref MappedLightBGFX light, ref LitShader.MappedLight shader, byte samplerOffset, float4 viewPosOrDir)
+        private unsafe static void EncodeMappedLight(bgfx.Encoder* encoder, ref MappedLightBGFX light, ref LitShader.MappedLight shader, float4 viewPosOrDir)
         {
             fixed (float4x4* p = &light.projection)
                 bgfx.encoder_set_uniform(encoder, shader.m_uniformMatrix, p, 1);
@@ -191,31 +217,77 @@ namespace Unity.Tiny.Rendering
             fixed (float4* p = &light.mask)
                 bgfx.encoder_set_uniform(encoder, shader.m_uniformLightMask, p, 1);
             bgfx.encoder_set_uniform(encoder, shader.m_uniformViewPosOrDir, &viewPosOrDir, 1);
-            bgfx.encoder_set_texture(encoder, (byte)(4 + samplerOffset), shader.m_samplerShadow, light.shadowMap, UInt32.MaxValue);
+        }
+
+        // Sort key for opaque lit draws into views with the default sort mode. bgfx orders those draws by program and then
+        // by depth, with this key as depth all draws with the same material and lighting are rendered back to back, from
+        // all encoders, in submit order. That is what makes skipping their material and lighting uniforms safe.
+        // Returns 0 when the entity indices do not fit, such draws always set everything.
+        public static uint LitStateKey(Entity material, Entity lighting)
+        {
+            if (material.Index < 0 || material.Index >= 0xfffff || lighting.Index < 0 || lighting.Index >= 0xfff)
+                return 0;
+            return (((uint)lighting.Index << 20) | (uint)material.Index) + 1;
+        }
+
+        // The uniform cache of one thread, for opaque passes into views with the default sort mode only, see LitStateKey
+        public static unsafe LitUniformCacheBGFX* LitUniformCache(PerThreadDataBGFX* perThreadData, ref RenderPass pass)
+        {
+            if (pass.sorting != RenderPassSort.Unsorted || pass.passType != RenderPassType.Opaque)
+                return null;
+            return &perThreadData->litUniformCache;
         }
 
         public static unsafe void EncodeLitMesh(RendererBGFXInstance* sys, bgfx.Encoder* encoder, ushort viewId, ref MeshBGFX mesh, ref float4x4 tx,
             ref LitMaterialBGFX mat, ref LightingBGFX lighting, ref float4x4 viewTx, int startIndex, int indexCount,
-            byte flipCulling, ref LightingViewSpaceBGFX viewSpaceLightCache, uint depth)
+            byte flipCulling, ref LightingViewSpaceBGFX viewSpaceLightCache, uint depth, LitUniformCacheBGFX* uniformCache = null, uint stateKey = 0)
         {
             mesh.SetForSubmit(encoder, startIndex, indexCount);
-            EncodeLit(sys, encoder, ref sys->m_litShader, mat.shaderProgram, viewId, ref tx, ref mat, ref lighting, ref viewTx, flipCulling, ref viewSpaceLightCache, depth);
+            EncodeLit(sys, encoder, ref sys->m_litShader, mat.shaderProgram, viewId, ref tx, ref mat, ref lighting, ref viewTx, flipCulling, ref viewSpaceLightCache, depth, uniformCache, stateKey);
         }
 
         public static unsafe void EncodeLitSkinnedMesh(RendererBGFXInstance* sys, bgfx.Encoder* encoder, ushort viewId, ref MeshBGFX mesh, ref float4x4 tx,
             ref LitMaterialBGFX mat, ref LightingBGFX lighting, ref float4x4 viewTx, int startIndex, int indexCount,
-            byte flipCulling, ref LightingViewSpaceBGFX viewSpaceLightCache, uint depth, float4x4[] boneMatrices)
+            byte flipCulling, ref LightingViewSpaceBGFX viewSpaceLightCache, uint depth, int bonePaletteOffset, LitUniformCacheBGFX* uniformCache = null, uint stateKey = 0)
         {
             mesh.SetForSubmit(encoder, startIndex, indexCount);
-            fixed (float4x4* p = boneMatrices) {
-                bgfx.encoder_set_uniform(encoder, sys->m_litSkinnedMeshShader.m_uniformBoneMatrices, p, (ushort)boneMatrices.Length);
-            }
-            EncodeLit(sys, encoder, ref sys->m_litSkinnedMeshShader.m_litShader, sys->m_litSkinnedMeshShader.m_litShader.m_prog, viewId, ref tx, ref mat, ref lighting, ref viewTx, flipCulling, ref viewSpaceLightCache, depth);
+            EncodeBonePalette(sys, encoder, sys->m_litSkinnedMeshShader.m_uniformBonePalette, sys->m_litSkinnedMeshShader.m_samplerBonePalette, bonePaletteOffset);
+            EncodeLit(sys, encoder, ref sys->m_litSkinnedMeshShader.m_litShader, sys->m_litSkinnedMeshShader.m_litShader.m_prog, viewId, ref tx, ref mat, ref lighting, ref viewTx, flipCulling, ref viewSpaceLightCache, depth, uniformCache, stateKey);
+        }
+
+        // Draws one instance of the mesh per matrix in instances. Only for materials that use the built in lit shader.
+        public static unsafe void EncodeLitMeshInstanced(RendererBGFXInstance* sys, bgfx.Encoder* encoder, ushort viewId, ref MeshBGFX mesh, bgfx.InstanceDataBuffer* instances,
+            ref LitMaterialBGFX mat, ref LightingBGFX lighting, ref float4x4 viewTx, int startIndex, int indexCount,
+            byte flipCulling, ref LightingViewSpaceBGFX viewSpaceLightCache, LitUniformCacheBGFX* uniformCache = null, uint stateKey = 0)
+        {
+            EncodeLitInstanced(sys, encoder, ref sys->m_litInstancedShader, viewId, ref mesh, instances, ref mat, ref lighting, ref viewTx, startIndex, indexCount, flipCulling, ref viewSpaceLightCache, 0, uniformCache, stateKey);
+        }
+
+        // Draws one particle per ParticleInstance in instances. Only for materials that use the built in lit shader.
+        public static unsafe void EncodeLitParticlesInstanced(RendererBGFXInstance* sys, bgfx.Encoder* encoder, ushort viewId, ref MeshBGFX mesh, bgfx.InstanceDataBuffer* instances,
+            ref LitMaterialBGFX mat, ref LightingBGFX lighting, ref float4x4 viewTx, int startIndex, int indexCount,
+            byte flipCulling, ref LightingViewSpaceBGFX viewSpaceLightCache, uint depth, LitUniformCacheBGFX* uniformCache = null, uint stateKey = 0)
+        {
+            EncodeLitInstanced(sys, encoder, ref sys->m_litParticleInstancedShader, viewId, ref mesh, instances, ref mat, ref lighting, ref viewTx, startIndex, indexCount, flipCulling, ref viewSpaceLightCache, depth, uniformCache, stateKey);
+        }
+
+        private static unsafe void EncodeLitInstanced(RendererBGFXInstance* sys, bgfx.Encoder* encoder, ref LitShader litShader, ushort viewId, ref MeshBGFX mesh, bgfx.InstanceDataBuffer* instances,
+            ref LitMaterialBGFX mat, ref LightingBGFX lighting, ref float4x4 viewTx, int startIndex, int indexCount,
+            byte flipCulling, ref LightingViewSpaceBGFX viewSpaceLightCache, uint depth, LitUniformCacheBGFX* uniformCache, uint stateKey)
+        {
+            mesh.SetForSubmit(encoder, startIndex, indexCount);
+            bgfx.encoder_set_instance_data_buffer(encoder, instances, 0, instances->num);
+            ulong state = mat.state;
+            if (flipCulling != 0)
+                state = FlipCulling(state);
+            bgfx.encoder_set_state(encoder, state, 0);
+            depth = EncodeLitUniforms(sys, encoder, ref litShader, litShader.m_prog, viewId, ref mat, ref lighting, ref viewTx, ref viewSpaceLightCache, depth, uniformCache, stateKey);
+            bgfx.encoder_submit(encoder, viewId, litShader.m_prog, depth, (byte)bgfx.DiscardFlags.All);
         }
 
         // For uniforms and shaders setup. Does not handle vertex/index buffers
         private unsafe static void EncodeLit(RendererBGFXInstance* sys, bgfx.Encoder* encoder, ref LitShader litShader, bgfx.ProgramHandle prog, ushort viewId, ref float4x4 tx, ref LitMaterialBGFX mat,
-            ref LightingBGFX lighting, ref float4x4 viewTx, byte flipCulling, ref LightingViewSpaceBGFX viewSpaceLightCache, uint depth)
+            ref LightingBGFX lighting, ref float4x4 viewTx, byte flipCulling, ref LightingViewSpaceBGFX viewSpaceLightCache, uint depth, LitUniformCacheBGFX* uniformCache, uint stateKey)
         {
             ulong state = mat.state;
             if (flipCulling != 0)
@@ -227,6 +299,64 @@ namespace Unity.Tiny.Rendering
             float4x4 minvtTemp = new float4x4(minvt, float3.zero);
             //float3x3 minvt = new float3x3(tx.c0.xyz, tx.c1.xyz, tx.c2.xyz);
             bgfx.encoder_set_uniform(encoder, litShader.m_uniformModelInverseTranspose, &minvtTemp, 1);
+            depth = EncodeLitUniforms(sys, encoder, ref litShader, prog, viewId, ref mat, ref lighting, ref viewTx, ref viewSpaceLightCache, depth, uniformCache, stateKey);
+
+            // submit
+            bgfx.encoder_submit(encoder, viewId, prog, depth, (byte)bgfx.DiscardFlags.All);
+        }
+
+        // number of encoder_set_uniform calls in EncodeLitStateUniforms
+        private const int kLitStateUniformCount = 27;
+
+        // Material and lighting uniforms and textures, everything but the transform. Returns the depth to submit with.
+        // With a uniform cache and a state key, the uniforms are skipped when the previous lit draw on this encoder had
+        // the same view, program and state key; textures are bindings that bgfx discards on every submit, they are always set.
+        private unsafe static uint EncodeLitUniforms(RendererBGFXInstance* sys, bgfx.Encoder* encoder, ref LitShader litShader, bgfx.ProgramHandle prog, ushort viewId,
+            ref LitMaterialBGFX mat, ref LightingBGFX lighting, ref float4x4 viewTx, ref LightingViewSpaceBGFX viewSpaceLightCache, uint depth,
+            LitUniformCacheBGFX* uniformCache, uint stateKey)
+        {
+            EncodeLitTextures(sys, encoder, ref litShader, ref mat, ref lighting);
+            if (uniformCache == null || stateKey == 0)
+            {
+                EncodeLitStateUniforms(sys, encoder, ref litShader, viewId, ref mat, ref lighting, ref viewTx, ref viewSpaceLightCache);
+                return depth;
+            }
+
+            if (uniformCache->stateKey == stateKey && uniformCache->viewId == viewId && uniformCache->program == prog.idx)
+            {
+                uniformCache->uniformsSkipped += kLitStateUniformCount;
+            }
+            else
+            {
+                EncodeLitStateUniforms(sys, encoder, ref litShader, viewId, ref mat, ref lighting, ref viewTx, ref viewSpaceLightCache);
+                uniformCache->stateKey = stateKey;
+                uniformCache->viewId = viewId;
+                uniformCache->program = prog.idx;
+                uniformCache->uniformsSet += kLitStateUniformCount;
+            }
+            return stateKey;
+        }
+
+        private unsafe static void EncodeLitTextures(RendererBGFXInstance* sys, bgfx.Encoder* encoder, ref LitShader litShader, ref LitMaterialBGFX mat, ref LightingBGFX lighting)
+        {
+            bgfx.encoder_set_texture(encoder, 0, litShader.m_samplerAlbedoOpacity, mat.texAlbedoOpacity, UInt32.MaxValue);
+            bgfx.encoder_set_texture(encoder, 3, litShader.m_samplerMetal, mat.texMetal, UInt32.MaxValue);
+            bgfx.encoder_set_texture(encoder, 1, litShader.m_samplerNormal, mat.texNormal, UInt32.MaxValue);
+            bgfx.encoder_set_texture(encoder, 2, litShader.m_samplerEmissive, mat.texEmissive, UInt32.MaxValue);
+
+            // mapped lights and csm (always have to set those or there are undefined samplers)
+            bgfx.encoder_set_texture(encoder, 4, litShader.m_mappedLight0.m_samplerShadow, lighting.mappedLight0.shadowMap, UInt32.MaxValue);
+            bgfx.encoder_set_texture(encoder, 5, litShader.m_mappedLight1.m_samplerShadow, lighting.mappedLight1.shadowMap, UInt32.MaxValue);
+            bgfx.encoder_set_texture(encoder, 6, litShader.m_samplerShadowCSM, lighting.csmLight.shadowMap, UInt32.MaxValue);
+
+            // clustered lights, stage 7 is the bone palette of the skinned lit shader
+            if (sys->m_lightClusterSupported)
+                bgfx.encoder_set_texture(encoder, 8, litShader.m_samplerLightCluster, lighting.clusterIndex >= 0 && sys->m_lightCluster.height > 0 ? sys->m_lightCluster.handle : sys->m_blackTexture, UInt32.MaxValue);
+        }
+
+        private unsafe static void EncodeLitStateUniforms(RendererBGFXInstance* sys, bgfx.Encoder* encoder, ref LitShader litShader, ushort viewId, ref LitMaterialBGFX mat,
+            ref LightingBGFX lighting, ref float4x4 viewTx, ref LightingViewSpaceBGFX viewSpaceLightCache)
+        {
             // material uniforms setup
             fixed (float4* p = &mat.constAlbedo_Opacity)
                 bgfx.encoder_set_uniform(encoder, litShader.m_uniformAlbedoOpacity, p, 1);
@@ -238,14 +368,6 @@ namespace Unity.Tiny.Rendering
             bgfx.encoder_set_uniform(encoder, litShader.m_uniformOutputDebugSelect, &debugVect, 1);
             fixed (float4* p = &mat.smoothness)
                 bgfx.encoder_set_uniform(encoder, litShader.m_uniformSmoothness, p, 1);
-
-            // textures
-            bgfx.encoder_set_texture(encoder, 0, litShader.m_samplerAlbedoOpacity, mat.texAlbedoOpacity, UInt32.MaxValue);
-            bgfx.encoder_set_texture(encoder, 3, litShader.m_samplerMetal, mat.texMetal, UInt32.MaxValue);
-            bgfx.encoder_set_texture(encoder, 1, litShader.m_samplerNormal, mat.texNormal, UInt32.MaxValue);
-
-            bgfx.encoder_set_texture(encoder, 2, litShader.m_samplerEmissive, mat.texEmissive, UInt32.MaxValue);
-
             fixed (float4* p = &mat.mainTextureScaleTranslate)
                 bgfx.encoder_set_uniform(encoder, litShader.m_uniformTexMad, p, 1);
 
@@ -263,9 +385,14 @@ namespace Unity.Tiny.Rendering
             fixed (float* p = lighting.podl_colorIVR)
                 bgfx.encoder_set_uniform(encoder, litShader.m_simplelightColorIVR, p, (ushort)lighting.numPointOrDirLights);
 
-            // mapped lights (always have to set those or there are undefined samplers)
-            EncodeMappedLight(encoder, ref lighting.mappedLight0, ref litShader.m_mappedLight0, 0, viewSpaceLightCache.mappedLight0_viewPosOrDir); // sampler 4
-            EncodeMappedLight(encoder, ref lighting.mappedLight1, ref litShader.m_mappedLight1, 1, viewSpaceLightCache.mappedLight1_viewPosOrDir); // sampler 5
+            // clustered point lights, the grid was built for this view by UpdateBGFXLightClusters
+            LightClusterViewBGFX noCluster = default;
+            LightClusterViewBGFX* cluster = lighting.clusterIndex >= 0 ? sys->m_lightClusterViews + lighting.clusterIndex * 256 + viewId : &noCluster;
+            bgfx.encoder_set_uniform(encoder, litShader.m_uniformLightCluster, cluster, 6);
+
+            // mapped lights
+            EncodeMappedLight(encoder, ref lighting.mappedLight0, ref litShader.m_mappedLight0, viewSpaceLightCache.mappedLight0_viewPosOrDir);
+            EncodeMappedLight(encoder, ref lighting.mappedLight1, ref litShader.m_mappedLight1, viewSpaceLightCache.mappedLight1_viewPosOrDir);
             fixed (float4* p = &lighting.mappedLight01sis)
                 bgfx.encoder_set_uniform(encoder, litShader.m_texShadow01sis, p, 1);
 
@@ -281,8 +408,6 @@ namespace Unity.Tiny.Rendering
             fixed (float4* p = &lighting.csmLightsis)
                 bgfx.encoder_set_uniform(encoder, litShader.m_sisCSM, p, 1);
 
-            bgfx.encoder_set_texture(encoder, 6, litShader.m_samplerShadowCSM, lighting.csmLight.shadowMap, UInt32.MaxValue);  // sampler 6
-
             float4 numlights = new float4(lighting.numPointOrDirLights, lighting.numMappedLights, lighting.numCsmLights, 0.0f);
             bgfx.encoder_set_uniform(encoder, litShader.m_numLights, &numlights, 1);
 
@@ -291,9 +416,6 @@ namespace Unity.Tiny.Rendering
                 bgfx.encoder_set_uniform(encoder, litShader.m_uniformFogColor, p, 1);
             fixed (float4* p = &lighting.fogParams)
                 bgfx.encoder_set_uniform(encoder, litShader.m_uniformFogParams, p, 1);
-
-            // submit
-            bgfx.encoder_submit(encoder, viewId, prog, depth, (byte)bgfx.DiscardFlags.All);
         }
 
         // ---------------- simple, unlit, with mesh ----------------------------------------------------------------------------------------------------------------------
@@ -310,16 +432,39 @@ namespace Unity.Tiny.Rendering
             EncodeSimple(sys, encoder, ref sys->m_simpleShader, viewId, ref tx, ref mat, flipCulling, depth);
         }
 
+        public static unsafe void SubmitSimpleParticlesInstancedDirect(RendererBGFXInstance* sys, ushort viewId, ref MeshBGFX mesh, bgfx.InstanceDataBuffer* instances, ref SimpleMaterialBGFX mat, int startIndex, int indexCount, byte flipCulling, uint depth)
+        {
+            bgfx.Encoder* encoder = bgfx.encoder_begin(false);
+            EncodeSimpleParticlesInstanced(sys, encoder, viewId, ref mesh, instances, ref mat, startIndex, indexCount, flipCulling, depth);
+            bgfx.encoder_end(encoder);
+        }
+
+        // Draws one particle per ParticleInstance in instances
+        public static unsafe void EncodeSimpleParticlesInstanced(RendererBGFXInstance* sys, bgfx.Encoder* encoder, ushort viewId, ref MeshBGFX mesh, bgfx.InstanceDataBuffer* instances,
+            ref SimpleMaterialBGFX mat, int startIndex, int indexCount, byte flipCulling, uint depth)
+        {
+            mesh.SetForSubmit(encoder, startIndex, indexCount);
+            bgfx.encoder_set_instance_data_buffer(encoder, instances, 0, instances->num);
+            float4x4 identity = float4x4.identity;
+            EncodeSimple(sys, encoder, ref sys->m_simpleParticleInstancedShader, viewId, ref identity, ref mat, flipCulling, depth);
+        }
+
         public static unsafe void EncodeSimpleSkinnedmesh(RendererBGFXInstance* sys, bgfx.Encoder* encoder, ushort viewId, ref MeshBGFX mesh, ref float4x4 tx, ref SimpleMaterialBGFX mat,
-            int startIndex, int indexCount, byte flipCulling, uint depth, float4x4[] boneMatrices)
+            int startIndex, int indexCount, byte flipCulling, uint depth, int bonePaletteOffset)
         {
             mesh.SetForSubmit(encoder, startIndex, indexCount);
-            fixed (float4x4* p = boneMatrices) {
-                bgfx.encoder_set_uniform(encoder, sys->m_simpleSkinnedMeshShader.m_uniformBoneMatrices, p, (ushort)boneMatrices.Length);
-            }
+            EncodeBonePalette(sys, encoder, sys->m_simpleSkinnedMeshShader.m_uniformBonePalette, sys->m_simpleSkinnedMeshShader.m_samplerBonePalette, bonePaletteOffset);
             EncodeSimple(sys, encoder, ref sys->m_simpleSkinnedMeshShader.m_simpleShader, viewId, ref tx, ref mat, flipCulling, depth);
         }
 
+        // Points a skinning shader at the bone matrices of this draw, bonePaletteOffset is its first bone in the frame's bone palette
+        private static unsafe void EncodeBonePalette(RendererBGFXInstance* sys, bgfx.Encoder* encoder, bgfx.UniformHandle uniformBonePalette, bgfx.UniformHandle samplerBonePalette, int bonePaletteOffset)
+        {
+            float4 palette = new float4(bonePaletteOffset, FrameDataTextureBGFX.kWidth, 1.0f / FrameDataTextureBGFX.kWidth, 1.0f / sys->m_bonePalette.height);
+            bgfx.encoder_set_uniform(encoder, uniformBonePalette, &palette, 1);
+            bgfx.encoder_set_texture(encoder, 7, samplerBonePalette, sys->m_bonePalette.handle, UInt32.MaxValue);
+        }
+
         // For uniforms and shaders setup. Does not handle vertex/index buffers
         private static unsafe void EncodeSimple(RendererBGFXInstance* sys, bgfx.Encoder* encoder, ref SimpleShader simpleShader, ushort viewId, ref float4x4 tx, ref SimpleMaterialBGFX mat, byte flipCulling, uint depth)
         {
@@ -440,10 +585,66 @@ namespace Unity.Tiny.Rendering
             EncodeSimple(sys, encoder, ref sys->m_simpleShader, viewId, ref tx, ref mat, flipCulling, depth);
         }
 
-        public static unsafe void EncodeLitTransient(RendererBGFXInstance* sys, bgfx.Encoder* encoder, bgfx.TransientIndexBuffer* tib, bgfx.TransientVertexBuffer* tvb, int nvertices, int nindices, ushort viewId, ref float4x4 tx, ref LitMaterialBGFX mat, ref LightingBGFX lighting, ref float4x4 viewTx, byte flipCulling, ref LightingViewSpaceBGFX viewSpaceLightCache, uint depth)
+        // Without instancing the particle mesh is written once per instance, placed the way the instanced particle shaders place it.
+        // Billboarded particles keep their position in the billboard position, the shader turns the mesh around it.
+        public static unsafe void ExpandSimpleParticles(SimpleVertex* destVertices, ushort* destIndices, ref SimpleMeshData mesh, ParticleInstance* instances, int count, bool billboarded)
+        {
+            int numVertices = mesh.Vertices.Length;
+            int numIndices = mesh.Indices.Length;
+            for (int particleIndex = 0; particleIndex < count; particleIndex++)
+            {
+                float4x4 localToWorld = instances[particleIndex].localToWorld;
+                float4x4 model = billboarded ? new float4x4(localToWorld.c0, localToWorld.c1, localToWorld.c2, new float4(0, 0, 0, 1)) : localToWorld;
+                float3 billboardPos = billboarded ? localToWorld.c3.xyz : float3.zero;
+                for (int i = 0; i < numVertices; i++)
+                {
+                    SimpleVertex vertex = mesh.Vertices[i];
+                    vertex.Position = math.transform(model, vertex.Position);
+                    vertex.Color = instances[particleIndex].color;
+                    vertex.BillboardPos = billboardPos;
+                    *destVertices++ = vertex;
+                }
+                int vertexOffset = particleIndex * numVertices;
+                for (int i = 0; i < numIndices; i++)
+                    *destIndices++ = (ushort)(mesh.Indices[i] + vertexOffset);
+            }
+        }
+
+        public static unsafe void ExpandLitParticles(LitVertex* destVertices, ushort* destIndices, ref LitMeshData mesh, ParticleInstance* instances, int count, bool billboarded)
+        {
+            int numVertices = mesh.Vertices.Length;
+            int numIndices = mesh.Indices.Length;
+            for (int particleIndex = 0; particleIndex < count; particleIndex++)
+            {
+                float4x4 localToWorld = instances[particleIndex].localToWorld;
+                float4x4 model = billboarded ? new float4x4(localToWorld.c0, localToWorld.c1, localToWorld.c2, new float4(0, 0, 0, 1)) : localToWorld;
+                float3 billboardPos = billboarded ? localToWorld.c3.xyz : float3.zero;
+                // inverse transpose from cofactors, as in the instanced shader
+                float3 x = math.cross(localToWorld.c1.xyz, localToWorld.c2.xyz);
+                float3 y = math.cross(localToWorld.c2.xyz, localToWorld.c0.xyz);
+                float3 z = math.cross(localToWorld.c0.xyz, localToWorld.c1.xyz);
+                float3x3 modelInverseTranspose = new float3x3(x, y, z) * (1.0f / math.dot(localToWorld.c0.xyz, x));
+                for (int i = 0; i < numVertices; i++)
+                {
+                    LitVertex vertex = mesh.Vertices[i];
+                    vertex.Position = math.transform(model, vertex.Position);
+                    vertex.Normal = math.mul(modelInverseTranspose, vertex.Normal);
+                    vertex.Tangent = math.mul(modelInverseTranspose, vertex.Tangent);
+                    vertex.BillboardPos = billboardPos;
+                    vertex.Albedo_Opacity = instances[particleIndex].color;
+                    *destVertices++ = vertex;
+                }
+                int vertexOffset = particleIndex * numVertices;
+                for (int i = 0; i < numIndices; i++)
+                    *destIndices++ = (ushort)(mesh.Indices[i] + vertexOffset);
+            }
+        }
+
+        public static unsafe void EncodeLitTransient(RendererBGFXInstance* sys, bgfx.Encoder* encoder, bgfx.TransientIndexBuffer* tib, bgfx.TransientVertexBuffer* tvb, int nvertices, int nindices, ushort viewId, ref float4x4 tx, ref LitMaterialBGFX mat, ref LightingBGFX lighting, ref float4x4 viewTx, byte flipCulling, ref LightingViewSpaceBGFX viewSpaceLightCache, uint depth,
+            LitUniformCacheBGFX* uniformCache = null, uint stateKey = 0)
         {
             EncodeLitTransientBuffers(sys, encoder, tib, tvb, nvertices, nindices);
-            EncodeLit(sys, encoder, ref sys->m_litShader, mat.shaderProgram, viewId, ref tx, ref mat, ref lighting, ref viewTx, flipCulling, ref viewSpaceLightCache, depth);
+            EncodeLit(sys, encoder, ref sys->m_litShader, mat.shaderProgram, viewId, ref tx, ref mat, ref lighting, ref viewTx, flipCulling, ref viewSpaceLightCache, depth, uniformCache, stateKey);
         }
     }
 }
@@ -0,0 +1,122 @@
+using Unity.Mathematics;
+using Unity.Entities;
+#if UNITY_DOTSRUNTIME && !UNITY_WEBGL
+using Unity.Tiny.STB;
+#endif
+using Bgfx;
+
+namespace Unity.Tiny.Rendering
+{
+    // An image placed into a shared atlas page, the TextureBGFX next to it is the page texture and not owned by the image
+    internal struct TextureAtlasEntryBGFX : ISystemStateComponentData
+    {
+        public long entryId;
+        public int generation;       // of the native entry, it moves when its page is repacked
+        public float4 uvScaleOffset; // image texture coordinates to page texture coordinates, xy * uv + zw
+    }
+
+    // An image handed to the atlas pack job and not placed yet
+    internal struct TextureAtlasPendingBGFX : ISystemStateComponentData
+    {
+        public long entryId;
+    }
+
+    // Page textures of the dynamic atlas for images tagged with Image2DAtlas. The native side packs images into cpu copies of the
+    // pages on a worker thread, see AtlasPacker.h. Once a pack job is done the changed part of every page is uploaded with
+    // update_texture_2d. Pages are RGBA8, clamped and without mips, images only share a page with images that sample the same way.
+    internal unsafe struct TextureAtlasBGFX
+    {
+        public const int kPageSize = 1024;
+        public const int kMaxPages = 8;
+        public const int kPadding = 1;       // repeated edge pixels around every image, keeps bilinear filtering from bleeding
+        public const int kMaxImageSize = 256;
+
+        const int kKindSrgb = 1;
+        const int kKindPoint = 2;
+
+        public fixed ushort pageTextures[kMaxPages];
+        public int pageCount;
+        public int placedImages; // stats, as of the last time the atlas was idle
+        public int repacks;
+
+        public bgfx.TextureHandle PageTexture(int page)
+        {
+            return new bgfx.TextureHandle { idx = pageTextures[page] };
+        }
+
+        // The sprite shader samples at (u, 1 - v) and image rows are stored top down
+        public static float4 UvScaleOffset(int x, int y, int w, int h)
+        {
+            float inv = 1.0f / kPageSize;
+            return new float4(w * inv, h * inv, x * inv, 1.0f - (y + h) * inv);
+        }
+
+#if UNITY_DOTSRUNTIME && !UNITY_WEBGL
+        public void Init()
+        {
+            ImageIOSTBNativeCalls.AtlasInit(kPageSize, kMaxPages, kPadding);
+            pageCount = 0;
+            placedImages = 0;
+            repacks = 0;
+        }
+
+        // Images that keep their own texture: mips, wrapping, normal maps and anything large
+        public static bool TryGetKind(RendererBGFXInstance* inst, Image2D im2d, out int kind)
+        {
+            kind = 0;
+            if (im2d.imagePixelWidth > kMaxImageSize || im2d.imagePixelHeight > kMaxImageSize)
+                return false;
+            if ((im2d.flags & TextureFlags.UVClamp) != TextureFlags.UVClamp || (im2d.flags & TextureFlags.UVMirror) != 0)
+                return false;
+            if ((im2d.flags & (TextureFlags.MimapEnabled | TextureFlags.IsNormalMap)) != 0)
+                return false;
+            if (inst->m_allowSRGBTextures && (im2d.flags & TextureFlags.Srgb) == TextureFlags.Srgb)
+                kind |= kKindSrgb;
+            if ((im2d.flags & TextureFlags.Point) == TextureFlags.Point)
+                kind |= kKindPoint;
+            return true;
+        }
+
+        // Creates textures for new pages and uploads what changed, only while the atlas is idle
+        public void UploadPages()
+        {
+            int pageSize = 0;
+            int count = ImageIOSTBNativeCalls.AtlasPageCount(ref pageSize);
+            for (int page = 0; page < count; page++)
+            {
+                if (page >= pageCount)
+                {
+                    int kind = ImageIOSTBNativeCalls.AtlasPageKind(page);
+                    ulong flags = (ulong)bgfx.SamplerFlags.UClamp | (ulong)bgfx.SamplerFlags.VClamp;
+                    if ((kind & kKindSrgb) != 0)
+                        flags |= (ulong)bgfx.TextureFlags.Srgb;
+                    if ((kind & kKindPoint) != 0)
+                        flags |= (ulong)bgfx.SamplerFlags.Point;
+                    pageTextures[page] = bgfx.create_texture_2d((ushort)pageSize, (ushort)pageSize, false, 1, bgfx.TextureFormat.RGBA8, flags, null).idx;
+                    pageCount = page + 1;
+                    RenderDebug.LogFormat("Created atlas page {0} of {1},{2} at bgfx index {3}", page, pageSize, pageSize, (int)pageTextures[page]);
+                }
+
+                int x = 0, y = 0, w = 0, h = 0;
+                byte* pixels = ImageIOSTBNativeCalls.AtlasTakeDirtyRect(page, ref x, ref y, ref w, ref h);
+                if (pixels == null)
+                    continue;
+                int pitch = pageSize * 4;
+                bgfx.Memory* mem = RendererBGFXStatic.CreateMemoryBlock(pixels, (h - 1) * pitch + w * 4);
+                bgfx.update_texture_2d(PageTexture(page), 0, 0, (ushort)x, (ushort)y, (ushort)w, (ushort)h, mem, (ushort)pitch);
+            }
+            placedImages = ImageIOSTBNativeCalls.AtlasStats(ref repacks);
+        }
+
+        public void Destroy()
+        {
+            for (int page = 0; page < pageCount; page++)
+                bgfx.destroy_texture(PageTexture(page));
+            pageCount = 0;
+            placedImages = 0;
+            repacks = 0;
+            ImageIOSTBNativeCalls.AtlasReset();
+        }
+#endif
+    }
+}
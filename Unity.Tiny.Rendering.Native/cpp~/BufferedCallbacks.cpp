@@ -11,6 +11,7 @@ Don't care about multiple instances, it's all a single one and static anyway
 
 #include <baselibext.h>
 #include <allocators.h>
+#include <atomic>
 #include <vector>
 #include <memory>
 #include <string.h>
@@ -19,11 +20,15 @@ Don't care about multiple instances, it's all a single one and static anyway
 
 #include <Unity/Runtime.h>
 
+#include "ShaderCache.h"
+#include "FrameCapture.h"
+#include "PooledAllocator.h"
+#include "ProfilerEvents.h"
+
 //#define BGFX_CALLBACK_DO_ABORT abort();
 //#define BGFX_CALLBACK_PRINTF(...) printf(__VA_ARGS__);
 #define BGFX_CALLBACK_DO_ABORT
 #define BGFX_CALLBACK_PRINTF(...)
-//#define BGFX_CALLBACK_WRITESCREENSHOT
 
 // gcc will complain if the return value of snprintf isn't used to validate truncation has occurred.
 // Should truncation occur, snprintf returns > 0. We only call abort if a real fatal error occurred.
@@ -133,24 +138,6 @@ typedef enum bgfx_texture_format
 
 } bgfx_texture_format_t;
 
-#pragma pack(push)
-#pragma pack(1)
-typedef struct {
-    char  idlength;
-    char  colourmaptype;
-    char  datatypecode;
-    short int colourmaporigin;
-    short int colourmaplength;
-    char  colourmapdepth;
-    short int x_origin;
-    short int y_origin;
-    short width;
-    short height;
-    char  bitsperpixel;
-    char  imagedescriptor;
-} TGA_HEADER;
-#pragma pack(pop)
-
 /**/
 typedef struct bgfx_allocator_interface_s
 {
@@ -197,18 +184,7 @@ enum class BGFXCallbackEntryType {
     Trace = 1,
     ProfilerBegin = 2,
     ProfilerBeginLiteral = 3,
-    ProfilerEnd = 4,
-    ScreenShot = 5,
-    ScreenShotFilename = 6,
-    ScreenShotDesc = 7
-};
-
-struct BGFXScreenShotDesc {
-    int width;
-    int height;
-    int pitch;
-    int size;
-    int yflip;
+    ProfilerEnd = 4
 };
 
 struct BGFXCallbackEntry {
@@ -222,20 +198,37 @@ struct BGFXCallbackEntry {
 
 static bgfx_allocator_interface_s allocator_interface;
 static bgfx_allocator_vtbl_s allocator_vtbl;
+static ut::PooledAllocator pooledAllocator;
+static ut::FrameArena frameArena;
 
 typedef void(* ProfilerBeginCallback)(const char* name, int bytes);
 typedef void(* ProfilerEndCallback)();
 
 static ProfilerBeginCallback g_profilerBegin;
 static ProfilerEndCallback g_profilerEnd;
+// forward scopes to the live profiler connection, off while nobody is listening
+static std::atomic<bool> g_profilerForward;
+static ut::ProfilerEventRecorder profilerEvents;
 
 static bgfx_callback_interface_s cb_interface;
 static bgfx_callback_vtbl_s cb_vtbl;
+// fatals that did not fit into a ring, guarded by mutex
 static std::vector<char> logbuffer;
 static std::vector<BGFXCallbackEntry> calllog;
 static baselib::Lock mutex;
 
-static void addEntry(BGFXCallbackEntryType t, const char* mem, int memLen) {
+// main thread only, filled by BGFXCB_Drain and valid until the next drain
+static std::vector<char> drainbuffer;
+static std::vector<BGFXCallbackEntry> drainlog;
+
+// separate lock, program creation on the render thread should never contend with logging
+static ut::ShaderCache shaderCache;
+static baselib::Lock shaderCacheMutex;
+
+// screen shots and continuous captures, lock free between the render thread and the main thread
+static ut::FrameCapture frameCapture;
+
+static void appendEntry(std::vector<char>& buffer, std::vector<BGFXCallbackEntry>& log, BGFXCallbackEntryType t, const char* mem, int memLen) {
     BGFXCallbackEntry e;
     e.callbacktype = t;
     e.additionalAllocatedDataLen = memLen;
@@ -243,26 +236,128 @@ static void addEntry(BGFXCallbackEntryType t, const char* mem, int memLen) {
         e.additionalAllocatedDataStart = -1;
         e.additionalAllocatedDataLen = 0;
     } else {
-        int s = (int)logbuffer.size();
+        int s = (int)buffer.size();
         e.additionalAllocatedDataStart = s;
-        logbuffer.resize(s + memLen);
-        char* dest = logbuffer.data() + s;
+        buffer.resize(s + memLen);
+        char* dest = buffer.data() + s;
         memcpy(dest, mem, memLen);
     }
-    calllog.push_back(e);
+    log.push_back(e);
 }
 
-static void addEntryString(BGFXCallbackEntryType t, const char* str) {
-    int s = str ? (int)strlen(str) + 1 : 0;
-    addEntry(t, str, s);
+// caller holds mutex
+static void addEntry(BGFXCallbackEntryType t, const char* mem, int memLen) {
+    appendEntry(logbuffer, calllog, t, mem, memLen);
+}
+
+/*
+Trace and fatal messages go through one single producer / single consumer ring per calling thread, so bgfx
+never waits on a lock (or on the main thread) to log. The main thread copies all rings out in BGFXCB_Drain.
+A message that does not fit is dropped and counted. Rings are never freed, threads that log are few and long lived.
+*/
+static const int kMaxLogRings = 16;
+static const uint32_t kLogRingSize = 64 * 1024; // power of two
+static const uint32_t kLogRingWrap = 0xffffffff; // record type: rest of the ring is unused, continue at 0
+
+struct LogRecordHeader {
+    uint32_t type;
+    uint32_t len;   // payload bytes, record is padded to 4 bytes
+};
+
+struct LogRing {
+    std::atomic<uint32_t> head; // total bytes written, owned by the producer
+    std::atomic<uint32_t> tail; // total bytes consumed, owned by the main thread
+    std::atomic<uint32_t> dropped;
+    char data[kLogRingSize];
+};
+
+static std::atomic<LogRing*> logRings[kMaxLogRings];
+static std::atomic<int> logRingCount;
+static std::atomic<uint32_t> logDroppedNoRing;
+static thread_local LogRing* tlsLogRing;
+
+static LogRing* getThreadLogRing() {
+    if (tlsLogRing)
+        return tlsLogRing;
+    int idx = logRingCount.fetch_add(1);
+    if (idx >= kMaxLogRings)
+        return 0;
+    LogRing* ring = new LogRing(); // zero initialized
+    logRings[idx].store(ring, std::memory_order_release);
+    tlsLogRing = ring;
+    return ring;
 }
 
-static bool endsWith(const char *path, const char *ext) {
-    int pl = (int)strlen(path);
-    int l = (int)strlen(ext);
-    if (pl < l)
+static bool pushLogRecord(BGFXCallbackEntryType t, const char* str, uint32_t len) {
+    LogRing* ring = getThreadLogRing();
+    if (!ring) {
+        logDroppedNoRing.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    uint32_t recordSize = (uint32_t)sizeof(LogRecordHeader) + ((len + 3) & ~3u);
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    uint32_t tail = ring->tail.load(std::memory_order_acquire);
+    uint32_t offset = head & (kLogRingSize - 1);
+    uint32_t toEnd = kLogRingSize - offset;
+    // records never straddle the end, skip the remainder if needed
+    uint32_t needed = recordSize <= toEnd ? recordSize : toEnd + recordSize;
+    if (needed > kLogRingSize - (head - tail)) {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
         return false;
-    return strcmp(path + pl - l, ext) == 0;
+    }
+    if (recordSize > toEnd) {
+        // records are 4 byte aligned, so the gap can be too small for a marker; the reader skips it by size
+        if (toEnd >= sizeof(LogRecordHeader)) {
+            LogRecordHeader wrap = { kLogRingWrap, 0 };
+            memcpy(ring->data + offset, &wrap, sizeof(wrap));
+        }
+        head += toEnd;
+        offset = 0;
+    }
+    LogRecordHeader h = { (uint32_t)t, len };
+    memcpy(ring->data + offset, &h, sizeof(h));
+    memcpy(ring->data + offset + sizeof(h), str, len);
+    ring->head.store(head + recordSize, std::memory_order_release);
+    return true;
+}
+
+// main thread, copies everything currently in the rings into drainbuffer / drainlog
+static uint32_t drainLogRings() {
+    uint32_t dropped = logDroppedNoRing.exchange(0, std::memory_order_relaxed);
+    int n = logRingCount.load(std::memory_order_acquire);
+    if (n > kMaxLogRings)
+        n = kMaxLogRings;
+    for (int i = 0; i < n; i++) {
+        LogRing* ring = logRings[i].load(std::memory_order_acquire);
+        if (!ring)
+            continue; // slot claimed but not published yet, picked up next time
+        uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint32_t head = ring->head.load(std::memory_order_acquire);
+        while (tail != head) {
+            uint32_t offset = tail & (kLogRingSize - 1);
+            uint32_t toEnd = kLogRingSize - offset;
+            LogRecordHeader h;
+            if (toEnd < sizeof(h)) {
+                tail += toEnd;
+                continue;
+            }
+            memcpy(&h, ring->data + offset, sizeof(h));
+            if (h.type == kLogRingWrap) {
+                tail += toEnd;
+                continue;
+            }
+            appendEntry(drainbuffer, drainlog, (BGFXCallbackEntryType)h.type, ring->data + offset + sizeof(h), (int)h.len);
+            tail += (uint32_t)sizeof(h) + ((h.len + 3) & ~3u);
+        }
+        ring->tail.store(tail, std::memory_order_release);
+        dropped += ring->dropped.exchange(0, std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+static void addEntryString(BGFXCallbackEntryType t, const char* str) {
+    int s = str ? (int)strlen(str) + 1 : 0;
+    addEntry(t, str, s);
 }
 
 static const char *stripPath(const char *inPath) {
@@ -283,122 +378,92 @@ static void stripTrailing(char *buf, char c) {
         buf[idx - 1] = 0;
 }
 
-static void writeTGA(FILE *f, int w, int h, int pitch, const char *data, bool yflip) {
-    TGA_HEADER hdr = { 0 };
-    hdr.datatypecode = 2; // RGB uncompressed
-    hdr.width = (short)w;
-    hdr.height = (short)h;
-    hdr.bitsperpixel = 32;
-    fwrite(&hdr, sizeof(TGA_HEADER), 1, f);
-    for (int y = 0; y < h; y++) {
-        int y2 = yflip ? h - 1 - y : y;
-        const char *srcLine = y2 * pitch + data;
-        fwrite(srcLine, 4, w, f);
-    }
-}
-
 // callbacks from bgfx, any thread
 static void fatal(bgfx_callback_interface_t* _this, const char* _filePath, uint16_t _line, bgfx_fatal_t _code, const char* _str) {
-    { // don't hold mutex for abort
-		BaselibLock lock(mutex);
-        _filePath = stripPath(_filePath);
-        char buf[8192] = { 0 };
-        snprintf_nowarn(buf, sizeof(buf), "FATAL: %x %s at %s:%i", (int)_code, _str, _filePath, _line);
+    _filePath = stripPath(_filePath);
+    char buf[2048] = { 0 };
+    snprintf_nowarn(buf, sizeof(buf), "FATAL: %x %s at %s:%i", (int)_code, _str, _filePath, _line);
+    if (!pushLogRecord(BGFXCallbackEntryType::Fatal, buf, (uint32_t)strlen(buf) + 1)) {
+        // a fatal must never be dropped, take the slow path
+        BaselibLock lock(mutex);
         addEntryString(BGFXCallbackEntryType::Fatal, buf);
-        BGFX_CALLBACK_PRINTF("%s\n", buf);
     }
+    BGFX_CALLBACK_PRINTF("%s\n", buf);
     BGFX_CALLBACK_DO_ABORT;
 }
 
 static void trace_vargs(bgfx_callback_interface_t* _this, const char* _filePath, uint16_t _line, const char* _format, va_list _argList) {
-	BaselibLock lock(mutex);
     _filePath = stripPath(_filePath);
-    char buf[8192] = { 0 };
-    char buf2[8192] = { 0 };
+    char buf[2048] = { 0 };
     vsnprintf(buf, sizeof(buf), _format, _argList);
     stripTrailing(buf, '\n');
-    snprintf_nowarn(buf2, sizeof(buf2), "%s (at %s:%i)", buf, _filePath, (int)_line);
+    int len = (int)strlen(buf);
+    snprintf_nowarn(buf + len, sizeof(buf) - len, " (at %s:%i)", _filePath, (int)_line);
 
-    addEntryString(BGFXCallbackEntryType::Trace, buf2);
+    pushLogRecord(BGFXCallbackEntryType::Trace, buf, (uint32_t)strlen(buf) + 1);
     BGFX_CALLBACK_PRINTF("%s\n", buf);
 }
 
 static void profiler_begin(bgfx_callback_interface_t* _this, const char* _name, uint32_t _abgr, const char* _filePath, uint16_t _line) {
-    _filePath = stripPath(_filePath);
-    char buf[8192] = { 0 };
-    int bytes = snprintf(buf, sizeof(buf), "%s (at %s:%i)", _name, _filePath, (int)_line);
-    g_profilerBegin(buf, bytes);
+    if (profilerEvents.IsRecording())
+        profilerEvents.Begin(profilerEvents.InternSite(_name, _filePath, _line, false));
+    if (g_profilerForward.load(std::memory_order_relaxed))
+        g_profilerBegin(_name, (int)strlen(_name));
 }
 
 static void profiler_begin_literal(bgfx_callback_interface_t* _this, const char* _name, uint32_t _abgr, const char* _filePath, uint16_t _line) {
-    _filePath = stripPath(_filePath);
-    char buf[8192] = { 0 };
-    int bytes = snprintf(buf, sizeof(buf), "%s (at %s:%i)", _name, _filePath, (int)_line);
-    g_profilerBegin(buf, bytes);
+    if (profilerEvents.IsRecording())
+        profilerEvents.Begin(profilerEvents.InternSite(_name, _filePath, _line, true));
+    if (g_profilerForward.load(std::memory_order_relaxed))
+        g_profilerBegin(_name, (int)strlen(_name));
 }
 
 static void profiler_end(bgfx_callback_interface_t* _this) {
-    g_profilerEnd();
+    profilerEvents.End();
+    if (g_profilerForward.load(std::memory_order_relaxed))
+        g_profilerEnd();
 }
 
 static uint32_t cache_read_size(bgfx_callback_interface_t* _this, uint64_t _id) {
-    return 0;
+    BaselibLock lock(shaderCacheMutex);
+    return shaderCache.ReadSize(_id);
 }
 
 static bool cache_read(bgfx_callback_interface_t* _this, uint64_t _id, void* _data, uint32_t _size) {
-    return false;
+    BaselibLock lock(shaderCacheMutex);
+    return shaderCache.Read(_id, _data, _size);
 }
 
 static void cache_write(bgfx_callback_interface_t* _this, uint64_t _id, const void* _data, uint32_t _size) {
+    BaselibLock lock(shaderCacheMutex);
+    shaderCache.Write(_id, _data, _size);
 }
 
 static void screen_shot(bgfx_callback_interface_t* _this, const char* _filePath, uint32_t _width, uint32_t _height, uint32_t _pitch, const void* _data, uint32_t _size, bool _yflip) {
-	BaselibLock lock(mutex);
-    BGFXScreenShotDesc ds;
-    ds.width = (int)_width;
-    ds.height = (int)_height;
-    ds.pitch = (int)_pitch;
-    ds.size = (int)_size;
-    ds.yflip = _yflip ? 1 : 0;
-    addEntry(BGFXCallbackEntryType::ScreenShotDesc, (const char*)&ds, sizeof(BGFXScreenShotDesc));
-    addEntryString(BGFXCallbackEntryType::ScreenShotFilename, _filePath);
-    addEntry(BGFXCallbackEntryType::ScreenShot, (const char*)_data, _size);
+    frameCapture.AddScreenShot(_filePath, (int)_width, (int)_height, (int)_pitch, _data, _size, _yflip);
     BGFX_CALLBACK_PRINTF("SCREENSHOT: %s (%i*%i)\n", _filePath, (int)_width, (int)_height);
-
-#ifdef BGFX_CALLBACK_WRITESCREENSHOT
-    if (!_filePath || !_filePath[0])
-        return;
-    char path2[8192] = { 0 };
-    if (!endsWith(_filePath, ".tga")) {
-        snprintf_nowarn(path2, sizeof(path2), "%s.tga", _filePath);
-        _filePath = path2;
-    }
-    FILE *f = fopen(_filePath, "wb");
-    if (f) {
-        writeTGA(f, (int)_width, (int)_height, (int)_pitch, (const char*)_data, !_yflip);
-        fclose(f);
-        BGFX_CALLBACK_PRINTF("  wrote file %s\n", _filePath);
-    }
-    else {
-        BGFX_CALLBACK_PRINTF("  could not write file.\n");
-    }
-#endif
 }
 
 static void capture_begin(bgfx_callback_interface_t* _this, uint32_t _width, uint32_t _height, uint32_t _pitch, bgfx_texture_format_t _format, bool _yflip) {
-    BGFX_CALLBACK_DO_ABORT
+    if (_format != BGFX_TEXTURE_FORMAT_BGRA8 && _format != BGFX_TEXTURE_FORMAT_RGBA8) {
+        char buf[256] = { 0 };
+        snprintf_nowarn(buf, sizeof(buf), "Frame capture: back buffer format %i is not supported, only BGRA8 and RGBA8.", (int)_format);
+        pushLogRecord(BGFXCallbackEntryType::Trace, buf, (uint32_t)strlen(buf) + 1);
+        return;
+    }
+    frameCapture.Begin((int)_width, (int)_height, (int)_pitch, _format == BGFX_TEXTURE_FORMAT_BGRA8, _yflip);
 }
 
 static void capture_end(bgfx_callback_interface_t* _this) {
-    BGFX_CALLBACK_DO_ABORT
+    frameCapture.End();
 }
 
 static void capture_frame(bgfx_callback_interface_t* _this, const void* _data, uint32_t _size) {
-    BGFX_CALLBACK_DO_ABORT
+    frameCapture.AddCaptureFrame(_data, _size);
 }
 
 static void* wrapped_realloc(bgfx_allocator_interface_t* _this, void* _ptr, size_t _size, size_t _align, const char* _file, uint32_t _line) {
-    return unsafeutility_realloc(_ptr, (int64_t)_size, (int)_align, Unity::LowLevel::Allocator::Persistent);
+    return pooledAllocator.Realloc(_ptr, _size, _align);
 }
 
 // called from c#, main thread
@@ -408,6 +473,23 @@ DOTS_EXPORT(void*) BGFXAllocator_Init() {
     return &allocator_interface;
 }
 
+// main thread, 16 byte aligned memory that stays valid until bgfx consumed the current frame, use with make_ref.
+// Returns null when this frame's arena is full.
+DOTS_EXPORT(void*) BGFXAllocator_FrameAlloc(int size) {
+    return frameArena.Alloc((size_t)size);
+}
+
+// main thread, right after bgfx::frame
+DOTS_EXPORT(void) BGFXAllocator_EndFrame() {
+    pooledAllocator.EndFrame();
+    frameArena.EndFrame();
+}
+
+DOTS_EXPORT(void) BGFXAllocator_Stats(ut::PooledAllocatorStats* stats) {
+    pooledAllocator.GetStats(stats);
+    frameArena.GetStats(stats);
+}
+
 DOTS_EXPORT(void*) BGFXCB_Init(ProfilerBeginCallback funcBegin, ProfilerEndCallback funcEnd) {
 	BaselibLock lock(mutex);
     cb_vtbl.fatal = &fatal;
@@ -426,6 +508,7 @@ DOTS_EXPORT(void*) BGFXCB_Init(ProfilerBeginCallback funcBegin, ProfilerEndCallb
 
     g_profilerBegin = funcBegin;
     g_profilerEnd = funcEnd;
+    g_profilerForward.store(funcBegin && funcEnd);
 
     return &cb_interface;
 }
@@ -433,24 +516,107 @@ DOTS_EXPORT(void*) BGFXCB_Init(ProfilerBeginCallback funcBegin, ProfilerEndCallb
 DOTS_EXPORT(void) BGFXCB_DeInit() {
 	BaselibLock lock(mutex);
     memset(&cb_vtbl, 0, sizeof(cb_vtbl));
+    g_profilerForward.store(false);
+    profilerEvents.Stop();
+    frameCapture.Stop();
+    frameCapture.FreeAll(); // bgfx is shut down and the caller has released every slot it acquired
     logbuffer.clear();
     calllog.clear();
+    drainLogRings(); // discard whatever is still queued
+    drainbuffer.clear();
+    drainlog.clear();
+}
+
+// driverKey should change whenever cached program binaries can no longer be loaded (driver, gpu, app update)
+DOTS_EXPORT(int) BGFXCB_ShaderCacheOpen(const char* path, uint64_t driverKey) {
+    BaselibLock lock(shaderCacheMutex);
+    return shaderCache.Open(path, driverKey) ? 1 : 0;
+}
+
+// call after bgfx shutdown
+DOTS_EXPORT(void) BGFXCB_ShaderCacheClose() {
+    BaselibLock lock(shaderCacheMutex);
+    shaderCache.Close();
 }
 
-DOTS_EXPORT(int) BGFXCB_Lock(char **text, BGFXCallbackEntry **log) {
-    mutex.Acquire();
-    if (!calllog.empty()) {
-        *log = calllog.data();
-        *text = logbuffer.data();
+// frameCount frames are captured once the Capture reset flag is set, see FrameCapture::Start for file names
+DOTS_EXPORT(int) BGFXCB_CaptureStart(const char* path, int frameCount) {
+    return frameCapture.Start(path, frameCount) ? 1 : 0;
+}
+
+DOTS_EXPORT(void) BGFXCB_CaptureStop() {
+    frameCapture.Stop();
+}
+
+// hands out the oldest captured frame, the pixels stay valid until BGFXCB_CaptureRelease
+DOTS_EXPORT(int) BGFXCB_CaptureAcquire(ut::CapturedFrame* frame) {
+    return frameCapture.Acquire(frame) ? 1 : 0;
+}
+
+DOTS_EXPORT(void) BGFXCB_CaptureRelease(int slot) {
+    frameCapture.Release(slot);
+}
+
+DOTS_EXPORT(void) BGFXCB_CaptureStats(int* captured, int* dropped, int* remaining) {
+    *captured = frameCapture.capturedFrames();
+    *dropped = frameCapture.droppedFrames();
+    *remaining = frameCapture.remainingFrames();
+}
+
+DOTS_EXPORT(void) BGFXCB_ShaderCacheStats(int* hits, int* misses, int* writes, int* entries) {
+    BaselibLock lock(shaderCacheMutex);
+    ut::ShaderCache::Stats stats = shaderCache.GetStats();
+    *hits = stats.hits;
+    *misses = stats.misses;
+    *writes = stats.writes;
+    *entries = stats.entries;
+}
+
+// main thread, only has an effect when profiler callbacks were passed to BGFXCB_Init
+DOTS_EXPORT(void) BGFXCB_ProfilerSetForwarding(int enabled) {
+    g_profilerForward.store(enabled && g_profilerBegin && g_profilerEnd);
+}
+
+// Keeps up to maxEvents bgfx profiler scope begins and ends from now on. Needs bgfx initialized with profiling
+// enabled, otherwise there are no scopes to record.
+DOTS_EXPORT(int) BGFXCB_ProfilerRecordStart(int maxEvents) {
+    return profilerEvents.Start(maxEvents) ? 1 : 0;
+}
+
+// Stops recording and, if path is set, writes everything recorded as a Chrome trace event file
+// (chrome://tracing, Perfetto). Returns 0 if the file could not be written.
+DOTS_EXPORT(int) BGFXCB_ProfilerRecordStop(const char* path) {
+    profilerEvents.Stop();
+    if (!path || !path[0])
+        return 1;
+    return profilerEvents.WriteChromeTrace(path) ? 1 : 0;
+}
+
+DOTS_EXPORT(void) BGFXCB_ProfilerRecordStats(int* recorded, int* dropped) {
+    *recorded = profilerEvents.recordedEvents();
+    *dropped = profilerEvents.droppedEvents();
+}
+
+// called from c#, main thread
+// Copies out everything logged since the last call. The returned memory stays valid until the next drain.
+// dropped is the number of messages lost because a ring was full.
+DOTS_EXPORT(int) BGFXCB_Drain(char **text, BGFXCallbackEntry **log, int *dropped) {
+    drainbuffer.clear();
+    drainlog.clear();
+    {
+        BaselibLock lock(mutex);
+        drainbuffer.swap(logbuffer);
+        drainlog.swap(calllog);
+    }
+    *dropped = (int)drainLogRings();
+    if (profilerEvents.IsRecording())
+        profilerEvents.Drain();
+    if (!drainlog.empty()) {
+        *log = drainlog.data();
+        *text = drainbuffer.data();
     } else {
         *log = 0;
         *text = 0;
     }
-    return (int)calllog.size();
-}
-
-DOTS_EXPORT(void) BGFXCB_UnlockAndClear() {
-    calllog.clear();
-    logbuffer.clear();
-    mutex.Release();
+    return (int)drainlog.size();
 }
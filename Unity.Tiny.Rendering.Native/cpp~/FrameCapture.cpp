@@ -0,0 +1,189 @@
+#include "FrameCapture.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace ut;
+
+FrameCapture::FrameCapture()
+{
+    for (int i = 0; i < sSlotCount; i++) {
+        slots[i].state.store(Free);
+        slots[i].pixels = 0;
+        slots[i].capacity = 0;
+        slots[i].sequence = 0;
+        memset(&slots[i].frame, 0, sizeof(CapturedFrame));
+        slots[i].path[0] = 0;
+    }
+    nextSequence.store(0);
+    captured.store(0);
+    dropped.store(0);
+    remaining.store(0);
+    basePath[0] = 0;
+    frameIndex = 0;
+    width = height = pitch = 0;
+    bgra = true;
+    yflip = false;
+    begun = false;
+}
+
+bool
+FrameCapture::Start(const char* path, int frameCount)
+{
+    if (!path || !path[0] || frameCount <= 0 || remaining.load() != 0)
+        return false;
+    if (strlen(path) + 8 >= sMaxPath)
+        return false;
+    strcpy(basePath, path);
+    remaining.store(frameCount, std::memory_order_release);
+    return true;
+}
+
+void
+FrameCapture::Stop()
+{
+    remaining.store(0, std::memory_order_release);
+}
+
+void
+FrameCapture::Begin(int w, int h, int p, bool isBgra, bool flip)
+{
+    width = w;
+    height = h;
+    pitch = p;
+    bgra = isBgra;
+    yflip = flip;
+    begun = true;
+    frameIndex = 0;
+}
+
+void
+FrameCapture::End()
+{
+    begun = false;
+}
+
+FrameCapture::Slot*
+FrameCapture::ClaimSlot(uint32_t size)
+{
+    for (int i = 0; i < sSlotCount; i++) {
+        int expected = Free;
+        if (!slots[i].state.compare_exchange_strong(expected, Filling, std::memory_order_acquire))
+            continue;
+        Slot* s = &slots[i];
+        if (s->capacity < size) {
+            uint8_t* p = (uint8_t*)realloc(s->pixels, size);
+            if (!p) {
+                s->state.store(Free, std::memory_order_release);
+                return 0;
+            }
+            s->pixels = p;
+            s->capacity = size;
+        }
+        return s;
+    }
+    return 0;
+}
+
+void
+FrameCapture::Publish(Slot* s)
+{
+    s->sequence = nextSequence.fetch_add(1, std::memory_order_relaxed);
+    s->frame.pixels = s->pixels;
+    s->frame.slot = (int)(s - slots);
+    s->frame.path = s->path;
+    s->state.store(Ready, std::memory_order_release);
+}
+
+void
+FrameCapture::AddCaptureFrame(const void* data, uint32_t size)
+{
+    if (!begun || remaining.load(std::memory_order_acquire) <= 0)
+        return;
+    if (remaining.fetch_sub(1, std::memory_order_acq_rel) <= 0) {
+        remaining.store(0);
+        return;
+    }
+    int index = frameIndex++;
+    Slot* s = ClaimSlot(size);
+    if (!s) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    memcpy(s->pixels, data, size);
+
+    // frame.png -> frame_00003.png
+    const char* ext = strrchr(basePath, '.');
+    const char* sep = strrchr(basePath, '/');
+    if (!ext || (sep && ext < sep))
+        ext = basePath + strlen(basePath);
+    snprintf(s->path, sizeof(s->path), "%.*s_%05d%s", (int)(ext - basePath), basePath, index, ext);
+
+    s->frame.width = width;
+    s->frame.height = height;
+    s->frame.pitch = pitch;
+    s->frame.bgra = bgra ? 1 : 0;
+    s->frame.yflip = yflip ? 1 : 0;
+    s->frame.screenShot = 0;
+    Publish(s);
+    captured.fetch_add(1, std::memory_order_relaxed);
+}
+
+void
+FrameCapture::AddScreenShot(const char* path, int w, int h, int p, const void* data, uint32_t size, bool flip)
+{
+    Slot* s = ClaimSlot(size);
+    if (!s) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    memcpy(s->pixels, data, size);
+    snprintf(s->path, sizeof(s->path), "%s", path ? path : "");
+    s->frame.width = w;
+    s->frame.height = h;
+    s->frame.pitch = p;
+    s->frame.bgra = 1; // bgfx always hands out screen shots as BGRA8
+    s->frame.yflip = flip ? 1 : 0;
+    s->frame.screenShot = 1;
+    Publish(s);
+}
+
+bool
+FrameCapture::Acquire(CapturedFrame* frame)
+{
+    Slot* best = 0;
+    for (int i = 0; i < sSlotCount; i++) {
+        if (slots[i].state.load(std::memory_order_acquire) != Ready)
+            continue;
+        if (!best || (int32_t)(slots[i].sequence - best->sequence) < 0)
+            best = &slots[i];
+    }
+    if (!best)
+        return false;
+    // only the main thread moves slots out of Ready, so this cannot race
+    best->state.store(Busy, std::memory_order_relaxed);
+    *frame = best->frame;
+    return true;
+}
+
+void
+FrameCapture::Release(int slot)
+{
+    if (slot < 0 || slot >= sSlotCount)
+        return;
+    slots[slot].state.store(Free, std::memory_order_release);
+}
+
+void
+FrameCapture::FreeAll()
+{
+    // only valid once bgfx is shut down and no encoder holds a slot
+    for (int i = 0; i < sSlotCount; i++) {
+        free(slots[i].pixels);
+        slots[i].pixels = 0;
+        slots[i].capacity = 0;
+        slots[i].state.store(Free);
+    }
+    remaining.store(0);
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+namespace ut {
+
+// keep this in sync with C# bgfx.CapturedFrame
+struct CapturedFrame {
+    uint8_t* pixels;
+    int slot;
+    int width;
+    int height;
+    int pitch;
+    int bgra;       // 1 = BGRA8, 0 = RGBA8
+    int yflip;
+    int screenShot; // 1 = request_screen_shot, 0 = continuous capture
+    const char* path;
+};
+
+// Pool of frame buffers handed from the bgfx render thread to the main thread and on to an encoder.
+// The render thread only ever copies into a free slot and never waits: if every slot is still being
+// encoded the frame is dropped and counted. Slots move Free -> Filling (render thread) -> Ready -> Busy
+// (main thread, handed to the encoder) -> Free.
+class FrameCapture {
+public:
+    static const int sSlotCount = 6;
+    static const int sMaxPath = 512;
+
+    FrameCapture();
+
+    // main thread; frames are written as name_00000.ext, name_00001.ext, ... for path name.ext
+    bool Start(const char* path, int frameCount);
+    void Stop();
+
+    // render thread
+    void Begin(int width, int height, int pitch, bool bgra, bool yflip);
+    void End();
+    void AddCaptureFrame(const void* data, uint32_t size);
+    void AddScreenShot(const char* path, int width, int height, int pitch, const void* data, uint32_t size, bool yflip);
+
+    // main thread, oldest ready frame first
+    bool Acquire(CapturedFrame* frame);
+    // any thread, once the encoder is done with the pixels
+    void Release(int slot);
+    void FreeAll();
+
+    int capturedFrames() const { return captured.load(std::memory_order_relaxed); }
+    int droppedFrames() const { return dropped.load(std::memory_order_relaxed); }
+    int remainingFrames() const { return remaining.load(std::memory_order_relaxed); }
+
+private:
+    enum SlotState {
+        Free = 0,
+        Filling,
+        Ready,
+        Busy
+    };
+
+    struct Slot {
+        std::atomic<int> state;
+        uint8_t* pixels;
+        uint32_t capacity;
+        uint32_t sequence;
+        CapturedFrame frame;
+        char path[sMaxPath];
+    };
+
+    Slot* ClaimSlot(uint32_t size);
+    void Publish(Slot* s);
+
+    Slot slots[sSlotCount];
+    std::atomic<uint32_t> nextSequence;
+    std::atomic<int> captured;
+    std::atomic<int> dropped;
+    std::atomic<int> remaining; // frames still to record, 0 when no capture is running
+
+    // written by Start before remaining is set, read by the render thread
+    char basePath[sMaxPath];
+
+    // render thread only
+    int frameIndex;
+    int width, height, pitch;
+    bool bgra, yflip, begun;
+};
+
+} // namespace ut
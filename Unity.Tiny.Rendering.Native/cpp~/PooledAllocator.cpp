@@ -0,0 +1,252 @@
+#include "PooledAllocator.h"
+
+#include <allocators.h>
+#include <string.h>
+
+#include <Unity/Runtime.h>
+
+using namespace ut;
+using namespace Unity::LowLevel;
+
+namespace {
+
+static const uint32_t sLargeClass = 0xffffffff;
+static const size_t sFrameArenaInitialSize = 1024 * 1024;
+
+// sits right in front of every block handed to bgfx
+struct BlockHeader {
+    uint32_t sizeClass;
+    uint32_t offset;  // from the start of the underlying allocation to the user pointer, large blocks only
+    uint64_t size;    // usable bytes
+};
+static_assert(sizeof(BlockHeader) == PooledAllocator::sHeaderSize, "header must keep user pointers 16 byte aligned");
+
+static inline BlockHeader*
+HeaderOf(void* ptr)
+{
+    return (BlockHeader*)((uint8_t*)ptr - sizeof(BlockHeader));
+}
+
+static inline int
+ClassForSize(size_t size)
+{
+    size_t blockSize = PooledAllocator::sMinBlockSize;
+    for (int c = 0; c < PooledAllocator::sClassCount; c++, blockSize <<= 1) {
+        if (size + sizeof(BlockHeader) <= blockSize)
+            return c;
+    }
+    return -1;
+}
+
+template<typename T>
+static void
+AtomicMax(std::atomic<T>& target, T value)
+{
+    T prev = target.load(std::memory_order_relaxed);
+    while (prev < value && !target.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+PooledAllocator::PooledAllocator()
+{
+    for (int c = 0; c < sClassCount; c++) {
+        classes[c].freeList = 0;
+        classes[c].liveBytes.store(0);
+        classes[c].reservedBytes.store(0);
+    }
+    largeLiveBytes.store(0);
+    liveBytes.store(0);
+    peakLiveBytes.store(0);
+    allocationsThisFrame.store(0);
+    allocationsLastFrame = 0;
+}
+
+void
+PooledAllocator::TrackLive(int64_t delta)
+{
+    int64_t now = liveBytes.fetch_add(delta, std::memory_order_relaxed) + delta;
+    if (delta > 0)
+        AtomicMax(peakLiveBytes, now);
+}
+
+void*
+PooledAllocator::Alloc(size_t size, size_t align)
+{
+    allocationsThisFrame.fetch_add(1, std::memory_order_relaxed);
+    int c = align <= sHeaderSize ? ClassForSize(size) : -1;
+    if (c < 0) {
+        size_t a = align < sHeaderSize ? sHeaderSize : align;
+        uint8_t* raw = (uint8_t*)unsafeutility_malloc((int64_t)(size + sizeof(BlockHeader) + a), 16, Allocator::Persistent);
+        if (!raw)
+            return 0;
+        uintptr_t user = ((uintptr_t)raw + sizeof(BlockHeader) + a - 1) & ~(uintptr_t)(a - 1);
+        BlockHeader* h = HeaderOf((void*)user);
+        h->sizeClass = sLargeClass;
+        h->offset = (uint32_t)(user - (uintptr_t)raw);
+        h->size = size;
+        largeLiveBytes.fetch_add((int64_t)size, std::memory_order_relaxed);
+        TrackLive((int64_t)size);
+        return (void*)user;
+    }
+
+    SizeClass& sc = classes[c];
+    size_t blockSize = sMinBlockSize << c;
+    FreeBlock* block;
+    {
+        BaselibLock lock(sc.lock);
+        if (!sc.freeList) {
+            uint8_t* page = (uint8_t*)unsafeutility_malloc((int64_t)sPageSize, 16, Allocator::Persistent);
+            if (!page)
+                return 0;
+            // thread the whole page onto the free list, first block ends up on top
+            for (size_t o = sPageSize; o >= blockSize; o -= blockSize) {
+                FreeBlock* b = (FreeBlock*)(page + o - blockSize);
+                b->next = sc.freeList;
+                sc.freeList = b;
+            }
+            sc.reservedBytes.fetch_add((int64_t)sPageSize, std::memory_order_relaxed);
+        }
+        block = sc.freeList;
+        sc.freeList = block->next;
+    }
+    BlockHeader* h = (BlockHeader*)block;
+    h->sizeClass = (uint32_t)c;
+    h->offset = (uint32_t)sizeof(BlockHeader);
+    h->size = blockSize - sizeof(BlockHeader);
+    sc.liveBytes.fetch_add((int64_t)blockSize, std::memory_order_relaxed);
+    TrackLive((int64_t)blockSize);
+    return (uint8_t*)block + sizeof(BlockHeader);
+}
+
+void
+PooledAllocator::Free(void* ptr)
+{
+    BlockHeader* h = HeaderOf(ptr);
+    if (h->sizeClass == sLargeClass) {
+        largeLiveBytes.fetch_sub((int64_t)h->size, std::memory_order_relaxed);
+        TrackLive(-(int64_t)h->size);
+        unsafeutility_free((uint8_t*)ptr - h->offset, Allocator::Persistent);
+        return;
+    }
+    SizeClass& sc = classes[h->sizeClass];
+    size_t blockSize = sMinBlockSize << h->sizeClass;
+    sc.liveBytes.fetch_sub((int64_t)blockSize, std::memory_order_relaxed);
+    TrackLive(-(int64_t)blockSize);
+    FreeBlock* block = (FreeBlock*)h;
+    BaselibLock lock(sc.lock);
+    block->next = sc.freeList;
+    sc.freeList = block;
+}
+
+size_t
+PooledAllocator::UsableSize(void* ptr) const
+{
+    return (size_t)HeaderOf(ptr)->size;
+}
+
+void*
+PooledAllocator::Realloc(void* ptr, size_t size, size_t align)
+{
+    if (size == 0) {
+        if (ptr)
+            Free(ptr);
+        return 0;
+    }
+    if (!ptr)
+        return Alloc(size, align);
+
+    // still fits and is not wasting a larger class: keep the block
+    size_t usable = UsableSize(ptr);
+    BlockHeader* h = HeaderOf(ptr);
+    if (size <= usable && (h->sizeClass == sLargeClass ? size == usable : (int)h->sizeClass == ClassForSize(size)))
+        return ptr;
+
+    void* p = Alloc(size, align);
+    if (!p)
+        return 0;
+    memcpy(p, ptr, size < usable ? size : usable);
+    Free(ptr);
+    return p;
+}
+
+void
+PooledAllocator::EndFrame()
+{
+    allocationsLastFrame = allocationsThisFrame.exchange(0, std::memory_order_relaxed);
+}
+
+void
+PooledAllocator::GetStats(PooledAllocatorStats* stats)
+{
+    for (int c = 0; c < sClassCount; c++) {
+        stats->classLiveBytes[c] = classes[c].liveBytes.load(std::memory_order_relaxed);
+        stats->classReservedBytes[c] = classes[c].reservedBytes.load(std::memory_order_relaxed);
+    }
+    stats->largeLiveBytes = largeLiveBytes.load(std::memory_order_relaxed);
+    stats->liveBytes = liveBytes.load(std::memory_order_relaxed);
+    stats->peakLiveBytes = peakLiveBytes.load(std::memory_order_relaxed);
+    stats->allocationsLastFrame = allocationsLastFrame;
+}
+
+FrameArena::FrameArena()
+{
+    for (int i = 0; i < sArenaCount; i++) {
+        arenas[i].memory = 0;
+        arenas[i].capacity = 0;
+        arenas[i].wanted = sFrameArenaInitialSize;
+        arenas[i].used.store(0);
+        arenas[i].overflows.store(0);
+    }
+    current.store(0);
+    usedLastFrame = 0;
+    overflowsLastFrame = 0;
+}
+
+void*
+FrameArena::Alloc(size_t size)
+{
+    Arena& a = arenas[current.load(std::memory_order_relaxed)];
+    size = (size + 15) & ~(size_t)15;
+    size_t offset = a.used.fetch_add(size, std::memory_order_relaxed);
+    if (offset + size > a.capacity) {
+        a.overflows.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+    return a.memory + offset;
+}
+
+void
+FrameArena::EndFrame()
+{
+    // main thread, after bgfx::frame and with no FrameAlloc calls in flight
+    int cur = current.load(std::memory_order_relaxed);
+    Arena& done = arenas[cur];
+    usedLastFrame = done.used.load(std::memory_order_relaxed);
+    overflowsLastFrame = done.overflows.load(std::memory_order_relaxed);
+    if (usedLastFrame > done.capacity && usedLastFrame > done.wanted)
+        done.wanted = usedLastFrame + usedLastFrame / 4;
+
+    // the next arena was last filled two frames ago, bgfx is done with it
+    int next = (cur + 1) % sArenaCount;
+    Arena& a = arenas[next];
+    size_t wanted = done.wanted > a.wanted ? done.wanted : a.wanted;
+    if (wanted > a.capacity) {
+        unsafeutility_free(a.memory, Allocator::Persistent);
+        a.memory = (uint8_t*)unsafeutility_malloc((int64_t)wanted, 16, Allocator::Persistent);
+        a.capacity = a.memory ? wanted : 0;
+    }
+    a.wanted = wanted;
+    a.used.store(0, std::memory_order_relaxed);
+    a.overflows.store(0, std::memory_order_relaxed);
+    current.store(next, std::memory_order_release);
+}
+
+void
+FrameArena::GetStats(PooledAllocatorStats* stats) const
+{
+    stats->frameArenaBytesLastFrame = (int32_t)usedLastFrame;
+    stats->frameArenaCapacity = (int32_t)arenas[current.load(std::memory_order_relaxed)].capacity;
+    stats->frameArenaOverflowsLastFrame = overflowsLastFrame;
+}
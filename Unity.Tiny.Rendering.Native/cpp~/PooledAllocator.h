@@ -0,0 +1,96 @@
+#pragma once
+
+#include <baselibext.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+namespace ut {
+
+// keep this in sync with C# bgfx.AllocatorStats
+struct PooledAllocatorStats {
+    int64_t classLiveBytes[12];     // bytes handed out per size class, including block headers
+    int64_t classReservedBytes[12]; // bytes held by the pages of each size class
+    int64_t largeLiveBytes;         // allocations that bypass the pools
+    int64_t liveBytes;
+    int64_t peakLiveBytes;
+    int32_t allocationsLastFrame;
+    int32_t frameArenaBytesLastFrame;
+    int32_t frameArenaCapacity;
+    int32_t frameArenaOverflowsLastFrame;
+};
+
+// Allocator behind bgfx. Blocks up to 64KB come from per size class free lists that are carved out of
+// larger pages and never given back to the system, so the steady per frame churn of command buffers
+// and bgfx::Memory blocks does not touch the general purpose heap. Bigger or over aligned blocks go
+// straight to the Persistent allocator. Each size class has its own lock, any thread may allocate or free.
+class PooledAllocator {
+public:
+    static const int sClassCount = 12;
+    static const size_t sMinBlockSize = 32;   // block sizes are 32 << class, header included
+    static const size_t sPageSize = 256 * 1024;
+    static const size_t sHeaderSize = 16;
+
+    PooledAllocator();
+
+    // same contract as bgfx::AllocatorI::realloc: size 0 frees, null ptr allocates
+    void* Realloc(void* ptr, size_t size, size_t align);
+
+    void EndFrame();
+    void GetStats(PooledAllocatorStats* stats);
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct SizeClass {
+        baselib::Lock lock;
+        FreeBlock* freeList;
+        std::atomic<int64_t> liveBytes;
+        std::atomic<int64_t> reservedBytes;
+    };
+
+    void* Alloc(size_t size, size_t align);
+    void Free(void* ptr);
+    size_t UsableSize(void* ptr) const;
+    void TrackLive(int64_t delta);
+
+    SizeClass classes[sClassCount];
+    std::atomic<int64_t> largeLiveBytes;
+    std::atomic<int64_t> liveBytes;
+    std::atomic<int64_t> peakLiveBytes;
+    std::atomic<int32_t> allocationsThisFrame;
+    int32_t allocationsLastFrame;
+};
+
+// Linear allocator for memory that only has to live until bgfx has consumed it. bgfx guarantees that
+// memory passed with make_ref is no longer used after two bgfx::frame calls, so there are three arenas and
+// the oldest one is reset after every frame. Allocation is a single atomic add. An arena that ran out grows
+// the next time it is reset; until then FrameAlloc returns null and callers fall back to bgfx::copy.
+class FrameArena {
+public:
+    static const int sArenaCount = 3;
+
+    FrameArena();
+
+    void* Alloc(size_t size);
+    void EndFrame();
+    void GetStats(PooledAllocatorStats* stats) const;
+
+private:
+    struct Arena {
+        uint8_t* memory;
+        size_t capacity;
+        size_t wanted; // capacity asked for by the last overflow
+        std::atomic<size_t> used;
+        std::atomic<int32_t> overflows;
+    };
+
+    Arena arenas[sArenaCount];
+    std::atomic<int> current;
+    size_t usedLastFrame;
+    int32_t overflowsLastFrame;
+};
+
+} // namespace ut
@@ -0,0 +1,300 @@
+#include "ProfilerEvents.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+using namespace ut;
+
+namespace {
+
+static const int sSiteCacheSize = 64; // power of two
+
+// per thread cache for literal names, sites are never removed so entries never go stale
+struct SiteCacheEntry {
+    const char* name;
+    const char* file;
+    uint32_t line;
+    uint32_t site;
+};
+
+static thread_local SiteCacheEntry tlsSiteCache[sSiteCacheSize];
+static thread_local void* tlsRing;
+
+static inline uint64_t
+Now()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static const char*
+StripPath(const char* path)
+{
+    if (!path)
+        return "";
+    const char* s = path;
+    for (const char* p = path; *p; p++) {
+        if (*p == '/' || *p == '\\')
+            s = p + 1;
+    }
+    return s;
+}
+
+static uint64_t
+HashSite(const char* name, const char* file, uint16_t line)
+{
+    uint64_t h = 14695981039346656037ull;
+    for (const char* p = name; *p; p++)
+        h = (h ^ (uint8_t)*p) * 1099511628211ull;
+    h = (h ^ 0xff) * 1099511628211ull;
+    for (const char* p = file; *p; p++)
+        h = (h ^ (uint8_t)*p) * 1099511628211ull;
+    return (h ^ line) * 1099511628211ull;
+}
+
+static void
+WriteJsonString(FILE* f, const char* s)
+{
+    fputc('"', f);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+            fprintf(f, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(f, "\\u%04x", c);
+        else
+            fputc(c, f);
+    }
+    fputc('"', f);
+}
+
+} // namespace
+
+ProfilerEventRecorder::ProfilerEventRecorder()
+{
+    recording.store(false);
+    for (int i = 0; i < sMaxRings; i++)
+        rings[i].store(0);
+    ringCount.store(0);
+    droppedNoRing.store(0);
+    maxEventCount = 0;
+    dropped = 0;
+}
+
+uint32_t
+ProfilerEventRecorder::InternSite(const char* name, const char* file, uint16_t line, bool literal)
+{
+    if (!name)
+        name = "";
+    if (!literal)
+        return InternSlow(name, StripPath(file), line);
+
+    SiteCacheEntry& c = tlsSiteCache[(((uintptr_t)name >> 3) ^ line) & (sSiteCacheSize - 1)];
+    if (c.name == name && c.file == file && c.line == line)
+        return c.site;
+    uint32_t site = InternSlow(name, StripPath(file), line);
+    c.name = name;
+    c.file = file;
+    c.line = line;
+    c.site = site;
+    return site;
+}
+
+uint32_t
+ProfilerEventRecorder::InternSlow(const char* name, const char* file, uint16_t line)
+{
+    uint64_t hash = HashSite(name, file, line);
+    BaselibLock lock(siteLock);
+    auto range = siteIndex.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        const Site& s = sites[it->second];
+        if (s.line == line && s.name == name && s.file == file)
+            return it->second;
+    }
+    uint32_t site = (uint32_t)sites.size();
+    Site s;
+    s.name = name;
+    s.file = file;
+    s.line = line;
+    sites.push_back(s);
+    siteIndex.insert(std::make_pair(hash, site));
+    return site;
+}
+
+ProfilerEventRecorder::Ring*
+ProfilerEventRecorder::ThreadRing()
+{
+    if (tlsRing)
+        return (Ring*)tlsRing;
+    int idx = ringCount.fetch_add(1);
+    if (idx >= sMaxRings)
+        return 0;
+    Ring* ring = new Ring(); // zero initialized
+    ring->index = (uint32_t)idx;
+    rings[idx].store(ring, std::memory_order_release);
+    tlsRing = ring;
+    return ring;
+}
+
+void
+ProfilerEventRecorder::Push(uint32_t site)
+{
+    Ring* ring = ThreadRing();
+    if (!ring) {
+        droppedNoRing.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) >= sRingEvents) {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Event& e = ring->events[head & (sRingEvents - 1)];
+    e.time = Now();
+    e.site = site;
+    e.thread = ring->index;
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void
+ProfilerEventRecorder::Begin(uint32_t site)
+{
+    if (recording.load(std::memory_order_relaxed))
+        Push(site);
+}
+
+void
+ProfilerEventRecorder::End()
+{
+    if (recording.load(std::memory_order_relaxed))
+        Push(sEndSite);
+}
+
+bool
+ProfilerEventRecorder::Start(int maxEvents)
+{
+    if (maxEvents <= 0 || recording.load())
+        return false;
+    Drain(); // throw away anything left over from a previous recording
+    events.clear();
+    events.reserve((size_t)maxEvents);
+    maxEventCount = (size_t)maxEvents;
+    dropped = 0;
+    recording.store(true, std::memory_order_release);
+    return true;
+}
+
+void
+ProfilerEventRecorder::Stop()
+{
+    if (!recording.load())
+        return;
+    recording.store(false, std::memory_order_release);
+    Drain();
+}
+
+void
+ProfilerEventRecorder::Drain()
+{
+    dropped += (int)droppedNoRing.exchange(0, std::memory_order_relaxed);
+    int n = ringCount.load(std::memory_order_acquire);
+    if (n > sMaxRings)
+        n = sMaxRings;
+    for (int i = 0; i < n; i++) {
+        Ring* ring = rings[i].load(std::memory_order_acquire);
+        if (!ring)
+            continue; // slot claimed but not published yet, picked up next time
+        uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint32_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; tail++) {
+            if (events.size() < maxEventCount)
+                events.push_back(ring->events[tail & (sRingEvents - 1)]);
+            else
+                dropped++;
+        }
+        ring->tail.store(tail, std::memory_order_release);
+        dropped += (int)ring->dropped.exchange(0, std::memory_order_relaxed);
+    }
+}
+
+bool
+ProfilerEventRecorder::WriteChromeTrace(const char* path)
+{
+    FILE* f = fopen(path, "wb");
+    if (!f)
+        return false;
+
+    // sites only ever grow, a copy keeps the lock out of the loop below
+    std::vector<Site> siteCopy;
+    {
+        BaselibLock lock(siteLock);
+        siteCopy = sites;
+    }
+
+    uint64_t base = events.empty() ? 0 : events[0].time;
+    for (const Event& e : events) {
+        if (e.time < base)
+            base = e.time;
+    }
+
+    // recording starts and stops in the middle of scopes, only balanced pairs are written
+    int depth[sMaxRings] = { 0 };
+    uint64_t lastTime[sMaxRings] = { 0 };
+    bool renderThread[sMaxRings] = { false };
+    bool used[sMaxRings] = { false };
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (const Event& e : events) {
+        uint32_t t = e.thread;
+        if (t >= (uint32_t)sMaxRings)
+            continue;
+        if (e.site == sEndSite) {
+            if (depth[t] == 0)
+                continue;
+            depth[t]--;
+        } else {
+            if (e.site >= siteCopy.size())
+                continue;
+            depth[t]++;
+        }
+        used[t] = true;
+        lastTime[t] = e.time;
+        double ts = (double)(e.time - base) / 1000.0;
+        fprintf(f, "%s{\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%.3f", first ? "" : ",\n", e.site == sEndSite ? 'E' : 'B', t, ts);
+        if (e.site != sEndSite) {
+            const Site& s = siteCopy[e.site];
+            if (s.name == "bgfx::renderFrame")
+                renderThread[t] = true;
+            fprintf(f, ",\"cat\":\"bgfx\",\"name\":");
+            WriteJsonString(f, s.name.c_str());
+            fprintf(f, ",\"args\":{\"file\":");
+            WriteJsonString(f, s.file.c_str());
+            fprintf(f, ",\"line\":%u}", (unsigned)s.line);
+        }
+        fputc('}', f);
+        first = false;
+    }
+
+    for (int t = 0; t < sMaxRings; t++) {
+        for (; depth[t] > 0; depth[t]--) {
+            fprintf(f, "%s{\"ph\":\"E\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}", first ? "" : ",\n", t, (double)(lastTime[t] - base) / 1000.0);
+            first = false;
+        }
+        if (!used[t])
+            continue;
+        char name[64];
+        if (renderThread[t])
+            snprintf(name, sizeof(name), "Render Thread");
+        else
+            snprintf(name, sizeof(name), "bgfx thread %d", t);
+        fprintf(f, "%s{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":\"%s\"}}", first ? "" : ",\n", t, name);
+        first = false;
+    }
+    fprintf(f, "\n]}\n");
+
+    bool ok = !ferror(f);
+    if (fclose(f) != 0)
+        ok = false;
+    return ok;
+}
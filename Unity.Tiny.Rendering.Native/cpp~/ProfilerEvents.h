@@ -0,0 +1,82 @@
+#pragma once
+
+#include <baselibext.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ut {
+
+// Records bgfx profiler scopes as fixed size binary events instead of formatting strings on the calling thread.
+// A scope site (name, file, line) is interned once into a small id, after that a begin is a table lookup plus
+// a 16 byte write into the calling thread's ring and an end is just the write. The main thread moves ring
+// contents into one event list every frame; names are only looked at again when a trace file is written.
+// Events are only kept between Start and Stop, a full ring or list drops events and counts them.
+class ProfilerEventRecorder {
+public:
+    static const uint32_t sEndSite = 0xffffffff;
+
+    ProfilerEventRecorder();
+
+    // any thread; literal names have a stable address and take a per thread fast path
+    uint32_t InternSite(const char* name, const char* file, uint16_t line, bool literal);
+    void Begin(uint32_t site);
+    void End();
+    bool IsRecording() const { return recording.load(std::memory_order_relaxed); }
+
+    // main thread
+    bool Start(int maxEvents);
+    void Stop();
+    void Drain();
+    bool WriteChromeTrace(const char* path);
+
+    int recordedEvents() const { return (int)events.size(); }
+    int droppedEvents() const { return dropped; }
+
+private:
+    struct Event {
+        uint64_t time;   // nanoseconds, steady clock
+        uint32_t site;   // sEndSite for the end of the innermost scope
+        uint32_t thread; // ring index
+    };
+
+    static const int sMaxRings = 16;
+    static const uint32_t sRingEvents = 16 * 1024; // power of two
+
+    struct Ring {
+        std::atomic<uint32_t> head; // events written, owned by the producer
+        std::atomic<uint32_t> tail; // events consumed, owned by the main thread
+        std::atomic<uint32_t> dropped;
+        uint32_t index;
+        Event events[sRingEvents];
+    };
+
+    struct Site {
+        std::string name;
+        std::string file;
+        uint16_t line;
+    };
+
+    Ring* ThreadRing();
+    void Push(uint32_t site);
+    uint32_t InternSlow(const char* name, const char* file, uint16_t line);
+
+    std::atomic<bool> recording;
+    std::atomic<Ring*> rings[sMaxRings];
+    std::atomic<int> ringCount;
+    std::atomic<uint32_t> droppedNoRing;
+
+    baselib::Lock siteLock;
+    std::vector<Site> sites;
+    std::unordered_multimap<uint64_t, uint32_t> siteIndex; // hash of name, file and line -> site
+
+    // main thread only
+    std::vector<Event> events;
+    size_t maxEventCount;
+    int dropped;
+};
+
+} // namespace ut
@@ -0,0 +1,283 @@
+#include "ShaderCache.h"
+
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace ut;
+
+namespace {
+
+static const uint32_t sMagic = 0x43535455; // "UTSC"
+static const uint32_t sFormatVersion = 1;
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t driverKey;
+};
+
+struct RecordHeader {
+    uint64_t id;
+    uint32_t size;
+    uint32_t checksum;
+};
+
+// catches records that were cut short or never fully flushed when the app was killed mid write
+static uint32_t
+Checksum(const uint8_t* data, uint32_t size)
+{
+    uint32_t h = 2166136261u;
+    for (uint32_t i = 0; i < size; i++)
+        h = (h ^ data[i]) * 16777619u;
+    return h;
+}
+
+} // namespace
+
+ShaderCache::ShaderCache()
+{
+    file = 0;
+    writeOffset = 0;
+    mapped = 0;
+    mappedSize = 0;
+#if defined(_WIN32)
+    mapFile = INVALID_HANDLE_VALUE;
+    mapHandle = 0;
+#endif
+    memset(&stats, 0, sizeof(stats));
+}
+
+ShaderCache::~ShaderCache()
+{
+    Close();
+}
+
+bool
+ShaderCache::Map(const char* path)
+{
+#if defined(_WIN32)
+    HANDLE f = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (f == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(f, &size) || size.QuadPart < (LONGLONG)sizeof(FileHeader) || size.QuadPart > 0x7fffffff) {
+        CloseHandle(f);
+        return false;
+    }
+    HANDLE m = CreateFileMappingA(f, 0, PAGE_READONLY, 0, 0, 0);
+    if (!m) {
+        CloseHandle(f);
+        return false;
+    }
+    void* p = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+    if (!p) {
+        CloseHandle(m);
+        CloseHandle(f);
+        return false;
+    }
+    mapFile = f;
+    mapHandle = m;
+    mapped = (const uint8_t*)p;
+    mappedSize = (size_t)size.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(FileHeader) || st.st_size > 0x7fffffff) {
+        close(fd);
+        return false;
+    }
+    void* p = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps its own reference
+    if (p == MAP_FAILED)
+        return false;
+    mapped = (const uint8_t*)p;
+    mappedSize = (size_t)st.st_size;
+#endif
+    return true;
+}
+
+void
+ShaderCache::Unmap()
+{
+    if (!mapped)
+        return;
+#if defined(_WIN32)
+    UnmapViewOfFile(mapped);
+    CloseHandle((HANDLE)mapHandle);
+    CloseHandle((HANDLE)mapFile);
+    mapFile = INVALID_HANDLE_VALUE;
+    mapHandle = 0;
+#else
+    munmap((void*)mapped, mappedSize);
+#endif
+    mapped = 0;
+    mappedSize = 0;
+}
+
+size_t
+ShaderCache::ScanRecords()
+{
+    // returns the end of the last good record, 0 if the file has to be rebuilt
+    size_t offset = sizeof(FileHeader);
+    while (offset + sizeof(RecordHeader) <= mappedSize) {
+        RecordHeader rh;
+        memcpy(&rh, mapped + offset, sizeof(rh));
+        const uint8_t* data = mapped + offset + sizeof(RecordHeader);
+        if (rh.size == 0 || rh.size > mappedSize - offset - sizeof(RecordHeader))
+            break;
+        if (Checksum(data, rh.size) != rh.checksum)
+            break;
+        Entry e;
+        e.data = data;
+        e.size = rh.size;
+        e.sessionOffset = 0;
+        index[rh.id] = e; // a later record for the same id wins
+        offset += sizeof(RecordHeader) + rh.size;
+    }
+    return offset;
+}
+
+bool
+ShaderCache::Open(const char* path, uint64_t driverKey)
+{
+    Close();
+    if (!path || !path[0])
+        return false;
+
+    size_t validEnd = 0;
+    if (Map(path)) {
+        FileHeader fh;
+        memcpy(&fh, mapped, sizeof(fh));
+        if (fh.magic == sMagic && fh.version == sFormatVersion && fh.driverKey == driverKey)
+            validEnd = ScanRecords();
+        else
+            printf("Shader cache: %s was written by a different driver or version, discarding it.\n", path);
+    }
+
+    if (validEnd == 0) {
+        Unmap();
+        index.clear();
+        file = fopen(path, "w+b");
+        if (file) {
+            FileHeader fh;
+            fh.magic = sMagic;
+            fh.version = sFormatVersion;
+            fh.driverKey = driverKey;
+            if (fwrite(&fh, sizeof(fh), 1, file) == 1) {
+                fflush(file);
+            } else {
+                fclose(file);
+                file = 0;
+            }
+        }
+    } else {
+        // anything past validEnd is a torn record and gets overwritten by the next append
+        file = fopen(path, "r+b");
+    }
+
+    if (!file) {
+        printf("Shader cache: could not open %s for writing, cache disabled.\n", path);
+        Unmap();
+        index.clear();
+        return false;
+    }
+    writeOffset = validEnd == 0 ? sizeof(FileHeader) : validEnd;
+    return true;
+}
+
+void
+ShaderCache::Close()
+{
+    if (file) {
+        fclose(file);
+        file = 0;
+    }
+    Unmap();
+    index.clear();
+    sessionData.clear();
+    sessionData.shrink_to_fit();
+    writeOffset = 0;
+}
+
+uint32_t
+ShaderCache::ReadSize(uint64_t id)
+{
+    if (!file && index.empty())
+        return 0; // disabled, not a miss
+    auto it = index.find(id);
+    if (it == index.end()) {
+        stats.misses++;
+        return 0;
+    }
+    return it->second.size;
+}
+
+bool
+ShaderCache::Read(uint64_t id, void* dest, uint32_t size)
+{
+    auto it = index.find(id);
+    if (it == index.end() || it->second.size != size) {
+        stats.misses++;
+        return false;
+    }
+    const Entry& e = it->second;
+    memcpy(dest, e.data ? e.data : sessionData.data() + e.sessionOffset, size);
+    stats.hits++;
+    return true;
+}
+
+void
+ShaderCache::Write(uint64_t id, const void* data, uint32_t size)
+{
+    if (!file || !data || size == 0)
+        return;
+    auto it = index.find(id);
+    if (it != index.end() && it->second.size == size) {
+        const Entry& e = it->second;
+        if (memcmp(e.data ? e.data : sessionData.data() + e.sessionOffset, data, size) == 0)
+            return;
+    }
+
+    RecordHeader rh;
+    rh.id = id;
+    rh.size = size;
+    rh.checksum = Checksum((const uint8_t*)data, size);
+    if (fseek(file, (long)writeOffset, SEEK_SET) != 0 ||
+        fwrite(&rh, sizeof(rh), 1, file) != 1 ||
+        fwrite(data, size, 1, file) != 1) {
+        // disk full or similar, stop persisting but keep serving what we already have
+        printf("Shader cache: write failed, no further programs will be stored.\n");
+        fclose(file);
+        file = 0;
+        return;
+    }
+    fflush(file);
+    writeOffset += sizeof(rh) + size;
+
+    Entry e;
+    e.data = 0;
+    e.size = size;
+    e.sessionOffset = (uint32_t)sessionData.size();
+    sessionData.insert(sessionData.end(), (const uint8_t*)data, (const uint8_t*)data + size);
+    index[id] = e;
+    stats.writes++;
+}
+
+ShaderCache::Stats
+ShaderCache::GetStats() const
+{
+    Stats s = stats;
+    s.entries = (int)index.size();
+    return s;
+}
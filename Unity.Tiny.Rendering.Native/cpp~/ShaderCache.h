@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <unordered_map>
+#include <vector>
+
+namespace ut {
+
+// Persistent cache for the blobs bgfx hands to cache_write (linked program binaries on GL/GLES).
+// Everything lives in one append-only file: a header followed by { id, size, checksum, data } records.
+// On open the existing file is memory mapped and scanned once to build the id -> record index,
+// new records are appended to the end of the file and kept in memory for the rest of the session.
+// A header with a different driver key throws the whole file away.
+// Not thread safe on its own, callers hold a lock.
+class ShaderCache {
+public:
+    struct Stats {
+        int hits;
+        int misses;
+        int writes;
+        int entries;
+    };
+
+    ShaderCache();
+    ~ShaderCache();
+
+    bool Open(const char* path, uint64_t driverKey);
+    void Close();
+    bool IsOpen() const { return file != 0; }
+
+    // 0 if the id is not cached
+    uint32_t ReadSize(uint64_t id);
+    bool Read(uint64_t id, void* dest, uint32_t size);
+    void Write(uint64_t id, const void* data, uint32_t size);
+
+    Stats GetStats() const;
+
+private:
+    struct Entry {
+        const uint8_t* data; // points into the mapping or into sessionData
+        uint32_t size;
+        uint32_t sessionOffset; // only valid when data is null
+    };
+
+    void Unmap();
+    bool Map(const char* path);
+    size_t ScanRecords();
+
+    FILE* file;
+    uint64_t writeOffset;
+    std::unordered_map<uint64_t, Entry> index;
+    std::vector<uint8_t> sessionData; // records written this session, not covered by the mapping
+    const uint8_t* mapped;
+    size_t mappedSize;
+#if defined(_WIN32)
+    void* mapFile;
+    void* mapHandle;
+#endif
+    Stats stats;
+};
+
+} // namespace ut
@@ -73,6 +73,26 @@ namespace Unity.Tiny.Rendering
         public AABB Value;
     }
 
+    // Per frame culling counters of the chunked submit systems. Chunks are tested once per pass they render to,
+    // chunks that end up fully outside or fully inside a pass frustum skip the per entity tests for that pass.
+    public struct CullingStats
+    {
+        public int chunksTested;
+        public int chunksRejected;
+        public int chunksInside;
+        public int entitiesTested;
+        public int entitiesRejected;
+
+        public void Add(in CullingStats other)
+        {
+            chunksTested += other.chunksTested;
+            chunksRejected += other.chunksRejected;
+            chunksInside += other.chunksInside;
+            entitiesTested += other.entitiesTested;
+            entitiesRejected += other.entitiesRejected;
+        }
+    }
+
     public static class Culling
     {
         public static readonly int[] EdgeTable = { 0b_000_001, 0b_000_100, 0b001_101, 0b101_100, // top
@@ -184,6 +204,49 @@ namespace Unity.Tiny.Rendering
             return CullingResult.Intersects;
         }
 
+        static public CullingResult Cull(in AABB bounds, in Frustum f)
+        {
+            CullingResult rall = CullingResult.Inside;
+            for (int i = 0; i < f.PlanesCount; i++)
+            {
+                float4 plane = f.GetPlane(i);
+                float dist = math.dot(bounds.Center, plane.xyz) + plane.w;
+                float radius = math.dot(bounds.Extents, math.abs(plane.xyz));
+                if (dist + radius < 0.0f) return CullingResult.Outside;
+                if (dist - radius < 0.0f) rall = CullingResult.Intersects;
+            }
+            return rall;
+        }
+
+        // Coarse test for all entities of a chunk: the sphere first, the tighter box only when the sphere straddles a plane.
+        // A negative radius marks chunk bounds that were not computed yet, those always need the per entity tests.
+        static public CullingResult CullChunk(in WorldBoundingSphere sphere, in AABB box, in Frustum f, ref CullingStats stats)
+        {
+            if (sphere.radius < 0.0f)
+                return CullingResult.Intersects;
+            stats.chunksTested++;
+            CullingResult r = Cull(in sphere, in f);
+            if (r == CullingResult.Intersects)
+                r = Cull(in box, in f);
+            if (r == CullingResult.Outside)
+                stats.chunksRejected++;
+            else if (r == CullingResult.Inside)
+                stats.chunksInside++;
+            return r;
+        }
+
+        // Per entity test below a chunk that intersects the frustum, entities without bounds are never culled.
+        static public bool IsCulledInChunk(in WorldBoundingSphere bounds, in Frustum f, ref CullingStats stats)
+        {
+            if (bounds.radius <= 0.0f)
+                return false;
+            stats.entitiesTested++;
+            if (Cull(in bounds, in f) != CullingResult.Outside)
+                return false;
+            stats.entitiesRejected++;
+            return true;
+        }
+
         static public bool IsCulled(in WorldBounds bounds, in Frustum f)
         {
             // if all vertices are completely outside of one culling plane, the object is culled
@@ -41,6 +41,8 @@ namespace Unity.Tiny.Rendering
                                          // 1>x>y>z>0. z is the scale of the highest detail cascade.
         public float cascadeBlendWidth;  // Blend width for blending between cascades: 0=no blending, 1=maximum blending
         public Entity camera;            // The camera this cascade is computed from - must match the camera rendering the shadows
+        public int farCascadeUpdateInterval; // The two far cascades are only re-rendered every this many frames, staggered so they do not land on the same frame.
+                                             // 0 or 1 updates them every frame. All cascades update at once when the light moves.
     }
 
     public struct CascadeData
@@ -58,6 +60,8 @@ namespace Unity.Tiny.Rendering
         public CascadeData c1;
         public CascadeData c2;
         public CascadeData c3;
+        public int dueCascades;          // bit per cascade that may be re-rendered this frame, cascades that are not due keep their data and shadow map contents
+        public uint frameCount;          // frames since the cache was added, staggers the far cascades
 
         public CascadeData GetCascadeData(int idx)
         {
@@ -126,6 +130,7 @@ namespace Unity.Tiny.Rendering
         public const int maxPointOrDirLights = 8;
         public const int maxMappedLights = 2;
         public const int maxCsmLights = 1;
+        public const int maxClusteredLights = 256;
 
         // this is pretty hard limited to what tiny rendering can do, but can be expanded in the future
         public Entity CSMLight; // directional
@@ -151,6 +156,13 @@ namespace Unity.Tiny.Rendering
         }
     }
 
+    // point lights of a LightingSetup that did not fit into PlainLights, next to the LightingSetup
+    // these are assigned to screen space clusters per view and only shaded where they reach
+    public struct ClusteredLight : IBufferElementData
+    {
+        public Entity e;
+    }
+
     /// <summary>
     /// Ambient light.
     /// </summary>
@@ -269,7 +281,7 @@ namespace Unity.Tiny.Rendering
             bool anyEntMasksChanged = false;
             for ( int i=0; i<masks.Length; i++ ) {
                 if ( i>=m_lightingSetupPerMask.Length ) {
-                    Entity eSetup = EntityManager.CreateEntity(ComponentType.ReadWrite<LightingSetup>());
+                    Entity eSetup = EntityManager.CreateEntity(ComponentType.ReadWrite<LightingSetup>(), ComponentType.ReadWrite<ClusteredLight>());
                     anyEntMasksChanged = true;
                     m_lightingSetupPerMask.Add(new SetupAndMask {
                         eSetup = eSetup,
@@ -291,6 +303,8 @@ namespace Unity.Tiny.Rendering
             if (m_lightingSetupPerMask.Length > masks.Length)
                 m_lightingSetupPerMask.ResizeUninitialized(masks.Length);
 
+            var plainLights = new NativeList<Entity>(LightingSetup.maxPointOrDirLights, Allocator.Temp);
+            var clusteredLights = new NativeList<Entity>(Allocator.Temp);
             for ( int i=0; i<m_lightingSetupPerMask.Length; i++ ) {
                 ulong entMask = m_lightingSetupPerMask[i].entitiesMask;
                 // always add all lights to the the lighting setup.
@@ -316,16 +330,36 @@ namespace Unity.Tiny.Rendering
                     else
                         setup.MappedLight1 = e;
                 }).Run();
+                // up to eight lights are all plain lights. with more, the point lights are clustered and only directional lights stay plain
+                plainLights.Clear();
+                clusteredLights.Clear();
+                ComponentDataFromEntity<DirectionalLight> directionalCDFE = GetComponentDataFromEntity<DirectionalLight>(true);
                 Entities.WithNone<DisableRendering>().WithAll<Light, LocalToWorld>().WithNone<SpotLight, ShadowmappedLight, CascadeShadowmappedLight>().ForEach((Entity e)=>{
                     if ( lightMaskCDFE.HasComponent(e) )
                         if ((entMask & lightMaskCDFE[e].Value) == 0)
                             return;
-                    if ( setup.PlainLights.Length<8 ) {
-                        setup.PlainLights.Add(e);
-                    } else {
-                        Assert.IsTrue ( false, "Too many non-shadow mapped lights loaded. Using more than eight non-shadow mapped lights at once is currently not supported.");
-                    }
+                    if ( directionalCDFE.HasComponent(e) )
+                        plainLights.Add(e);
+                    else
+                        clusteredLights.Add(e);
                 }).Run();
+                if ( plainLights.Length + clusteredLights.Length <= LightingSetup.maxPointOrDirLights ) {
+                    plainLights.AddRange(clusteredLights);
+                    clusteredLights.Clear();
+                }
+                Assert.IsTrue ( plainLights.Length <= LightingSetup.maxPointOrDirLights, "Too many directional lights loaded. Using more than eight non-shadow mapped directional lights at once is currently not supported.");
+                Assert.IsTrue ( clusteredLights.Length <= LightingSetup.maxClusteredLights, "Too many point lights loaded. Using more than 256 non-shadow mapped point lights at once is currently not supported.");
+                for ( int j=0; j<plainLights.Length && j<LightingSetup.maxPointOrDirLights; j++ )
+                    setup.PlainLights.Add(plainLights[j]);
+                var prevClustered = EntityManager.GetBuffer<ClusteredLight>(m_lightingSetupPerMask[i].eSetup);
+                bool clusteredChanged = prevClustered.Length != clusteredLights.Length;
+                for ( int j=0; j<clusteredLights.Length && !clusteredChanged; j++ )
+                    clusteredChanged = prevClustered[j].e != clusteredLights[j];
+                if ( clusteredChanged ) {
+                    prevClustered.ResizeUninitialized(math.min(clusteredLights.Length, LightingSetup.maxClusteredLights));
+                    for ( int j=0; j<prevClustered.Length; j++ )
+                        prevClustered[j] = new ClusteredLight { e = clusteredLights[j] };
+                }
                 float3 prevAmbient = new float3();
                 Entities.WithoutBurst().WithAll<AmbientLight>().ForEach((Entity e, in AmbientLight l)=>{
                     if ( lightMaskCDFE.HasComponent(e) )
@@ -375,6 +409,9 @@ namespace Unity.Tiny.Rendering
                 }
             }
 
+            plainLights.Dispose();
+            clusteredLights.Dispose();
+
             var lspm = m_lightingSetupPerMask[uniqueMasksEntities.GetIndex(ulong.MaxValue)];
             if ( anyEntMasksChanged ) {
                 // go through LitMeshRenderers and set the shared component to the new value
@@ -524,7 +561,19 @@ namespace Unity.Tiny.Rendering
             // transform camera to light space, that's where we want to have the most samples!
             float3 camPos = math.transform(invLight, camTx.Value.c3.xyz);
 
+            // all cascades share the light view, if that changed everything has to be rendered again
+            bool lightMoved = !csmDest.c3.view.Equals(invLight);
+            int interval = math.max(csm.farCascadeUpdateInterval, 1);
+            csmDest.frameCount++;
+            csmDest.dueCascades = 0;
             for (int cascadeIndex = 0; cascadeIndex < 4; cascadeIndex++) {
+                if (cascadeIndex < 2 && !lightMoved) {
+                    // far cascades cover most of the world at low resolution, they can lag behind the camera for a few frames
+                    uint phase = cascadeIndex == 1 ? (uint)(interval / 2) : 0;
+                    if ((csmDest.frameCount + phase) % (uint)interval != 0)
+                        continue;
+                }
+                csmDest.dueCascades |= 1 << cascadeIndex;
                 float ratio = 1.0f;
                 float2 useOffset = camPos.xy;
                 switch (cascadeIndex) {
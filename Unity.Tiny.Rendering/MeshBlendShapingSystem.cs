@@ -13,7 +13,7 @@ namespace Unity.Tiny.Rendering
     public class MeshBlendShapingSystem : SystemBase
     {
         [BurstCompile]
-        unsafe struct MeshBlendShapingJob : IJobChunk
+        internal unsafe struct MeshBlendShapingJob : IJobChunk
         {
             [ReadOnly] public ComponentTypeHandle<SkinnedMeshRenderer> SkinnedMeshRendererType;
             [ReadOnly] public BufferTypeHandle<BlendShapeWeight> SMRBlendShapeWeightType;
@@ -52,38 +52,37 @@ namespace Unity.Tiny.Rendering
                 return frameIndex;
             }
 
-            public void ApplyBlendShapeToVertices(float weightInPercent, ref BlendShapeFrame frame, byte* retVerticesPtr, bool isLit)
+            // Only walks the vertices the frame moves, see BlendShapeFrame.VertexIndices
+            internal static void ApplyBlendShapeToVertices(float weightInPercent, ref BlendShapeFrame frame, byte* retVerticesPtr, bool isLit)
             {
-                int deltaValueLength = frame.VerticesPosition.Length;
-                int vertexSize = 0;
-                if (isLit)
-                    vertexSize = UnsafeUtility.SizeOf<DynamicLitVertex>();
-                else
-                    vertexSize = UnsafeUtility.SizeOf<DynamicSimpleVertex>();
-                for (int i = 0; i < deltaValueLength; i++)
+                if (weightInPercent == 0.0f)
+                    return;
+
+                int touchedCount = frame.VertexIndices.Length;
+                int* vertexIndices = (int*)frame.VertexIndices.GetUnsafePtr();
+                float3* deltaPositions = (float3*)frame.VerticesPosition.GetUnsafePtr();
+                if (!isLit)
                 {
-                    ref float3 deltaValue = ref frame.VerticesPosition[i].DeltaPosition;
-                    if (isLit)
-                    {
-                        DynamicLitVertex* dynamicLitVertexPttr = (DynamicLitVertex*)(retVerticesPtr + i * vertexSize);
-                        dynamicLitVertexPttr->Value.Position += weightInPercent * deltaValue;
-                        if (frame.HasNormals)
-                        {
-                            deltaValue = ref frame.VerticesNormal[i].DeltaNormal;
-                            dynamicLitVertexPttr->Value.Normal += weightInPercent * deltaValue;
-                        }
+                    DynamicSimpleVertex* simpleVertices = (DynamicSimpleVertex*)retVerticesPtr;
+                    for (int i = 0; i < touchedCount; i++)
+                        simpleVertices[vertexIndices[i]].Value.Position += weightInPercent * deltaPositions[i];
+                    return;
+                }
 
-                        if (frame.HasTangents)
-                        {
-                            deltaValue = ref frame.VerticesTangent[i].DeltaTangent;
-                            dynamicLitVertexPttr->Value.Tangent += weightInPercent * deltaValue;
-                        }
-                    }
-                    else
-                    {
-                        DynamicSimpleVertex* dynamicSimpleVertex = (DynamicSimpleVertex*)(retVerticesPtr + i * vertexSize);
-                        dynamicSimpleVertex->Value.Position += weightInPercent * deltaValue;
-                    }
+                DynamicLitVertex* litVertices = (DynamicLitVertex*)retVerticesPtr;
+                for (int i = 0; i < touchedCount; i++)
+                    litVertices[vertexIndices[i]].Value.Position += weightInPercent * deltaPositions[i];
+                if (frame.HasNormals)
+                {
+                    float3* deltaNormals = (float3*)frame.VerticesNormal.GetUnsafePtr();
+                    for (int i = 0; i < touchedCount; i++)
+                        litVertices[vertexIndices[i]].Value.Normal += weightInPercent * deltaNormals[i];
+                }
+                if (frame.HasTangents)
+                {
+                    float3* deltaTangents = (float3*)frame.VerticesTangent.GetUnsafePtr();
+                    for (int i = 0; i < touchedCount; i++)
+                        litVertices[vertexIndices[i]].Value.Tangent += weightInPercent * deltaTangents[i];
                 }
             }
 
@@ -4,6 +4,7 @@ using System.Runtime.CompilerServices;
 using Unity.Collections.LowLevel.Unsafe;
 
 [assembly: InternalsVisibleTo("Unity.Tiny.Rendering.Native")]
+[assembly: InternalsVisibleTo("Unity.Tiny.Rendering.Authoring.Tests")]
 namespace Unity.Tiny.Rendering
 {
     /// <summary>
@@ -31,6 +32,23 @@ namespace Unity.Tiny.Rendering
         public float2 Metal_Smoothness; // TODO: 8/16 bit packed
     }
 
+    /// <summary>
+    /// Simplified level of detail of a sub mesh, generated at conversion. Uses the same vertices as the sub mesh.
+    /// Its indices are in LODIndices, which is uploaded right after Indices into the same index buffer, so StartIndex
+    /// counts from the start of Indices.
+    /// Error is an estimate, relative to the radius of the mesh bounds: the root of the largest area weighted mean
+    /// squared distance of a collapsed vertex to the triangle planes it replaced. It is not a bound, the surface can
+    /// move further than that in places.
+    /// </summary>
+    public struct MeshLOD
+    {
+        public int SubMeshStartIndex;   // start index of the full detail sub mesh
+        public int Level;               // 1 is the first simplified level
+        public int StartIndex;
+        public int IndexCount;
+        public float Error;             // estimated distance to the full detail surface, see above
+    }
+
     /// <summary>
     /// Mesh structure (used for 3D cases)
     /// This is a blob asset, reference by the LitMeshRenderData component
@@ -39,6 +57,8 @@ namespace Unity.Tiny.Rendering
     {
         public BlobArray<ushort> Indices;
         public BlobArray<LitVertex> Vertices;
+        public BlobArray<ushort> LODIndices;
+        public BlobArray<MeshLOD> LODs;
     }
 
     /// <summary>
@@ -49,6 +69,8 @@ namespace Unity.Tiny.Rendering
     {
         public BlobArray<ushort> Indices;
         public BlobArray<SimpleVertex> Vertices;
+        public BlobArray<ushort> LODIndices;
+        public BlobArray<MeshLOD> LODs;
     }
 
     /// <summary>
@@ -74,9 +96,9 @@ namespace Unity.Tiny.Rendering
     public struct DynamicMeshData : IComponentData
     {
         public bool Dirty;                  // set to true to trigger re-upload, will revert to false after upload
-        public bool UseDynamicGPUBuffer;    // allocate a dynamic buffer on the gpu, only use this if you expect buffer contents to change every frame
-        public int VertexCapacity;          // capacity for gpu buffer, must be >= NumVertices. Increasing capacity will require re-allocating buffers
-        public int IndexCapacity;           // capacity for gpu buffer, must be >= NumIndices. Increasing capacity will require re-allocating buffers
+        public bool UseDynamicGPUBuffer;    // draw from the gpu buffers shared by all dynamic meshes, only use this if you expect buffer contents to change often
+        public int VertexCapacity;          // capacity for gpu buffer, must be >= NumVertices. Not used with UseDynamicGPUBuffer, the shared buffers grow as needed
+        public int IndexCapacity;           // capacity for gpu buffer, must be >= NumIndices. Not used with UseDynamicGPUBuffer
         public int NumVertices;             // number of vertices to copy from the DynamicLitVertex or DynamicSimpleVertex buffer located next to this component
         public int NumIndices;              // number of indices to copy from the DynamicIndex next to this component
         public Entity CopyFrom;
@@ -152,6 +174,7 @@ namespace Unity.Tiny.Rendering
         public float Weight;
         public bool HasNormals;
         public bool HasTangents;
+        public BlobArray<int> VertexIndices; // only vertices the frame moves, the arrays below run parallel to it
         public BlobArray<BlendShapeVertexPosition> VerticesPosition;
         public BlobArray<BlendShapeVertexNormal> VerticesNormal;
         public BlobArray<BlendShapeVertexTangent> VerticesTangent;
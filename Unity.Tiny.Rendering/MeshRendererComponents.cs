@@ -14,6 +14,40 @@ namespace Unity.Tiny.Rendering
         public int indexCount;
     }
 
+    /// <summary>
+    /// Optional component next to a MeshRenderer, the simplified levels of its sub mesh (see MeshLOD).
+    /// The submit systems draw the coarsest level whose estimated error stays below kMaxErrorPixels on screen.
+    /// The estimate is not a bound (see MeshLOD.Error), so small parts of a level can move further than that.
+    /// </summary>
+    public struct MeshRendererLOD : IComponentData
+    {
+        public const int kMaxLevels = 4;
+        public const float kMaxErrorPixels = 1.0f;
+
+        public Entity mesh;         // the MeshRenderer mesh the levels were built for
+        public int4 startIndex;     // per level, x is the full detail sub mesh of the MeshRenderer
+        public int4 indexCount;     // 0 for levels that do not exist
+        public float4 error;        // estimated distance to the full detail surface relative to the bounding sphere radius, see MeshLOD.Error
+
+        // false once the MeshRenderer points to another mesh or sub mesh, only level 0 can be drawn then
+        public bool Matches(in MeshRenderer meshRenderer)
+        {
+            return mesh == meshRenderer.mesh && startIndex.x == meshRenderer.startIndex && indexCount.x == meshRenderer.indexCount;
+        }
+
+        // level to draw when the bounding sphere radius covers radiusPixels on screen
+        public int SelectLevel(float radiusPixels)
+        {
+            int level = 0;
+            for (int i = 1; i < kMaxLevels; i++)
+            {
+                if (indexCount[i] > 0 && error[i] * radiusPixels <= kMaxErrorPixels)
+                    level = i;
+            }
+            return level;
+        }
+    }
+
     /// <summary>
     /// Component next to a MeshRenderer, indicating it is unlit
     /// </summary>
@@ -42,6 +76,16 @@ namespace Unity.Tiny.Rendering
     {
     }
 
+    /// <summary>
+    /// Buffer next to a SimpleParticleRenderer or LitParticleRenderer, one element per living particle.
+    /// The MeshRenderer mesh is drawn once per element, with instancing where the renderer supports it.
+    /// </summary>
+    public struct ParticleInstance : IBufferElementData
+    {
+        public float4x4 localToWorld;   // full transform, billboarded materials only use the rotation and scale to orient the billboard
+        public float4 color;            // replaces the mesh vertex colors
+    }
+
     public struct BlitRenderer : IComponentData
     {
         public Entity texture;
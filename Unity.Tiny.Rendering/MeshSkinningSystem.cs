@@ -205,7 +205,7 @@ namespace Unity.Tiny.Rendering
     public unsafe class CPUMeshSkinningSystem : SystemBase
     {
         [BurstCompile]
-        unsafe struct CPUMeshSkinningJob : IJobChunk
+        internal unsafe struct CPUMeshSkinningJob : IJobChunk
         {
             //skinned mesh renderer info
             [ReadOnly] public BufferTypeHandle<SkinnedMeshBoneRef> SkinnedMeshBoneRefType;
@@ -226,91 +226,101 @@ namespace Unity.Tiny.Rendering
             //simple skinned mesh data
             [ReadOnly] public ComponentDataFromEntity<SimpleMeshRenderData> ComponentSimpleMeshRenderData;
 
-            private float4x4 GetBoneMatrix(DynamicBuffer<SkinnedMeshBoneRef> smbrBuffer, int boneIndex)
+            // Bone matrices are gathered once per renderer, the vertex loops below only index into them
+            private void GatherBoneMatrices(DynamicBuffer<SkinnedMeshBoneRef> smbrBuffer, NativeArray<float4x4> boneMatrices)
             {
-                SkinnedMeshBoneRef boneRef = smbrBuffer[boneIndex];
-                SkinnedMeshBoneInfo boneInfo = ComponentSkinnedMeshBoneInfo[boneRef.bone];
-                return boneInfo.bonematrix;
+                for (int i = 0; i < smbrBuffer.Length; i++)
+                    boneMatrices[i] = ComponentSkinnedMeshBoneInfo[smbrBuffer[i].bone].bonematrix;
             }
 
-            public float4x4 GetSkinningMatrix(DynamicBuffer<SkinnedMeshBoneRef> smbrBuffer, SkinnedMeshRenderer skinnedMeshRenderer,
-                ref SkinnedMeshData skinnedMeshData, int vertexIndex, bool hasOriginalBoneIndex)
+            // Blends whole matrix columns, four lanes at a time, instead of summing weighted float4x4s
+            internal static float4x4 GetSkinningMatrix(float4x4* boneMatrices, float4 boneWeight, float4 boneIndex, SkinQuality skinQuality)
             {
-                float4x4 mat = float4x4.zero;
-                SkinnedMeshVertex skinnedVertex = skinnedMeshData.Vertices[vertexIndex];
-                float4 boneWeight = skinnedVertex.BoneWeight;
-                float4 boneIndex = float4.zero;
-                if (!hasOriginalBoneIndex)
-                    boneIndex = skinnedVertex.BoneIndex;
-                else
-                    boneIndex = BufferOriginalBoneIndex[skinnedMeshRenderer.sharedMesh][vertexIndex].BoneIndex;
-                switch (skinnedMeshRenderer.skinQuality)
+                int4 bone = (int4)boneIndex;
+                switch (skinQuality)
                 {
                     case SkinQuality.Bone1:
-                        mat = GetBoneMatrix(smbrBuffer, (int) boneIndex.x);
-                        break;
+                        return boneMatrices[bone.x];
                     case SkinQuality.Bone2:
-                        float4x4 boneMatrix = GetBoneMatrix(smbrBuffer, (int) boneIndex.x);
-                        float invSum = 1 / (boneWeight.x + boneWeight.y);
-                        float4x4 matX = boneWeight.x * invSum * boneMatrix;
-                        boneMatrix = GetBoneMatrix(smbrBuffer, (int) boneIndex.y);
-                        float4x4 matY = boneWeight.y * invSum * boneMatrix;
-                        mat = matX + matY;
-                        break;
+                    {
+                        float2 w = boneWeight.xy / (boneWeight.x + boneWeight.y);
+                        float4x4 a = boneMatrices[bone.x];
+                        float4x4 b = boneMatrices[bone.y];
+                        return new float4x4(w.x * a.c0 + w.y * b.c0, w.x * a.c1 + w.y * b.c1, w.x * a.c2 + w.y * b.c2, w.x * a.c3 + w.y * b.c3);
+                    }
                     case SkinQuality.Bone4:
-                        boneMatrix = GetBoneMatrix(smbrBuffer, (int) boneIndex.x);
-                        matX = boneWeight.x * boneMatrix;
-                        boneMatrix = GetBoneMatrix(smbrBuffer, (int) boneIndex.y);
-                        matY = boneWeight.y * boneMatrix;
-                        boneMatrix = GetBoneMatrix(smbrBuffer, (int) boneIndex.z);
-                        float4x4 matZ = boneWeight.z * boneMatrix;
-                        boneMatrix = GetBoneMatrix(smbrBuffer, (int) boneIndex.w);
-                        float4x4 matW = boneWeight.w * boneMatrix;
-                        mat = matX + matY + matZ + matW;
-                        break;
+                    {
+                        float4x4 a = boneMatrices[bone.x];
+                        float4x4 b = boneMatrices[bone.y];
+                        float4x4 c = boneMatrices[bone.z];
+                        float4x4 d = boneMatrices[bone.w];
+                        float4 w = boneWeight;
+                        return new float4x4(w.x * a.c0 + w.y * b.c0 + w.z * c.c0 + w.w * d.c0,
+                            w.x * a.c1 + w.y * b.c1 + w.z * c.c1 + w.w * d.c1,
+                            w.x * a.c2 + w.y * b.c2 + w.z * c.c2 + w.w * d.c2,
+                            w.x * a.c3 + w.y * b.c3 + w.z * c.c3 + w.w * d.c3);
+                    }
                 }
+                return float4x4.zero;
+            }
 
-                return mat;
+            // Bone indices come from OriginalVertexBoneIndex when the mesh was split into gpu draw ranges at conversion
+            private float4* GetOriginalBoneIndices(SkinnedMeshRenderer skinnedMeshRenderer)
+            {
+                if (!BufferOriginalBoneIndex.HasComponent(skinnedMeshRenderer.sharedMesh))
+                    return null;
+                return (float4*)BufferOriginalBoneIndex[skinnedMeshRenderer.sharedMesh].GetUnsafeReadOnlyPtr();
             }
 
-            public unsafe void Skinning(ref DynamicBuffer<DynamicSimpleVertex> retBuffer, ref BlobArray<SimpleVertex> staticVertices,
-                DynamicBuffer<SkinnedMeshBoneRef> smbrBuffer, SkinnedMeshRenderer skinnedMeshRenderer, ref SkinnedMeshData skinnedMeshData)
+            // Bone indices come from originalBoneIndex instead of skin when it is not null
+            internal static void SkinVertices(SimpleVertex* src, SkinnedMeshVertex* skin, float4* originalBoneIndex,
+                float4x4* boneMatrices, SkinQuality skinQuality, DynamicSimpleVertex* dest, int vertexCount)
             {
-                int vertexCount = staticVertices.Length;
-                bool hasOriginalBoneIndex = BufferOriginalBoneIndex.HasComponent(skinnedMeshRenderer.sharedMesh);
                 for (int i = 0; i < vertexCount; i++)
                 {
-                    DynamicSimpleVertex dynamicVertex = retBuffer[i];
-                    SimpleVertex staticVertex = staticVertices[i];
-                    float4x4 mat = GetSkinningMatrix(smbrBuffer, skinnedMeshRenderer, ref skinnedMeshData, i, hasOriginalBoneIndex);
-                    float4 retPosition = math.mul(mat, new float4(staticVertex.Position, 1));
-                    dynamicVertex.Value.Position = retPosition.xyz;
-                    retBuffer[i] = dynamicVertex;
+                    float4 boneIndex = originalBoneIndex != null ? originalBoneIndex[i] : skin[i].BoneIndex;
+                    float4x4 mat = GetSkinningMatrix(boneMatrices, skin[i].BoneWeight, boneIndex, skinQuality);
+                    float3 p = src[i].Position;
+                    dest[i].Value.Position = (mat.c0 * p.x + mat.c1 * p.y + mat.c2 * p.z + mat.c3).xyz;
                 }
             }
 
-            public unsafe void Skinning(ref DynamicBuffer<DynamicLitVertex> retBuffer, ref BlobArray<LitVertex> staticVertices,
-                DynamicBuffer<SkinnedMeshBoneRef> smbrBuffer, SkinnedMeshRenderer skinnedMeshRenderer, ref SkinnedMeshData skinnedMeshData)
+            // Normals are directions, the bone translation is left out for them
+            internal static void SkinVertices(LitVertex* src, SkinnedMeshVertex* skin, float4* originalBoneIndex,
+                float4x4* boneMatrices, SkinQuality skinQuality, DynamicLitVertex* dest, int vertexCount)
             {
-                int vertexCount = staticVertices.Length;
-                bool hasOriginalBoneIndex = BufferOriginalBoneIndex.HasComponent(skinnedMeshRenderer.sharedMesh);
                 for (int i = 0; i < vertexCount; i++)
                 {
-                    DynamicLitVertex dynamicVertex = retBuffer[i];
-                    LitVertex staticVertex = staticVertices[i];
-                    float4x4 mat = GetSkinningMatrix(smbrBuffer, skinnedMeshRenderer, ref skinnedMeshData, i, hasOriginalBoneIndex);
-                    float4 retPosition = math.mul(mat, new float4(staticVertex.Position, 1));
-                    float4 retNormal = math.mul(mat, new float4(staticVertex.Normal, 1));
-                    dynamicVertex.Value.Position = retPosition.xyz;
-                    dynamicVertex.Value.Normal = retNormal.xyz;
-                    retBuffer[i] = dynamicVertex;
+                    float4 boneIndex = originalBoneIndex != null ? originalBoneIndex[i] : skin[i].BoneIndex;
+                    float4x4 mat = GetSkinningMatrix(boneMatrices, skin[i].BoneWeight, boneIndex, skinQuality);
+                    float3 p = src[i].Position;
+                    float3 n = src[i].Normal;
+                    dest[i].Value.Position = (mat.c0 * p.x + mat.c1 * p.y + mat.c2 * p.z + mat.c3).xyz;
+                    dest[i].Value.Normal = (mat.c0 * n.x + mat.c1 * n.y + mat.c2 * n.z).xyz;
                 }
             }
 
+            public unsafe void Skinning(ref DynamicBuffer<DynamicSimpleVertex> retBuffer, ref BlobArray<SimpleVertex> staticVertices,
+                float4x4* boneMatrices, SkinnedMeshRenderer skinnedMeshRenderer, ref SkinnedMeshData skinnedMeshData)
+            {
+                SkinVertices((SimpleVertex*)staticVertices.GetUnsafePtr(), (SkinnedMeshVertex*)skinnedMeshData.Vertices.GetUnsafePtr(),
+                    GetOriginalBoneIndices(skinnedMeshRenderer), boneMatrices, skinnedMeshRenderer.skinQuality,
+                    (DynamicSimpleVertex*)retBuffer.GetUnsafePtr(), staticVertices.Length);
+            }
+
+            public unsafe void Skinning(ref DynamicBuffer<DynamicLitVertex> retBuffer, ref BlobArray<LitVertex> staticVertices,
+                float4x4* boneMatrices, SkinnedMeshRenderer skinnedMeshRenderer, ref SkinnedMeshData skinnedMeshData)
+            {
+                SkinVertices((LitVertex*)staticVertices.GetUnsafePtr(), (SkinnedMeshVertex*)skinnedMeshData.Vertices.GetUnsafePtr(),
+                    GetOriginalBoneIndices(skinnedMeshRenderer), boneMatrices, skinnedMeshRenderer.skinQuality,
+                    (DynamicLitVertex*)retBuffer.GetUnsafePtr(), staticVertices.Length);
+            }
+
             public unsafe void Execute(ArchetypeChunk chunk, int chunkIndex, int firstEntityIndex)
             {
                 BufferAccessor<SkinnedMeshBoneRef> smbrBufferAccessor = chunk.GetBufferAccessor(SkinnedMeshBoneRefType);
                 NativeArray<SkinnedMeshRenderer> chunkSkinnedMeshRenderer = chunk.GetNativeArray(SkinnedMeshRendererType);
+                var boneMatrices = new NativeArray<float4x4>(64, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
                 for (int j = 0; j < chunk.Count; j++)
                 {
                     SkinnedMeshRenderer skinnedMeshRenderer = chunkSkinnedMeshRenderer[j];
@@ -318,6 +328,13 @@ namespace Unity.Tiny.Rendering
                         continue;
 
                     DynamicBuffer<SkinnedMeshBoneRef> smbrBuffer = smbrBufferAccessor[j];
+                    if (smbrBuffer.Length > boneMatrices.Length)
+                    {
+                        boneMatrices.Dispose();
+                        boneMatrices = new NativeArray<float4x4>(smbrBuffer.Length, Allocator.Temp, NativeArrayOptions.UninitializedMemory);
+                    }
+                    GatherBoneMatrices(smbrBuffer, boneMatrices);
+                    float4x4* boneMatricesPtr = (float4x4*)boneMatrices.GetUnsafePtr();
 
                     SkinnedMeshRenderData skinnedMeshRenderData = ComponentSkinnedMeshRenderData[skinnedMeshRenderer.sharedMesh];
                     ref SkinnedMeshData skinnedMeshData = ref skinnedMeshRenderData.SkinnedMeshDataRef.Value;
@@ -328,20 +345,21 @@ namespace Unity.Tiny.Rendering
                         LitMeshRenderData litMeshRenderData = ComponentLitMeshRenderData[skinnedMeshRenderer.sharedMesh];
                         ref LitMeshData litMeshData = ref litMeshRenderData.Mesh.Value;
                         DynamicBuffer<DynamicLitVertex> dlvBuffer = BufferDynamicLitVertex[skinnedMeshRenderer.dynamicMesh];
-                        Skinning(ref dlvBuffer, ref litMeshData.Vertices, smbrBuffer, skinnedMeshRenderer, ref skinnedMeshData);
+                        Skinning(ref dlvBuffer, ref litMeshData.Vertices, boneMatricesPtr, skinnedMeshRenderer, ref skinnedMeshData);
                     }
                     else
                     {
                         SimpleMeshRenderData simpleMeshRenderData = ComponentSimpleMeshRenderData[skinnedMeshRenderer.sharedMesh];
                         ref SimpleMeshData simpleMeshData = ref simpleMeshRenderData.Mesh.Value;
                         DynamicBuffer<DynamicSimpleVertex> dsvBuffer = BufferDynamicSimpleVertex[skinnedMeshRenderer.dynamicMesh];
-                        Skinning(ref dsvBuffer, ref simpleMeshData.Vertices, smbrBuffer, skinnedMeshRenderer, ref skinnedMeshData);
+                        Skinning(ref dsvBuffer, ref simpleMeshData.Vertices, boneMatricesPtr, skinnedMeshRenderer, ref skinnedMeshData);
                     }
 
                     DynamicMeshData dmd = ComponentDynamicMeshData[skinnedMeshRenderer.dynamicMesh];
                     dmd.Dirty = true;
                     ComponentDynamicMeshData[skinnedMeshRenderer.dynamicMesh] = dmd;
                 }
+                boneMatrices.Dispose();
             }
         }
 
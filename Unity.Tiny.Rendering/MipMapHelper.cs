@@ -68,6 +68,34 @@ namespace Unity.Tiny.Rendering
             }
         }
 
+        [BurstCompile]
+        internal unsafe static void DownSampleBox8(byte* src, int w, int h, byte* dest, int wdest, int hdest)
+        {
+            Assert.IsTrue(w > 1 || h > 1);
+            if ((hdest == 1 && h == 1) || (wdest == 1 && w == 1))   // x or y only
+            {
+                int n = hdest > wdest ? hdest : wdest;
+                for (int i = 0; i < n; i++)
+                {
+                    *dest = (byte)((src[0] + src[1]) >> 1);
+                    dest++;
+                    src += 2;
+                }
+                return;
+            }
+            // regular
+            for (int y = 0; y < hdest; y++)
+            {
+                byte* srcl = src + y * 2 * w;
+                for (int x = 0; x < wdest; x++)
+                {
+                    *dest = (byte)((srcl[0] + srcl[1] + srcl[w] + srcl[w + 1]) >> 2);
+                    dest++;
+                    srcl += 2;
+                }
+            }
+        }
+
         [BurstCompile]
         internal static unsafe void DownSampleBox(float4* src, int w, int h, float4* dest, int wdest, int hdest)
         {
@@ -223,6 +251,24 @@ namespace Unity.Tiny.Rendering
             }
         }
 
+        // single channel images (masks) are always linear
+        internal static unsafe void FillMipMapChain8(int w, int h, byte* dest)
+        {
+            byte* src = dest;
+            dest += w * h;
+            for (;;)
+            {
+                if (w == 1 && h == 1) break;
+                int wdest = w == 1 ? 1 : w >> 1;
+                int hdest = h == 1 ? 1 : h >> 1;
+                DownSampleBox8(src, w, h, dest, wdest, hdest);
+                src += w * h;
+                dest += wdest * hdest;
+                w = wdest;
+                h = hdest;
+            }
+        }
+
         internal static unsafe void FillMipMapChain32(int w, int h, uint* dest, bool srgb)
         {
             uint* src = dest;
@@ -1,5 +1,6 @@
 using System;
 using System.Collections.Generic;
+using Unity.Collections;
 using Unity.Mathematics;
 using Unity.Entities;
 using Unity.Tiny;
@@ -190,7 +191,8 @@ namespace Unity.Tiny.Rendering
     {
         FlipCulling = 3,
         CullingMask = 3,
-        RenderToTexture = 4
+        RenderToTexture = 4,
+        Cached = 8              // shadow map pass whose target still holds what it would render, nothing is submitted to it this frame
     }
 
     public struct RenderPass : IComponentData
@@ -227,6 +229,18 @@ namespace Unity.Tiny.Rendering
             if (normZ < 0.0f) normZ = 0.0f; // we have to clamp here, as this is only the center of the object, and objects still can render even if their center is near clipped
             return math.asuint(normZ); // floats with the same sign sort as uints
         }
+
+        // rough size of a world space sphere radius in viewport pixels, for picking a level of detail
+        public float ComputeScreenRadius(in float3 center, float radius)
+        {
+            float pixelsPerUnit = projectionTransform.c1.y * viewport.h * 0.5f;
+            if (projectionTransform.c3.w != 0.0f) // orthographic
+                return radius * pixelsPerUnit;
+            float w = math.mul(viewProjectionTransform, new float4(center, 1.0f)).w;
+            if (w <= radius) // camera close to or inside the sphere
+                return float.MaxValue;
+            return radius * pixelsPerUnit / w;
+        }
     }
 
     [UpdateInGroup(typeof(PresentationSystemGroup))]
@@ -235,36 +249,79 @@ namespace Unity.Tiny.Rendering
     [UpdateBefore(typeof(SubmitSystemGroup))]
     public unsafe class PreparePassesSystem : SystemBase
     {
-        private void RecAddPasses(Entity eNode, ref ushort nextViewId)
+        // the graph compiled into evaluation order, index in here is the view id of the pass.
+        // Only recompiled when nodes or passes are added, removed or rewired.
+        private NativeList<Entity> m_passOrder;
+        private EntityQuery m_changedNodeDeps;
+        private EntityQuery m_changedNodePasses;
+        private int m_orderVersion;
+
+        private void RecAddPasses(Entity eNode)
         {
             // check already added
             RenderNode node = EntityManager.GetComponentData<RenderNode>(eNode);
             if (node.alreadyAdded)
                 return;
             node.alreadyAdded = true;
+            EntityManager.SetComponentData(eNode, node);
             // recurse dependencies
             if (EntityManager.HasComponent<RenderNodeRef>(eNode))
             {
-                DynamicBuffer<RenderNodeRef> deps = EntityManager.GetBuffer<RenderNodeRef>(eNode);
+                DynamicBuffer<RenderNodeRef> deps = EntityManager.GetBufferRO<RenderNodeRef>(eNode);
                 for (int i = 0; i < deps.Length; i++)
-                    RecAddPasses(deps[i].e, ref nextViewId);
+                    RecAddPasses(deps[i].e);
             }
             // now add own passes
             if (EntityManager.HasComponent<RenderPassRef>(eNode))
             {
-                DynamicBuffer<RenderPassRef> passes = EntityManager.GetBuffer<RenderPassRef>(eNode);
+                DynamicBuffer<RenderPassRef> passes = EntityManager.GetBufferRO<RenderPassRef>(eNode);
                 //RenderDebug.LogFormat("Adding passes to graph for {0}: {1} passes.", eNode, passes.Length);
                 for (int i = 0; i < passes.Length; i++)
-                {
-                    var p = EntityManager.GetComponentData<RenderPass>(passes[i].e);
-                    p.viewId = nextViewId++;
-                    EntityManager.SetComponentData<RenderPass>(passes[i].e, p);
-                }
+                    m_passOrder.Add(passes[i].e);
+            }
+        }
+
+        private int GraphOrderVersion()
+        {
+            return EntityManager.GetComponentOrderVersion<RenderNode>() + EntityManager.GetComponentOrderVersion<RenderNodeRef>() +
+                EntityManager.GetComponentOrderVersion<RenderPassRef>() + EntityManager.GetComponentOrderVersion<RenderPass>() +
+                EntityManager.GetComponentOrderVersion<RenderNodePrimarySurface>();
+        }
+
+        private void CompileGraph()
+        {
+            // sort into eval order (bgfx issues in-order per view. a better api could use the render graph to issue without gpu
+            // barriers where possible)
+            // we expect < 100 or so passes, so the below code does not need to be crazy great
+            m_passOrder.Clear();
+            Entities.ForEach((ref RenderNode rnode) => { rnode.alreadyAdded = false; }).Run();
+            Entities.WithoutBurst().WithAll<RenderNodePrimarySurface>().ForEach((Entity eNode) => { RecAddPasses(eNode); }).Run();
+            Assert.IsTrue(m_passOrder.Length <= 0xffff);
+
+            // there SHOULD not be any passes around that are not referenced by the graph...
+            Entities.ForEach((ref RenderPass pass) => { pass.viewId = 0xffff; }).Run();
+            var passes = GetComponentDataFromEntity<RenderPass>();
+            for (int i = 0; i < m_passOrder.Length; i++)
+            {
+                var p = passes[m_passOrder[i]];
+                p.viewId = (ushort)i;
+                passes[m_passOrder[i]] = p;
             }
         }
 
         protected override void OnCreate()
         {
+            m_passOrder = new NativeList<Entity>(Allocator.Persistent);
+            m_changedNodeDeps = GetEntityQuery(ComponentType.ReadOnly<RenderNode>(), ComponentType.ReadOnly<RenderNodeRef>());
+            m_changedNodeDeps.SetChangedVersionFilter(typeof(RenderNodeRef));
+            m_changedNodePasses = GetEntityQuery(ComponentType.ReadOnly<RenderNode>(), ComponentType.ReadOnly<RenderPassRef>());
+            m_changedNodePasses.SetChangedVersionFilter(typeof(RenderPassRef));
+            m_orderVersion = -1;
+        }
+
+        protected override void OnDestroy()
+        {
+            m_passOrder.Dispose();
         }
 
         void ResizeRenderTexture ( Entity eTex, int w, int h )
@@ -284,16 +341,13 @@ namespace Unity.Tiny.Rendering
         {
             // make sure passes have viewid, transform, scissor rect and view rect set
 
-            // reset alreadyAdded state
-            // we expect < 100 or so passes, so the below code does not need to be crazy great
-            Entities.ForEach((ref RenderNode rnode) => { rnode.alreadyAdded = false; }).Run();
-            Entities.ForEach((ref RenderPass pass) => { pass.viewId = 0xffff; }).Run(); // there SHOULD not be any passes around that are not referenced by the graph...
-
-            // get all nodes, sort (bgfx issues in-order per view. a better api could use the render graph to issue without gpu
-            // barriers where possible)
-            // sort into eval order, assign pass viewId
-            ushort nextViewId = 0;
-            Entities.WithoutBurst().WithAll<RenderNodePrimarySurface>().ForEach((Entity eNode) => { RecAddPasses(eNode, ref nextViewId); }).Run();
+            // the graph only changes with cameras or the render graph config, not every frame
+            int orderVersion = GraphOrderVersion();
+            if (orderVersion != m_orderVersion || m_changedNodeDeps.CalculateEntityCount() != 0 || m_changedNodePasses.CalculateEntityCount() != 0)
+            {
+                CompileGraph();
+                m_orderVersion = orderVersion;
+            }
 
             var di = GetSingleton<DisplayInfo>();
             
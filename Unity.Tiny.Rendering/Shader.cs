@@ -15,6 +15,10 @@ namespace Unity.Tiny.Rendering
         public static readonly Hash128 blitsrgb = new Hash128("5876A49959C746A7A93B6475C97745D5");
         public static readonly Hash128 shadowmap = new Hash128("AFFC8771429B4546B0048069114518B7");
         public static readonly Hash128 shadowmapgpuskinning = new Hash128("BC2BD45FD16846678911E10BE12BC081");
+        public static readonly Hash128 simplelitinstanced = new Hash128("0C60673274444CF9A8EC62C300223466");
+        public static readonly Hash128 shadowmapinstanced = new Hash128("5193390AA2AA4CBFA1A29E396DE68354");
+        public static readonly Hash128 simpleparticleinstanced = new Hash128("EF696A8C35EA42A7863E2982AE096C3B");
+        public static readonly Hash128 simplelitparticleinstanced = new Hash128("3B993D7CDC784A1AB7F544E8A46A2BF7");
     }
 
     public struct BuiltInShader : IComponentData
@@ -63,4 +67,25 @@ namespace Unity.Tiny.Rendering
     {
         public BlobAssetReference<PrecompiledShaderPipeline> shaders;
     }
+
+    /// <summary>
+    /// Singleton that enables the persistent shader program cache.
+    /// </summary>
+    /// <remarks>
+    /// Linked program binaries are written to a single file at Path and reused on the next launch,
+    /// which skips shader compilation and linking on drivers that support it (mostly OpenGL and OpenGL ES).
+    /// The file is discarded when the GPU, the backend or Version changes. Bump Version after a driver or app update
+    /// that the device ids do not reflect. Must be set before the renderer is initialized.
+    /// </remarks>
+    public struct ShaderCacheConfig : IComponentData
+    {
+        /// <summary>
+        /// Writable file path for the cache. Empty disables the cache.
+        /// </summary>
+        public FixedString512 Path;
+        /// <summary>
+        /// Application defined version, only the low 24 bits are used.
+        /// </summary>
+        public uint Version;
+    }
 }
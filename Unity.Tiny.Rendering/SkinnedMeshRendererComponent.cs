@@ -5,7 +5,9 @@ namespace Unity.Tiny.Rendering
 {
     public class MeshSkinningConfig
     {
-        public static int GPU_SKINNING_MAX_BONES = 16;
+        // Bones per gpu skinned draw. Bone matrices are read from a palette texture, so this only decides when a mesh
+        // is split into several draw ranges at conversion time.
+        public static int GPU_SKINNING_MAX_BONES = 256;
     }
 
     public enum ShadowCastingMode
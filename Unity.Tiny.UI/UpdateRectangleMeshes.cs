@@ -207,7 +207,7 @@ namespace Unity.Tiny.UI
                 VertexCapacity = vBuffer.Capacity,
                 NumIndices = iBuffer.Length,
                 NumVertices = vBuffer.Length,
-                UseDynamicGPUBuffer = false
+                UseDynamicGPUBuffer = true
             };
             EntityManager.AddComponentData<DynamicMeshData>(eMesh, dmd);
         }